@@ -0,0 +1,229 @@
+#include <ANSIColors.hpp>
+#include <ArgParser.hpp>
+#include <Config.hpp>
+#include <Drone.hpp>
+#include <DroneLogLoader.hpp>
+#include <Equivalence.hpp>
+
+#include <cstdlib>  // strtod, strtoul
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+/// The streams that are replayed through both implementations.
+struct Streams {
+    vector<ColVector<Nx_att>> x_att;
+    vector<ColVector<Ny_att>> r_att;
+    vector<ColVector<Nx_alt>> x_alt;
+    vector<ColVector<Ny_alt>> r_alt;
+
+    vector<ColVector<Nx_att>> x_hat_att;
+    vector<ColVector<Ny_att>> y_att;
+    vector<ColVector<Nu_att>> u_att;
+    vector<ColVector<Nx_alt>> x_hat_alt;
+    vector<ColVector<Ny_alt>> y_alt;
+    vector<ColVector<Nu_alt>> u_alt;
+};
+
+/**
+ * Random states around hovering, with random references, sensor readings and
+ * control signals. The elements are independent, so the integral of the
+ * altitude controller doesn't correspond to a real flight.
+ */
+Streams randomStreams(const Drone &drone, size_t samples) {
+    mt19937 rng(1);
+    uniform_real_distribution<double> dist(-1, 1);
+    auto random = [&](double scale) { return scale * dist(rng); };
+
+    auto randomAttitude = [&] {
+        DroneAttitudeState x = {};
+        x.setOrientation(eul2quat({random(M_PI_2), random(0.3), random(0.3)}));
+        x.setAngularVelocity({random(1), random(1), random(1)});
+        x.setMotorSpeed({random(20), random(20), random(20)});
+        return x;
+    };
+    auto randomAltitude = [&] {
+        return ColVector<Nx_alt>{drone.p.nh + random(20), 1 + random(1),
+                                 random(0.5)};
+    };
+
+    Streams s;
+    for (size_t i = 0; i < samples; ++i) {
+        DroneAttitudeState ref = randomAttitude();
+        s.x_att.push_back(randomAttitude());
+        s.r_att.push_back(vcat(ref.getOrientation(), zeros<3, 1>()));
+        s.x_alt.push_back(randomAltitude());
+        s.r_alt.push_back({1 + random(1)});
+
+        DroneAttitudeState x_hat = randomAttitude();
+        DroneAttitudeState y     = x_hat;
+        Quaternion dq = eul2quat({random(0.05), random(0.05), random(0.05)});
+        y.setOrientation(quatmultiply(x_hat.getOrientation(), dq));
+        y.setAngularVelocity(x_hat.getAngularVelocity() +
+                             ColVector<3>{random(0.1), random(0.1),
+                                          random(0.1)});
+        s.x_hat_att.push_back(x_hat);
+        s.y_att.push_back(vcat(y.getOrientation(), y.getAngularVelocity()));
+        s.u_att.push_back({random(0.1), random(0.1), random(0.1)});
+        ColVector<Nx_alt> x_hat_alt = randomAltitude();
+        s.x_hat_alt.push_back(x_hat_alt);
+        s.y_alt.push_back({x_hat_alt[1][0] + random(0.05)});
+        s.u_alt.push_back({random(0.1)});
+    }
+    return s;
+}
+
+/**
+ * The states, references, sensor readings and control signals of a recorded
+ * flight. The observers are given the estimate of the previous sample.
+ */
+Streams recordedStreams(const DroneLogLoader &log) {
+    Streams s;
+    for (size_t i = 1; i < log.size(); ++i) {
+        const DroneLogEntry &prev = log[i - 1], &entry = log[i];
+        ColVector<Ny> reference   = entry.getReference();
+        s.x_att.push_back(entry.getAttitudeState());
+        s.r_att.push_back(getBlock<0, Ny_att, 0, 1>(reference));
+        s.x_alt.push_back(DroneState{entry.getState()}.getAltitude());
+        s.r_alt.push_back({entry.referenceHeight});
+
+        s.x_hat_att.push_back(prev.getAttitudeState());
+        s.y_att.push_back(
+            vcat(ColVectorFromCppArray(entry.measurementOrientation),
+                 ColVectorFromCppArray(entry.measurementAngularVelocity)));
+        s.u_att.push_back(ColVectorFromCppArray(entry.attitudeControlSignals));
+        s.x_hat_alt.push_back(DroneState{prev.getState()}.getAltitude());
+        s.y_alt.push_back({entry.measurementHeight});
+        s.u_alt.push_back({entry.altitudeMarginalControlSignal});
+    }
+    return s;
+}
+
+void printLatency(const char *name, const LatencyStatistics &stats) {
+    cout << "  " << setw(14) << left << name << right << "p50 " << setw(8)
+         << stats.p50 << "   p99 " << setw(8) << stats.p99 << "   max "
+         << setw(9) << stats.max << "  " << cycleCounterUnit() << endl;
+}
+
+/// Prints the result, and returns whether the outputs agree.
+bool report(const char *name, const EquivalenceResult &result,
+            double tolerance, bool cold) {
+    bool agree = result.maxDifference <= tolerance;
+    cout << ANSIColors::whiteb << name << ANSIColors::reset << endl
+         << "  Maximum difference: " << (agree ? "" : ANSIColors::redb)
+         << scientific << setprecision(3) << result.maxDifference
+         << ANSIColors::reset << " (sample " << result.maxDifferenceIndex
+         << ")" << endl
+         << "  RMS difference:     " << result.rmsDifference << endl
+         << fixed << setprecision(0);
+    printLatency("C++ (warm)", result.warm[0]);
+    printLatency("C (warm)", result.warm[1]);
+    if (cold) {
+        printLatency("C++ (cold)", result.cold[0]);
+        printLatency("C (cold)", result.cold[1]);
+    }
+    cout << defaultfloat << endl;
+    return agree;
+}
+
+/**
+ * Replays the same streams through the C++ controllers and observers and
+ * through the wrappers of the on-board C implementations, and reports the
+ * largest and the RMS difference of their outputs, and the distribution of
+ * the execution time of every call, with warm and with cold caches.
+ *
+ * The streams are random, or they are taken from a recorded flight. Fails if
+ * the outputs differ by more than the tolerance.
+ */
+int main(int argc, char const *argv[]) {
+
+    /* ------ Parse command line arguments ---------------------------------- */
+
+    filesystem::path loadPath = Config::loadPath;
+    filesystem::path logPath  = {};
+    size_t samples            = 1000;
+    double tolerance          = 1e-4;
+    EquivalenceOptions opt    = {};
+
+    ArgParser parser;
+    parser.add("--load", "-l", [&](const char *argv[]) {
+        loadPath = argv[1];
+        cout << "Setting load path to: " << argv[1] << endl;
+    });
+    parser.add("--log", "-g", [&](const char *argv[]) {
+        logPath = argv[1];
+        cout << "Replaying the recorded flight: " << argv[1] << endl;
+    });
+    parser.add("--samples", "-n", [&](const char *argv[]) {
+        samples = strtoul(argv[1], nullptr, 10);
+        cout << "Setting number of random samples to: " << samples << endl;
+    });
+    parser.add("--tolerance", "-t", [&](const char *argv[]) {
+        tolerance = strtod(argv[1], nullptr);
+        cout << "Setting tolerance to: " << tolerance << endl;
+    });
+    parser.add("--eviction-size", "-e", [&](const char *argv[]) {
+        opt.evictionBytes = strtoul(argv[1], nullptr, 10);
+        cout << "Setting size of the cache eviction buffer to: "
+             << opt.evictionBytes << " bytes" << endl;
+    });
+    parser.add<0>("--warm-only", "-w", [&](const char *[]) {
+        opt.cold = false;
+        cout << "Only measuring the latency with warm caches" << endl;
+    });
+    cout << ANSIColors::blue;
+    parser.parse(argc, argv);
+    cout << ANSIColors::reset << endl;
+
+    /* ------ Load the drone and the streams -------------------------------- */
+
+    Drone drone     = {loadPath};
+    Streams streams = logPath.empty()
+                          ? randomStreams(drone, samples)
+                          : recordedStreams(DroneLogLoader{logPath});
+
+    Attitude::LQRController attCpp =
+        drone.getAttitudeController(Config::Attitude::Q, Config::Attitude::R);
+    Attitude::CLQRController attC = {drone.p.Ts_att};
+    Altitude::LQRController altCpp =
+        drone.getAltitudeController(Config::Altitude::Q, Config::Altitude::K_i,
+                                    Config::Altitude::maxIntegralInfluence);
+    Altitude::CLQRController altC = drone.getCAltitudeController();
+
+    Attitude::KalmanObserver attObsvCpp = drone.getAttitudeObserver(
+        Config::Attitude::varDynamics, Config::Attitude::varSensors);
+    Attitude::CKalmanObserver attObsvC = {drone.p.Ts_att};
+    Altitude::KalmanObserver altObsvCpp = drone.getAltitudeObserver(
+        Config::Altitude::varDynamics, Config::Altitude::varSensors);
+    Altitude::CKalmanObserver altObsvC = {drone.p.Ts_alt};
+
+    /* ------ Replay and report --------------------------------------------- */
+
+    cout << "Replaying " << streams.x_att.size() << " samples" << endl << endl;
+    bool agree = true;
+    agree &= report("Attitude controller",
+                    compareControllers(attCpp, attC, streams.x_att,
+                                       streams.r_att, opt),
+                    tolerance, opt.cold);
+    agree &= report("Altitude controller",
+                    compareControllers(altCpp, altC, streams.x_alt,
+                                       streams.r_alt, opt),
+                    tolerance, opt.cold);
+    agree &= report("Attitude observer",
+                    compareObservers(attObsvCpp, attObsvC, streams.x_hat_att,
+                                     streams.y_att, streams.u_att, opt),
+                    tolerance, opt.cold);
+    agree &= report("Altitude observer",
+                    compareObservers(altObsvCpp, altObsvC, streams.x_hat_alt,
+                                     streams.y_alt, streams.u_alt, opt),
+                    tolerance, opt.cold);
+
+    cout << (agree ? ANSIColors::greenb : ANSIColors::redb)
+         << (agree ? "The C and C++ implementations agree"
+                   : "The C and C++ implementations differ")
+         << ANSIColors::reset << endl;
+    return agree ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,84 @@
+#include <ANSIColors.hpp>
+#include <ArgParser.hpp>
+#include <Config.hpp>
+#include <Drone.hpp>
+#include <DroneCodeGenerator.hpp>
+
+#include <cstdlib>  // strtod
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+/**
+ * Generates a header with the drone dynamics, attitude controller and
+ * attitude observer, specialized for the parameters in the load path and the
+ * given LQR and LQE weights. The default weights are the ones in the
+ * configuration.
+ */
+int main(int argc, char const *argv[]) {
+
+    /* ------ Parse command line arguments ---------------------------------- */
+
+    filesystem::path loadPath        = Config::loadPath;
+    filesystem::path outPath         = "GeneratedDrone.hpp";
+    string ns                        = "GeneratedDrone";
+    Matrix<Nx_att - 1, Nx_att - 1> Q = Config::Attitude::Q;
+    Matrix<Nu_att, Nu_att> R         = Config::Attitude::R;
+    RowVector<Nu_att> varDynamics    = Config::Attitude::varDynamics;
+    RowVector<Ny_att> varSensors     = Config::Attitude::varSensors;
+
+    ArgParser parser;
+    parser.add("--load", "-l", [&](const char *argv[]) {
+        loadPath = argv[1];
+        cout << "Setting load path to: " << argv[1] << endl;
+    });
+    parser.add("--out", "-o", [&](const char *argv[]) {
+        outPath = argv[1];
+        cout << "Setting output file to: " << argv[1] << endl;
+    });
+    parser.add("--namespace", "-n", [&](const char *argv[]) {
+        ns = argv[1];
+        cout << "Setting namespace to: " << argv[1] << endl;
+    });
+    parser.add<Nx_att - 1>("--Q", "-Q", [&](const char *argv[]) {
+        for (size_t i = 0; i < Nx_att - 1; ++i)
+            Q[i][i] = strtod(argv[i + 1], nullptr);
+        cout << "Setting Q to: " << Q;
+    });
+    parser.add<Nu_att>("--R", "-R", [&](const char *argv[]) {
+        for (size_t i = 0; i < Nu_att; ++i)
+            R[i][i] = strtod(argv[i + 1], nullptr);
+        cout << "Setting R to: " << R;
+    });
+    parser.add<Nu_att>("--var-dynamics", [&](const char *argv[]) {
+        for (size_t i = 0; i < Nu_att; ++i)
+            varDynamics[0][i] = strtod(argv[i + 1], nullptr);
+        cout << "Setting dynamics variance to: " << varDynamics;
+    });
+    parser.add<Ny_att>("--var-sensors", [&](const char *argv[]) {
+        for (size_t i = 0; i < Ny_att; ++i)
+            varSensors[0][i] = strtod(argv[i + 1], nullptr);
+        cout << "Setting sensor variance to: " << varSensors;
+    });
+    cout << ANSIColors::blue;
+    parser.parse(argc, argv);
+    cout << ANSIColors::reset << endl;
+
+    /* ------ Design the controller and observer, and generate the code ----- */
+
+    Drone drone = {loadPath};
+    auto K      = drone.getAttitudeControllerMatrixK(Q, R);
+    auto L      = drone.getAttitudeObserverMatrixL(varDynamics, varSensors);
+
+    ofstream out(outPath);
+    if (!out) {
+        cerr << ANSIColors::redb << "Could not open " << outPath
+             << ANSIColors::reset << endl;
+        return EXIT_FAILURE;
+    }
+    generateDroneCode(out, drone.p, K, L, ns);
+    cout << ANSIColors::greenb << "Generated " << outPath << ANSIColors::reset
+         << endl;
+    return EXIT_SUCCESS;
+}
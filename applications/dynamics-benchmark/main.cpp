@@ -0,0 +1,145 @@
+#include <ANSIColors.hpp>
+#include <ArgParser.hpp>
+#include <Config.hpp>
+#include <Drone.hpp>
+#include <DroneFleet.hpp>
+#include <PerfTimer.hpp>
+
+#include <algorithm>
+#include <cstdlib>  // strtoul
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Compares the time per call of the reference implementation of the drone
+ * dynamics with the fused implementation, which is used by Drone::operator(),
+ * and with the time per drone of the structure-of-arrays DroneFleet.
+ */
+int main(int argc, char const *argv[]) {
+
+    /* ------ Parse command line arguments ---------------------------------- */
+
+    filesystem::path loadPath = Config::loadPath;
+    size_t samples            = 1024;
+    size_t repetitions        = 10000;
+
+    ArgParser parser;
+    parser.add("--load", "-l", [&](const char *argv[]) {
+        loadPath = argv[1];
+        cout << "Setting load path to: " << argv[1] << endl;
+    });
+    parser.add("--samples", "-n", [&](const char *argv[]) {
+        samples = strtoul(argv[1], nullptr, 10);
+        cout << "Setting number of samples to: " << samples << endl;
+    });
+    parser.add("--repetitions", "-r", [&](const char *argv[]) {
+        repetitions = strtoul(argv[1], nullptr, 10);
+        cout << "Setting number of repetitions to: " << repetitions << endl;
+    });
+    cout << ANSIColors::blue;
+    parser.parse(argc, argv);
+    cout << ANSIColors::reset << endl;
+
+    /* ------ Load the drone and generate random states and inputs ---------- */
+
+    Drone drone = {loadPath};
+
+    mt19937 rng(1);
+    uniform_real_distribution<double> dist(-1, 1);
+    auto random = [&](double scale) { return scale * dist(rng); };
+
+    vector<Drone::VecX_t> xs(samples);
+    vector<Drone::VecU_t> us(samples);
+    for (size_t i = 0; i < samples; ++i) {
+        DroneState x;
+        Quaternion q = {random(1), random(1), random(1), random(1)};
+        x.setOrientation(q / norm(q));
+        x.setAngularVelocity({random(5), random(5), random(5)});
+        x.setMotorSpeed({random(20), random(20), random(20)});
+        x.setVelocity({random(2), random(2), random(2)});
+        x.setPosition({random(10), random(10), random(10)});
+        x.setThrustMotorSpeed(random(20));
+        xs[i] = x;
+        us[i] = DroneControl{{random(0.5), random(0.5), random(0.5)},
+                             {random(0.5)}};
+    }
+
+    /* ------ Check the results --------------------------------------------- */
+
+    double maxRelErr = 0;
+    for (size_t i = 0; i < samples; ++i) {
+        Drone::VecX_t expected = drone.referenceStateChange(xs[i], us[i]);
+        Drone::VecX_t result   = drone(xs[i], us[i]);
+        for (size_t j = 0; j < Nx; ++j)
+            maxRelErr = max(maxRelErr, abs(result[j][0] - expected[j][0]) /
+                                           max(1.0, abs(expected[j][0])));
+    }
+    cout << "Maximum relative difference: " << maxRelErr << endl << endl;
+
+    /* ------ Benchmark ----------------------------------------------------- */
+
+    // The results are summed, so the calls can't be optimized out
+    auto benchmark = [&](const char *name, auto f) {
+        Drone::VecX_t x_dot;
+        Drone::VecX_t sum = {};
+        PerfTimer timer;
+        for (size_t r = 0; r < repetitions; ++r)
+            for (size_t i = 0; i < samples; ++i) {
+                f(xs[i], us[i], x_dot);
+                sum += x_dot;
+            }
+        auto duration  = timer.getDuration<chrono::nanoseconds>();
+        double perCall = double(duration) / (repetitions * samples);
+        cout << setw(12) << left << name << fixed << setprecision(2)
+             << setw(8) << right << perCall << " ns/call" << defaultfloat
+             << "\t(checksum " << sum[0][0] << ")" << endl;
+        return perCall;
+    };
+
+    auto reference = [&](auto &x, auto &u, auto &x_dot) {
+        x_dot = drone.referenceStateChange(x, u);
+    };
+    auto call = [&](auto &x, auto &u, auto &x_dot) { x_dot = drone(x, u); };
+    auto inplace = [&](auto &x, auto &u, auto &x_dot) {
+        drone.getStateChange(x, u, x_dot);
+    };
+
+    double t_ref   = benchmark("Reference", reference);
+    double t_call  = benchmark("operator()", call);
+    double t_fused = benchmark("In place", inplace);
+
+    // All drones in the fleet have the same parameters, the states and inputs
+    // are the first samples
+    constexpr size_t F  = 64;
+    DroneFleet<F> fleet = {vector<DroneParamsAndMatrices>(F, drone.p)};
+    DroneFleet<F>::MatX_t fx, fx_dot, fsum = {};
+    DroneFleet<F>::MatU_t fu;
+    for (size_t d = 0; d < F; ++d) {
+        DroneFleet<F>::setDroneState(fx, d, xs[d % samples]);
+        for (size_t i = 0; i < Nu; ++i)
+            fu[i][d] = us[d % samples][i][0];
+    }
+    size_t fleetRepetitions = max<size_t>(1, repetitions * samples / F);
+    PerfTimer timer;
+    for (size_t r = 0; r < fleetRepetitions; ++r) {
+        fleet(fx, fu, fx_dot);
+        fsum += fx_dot;
+    }
+    auto duration  = timer.getDuration<chrono::nanoseconds>();
+    double t_fleet = double(duration) / (fleetRepetitions * F);
+    cout << setw(12) << left << "Fleet (64)" << fixed << setprecision(2)
+         << setw(8) << right << t_fleet << " ns/drone" << defaultfloat
+         << "\t(checksum " << fsum[0][0] << ")" << endl;
+
+    cout << endl
+         << ANSIColors::greenb << "Speedup: " << setprecision(3)
+         << t_ref / t_call << " (operator()), " << t_ref / t_fused
+         << " (in place), " << t_ref / t_fleet << " (fleet)"
+         << ANSIColors::reset << endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,84 @@
+#include <ANSIColors.hpp>
+#include <ArgParser.hpp>
+#include <Config.hpp>
+#include <Drone.hpp>
+#include <PerfTimer.hpp>
+
+#include <cstdlib>  // strtod, strtoul
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Precomputes the gains of the gain-scheduled attitude controller on a grid
+ * of roll and pitch angles, using the LQR weights of the configuration, and
+ * writes them to a binary file that can be loaded with GainTable::load.
+ */
+int main(int argc, char const *argv[]) {
+
+    /* ------ Parse command line arguments ---------------------------------- */
+
+    filesystem::path loadPath        = Config::loadPath;
+    filesystem::path outPath         = "AttitudeGainTable.bin";
+    double maxAngle                  = 0.5;
+    size_t points                    = 11;
+    Matrix<Nx_att - 1, Nx_att - 1> Q = Config::Attitude::Q;
+    Matrix<Nu_att, Nu_att> R         = Config::Attitude::R;
+
+    ArgParser parser;
+    parser.add("--load", "-l", [&](const char *argv[]) {
+        loadPath = argv[1];
+        cout << "Setting load path to: " << argv[1] << endl;
+    });
+    parser.add("--out", "-o", [&](const char *argv[]) {
+        outPath = argv[1];
+        cout << "Setting output file to: " << argv[1] << endl;
+    });
+    parser.add("--max-angle", "-a", [&](const char *argv[]) {
+        maxAngle = strtod(argv[1], nullptr);
+        cout << "Setting maximum roll and pitch angle to: " << maxAngle
+             << endl;
+    });
+    parser.add("--points", "-n", [&](const char *argv[]) {
+        points = strtoul(argv[1], nullptr, 10);
+        cout << "Setting number of grid points per angle to: " << points
+             << endl;
+    });
+    parser.add<Nx_att - 1>("--Q", "-Q", [&](const char *argv[]) {
+        for (size_t i = 0; i < Nx_att - 1; ++i)
+            Q[i][i] = strtod(argv[i + 1], nullptr);
+        cout << "Setting Q to: " << Q;
+    });
+    parser.add<Nu_att>("--R", "-R", [&](const char *argv[]) {
+        for (size_t i = 0; i < Nu_att; ++i)
+            R[i][i] = strtod(argv[i + 1], nullptr);
+        cout << "Setting R to: " << R;
+    });
+    cout << ANSIColors::blue;
+    parser.parse(argc, argv);
+    cout << ANSIColors::reset << endl;
+
+    if (points < 2) {
+        cerr << ANSIColors::redb << "Error: at least 2 grid points required"
+             << ANSIColors::reset << endl;
+        return EXIT_FAILURE;
+    }
+
+    /* ------ Build the table ----------------------------------------------- */
+
+    vector<double> grid(points);
+    for (size_t i = 0; i < points; ++i)
+        grid[i] = -maxAngle + 2 * maxAngle * i / (points - 1);
+
+    Drone drone = {loadPath};
+    PerfTimer timer;
+    auto table      = drone.getAttitudeGainTable(grid, grid, Q, R);
+    double duration = timer.getDuration<chrono::microseconds>() / 1e3;
+    table.save(outPath);
+
+    cout << ANSIColors::greenb << "Wrote " << table.size() << " gains to "
+         << outPath << " in " << duration << " ms" << ANSIColors::reset
+         << endl;
+    return EXIT_SUCCESS;
+}
@@ -8,13 +8,16 @@ int main(int argc, const char *argv[]) {
     (void) argc;
     (void) argv;
 
+    // All random numbers are drawn from a single stream with a fixed seed
+    Philox::Stream rng = {Philox::makeKey(0), 0};
+
     // Cross over two parents
     const Chromosome<6> parent1 = {10.0, 11.0, 12.0, 13.0, 14.0, 15.0};
     const Chromosome<6> parent2 = {20.0, 21.0, 22.0, 23.0, 24.0, 25.0};
     Chromosome<6> child1, child2;
     Chromosome<6> child3, child4;
-    crossOver(parent1, parent2, child1, child2);
-    crossOver(parent1, parent2, child3, child4);
+    crossOver(parent1, parent2, child1, child2, rng);
+    crossOver(parent1, parent2, child3, child4, rng);
 
     // Print results
     cout << "parent1: [";
@@ -42,10 +45,10 @@ int main(int argc, const char *argv[]) {
     cout << "child4: " << toString(child4) << "\r\n";
 
     // Mutate children with factor 0.1
-    mutate(child1, 0.1);
-    mutate(child2, 0.1);
-    mutate(child3, 0.1);
-    mutate(child4, 0.1);
+    mutate(child1, 0.1, rng);
+    mutate(child2, 0.1, rng);
+    mutate(child3, 0.1, rng);
+    mutate(child4, 0.1, rng);
 
     // Print children with toString()
     cout << "child1: " << toString(child1) << "\r\n";
@@ -0,0 +1,138 @@
+#include <ANSIColors.hpp>
+#include <ArgParser.hpp>
+#include <Config.hpp>
+#include <Drone.hpp>
+#include <InputSignals.hpp>
+#include <PerfTimer.hpp>
+
+#include <algorithm>
+#include <cstdlib>  // strtod
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Compares the number of steps of the ODE solver and the accuracy of the
+ * integration modes of the drone on the scenario of plot-simulation, with the
+ * controller and observer from the configuration. The noise is left out, so
+ * all modes simulate exactly the same system, and the accuracy is measured
+ * against a simulation with a much smaller tolerance.
+ */
+int main(int argc, char const *argv[]) {
+
+    /* ------ Parse command line arguments ---------------------------------- */
+
+    filesystem::path loadPath = Config::loadPath;
+    AdaptiveODEOptions opt    = Config::odeopt;
+    double referenceEpsilon   = 1e-9;
+
+    ArgParser parser;
+    parser.add("--load", "-l", [&](const char *argv[]) {
+        loadPath = argv[1];
+        cout << "Setting load path to: " << argv[1] << endl;
+    });
+    parser.add("--epsilon", "-e", [&](const char *argv[]) {
+        opt.epsilon = strtod(argv[1], nullptr);
+        cout << "Setting tolerance to: " << opt.epsilon << endl;
+    });
+    parser.add("--reference-epsilon", [&](const char *argv[]) {
+        referenceEpsilon = strtod(argv[1], nullptr);
+        cout << "Setting tolerance of the reference to: " << referenceEpsilon
+             << endl;
+    });
+    cout << ANSIColors::blue;
+    parser.parse(argc, argv);
+    cout << ANSIColors::reset << endl;
+
+    /* ------ Load drone data and get the controller and observer ----------- */
+
+    Drone drone = {loadPath};
+
+    Drone::Controller controller = drone.getController(
+        Config::Attitude::Q, Config::Attitude::R, Config::Altitude::Q,
+        Config::Altitude::K_i, Config::Altitude::maxIntegralInfluence);
+
+    Drone::Observer observer = drone.getObserver(
+        Config::Attitude::varDynamics, Config::Attitude::varSensors,
+        Config::Altitude::varDynamics, Config::Altitude::varSensors);
+
+    TestReferenceFunction ref = {};
+    NoNoiseGenerator<Nu> randFnW;
+    NoNoiseGenerator<Ny> randFnV;
+
+    /* ------ Simulate the scenario with all integration modes -------------- */
+
+    struct Run {
+        size_t iterations;
+        double duration;
+        ODEResultCode resultCode;
+        vector<Drone::VecX_t> states;
+    };
+
+    auto simulate = [&](bool lieGroup, bool splitMotors, double epsilon) {
+        drone.lieGroupIntegration = lieGroup;
+        drone.splitMotorDynamics  = splitMotors;
+        controller.reset();
+        observer.reset();
+        AdaptiveODEOptions curr_opt = opt;
+        curr_opt.epsilon            = epsilon;
+        Drone::Stepper stepper      = {
+            drone, controller, observer, randFnW,
+            randFnV, ref, drone.getStableState(), curr_opt,
+        };
+        Run run;
+        run.states.reserve(stepper.getNumberOfSamples());
+        Drone::Stepper::Sample sample;
+        PerfTimer timer;
+        while (stepper.next(sample))
+            run.states.push_back(sample.x);
+        run.duration   = timer.getDuration<chrono::microseconds>() / 1e3;
+        run.iterations = stepper.getIterations();
+        run.resultCode = stepper.getResultCode();
+        return run;
+    };
+
+    Run reference = simulate(false, false, referenceEpsilon);
+
+    cout << setw(24) << left << "Mode" << setw(12) << right << "Steps"
+         << setw(12) << "Time (ms)" << setw(16) << "Attitude err."
+         << setw(16) << "Position err." << endl;
+    auto print = [&](const char *name, const Run &run) {
+        double attitudeError = 0, positionError = 0;
+        size_t K = min(run.states.size(), reference.states.size());
+        for (size_t k = 0; k < K; ++k) {
+            DroneState x     = run.states[k];
+            DroneState x_ref = reference.states[k];
+            Quaternion dq    = x.getOrientation() - x_ref.getOrientation();
+            ColVector<3> dp  = x.getPosition() - x_ref.getPosition();
+            attitudeError    = max(attitudeError, norm(dq));
+            positionError    = max(positionError, norm(dp));
+        }
+        cout << setw(24) << left << name << setw(12) << right
+             << run.iterations << setw(12) << fixed << setprecision(1)
+             << run.duration << defaultfloat << setprecision(3) << setw(16)
+             << attitudeError << setw(16) << positionError << endl;
+        run.resultCode.verbose();
+    };
+
+    Run dormandPrince = simulate(false, false, opt.epsilon);
+    Run lieGroup      = simulate(true, false, opt.epsilon);
+    Run split         = simulate(false, true, opt.epsilon);
+    Run lieSplit      = simulate(true, true, opt.epsilon);
+
+    print("Dormand-Prince", dormandPrince);
+    print("Lie group", lieGroup);
+    print("Motor splitting", split);
+    print("Lie group + splitting", lieSplit);
+
+    cout << endl
+         << ANSIColors::greenb << "Step reduction: " << setprecision(3)
+         << double(dormandPrince.iterations) / split.iterations
+         << " (splitting), "
+         << double(dormandPrince.iterations) / lieSplit.iterations
+         << " (Lie group + splitting)" << ANSIColors::reset << endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,108 @@
+#include <ANSIColors.hpp>
+#include <ArgParser.hpp>
+#include <Config.hpp>
+#include <LogSmoother.hpp>
+
+#include <cstdlib>  // strtoul, strtod
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+
+/**
+ * Smooths the state estimates of a recorded flight offline, with a forward
+ * Kalman filter and a backward Rauch–Tung–Striebel pass, using the models of
+ * the drone and the variances of the configuration.
+ *
+ * The output is a log in the same format as the input, where the observer
+ * estimates are replaced by the smoothed estimates, so it can be loaded and
+ * plotted by the same tools. The intermediate results are spilled to disk,
+ * so logs of any length can be smoothed with a bounded amount of memory.
+ */
+int main(int argc, char const *argv[]) {
+
+    /* ------ Parse command line arguments ---------------------------------- */
+
+    filesystem::path loadPath   = Config::loadPath;
+    filesystem::path logPath    = {};
+    filesystem::path outputPath = {};
+    LogSmootherOptions options  = {};
+    options.varDynamics_att     = Config::Attitude::varDynamics;
+    options.varSensors_att =
+        getBlock<0, 1, 1, Ny_att>(Config::Attitude::varSensors);
+    options.varDynamics_alt = Config::Altitude::varDynamics;
+    options.varSensors_alt  = Config::Altitude::varSensors;
+
+    ArgParser parser;
+    parser.add("--load", "-l", [&](const char *argv[]) {
+        loadPath = argv[1];
+        cout << "Setting load path to: " << argv[1] << endl;
+    });
+    parser.add("--log", "-g", [&](const char *argv[]) {
+        logPath = argv[1];
+        cout << "Smoothing the recorded flight: " << argv[1] << endl;
+    });
+    parser.add("--out", "-o", [&](const char *argv[]) {
+        outputPath = argv[1];
+        cout << "Setting output path to: " << argv[1] << endl;
+    });
+    parser.add("--block-size", "-b", [&](const char *argv[]) {
+        options.blockSize = strtoul(argv[1], nullptr, 10);
+        cout << "Setting number of entries per spill block to: "
+             << options.blockSize << endl;
+    });
+    parser.add("--spill-dir", "-s", [&](const char *argv[]) {
+        options.spillDirectory = argv[1];
+        cout << "Setting spill directory to: " << argv[1] << endl;
+    });
+    parser.add("--initial-variance", "-v", [&](const char *argv[]) {
+        options.varInitial = strtod(argv[1], nullptr);
+        cout << "Setting initial variance to: " << options.varInitial
+             << endl;
+    });
+    cout << ANSIColors::blue;
+    parser.parse(argc, argv);
+    cout << ANSIColors::reset << endl;
+
+    if (logPath.empty() || outputPath.empty()) {
+        cerr << ANSIColors::red
+             << "Error: both the input log (--log) and the output path "
+                "(--out) are required"
+             << ANSIColors::reset << endl;
+        return EXIT_FAILURE;
+    }
+    if (options.blockSize == 0) {
+        cerr << ANSIColors::red << "Error: the block size must be positive"
+             << ANSIColors::reset << endl;
+        return EXIT_FAILURE;
+    }
+
+    /* ------ Smooth -------------------------------------------------------- */
+
+    DroneParamsAndMatrices p;
+    p.load(loadPath);
+    LogSmootherStatistics stats;
+    try {
+        stats = smoothDroneLog(p, logPath, outputPath, options);
+    } catch (const runtime_error &e) {
+        cerr << ANSIColors::red << e.what() << ANSIColors::reset << endl;
+        return EXIT_FAILURE;
+    }
+
+    /* ------ Report -------------------------------------------------------- */
+
+    double total = stats.forwardSeconds + stats.backwardSeconds;
+    cout << ANSIColors::whiteb << "Smoothed " << stats.entries << " entries ("
+         << fixed << setprecision(1) << stats.flightSeconds << " s of flight)"
+         << ANSIColors::reset << endl
+         << setprecision(3) << "  Forward pass:  " << stats.forwardSeconds
+         << " s" << endl
+         << "  Backward pass: " << stats.backwardSeconds << " s" << endl
+         << "  Total:         " << total << " s" << endl;
+    if (total > 0)
+        cout << "  " << setprecision(0) << stats.flightSeconds / total
+             << "× faster than real time" << endl;
+    cout << ANSIColors::greenb << "Written to " << outputPath
+         << ANSIColors::reset << endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,164 @@
+#include <ANSIColors.hpp>
+#include <ArgParser.hpp>
+#include <Config.hpp>
+#include <Drone.hpp>
+
+#include <algorithm>  // max_element, sort
+#include <chrono>
+#include <cstdlib>  // strtoul
+#include <iomanip>
+#include <iostream>
+#include <numeric>  // accumulate
+#include <vector>
+
+using namespace std;
+
+/// The prediction horizon of the MPC controller.
+constexpr size_t N = 10;
+
+/// Measures the execution time of every call of the attitude controller.
+class TimedController : public DiscreteController<Nx_att, Nu_att, Ny_att> {
+  public:
+    TimedController(Attitude::MPCController<N> &mpc)
+        : DiscreteController<Nx_att, Nu_att, Ny_att>{mpc.Ts}, mpc{mpc} {}
+
+    VecU_t operator()(const VecX_t &x, const VecR_t &r) override {
+        auto start = chrono::steady_clock::now();
+        VecU_t u   = mpc(x, r);
+        auto stop  = chrono::steady_clock::now();
+        durations.push_back(chrono::duration<double, micro>(stop - start));
+        iterations.push_back(mpc.getIterations());
+        return u;
+    }
+
+    Attitude::MPCController<N> &mpc;
+    vector<chrono::duration<double, micro>> durations;
+    vector<size_t> iterations;
+};
+
+/**
+ * Reports the execution time of the MPC attitude controller with the LQR
+ * weights of the configuration, on a sequence of attitude steps that saturate
+ * the motors, and the time of a solve that runs the maximum number of solver
+ * iterations, which bounds the execution time of every solve. Fails if the
+ * 99th percentile of either exceeds the attitude sample time.
+ */
+int main(int argc, char const *argv[]) {
+
+    /* ------ Parse command line arguments ---------------------------------- */
+
+    filesystem::path loadPath                        = Config::loadPath;
+    Attitude::MPCController<N>::Solver::Options sopt = {};
+    size_t repetitions                               = 1000;
+
+    ArgParser parser;
+    parser.add("--load", "-l", [&](const char *argv[]) {
+        loadPath = argv[1];
+        cout << "Setting load path to: " << argv[1] << endl;
+    });
+    parser.add("--max-iterations", "-i", [&](const char *argv[]) {
+        sopt.maxIterations = strtoul(argv[1], nullptr, 10);
+        cout << "Setting maximum number of iterations to: "
+             << sopt.maxIterations << endl;
+    });
+    parser.add("--repetitions", "-r", [&](const char *argv[]) {
+        repetitions = strtoul(argv[1], nullptr, 10);
+        cout << "Setting repetitions of the worst-case solve to: "
+             << repetitions << endl;
+    });
+    cout << ANSIColors::blue;
+    parser.parse(argc, argv);
+    cout << ANSIColors::reset << endl;
+
+    /* ------ Closed-loop simulation with attitude steps -------------------- */
+
+    Drone drone                    = {loadPath};
+    Drone::AttitudeModel attmodel  = drone.getAttitudeModel();
+    Attitude::MPCController<N> mpc = drone.getMPCAttitudeController<N>(
+        Config::Attitude::Q, Config::Attitude::R, sopt);
+    TimedController timed          = {mpc};
+
+    // A new attitude step every second
+    const vector<EulerAngles> steps = {
+        {0, 0, 0},     {0.5, 0.2, -0.15}, {-0.5, -0.2, 0.2},
+        {0, 0.3, 0.3}, {0.2, -0.3, 0},    {0, 0, 0},
+    };
+    FunctionalTimeFunctionT<ColVector<Ny_att>> r = {[&](double t) {
+        size_t i = min(size_t(t), steps.size() - 1);
+        return ColVector<Ny_att>{vcat(eul2quat(steps[i]), zeros<3, 1>())};
+    }};
+
+    AdaptiveODEOptions opt = Config::odeopt;
+    opt.t_start            = 0;
+    opt.t_end              = steps.size();
+    DroneAttitudeState x0  = {};
+    x0.setOrientation(eul2quat({0, 0, 0}));
+    auto f = [](double, const ColVector<Nx_att> &, const ColVector<Nu_att> &) {
+        return true;
+    };
+    attmodel.simulateRealTime(timed, r, x0, opt, f);
+
+    auto durations = timed.durations;
+    sort(durations.begin(), durations.end());
+    double mean = accumulate(durations.begin(), durations.end(),
+                             chrono::duration<double, micro>{})
+                      .count() /
+                  durations.size();
+    double p99     = durations[durations.size() * 99 / 100].count();
+    double maxTime = durations.back().count();
+    size_t maxIterations =
+        *max_element(timed.iterations.begin(), timed.iterations.end());
+
+    /* ------ Worst case: solve with the maximum number of iterations ------- */
+
+    // With a tolerance of zero, the solver never converges early. Every
+    // iteration executes the same operations, so this bounds the execution
+    // time of any solve.
+    Attitude::MPCController<N>::Solver::Options wopt = sopt;
+    wopt.tolerance                                   = 0;
+    Attitude::MPCController<N> worst = drone.getMPCAttitudeController<N>(
+        Config::Attitude::Q, Config::Attitude::R, wopt);
+    ColVector<Ny_att> r1 = r(1);
+    vector<chrono::duration<double, micro>> worstDurations;
+    worstDurations.reserve(repetitions);
+    for (size_t i = 0; i < repetitions; ++i) {
+        worst.reset();
+        auto start = chrono::steady_clock::now();
+        worst(x0, r1);
+        auto stop = chrono::steady_clock::now();
+        worstDurations.push_back(chrono::duration<double, micro>(stop - start));
+    }
+    sort(worstDurations.begin(), worstDurations.end());
+    // The longest repetitions include the preemptions by the operating system
+    // of the host, which the execution time of the solver itself doesn't
+    const size_t n    = worstDurations.size();
+    double wcetMedian = worstDurations[n / 2].count();
+    double wcet       = worstDurations[n * 99 / 100].count();
+    double wcetMax    = worstDurations.back().count();
+
+    /* ------ Report -------------------------------------------------------- */
+
+    const double budget = drone.p.Ts_att * 1e6;
+    cout << fixed << setprecision(1);
+    cout << "Horizon:                   " << N << " samples" << endl
+         << "Controller calls:          " << durations.size() << endl
+         << "Mean time:                 " << mean << " µs" << endl
+         << "99th percentile:           " << p99 << " µs" << endl
+         << "Maximum time:              " << maxTime << " µs" << endl
+         << "Maximum iterations:        " << maxIterations << " / "
+         << sopt.maxIterations << endl
+         << "Worst case (" << sopt.maxIterations << " iterations):" << endl
+         << "  median:                  " << wcetMedian << " µs" << endl
+         << "  99th percentile:         " << wcet << " µs" << endl
+         << "  maximum:                 " << wcetMax << " µs" << endl
+         << "Sample time Ts_att:        " << budget << " µs" << endl;
+
+    bool fits = wcet < budget && p99 < budget;
+    cout << endl
+         << (fits ? ANSIColors::greenb : ANSIColors::redb)
+         << (fits ? "Every solve fits in the sample time, using "
+                  : "Solves don't fit in the sample time, using ")
+         << 100 * std::max(wcet, p99) / budget << "% of it"
+         << ANSIColors::reset << endl;
+    return fits ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,417 @@
+#include <ANSIColors.hpp>
+#include <ArgParser.hpp>
+#include <Config.hpp>
+#include <Drone.hpp>
+#include <DroneLogLoader.hpp>
+#include <PerfCounters.hpp>
+
+#include <algorithm>  // sort, push_heap, pop_heap
+#include <array>
+#include <chrono>
+#include <cstdlib>  // strtod, strtoul
+#include <iomanip>
+#include <iostream>
+#include <limits>  // denorm_min
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+/// The families of inputs that are replayed through the controller and the
+/// observer.
+enum Scenario : uint8_t {
+    Recorded,            ///< The samples of a recorded flight.
+    Hover,               ///< Hovering with sensor noise.
+    LargeAttitudeError,  ///< Large attitude errors, which saturate.
+    LargeAltitudeError,  ///< Large height errors, which wind up the integral.
+    FastRotation,        ///< Extreme angular velocities and motor speeds.
+    Subnormal,           ///< Hovering, with subnormal deviations.
+    NumScenarios,
+};
+
+const char *scenarioNames[NumScenarios] = {
+    "recorded",         "hover",         "large attitude error",
+    "large alt. error", "fast rotation", "subnormal",
+};
+
+/// The branches taken in a sample, as a set of flags.
+enum Path : uint8_t {
+    AltitudeUpdate = 1 << 0,  ///< The subsampled altitude loops ran.
+    Saturated      = 1 << 1,  ///< clampAttitude scaled the attitude control.
+    Exception      = 1 << 2,  ///< checkControlSignal threw.
+    NumPaths       = 1 << 3,
+};
+
+string pathName(uint8_t path) {
+    string name = path & AltitudeUpdate ? "altitude" : "attitude only";
+    if (path & Saturated)
+        name += " + clamp";
+    if (path & Exception)
+        name += " + throw";
+    return name;
+}
+
+/// One input sample: the (estimated) state, the reference and the sensor
+/// readings.
+struct Input {
+    ColVector<Nx> x;
+    ColVector<Ny> r;
+    ColVector<Ny> y;
+};
+
+/// The measurement of one sample.
+struct Record {
+    PerfSample events;
+    double nanoseconds;
+    uint8_t scenario;
+    uint8_t path;
+};
+
+/// One of the slowest samples, with its input.
+struct Outlier {
+    Record record;
+    Input input;
+    size_t index;
+    bool operator<(const Outlier &o) const {
+        // Min-heap on the number of cycles
+        return record.events.cycles > o.record.events.cycles;
+    }
+};
+
+/// Generates the inputs of the synthetic scenarios.
+class InputGenerator {
+  public:
+    InputGenerator(const Drone &drone) : drone{drone} {}
+
+    Input operator()(Scenario scenario) {
+        DroneState x   = drone.getStableState();
+        DroneState ref = x;
+        double z       = 1 + random(0.5);
+        x.setPosition({0, 0, z});
+        ref.setPosition({0, 0, z});
+        x.setOrientation(tilt(0.05, 0.02));
+        x.setAngularVelocity(randomVector(0.05));
+
+        switch (scenario) {
+            case LargeAttitudeError:
+                x.setOrientation(tilt(M_PI_2, 0.8));
+                ref.setOrientation(tilt(M_PI_2, 0.8));
+                x.setAngularVelocity(randomVector(3));
+                break;
+            case LargeAltitudeError:
+                x.setPosition({0, 0, z + random(5)});
+                x.setVelocity({0, 0, random(3)});
+                x.setThrustMotorSpeed(drone.p.nh + random(30));
+                break;
+            case FastRotation:
+                x.setAngularVelocity(randomVector(20));
+                x.setMotorSpeed(randomVector(drone.p.nh));
+                break;
+            case Subnormal: {
+                const double tiny = numeric_limits<double>::denorm_min();
+                ColVector<Nx> xx  = x;
+                for (size_t i = 0; i < Nx; ++i)
+                    if (xx[i][0] == 0)
+                        xx[i][0] = random(1e6) * tiny;
+                x = xx;
+                x.setOrientation(tilt(1e6 * tiny, 1e6 * tiny));
+                break;
+            }
+            default: break;
+        }
+
+        ColVector<1> height = {x.getPosition()[2]};
+        DroneOutput y       = {vcat(x.getOrientation(), x.getAngularVelocity()),
+                               vcat(zeros<2, 1>(), height)};
+        Quaternion dq = eul2quat(randomVector(0.01));
+        y.setOrientation(quatmultiply(x.getOrientation(), dq));
+        DroneReference r = {vcat(ref.getOrientation(), zeros<3, 1>()),
+                            ref.getPosition()};
+        return {x, r, y};
+    }
+
+  private:
+    double random(double scale) { return scale * dist(rng); }
+    ColVector<3> randomVector(double scale) {
+        return {random(scale), random(scale), random(scale)};
+    }
+    Quaternion tilt(double yaw, double rollPitch) {
+        return eul2quat({random(yaw), random(rollPitch), random(rollPitch)});
+    }
+
+    const Drone &drone;
+    mt19937 rng{1};
+    uniform_real_distribution<double> dist{-1, 1};
+};
+
+vector<Input> recordedInputs(const DroneLogLoader &log) {
+    vector<Input> inputs;
+    for (const DroneLogEntry &entry : log) {
+        DroneOutput y = {
+            vcat(ColVectorFromCppArray(entry.measurementOrientation),
+                 ColVectorFromCppArray(entry.measurementAngularVelocity)),
+            vcat(zeros<2, 1>(), ColVector<1>{entry.measurementHeight})};
+        inputs.push_back({entry.getState(), entry.getReference(), y});
+    }
+    return inputs;
+}
+
+/// Check whether the attitude control lies on the bound of clampAttitude.
+bool isSaturated(const DroneControl &u, double uh) {
+    ColVector<3> u_att = u.getAttitudeControl();
+    double thrust      = std::abs(u.getThrustControl()[0][0] + uh);
+    double bound       = std::min(1 - thrust, thrust);
+    double actual      = std::abs(u_att[0][0]) + std::abs(u_att[1][0]) +
+                         std::abs(u_att[2][0]);
+    return actual >= bound * (1 - 1e-9);
+}
+
+struct Statistics {
+    size_t count = 0;
+    double p50 = 0, p99 = 0, p9999 = 0, max = 0;
+};
+
+Statistics statistics(vector<double> cycles) {
+    Statistics s = {};
+    s.count      = cycles.size();
+    if (cycles.empty())
+        return s;
+    sort(cycles.begin(), cycles.end());
+    auto at = [&](double q) { return cycles[size_t(q * (s.count - 1))]; };
+    s.p50   = at(0.5);
+    s.p99   = at(0.99);
+    s.p9999 = at(0.9999);
+    s.max   = cycles.back();
+    return s;
+}
+
+void printStatistics(const string &name, const Statistics &s) {
+    cout << "  " << setw(34) << left << name << right << setw(9) << s.count
+         << setw(10) << s.p50 << setw(10) << s.p99 << setw(10) << s.p9999
+         << setw(10) << s.max << endl;
+}
+
+/**
+ * Measures the execution time of a full sample of the flight code, i.e. one
+ * call of the cascaded controller and one of the cascaded observer, for
+ * millions of samples of recorded flights and of adversarial inputs.
+ *
+ * Every sample is measured with the hardware performance counters (cycles,
+ * instructions, branch and cache misses) if they are available, and with the
+ * steady clock. The samples are grouped by the branches they take (the
+ * altitude subsample, the attitude clamping, and the exception thrown by
+ * checkControlSignal), and by the scenario of their inputs. The report shows
+ * the distribution of every group, the slowest samples with their inputs, and
+ * an estimate of the worst-case execution time: the 99.99th percentile of the
+ * slowest path plus a safety margin, compared to the attitude sample time.
+ */
+int main(int argc, char const *argv[]) {
+
+    /* ------ Parse command line arguments ---------------------------------- */
+
+    filesystem::path loadPath = Config::loadPath;
+    filesystem::path logPath  = {};
+    size_t samples            = 1'000'000;
+    size_t outliers           = 10;
+    double margin             = 0.2;
+
+    ArgParser parser;
+    parser.add("--load", "-l", [&](const char *argv[]) {
+        loadPath = argv[1];
+        cout << "Setting load path to: " << argv[1] << endl;
+    });
+    parser.add("--log", "-g", [&](const char *argv[]) {
+        logPath = argv[1];
+        cout << "Replaying the recorded flight: " << argv[1] << endl;
+    });
+    parser.add("--samples", "-n", [&](const char *argv[]) {
+        samples = strtoul(argv[1], nullptr, 10);
+        cout << "Setting number of samples per scenario to: " << samples
+             << endl;
+    });
+    parser.add("--outliers", "-o", [&](const char *argv[]) {
+        outliers = strtoul(argv[1], nullptr, 10);
+        cout << "Setting number of reported slowest samples to: " << outliers
+             << endl;
+    });
+    parser.add("--margin", "-m", [&](const char *argv[]) {
+        margin = strtod(argv[1], nullptr);
+        cout << "Setting WCET safety margin to: " << margin << endl;
+    });
+    cout << ANSIColors::blue;
+    parser.parse(argc, argv);
+    cout << ANSIColors::reset << endl;
+
+    /* ------ Load the drone, the controller and the observer --------------- */
+
+    Drone drone                  = {loadPath};
+    Drone::Controller controller = drone.getController(
+        Config::Attitude::Q, Config::Attitude::R, Config::Altitude::Q,
+        Config::Altitude::K_i, Config::Altitude::maxIntegralInfluence);
+    Drone::Observer observer = drone.getObserver(
+        Config::Attitude::varDynamics, Config::Attitude::varSensors,
+        Config::Altitude::varDynamics, Config::Altitude::varSensors);
+    vector<Input> recorded;
+    if (!logPath.empty())
+        recorded = recordedInputs(DroneLogLoader{logPath});
+
+    PerfCounters counters;
+    if (!counters.available())
+        cerr << ANSIColors::yellow
+             << "Hardware performance counters are not available, using "
+             << cycleCounterUnit() << " of the cycle counter instead"
+             << ANSIColors::reset << endl;
+
+    /* ------ Replay every scenario ----------------------------------------- */
+
+    InputGenerator generate = {drone};
+    vector<Record> records;
+    records.reserve(NumScenarios * samples);
+    vector<Outlier> slowest;
+    size_t index   = 0;
+    size_t invalid = 0;
+
+    for (uint8_t scenario = 0; scenario < NumScenarios; ++scenario) {
+        if (scenario == Recorded && recorded.empty())
+            continue;
+        // The loops start at the altitude subsample, like after take-off
+        controller.reset();
+        observer.reset();
+        Drone::VecU_t u = {};
+        for (size_t i = 0; i < samples; ++i, ++index) {
+            Input in = scenario == Recorded ? recorded[i % recorded.size()]
+                                            : generate(Scenario(scenario));
+            uint8_t path = 0;
+
+            auto start = chrono::steady_clock::now();
+            counters.start();
+            try {
+                u = controller(in.x, in.r);
+            } catch (const runtime_error &) {
+                path |= Exception;
+            }
+            observer.getStateChange(in.x, in.y, u);
+            PerfSample events = counters.stop();
+            auto stop         = chrono::steady_clock::now();
+
+            if (!events.valid) {
+                ++invalid;
+                continue;
+            }
+            if (controller.updatedAltitude() || observer.updatedAltitude())
+                path |= AltitudeUpdate;
+            if (isSaturated(u, drone.p.uh))
+                path |= Saturated;
+            double ns = chrono::duration<double, nano>(stop - start).count();
+            Record record = {events, ns, scenario, path};
+            records.push_back(record);
+
+            if (slowest.size() < outliers ||
+                events.cycles > slowest.front().record.events.cycles) {
+                slowest.push_back({record, in, index});
+                push_heap(slowest.begin(), slowest.end());
+                if (slowest.size() > outliers) {
+                    pop_heap(slowest.begin(), slowest.end());
+                    slowest.pop_back();
+                }
+            }
+        }
+    }
+
+    /* ------ Report -------------------------------------------------------- */
+
+    if (invalid > 0)
+        cerr << ANSIColors::yellow << "Discarded " << invalid
+             << " samples because the performance counters couldn't be read"
+             << ANSIColors::reset << endl
+             << endl;
+
+    cout << fixed << setprecision(0);
+    auto header = [&](const char *title) {
+        cout << ANSIColors::whiteb << title << " (" << counters.unit() << ")"
+             << ANSIColors::reset << endl
+             << "  " << setw(34) << left << "" << right << setw(9) << "count"
+             << setw(10) << "p50" << setw(10) << "p99" << setw(10) << "p99.99"
+             << setw(10) << "max" << endl;
+    };
+    auto select = [&](auto predicate) {
+        vector<double> cycles;
+        for (const Record &rec : records)
+            if (predicate(rec))
+                cycles.push_back(rec.events.cycles);
+        return statistics(move(cycles));
+    };
+
+    header("Per path");
+    for (uint8_t path = 0; path < NumPaths; ++path) {
+        Statistics s = select([&](const Record &r) { return r.path == path; });
+        if (s.count > 0)
+            printStatistics(pathName(path), s);
+    }
+    cout << endl;
+
+    header("Per scenario");
+    for (uint8_t scenario = 0; scenario < NumScenarios; ++scenario) {
+        Statistics s =
+            select([&](const Record &r) { return r.scenario == scenario; });
+        if (s.count > 0)
+            printStatistics(scenarioNames[scenario], s);
+    }
+    cout << endl;
+
+    sort_heap(slowest.begin(), slowest.end());
+    cout << ANSIColors::whiteb << "Slowest samples" << ANSIColors::reset
+         << endl;
+    for (const Outlier &o : slowest) {
+        const Record &rec = o.record;
+        DroneState x      = {o.input.x};
+        DroneReference r  = {o.input.r};
+        EulerAngles eul   = x.getOrientationEuler();
+        cout << "  #" << setw(8) << left << o.index << right << setw(9)
+             << rec.events.cycles << " " << counters.unit() << setw(10)
+             << rec.nanoseconds << " ns  " << scenarioNames[rec.scenario]
+             << ", " << pathName(rec.path) << endl
+             << "      instructions " << rec.events.instructions
+             << ", branch misses " << rec.events.branchMisses
+             << ", cache misses " << rec.events.cacheMisses << endl
+             << setprecision(3) << "      euler " << eul[0][0] << " "
+             << eul[1][0] << " " << eul[2][0]
+             << ", |w| " << norm(x.getAngularVelocity())
+             << ", z " << x.getPosition()[2][0] << " (ref "
+             << r.getPosition()[2][0] << ")" << setprecision(0) << endl;
+    }
+    cout << endl;
+
+    // The slowest samples include the preemptions by the operating system of
+    // the host, so the estimate is based on the 99.99th percentile of every
+    // path. For rare paths, this is their slowest sample.
+    double wcet = 0;
+    for (uint8_t path = 0; path < NumPaths; ++path) {
+        vector<double> nanoseconds;
+        for (const Record &rec : records)
+            if (rec.path == path)
+                nanoseconds.push_back(rec.nanoseconds);
+        wcet = std::max(wcet, statistics(move(nanoseconds)).p9999 * 1e-3);
+    }
+    wcet *= 1 + margin;
+    vector<double> nanoseconds(records.size());
+    transform(records.begin(), records.end(), nanoseconds.begin(),
+              [](const Record &r) { return r.nanoseconds; });
+    Statistics time = statistics(move(nanoseconds));
+    double budget   = drone.p.Ts_att * 1e6;
+    cout << setprecision(1) << "Samples:                 " << records.size()
+         << endl
+         << "Median time:             " << time.p50 * 1e-3 << " µs" << endl
+         << "Slowest sample:          " << time.max * 1e-3 << " µs" << endl
+         << "WCET estimate (+" << setprecision(0) << 100 * margin
+         << "%):    " << setprecision(1) << wcet << " µs" << endl
+         << "Sample time Ts_att:      " << budget << " µs" << endl;
+
+    bool fits = wcet < budget;
+    cout << endl
+         << (fits ? ANSIColors::greenb : ANSIColors::redb)
+         << "The WCET estimate is " << 100 * wcet / budget
+         << "% of the sample time" << ANSIColors::reset << endl;
+    return fits ? EXIT_SUCCESS : EXIT_FAILURE;
+}
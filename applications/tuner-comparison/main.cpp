@@ -0,0 +1,288 @@
+#include "AttitudeTuning.hpp"
+#include <ANSIColors.hpp>
+#include <ArgParser.hpp>
+#include <CMAES.hpp>
+#include <DifferentialEvolution.hpp>
+#include <PerfTimer.hpp>
+#include <TunerConfig.hpp>
+
+#include <algorithm>  // sort
+#include <cstdlib>    // strtod, strtoul, strtoull
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+/// Counts the evaluations of another evaluator.
+class CountingEvaluator : public Evaluator<AttitudeMember> {
+  public:
+    CountingEvaluator(Evaluator<AttitudeMember> &evaluator)
+        : evaluator{evaluator} {}
+
+    void evaluate(Span<AttitudeMember> members, double cutoff) override {
+        evaluator.evaluate(members, cutoff);
+        evaluations += members.size();
+    }
+
+    Evaluator<AttitudeMember> &evaluator;
+    size_t evaluations = 0;
+};
+
+struct RunResult {
+    /// The number of evaluations until the best cost reached the target, or
+    /// zero if it didn't within the budget.
+    size_t evaluationsToTarget = 0;
+    size_t evaluations         = 0;
+    double bestCost            = 0;
+    double seconds             = 0;
+};
+
+/**
+ * Initialize an optimizer, and step until the best cost reaches the target,
+ * or until the budget of evaluations is used. The evaluations are only
+ * checked after every generation, so the counts are rounded up to whole
+ * generations.
+ */
+RunResult run(CountingEvaluator &counter, size_t budget, double target,
+              const function<void()> &initialize, const function<void()> &step,
+              const function<double()> &getBestCost) {
+    PerfTimer timer;
+    RunResult result = {};
+    counter.evaluations = 0;
+    initialize();
+    while (getBestCost() > target && counter.evaluations < budget)
+        step();
+    if (getBestCost() <= target)
+        result.evaluationsToTarget = counter.evaluations;
+    result.evaluations = counter.evaluations;
+    result.bestCost    = getBestCost();
+    result.seconds     = timer.getDuration() * 1e-6;
+    return result;
+}
+
+void printResult(const string &name, uint64_t seed, const RunResult &r) {
+    cout << setw(6) << name << "  seed " << setw(3) << seed << ": ";
+    if (r.evaluationsToTarget > 0)
+        cout << ANSIColors::greenb << "target reached after " << setw(7)
+             << r.evaluationsToTarget << " evaluations";
+    else
+        cout << ANSIColors::yellow << "target not reached in " << setw(6)
+             << r.evaluations << " evaluations";
+    cout << ANSIColors::reset << " (best cost " << scientific
+         << setprecision(3) << r.bestCost << defaultfloat << ", " << fixed
+         << setprecision(1) << r.seconds << defaultfloat << " s)" << endl;
+}
+
+/// The median of the evaluations to the target, counting failures as
+/// infinitely many evaluations.
+string median(vector<RunResult> results) {
+    sort(results.begin(), results.end(),
+         [](const RunResult &a, const RunResult &b) {
+             if ((a.evaluationsToTarget == 0) != (b.evaluationsToTarget == 0))
+                 return b.evaluationsToTarget == 0;
+             return a.evaluationsToTarget < b.evaluationsToTarget;
+         });
+    const RunResult &m = results[(results.size() - 1) / 2];
+    return m.evaluationsToTarget > 0 ? to_string(m.evaluationsToTarget) : "∞";
+}
+
+}  // namespace
+
+/**
+ * Compares the optimizers of the genetic-tuner library on the attitude
+ * tuning problem of the tuner: the genetic algorithm of the tuner, CMA-ES and
+ * differential evolution. Every optimizer starts at the initial weights of
+ * the tuner config, and runs until the best cost reaches the target cost, or
+ * until the budget of nonlinear cost evaluations is used.
+ *
+ * The number of evaluations until the target is reached is the measure of
+ * interest, since the simulations dominate the run time of the tuner.
+ */
+int main(int argc, char const *argv[]) {
+
+    /* ------ Parse command line arguments ---------------------------------- */
+
+    filesystem::path loadPath = Config::Tuner::loadPath;
+    size_t budget             = 20000;
+    double target             = 0;
+    double targetFraction     = 1e-2;
+    size_t runs               = 3;
+    uint64_t seed             = Config::Tuner::seed;
+    double sigma              = 1;
+    size_t gaPopulation       = Config::Tuner::population;
+    size_t gaSurvivors        = Config::Tuner::survivors;
+    size_t dePopulation       = 10 * 7;
+
+    double steperrorfactor      = Config::Tuner::steperrorfactor;
+    CostWeights stepcostweights = Config::Tuner::stepcostweights;
+    AdaptiveODEOptions odeopt   = Config::Tuner::odeopt;
+
+    ArgParser parser;
+    parser.add("--load", "-l", [&](const char *argv[]) {
+        loadPath = argv[1];
+        cout << "Setting load path to: " << argv[1] << endl;
+    });
+    parser.add("--budget", "-b", [&](const char *argv[]) {
+        budget = strtoul(argv[1], nullptr, 10);
+        cout << "Setting number of evaluations per run to: " << budget << endl;
+    });
+    parser.add("--target", "-t", [&](const char *argv[]) {
+        target = strtod(argv[1], nullptr);
+        cout << "Setting target cost to: " << target << endl;
+    });
+    parser.add("--target-fraction", "-f", [&](const char *argv[]) {
+        targetFraction = strtod(argv[1], nullptr);
+        cout << "Setting target cost to the cost of the initial weights "
+                "times: "
+             << targetFraction << endl;
+    });
+    parser.add("--runs", "-n", [&](const char *argv[]) {
+        runs = strtoul(argv[1], nullptr, 10);
+        cout << "Setting number of runs per optimizer to: " << runs << endl;
+    });
+    parser.add("--seed", "-r", [&](const char *argv[]) {
+        seed = strtoull(argv[1], nullptr, 10);
+        cout << "Setting random seed of the first run to: " << seed << endl;
+    });
+    parser.add("--sigma", "-s", [&](const char *argv[]) {
+        sigma = strtod(argv[1], nullptr);
+        cout << "Setting initial step size of CMA-ES and DE to: " << sigma
+             << endl;
+    });
+    parser.add("--ga-population", "-p", [&](const char *argv[]) {
+        gaPopulation = strtoul(argv[1], nullptr, 10);
+        cout << "Setting population size of the GA to: " << gaPopulation
+             << endl;
+    });
+    parser.add("--ga-survivors", "-S", [&](const char *argv[]) {
+        gaSurvivors = strtoul(argv[1], nullptr, 10);
+        cout << "Setting number of survivors of the GA to: " << gaSurvivors
+             << endl;
+    });
+    parser.add("--de-population", "-d", [&](const char *argv[]) {
+        dePopulation = strtoul(argv[1], nullptr, 10);
+        cout << "Setting population size of DE to: " << dePopulation << endl;
+    });
+    cout << ANSIColors::blue;
+    parser.parse(argc, argv);
+    cout << ANSIColors::reset << endl;
+
+    if (runs == 0) {
+        cerr << ANSIColors::red << "Error: the number of runs must be positive"
+             << ANSIColors::reset << endl;
+        return EXIT_FAILURE;
+    }
+
+    /* ------ Load drone data and get the models ---------------------------- */
+
+    cout << "Loading Drone ..." << endl;
+    Drone drone = {loadPath};
+    cout << ANSIColors::greenb << "Successfully loaded Drone!"
+         << ANSIColors::reset << endl
+         << endl;
+
+    Drone::AttitudeModel model             = drone.getAttitudeModel();
+    Drone::LinearAttitudeModel linearModel = drone.getLinearAttitudeModel();
+    DroneAttitudeState attx0 = drone.getStableState().getAttitude();
+
+    /* ------ Initial weights and target cost ------------------------------- */
+
+    Chromosome<8> initial = AttitudeMember::toChromosome(
+        Config::Tuner::Q_diag_initial, Config::Tuner::R_diag_initial);
+    renormalize(initial);
+
+    ReferenceOrder referenceOrder = defaultReferenceOrder;
+    try {
+        AttitudeMember m = {};
+        m.chromosome     = initial;
+        Drone::FixedClampAttitudeController ctrl =
+            drone.getFixedClampAttitudeController(m.getQ(), m.getR());
+        referenceOrder = getReferenceOrder(ctrl, model, steperrorfactor, attx0,
+                                           odeopt, stepcostweights);
+    } catch (std::runtime_error &) {
+        // Keep the default order if LAPACK fails
+    }
+
+#ifndef DEBUG
+    WorkStealingPool pool;
+#else
+    WorkStealingPool pool{1};
+#endif
+    // Screening is disabled, every evaluation is a nonlinear simulation
+    AttitudeEvaluator evaluator = {
+        drone,  model,           linearModel,     attx0, steperrorfactor,
+        odeopt, stepcostweights, referenceOrder, pool,
+    };
+    CountingEvaluator counter = {evaluator};
+
+    AttitudeMember initialMember = {};
+    initialMember.chromosome     = initial;
+    evaluator.evaluate({&initialMember, 1},
+                       std::numeric_limits<double>::infinity());
+    if (target == 0)
+        target = targetFraction * initialMember.cost;
+    cout << "Cost of the initial weights: " << initialMember.cost << endl
+         << "Target cost: " << target << endl
+         << endl;
+
+    /* ------ Run the optimizers -------------------------------------------- */
+
+    const SearchSpace<8> space = getAttitudeSearchSpace();
+    UniformSelection select;
+    SinglePointCrossOver<8> crossOver;
+    AttitudeMutation mutate;
+
+    vector<RunResult> gaResults, cmaResults, deResults;
+    for (size_t r = 0; r < runs; ++r) {
+        const uint64_t s = seed + r;
+
+        GeneticAlgorithm<AttitudeMember> ga = {select, crossOver, mutate,
+                                               counter, s};
+        Population<AttitudeMember> specimens = {gaPopulation, gaSurvivors};
+        size_t generation                    = 0;
+        gaResults.push_back(run(
+            counter, budget, target,
+            [&] {
+                specimens.initialize(initial, mutate, ga.getKey());
+                ga.evaluate(specimens);
+            },
+            [&] {
+                ga.breed(specimens, ++generation);
+                ga.evaluate(specimens);
+            },
+            [&] { return specimens.best().cost; }));
+        printResult("GA", s, gaResults.back());
+
+        CMAESOptions cmaOptions = {};
+        cmaOptions.sigma        = sigma;
+        CMAES<AttitudeMember> cma = {space, counter, cmaOptions, s};
+        cmaResults.push_back(run(
+            counter, budget, target, [&] { cma.initialize(initial); },
+            [&] { cma.step(); }, [&] { return cma.getBest().cost; }));
+        printResult("CMA-ES", s, cmaResults.back());
+
+        DifferentialEvolutionOptions deOptions = {};
+        deOptions.populationSize               = dePopulation;
+        DifferentialEvolution<AttitudeMember> de = {space, counter, deOptions,
+                                                    s};
+        deResults.push_back(run(
+            counter, budget, target, [&] { de.initialize(initial, sigma); },
+            [&] { de.step(); }, [&] { return de.getBest().cost; }));
+        printResult("DE", s, deResults.back());
+    }
+
+    /* ------ Summary ------------------------------------------------------- */
+
+    cout << endl
+         << ANSIColors::whiteb << "Median number of evaluations to reach "
+         << scientific << setprecision(3) << target << defaultfloat << " ("
+         << runs << " runs):" << ANSIColors::reset << endl
+         << "  GA:     " << median(gaResults) << endl
+         << "  CMA-ES: " << median(cmaResults) << endl
+         << "  DE:     " << median(deResults) << endl;
+    return EXIT_SUCCESS;
+}
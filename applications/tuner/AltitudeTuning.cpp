@@ -0,0 +1,17 @@
+#include "AltitudeTuning.hpp"
+
+#include <cmath>  // isfinite
+
+void AltitudeEvaluator::evaluate(Span<AltitudeMember> members, double cutoff) {
+    pool.parallelFor(members.size(), [&](size_t i) {
+        AltitudeMember &m = members[i];
+        // Every task needs its own controller, because it has an integrator
+        Drone::ClampAltitudeController ctrl = getController(m);
+        double c = getAltitudeCost(ctrl, model, errorfactor, altx0, opt, cost,
+                                   cutoff);
+        // Unstable controllers can produce NaN states, and NaN costs would
+        // break the strict weak ordering of the population
+        m.cost = std::isfinite(c) ? c : std::numeric_limits<double>::infinity();
+        m.costValid = true;
+    });
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Cost.hpp"
+#include <GeneticAlgorithm.hpp>
+#include <WorkStealingPool.hpp>
+
+/**
+ * Calculates the costs of the PI altitude controllers for a batch of members,
+ * using the nonlinear altitude model, which only integrates the 3 altitude
+ * states instead of all states of the drone.
+ *
+ * Every member is simulated as one task on the pool, and it is aborted as
+ * soon as the sum of its step responses exceeds the cutoff (see
+ * getAltitudeCost).
+ */
+class AltitudeEvaluator : public Evaluator<AltitudeMember> {
+  public:
+    AltitudeEvaluator(const Drone &drone, Drone::AltitudeModel &model,
+                      const ColVector<Nx_alt> &altx0, double errorfactor,
+                      const AdaptiveODEOptions &opt, const CostWeights &cost,
+                      double maxIntegralInfluence, WorkStealingPool &pool)
+        : drone{drone}, model{model}, altx0{altx0}, errorfactor{errorfactor},
+          opt{opt}, cost{cost}, maxIntegralInfluence{maxIntegralInfluence},
+          pool{pool} {}
+
+    void evaluate(Span<AltitudeMember> members, double cutoff) override;
+
+    /// Get the clamped PI controller for the given member.
+    Drone::ClampAltitudeController
+    getController(const AltitudeMember &m) const {
+        return drone.getClampAltitudeController(m.getK_pi(),
+                                                maxIntegralInfluence);
+    }
+
+  private:
+    const Drone &drone;
+    Drone::AltitudeModel &model;
+    const ColVector<Nx_alt> altx0;
+    const double errorfactor;
+    const AdaptiveODEOptions opt;
+    const CostWeights cost;
+    const double maxIntegralInfluence;
+    WorkStealingPool &pool;
+};
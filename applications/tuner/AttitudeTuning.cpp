@@ -0,0 +1,130 @@
+#include "AttitudeTuning.hpp"
+
+#include <ANSIColors.hpp>
+#include <TunerConfig.hpp>
+
+#include <algorithm>  // min, partial_sort
+#include <cmath>      // isfinite
+#include <deque>
+#include <iostream>
+#include <numeric>    // iota
+
+void renormalize(Chromosome<8> &chromosome) {
+    const double factor = 1.0 / chromosome[6][0];
+    for (size_t i = 0; i < 8; ++i)
+        chromosome[i][0] *= factor;
+    chromosome[6][0] = 1.0;
+}
+
+using Config::Tuner::Qmax;
+using Config::Tuner::Qmin;
+using Config::Tuner::Rmax;
+using Config::Tuner::Rmin;
+using Config::Tuner::varQ;
+using Config::Tuner::varR;
+
+SearchSpace<8> getAttitudeSearchSpace() {
+    Chromosome<8> min = AttitudeMember::toChromosome(Qmin, Rmin);
+    Chromosome<8> max = AttitudeMember::toChromosome(Qmax, Rmax);
+    min[6][0]         = 1;
+    max[6][0]         = 1;
+    return {min, max, true};
+}
+
+AttitudeMutation::AttitudeMutation()
+    : gaussian{AttitudeMember::toChromosome(varQ, varR),
+               AttitudeMember::toChromosome(Qmin, Rmin),
+               AttitudeMember::toChromosome(Qmax, Rmax)} {}
+
+void AttitudeMutation::operator()(Chromosome<8> &chromosome,
+                                  Philox::Stream &rng) const {
+    gaussian(chromosome, rng);
+    renormalize(chromosome);
+}
+
+std::optional<Drone::FixedClampAttitudeController>
+AttitudeEvaluator::getController(const AttitudeMember &m) const {
+    try {
+        return drone.getFixedClampAttitudeController(m.getQ(), m.getR());
+    } catch (std::runtime_error &e) {
+        // LAPACK sometimes fails for certain Q and R
+#ifdef DEBUG
+        std::cerr << ANSIColors::redb << e.what() << ANSIColors::reset
+                  << std::endl;
+#endif
+        return std::nullopt;
+    }
+}
+
+void AttitudeEvaluator::evaluate(Span<AttitudeMember> members, double cutoff) {
+    // The members of the population that are not in the batch already have
+    // a nonlinear cost
+    size_t simulated = members.size();
+    if (fullySimulated < populationSize) {
+        const size_t cached = populationSize - members.size();
+        simulated = fullySimulated > cached ? fullySimulated - cached : 0;
+        simulated = std::min(simulated, members.size());
+    }
+    std::vector<size_t> indices(members.size());
+    std::iota(indices.begin(), indices.end(), 0);
+
+    screenedCount = 0;
+    if (simulated < members.size()) {
+        // Screen all members using the linear model, the screening ranks
+        // more members than there are survivors, so it has no cutoff
+        std::vector<double> screeningCosts(members.size());
+        pool.parallelFor(members.size(), [&](size_t i) {
+            auto ctrl = getController(members[i]);
+            double c  = ctrl ? getCost(*ctrl, linearModel, errorfactor, attx0,
+                                       opt, cost)
+                             : std::numeric_limits<double>::infinity();
+            // An unstable linear model can produce NaN states, and NaN costs
+            // would break the strict weak ordering of the sort below
+            screeningCosts[i] =
+                std::isfinite(c) ? c : std::numeric_limits<double>::infinity();
+        });
+        screenedCount = members.size();
+        std::partial_sort(indices.begin(), indices.begin() + simulated,
+                          indices.end(), [&](size_t a, size_t b) {
+                              if (screeningCosts[a] != screeningCosts[b])
+                                  return screeningCosts[a] < screeningCosts[b];
+                              return a < b;
+                          });
+        // The costs of the linear and nonlinear models can't be compared,
+        // so make sure that none of the screened-out members survive
+        for (size_t j = simulated; j < members.size(); ++j) {
+            AttitudeMember &m = members[indices[j]];
+            m.cost            = std::numeric_limits<double>::infinity();
+            m.costValid       = true;
+        }
+    }
+    simulatedCount = simulated;
+
+    std::vector<std::optional<Drone::FixedClampAttitudeController>> controllers(
+        simulated);
+    pool.parallelFor(simulated, [&](size_t j) {
+        auto ctrl = getController(members[indices[j]]);
+        if (ctrl)  // The controllers can't be assigned, only copied
+            controllers[j].emplace(*ctrl);
+    });
+
+    // Every (member, reference) pair is a separate task, the references of
+    // a member share the partial cost for the early abort
+    constexpr size_t R = CostReferences::numberOfReferences;
+    std::deque<ConcurrentCost> costs;
+    for (size_t j = 0; j < simulated; ++j)
+        costs.emplace_back(cutoff);
+    pool.parallelFor(simulated * R, [&](size_t k) {
+        size_t j = k / R;
+        if (controllers[j])
+            costs[j].evaluate(order[k % R], *controllers[j], model,
+                              errorfactor, attx0, opt, cost);
+        else
+            costs[j].fail();
+    });
+    for (size_t j = 0; j < simulated; ++j) {
+        AttitudeMember &m = members[indices[j]];
+        m.cost            = costs[j].get();
+        m.costValid       = true;
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "Cost.hpp"
+#include <GeneticAlgorithm.hpp>
+#include <SearchSpace.hpp>
+#include <WorkStealingPool.hpp>
+
+#include <optional>
+
+/**
+ * Scale the chromosome so that the first weight of R is one. The LQR
+ * controller only depends on the ratios of the weights.
+ */
+void renormalize(Chromosome<8> &chromosome);
+
+/**
+ * The bounds of the tuner config, on a logarithmic scale, for optimizers that
+ * search in coordinates (CMA-ES and differential evolution). The first weight
+ * of R is fixed to one, see renormalize.
+ */
+SearchSpace<8> getAttitudeSearchSpace();
+
+/**
+ * Adds normally distributed noise with the variances of the tuner config to
+ * the weights, clamps them to their bounds, and renormalizes them.
+ */
+class AttitudeMutation : public Mutation<8> {
+  public:
+    AttitudeMutation();
+    void operator()(Chromosome<8> &chromosome,
+                    Philox::Stream &rng) const override;
+
+  private:
+    GaussianMutation<8> gaussian;
+};
+
+/**
+ * Calculates the costs of the LQR attitude controllers for a batch of
+ * members.
+ *
+ * If screening is enabled (fullySimulated < populationSize), all members are
+ * first screened using the linearized model, and only the best ones are
+ * simulated using the nonlinear model, so that the population contains the
+ * given number of members with a nonlinear cost. The cost of the others is
+ * infinite. Otherwise, every member of the batch is simulated, whatever the
+ * size of the batch.
+ *
+ * The nonlinear simulations are run on the pool, as one task per (member,
+ * reference) pair, and a member is aborted as soon as its cost exceeds the
+ * cutoff (see ConcurrentCost).
+ */
+class AttitudeEvaluator : public Evaluator<AttitudeMember> {
+  public:
+    AttitudeEvaluator(const Drone &drone, Drone::AttitudeModel &model,
+                      Drone::LinearAttitudeModel &linearModel,
+                      const DroneAttitudeState &attx0, double errorfactor,
+                      const AdaptiveODEOptions &opt, const CostWeights &cost,
+                      const ReferenceOrder &order, WorkStealingPool &pool,
+                      size_t populationSize = 0, size_t fullySimulated = 0)
+        : drone{drone}, model{model}, linearModel{linearModel}, attx0{attx0},
+          errorfactor{errorfactor}, opt{opt}, cost{cost}, order{order},
+          pool{pool}, populationSize{populationSize},
+          fullySimulated{fullySimulated} {}
+
+    void evaluate(Span<AttitudeMember> members, double cutoff) override;
+
+    /// Get the LQR controller for the given member, if it exists.
+    std::optional<Drone::FixedClampAttitudeController>
+    getController(const AttitudeMember &m) const;
+
+    /// The number of members screened by the last evaluation.
+    size_t getScreenedCount() const { return screenedCount; }
+    /// The number of members simulated by the last evaluation.
+    size_t getSimulatedCount() const { return simulatedCount; }
+
+  private:
+    const Drone &drone;
+    Drone::AttitudeModel &model;
+    Drone::LinearAttitudeModel &linearModel;
+    const DroneAttitudeState attx0;
+    const double errorfactor;
+    const AdaptiveODEOptions opt;
+    const CostWeights cost;
+    const ReferenceOrder order;
+    WorkStealingPool &pool;
+    const size_t populationSize;
+    const size_t fullySimulated;
+
+    size_t screenedCount  = 0;
+    size_t simulatedCount = 0;
+};
@@ -1,5 +1,12 @@
 #include "Cost.hpp"
 
+#include <algorithm>  // min, stable_sort
+#include <numeric>    // iota
+
+#ifdef DEBUG
+#include <StepResponseAnalyzerPlotter.hpp>
+#endif
+
 constexpr double infinity = std::numeric_limits<double>::infinity();
 
 template <size_t N>
@@ -13,7 +20,7 @@ double getTimeStepCost(const typename StepResponseAnalyzer<N>::Result &result,
     const auto &overshoot  = result.overshoot;
     const auto &risetime   = result.risetime;
     double cost            = 0;
-    for (size_t i = 0; i < 4; ++i) {
+    for (size_t i = 0; i < N; ++i) {
         if (overshoot[i] == infinity)
             return infinity;
         if (absdelta[i] == 0)
@@ -33,10 +40,46 @@ double getTimeStepCost(const typename StepResponseAnalyzer<N>::Result &result,
     return cost;
 }
 
-double getRiseTimeCost(Drone::FixedClampAttitudeController &attctrl,
-                       Drone::AttitudeModel &attmodel, Quaternion q_ref,
-                       double errorfactor, const DroneAttitudeState &attx0,
-                       const AdaptiveODEOptions &opt, const CostWeights &cost) {
+/**
+ * @brief   Get a lower bound of the final cost of getTimeStepCost, given the
+ *          intermediate result of a step response that's still being
+ *          simulated. The weights must be nonnegative.
+ *
+ * Components that haven't risen yet could still rise or settle at any time,
+ * so they don't contribute. The cost of settled components no longer
+ * changes. Components that have risen will either settle, or keep at least
+ * their overshoot, if it's known already.
+ */
+template <size_t N>
+double getTimeStepCostLowerBound(
+    const typename StepResponseAnalyzer<N>::Result &result,
+    double notSettledCost, double risetimeCost, double overshootCost,
+    double settleTimeCost) {
+    const auto &settletime = result.settletime;
+    const auto &absdelta   = result.absdelta;
+    const auto &overshoot  = result.overshoot;
+    const auto &risetime   = result.risetime;
+    double bound           = 0;
+    for (size_t i = 0; i < N; ++i) {
+        if (absdelta[i] == 0 || risetime[i] < 0)
+            continue;
+        double riseCost = risetimeCost * risetime[i]  //
+                          + overshootCost * abs(overshoot[i] / absdelta[i]);
+        if (settletime[i] >= 0)
+            bound += riseCost + settleTimeCost * (settletime[i] - risetime[i]);
+        else
+            bound += std::min<double>(riseCost,
+                                      notSettledCost * abs(overshoot[i]));
+    }
+    return bound;
+}
+
+template <class AttitudeModel>
+double getRiseTimeCostT(Drone::FixedClampAttitudeController &attctrl,
+                        AttitudeModel &attmodel, Quaternion q_ref,
+                        double errorfactor, const DroneAttitudeState &attx0,
+                        const AdaptiveODEOptions &opt, const CostWeights &cost,
+                        double budget) {
     DroneAttitudeOutput y_ref;
     y_ref.setOrientation(q_ref);
     const DroneAttitudeOutput atty0 = attmodel.getOutput(attx0, {0});
@@ -49,15 +92,27 @@ double getRiseTimeCost(Drone::FixedClampAttitudeController &attctrl,
     StepResponseAnalyzer<4> analyzer = {q_ref, errorfactor, q0};
 #endif
 
+    bool aborted = false;
+
+    // Stop the simulation when the cost is known to exceed the budget
     auto f = [&](double t, const ColVector<Nx_att> &x,
                  const ColVector<Nu_att> &u) {
         DroneAttitudeOutput y = attmodel.getOutput(x, u);
-        return analyzer(t, y.getOrientation());
+        if (!analyzer(t, y.getOrientation()))
+            return false;
+        if (budget == infinity)
+            return true;
+        aborted = getTimeStepCostLowerBound<4>(
+                      analyzer.getResult(), cost.notSettled, cost.risetime,
+                      cost.overshoot, cost.settleTime) > budget;
+        return !aborted;
     };
 
     ODEResultCode resultCode =
         attmodel.simulateRealTime(attctrl, y_ref_f, attx0, opt, f);
     resultCode.verbose();
+    if (aborted)
+        return infinity;
 
 #ifdef DEBUG
     analyzer.plot();
@@ -82,14 +137,150 @@ double getRiseTimeCost(Drone::FixedClampAttitudeController &attctrl,
                               cost.risetime, cost.overshoot, cost.settleTime);
 }
 
+template <class AttitudeModel>
+double getCostT(Drone::FixedClampAttitudeController &ctrl,
+                AttitudeModel &model, double errorfactor,
+                const DroneAttitudeState &attx0, const AdaptiveODEOptions &opt,
+                const CostWeights &cost, double cutoff,
+                const ReferenceOrder &order) {
+    // The costs are summed in the original order afterwards, so the result
+    // doesn't depend on the order of the simulations
+    Array<double, CostReferences::numberOfReferences> costs = {};
+    double partialCost                                      = 0;
+    for (size_t r : order) {
+        costs[r] = getRiseTimeCostT(ctrl, model, CostReferences::references[r],
+                                    errorfactor, attx0, opt, cost,
+                                    cutoff - partialCost);
+        partialCost += costs[r];
+        if (partialCost > cutoff)
+            return infinity;
+    }
+    double totalCost = 0;
+    for (double c : costs)
+        totalCost += c;
+    return totalCost;
+}
+
+double getRiseTimeCost(Drone::FixedClampAttitudeController &attctrl,
+                       Drone::AttitudeModel &attmodel, Quaternion q_ref,
+                       double errorfactor, const DroneAttitudeState &attx0,
+                       const AdaptiveODEOptions &opt, const CostWeights &cost,
+                       double budget) {
+    return getRiseTimeCostT(attctrl, attmodel, q_ref, errorfactor, attx0, opt,
+                            cost, budget);
+}
+
+double getRiseTimeCost(Drone::FixedClampAttitudeController &attctrl,
+                       Drone::LinearAttitudeModel &attmodel, Quaternion q_ref,
+                       double errorfactor, const DroneAttitudeState &attx0,
+                       const AdaptiveODEOptions &opt, const CostWeights &cost,
+                       double budget) {
+    return getRiseTimeCostT(attctrl, attmodel, q_ref, errorfactor, attx0, opt,
+                            cost, budget);
+}
+
 double getCost(Drone::FixedClampAttitudeController &ctrl,
                Drone::AttitudeModel &model, double errorfactor,
                const DroneAttitudeState &attx0, const AdaptiveODEOptions &opt,
-               const CostWeights &cost) {
+               const CostWeights &cost, double cutoff,
+               const ReferenceOrder &order) {
+    return getCostT(ctrl, model, errorfactor, attx0, opt, cost, cutoff, order);
+}
+
+double getCost(Drone::FixedClampAttitudeController &ctrl,
+               Drone::LinearAttitudeModel &model, double errorfactor,
+               const DroneAttitudeState &attx0, const AdaptiveODEOptions &opt,
+               const CostWeights &cost, double cutoff,
+               const ReferenceOrder &order) {
+    return getCostT(ctrl, model, errorfactor, attx0, opt, cost, cutoff, order);
+}
+
+void ConcurrentCost::evaluate(size_t r,
+                              Drone::FixedClampAttitudeController attctrl,
+                              Drone::AttitudeModel &attmodel,
+                              double errorfactor,
+                              const DroneAttitudeState &attx0,
+                              const AdaptiveODEOptions &opt,
+                              const CostWeights &cost) {
+    if (aborted)
+        return;
+    costs[r] = getRiseTimeCostT(attctrl, attmodel,
+                                CostReferences::references[r], errorfactor,
+                                attx0, opt, cost, cutoff - partialCost);
+    double partial = partialCost.load();
+    while (!partialCost.compare_exchange_weak(partial, partial + costs[r]))
+        ;
+    if (partial + costs[r] > cutoff)
+        aborted = true;
+}
 
+double ConcurrentCost::get() const {
+    if (aborted)
+        return infinity;
     double totalCost = 0;
-    for (const Quaternion &ref : CostReferences::references)
-        totalCost +=
-            getRiseTimeCost(ctrl, model, ref, errorfactor, attx0, opt, cost);
+    for (double c : costs)
+        totalCost += c;
+    return totalCost;
+}
+
+ReferenceOrder getReferenceOrder(Drone::FixedClampAttitudeController &attctrl,
+                                 Drone::AttitudeModel &attmodel,
+                                 double errorfactor,
+                                 const DroneAttitudeState &attx0,
+                                 const AdaptiveODEOptions &opt,
+                                 const CostWeights &cost) {
+    Array<double, CostReferences::numberOfReferences> costs = {};
+    for (size_t r = 0; r < CostReferences::numberOfReferences; ++r)
+        costs[r] = getRiseTimeCostT(attctrl, attmodel,
+                                    CostReferences::references[r], errorfactor,
+                                    attx0, opt, cost, infinity);
+    ReferenceOrder order;
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return costs[a] > costs[b];
+    });
+    return order;
+}
+
+double getAltitudeStepCost(Drone::ClampAltitudeController &altctrl,
+                           Drone::AltitudeModel &altmodel, double z_ref,
+                           double errorfactor, const ColVector<Nx_alt> &altx0,
+                           const AdaptiveODEOptions &opt,
+                           const CostWeights &cost) {
+    const ColVector<Ny_alt> z0     = altmodel.getOutput(altx0, {0});
+    const ColVector<Ny_alt> y_ref  = z0 + ColVector<Ny_alt>{z_ref};
+    ConstantTimeFunctionT<ColVector<Ny_alt>> y_ref_f = {y_ref};
+    StepResponseAnalyzer<1> analyzer = {y_ref, errorfactor, z0};
+
+    auto f = [&](double t, const ColVector<Nx_alt> &x,
+                 const ColVector<Nu_alt> &u) {
+        return analyzer(t, altmodel.getOutput(x, u));
+    };
+
+    altctrl.reset();
+    ODEResultCode resultCode =
+        altmodel.simulateRealTime(altctrl, y_ref_f, altx0, opt, f);
+    resultCode.verbose();
+
+    if (resultCode & ODEResultCodes::MAXIMUM_ITERATIONS_EXCEEDED)
+        return infinity;
+
+    auto result = analyzer.getResult();
+    return getTimeStepCost<1>(result, cost.notRisen, cost.notSettled,
+                              cost.risetime, cost.overshoot, cost.settleTime);
+}
+
+double getAltitudeCost(Drone::ClampAltitudeController &altctrl,
+                       Drone::AltitudeModel &altmodel, double errorfactor,
+                       const ColVector<Nx_alt> &altx0,
+                       const AdaptiveODEOptions &opt, const CostWeights &cost,
+                       double cutoff) {
+    double totalCost = 0;
+    for (double z_ref : CostReferences::altitudes) {
+        totalCost += getAltitudeStepCost(altctrl, altmodel, z_ref, errorfactor,
+                                         altx0, opt, cost);
+        if (totalCost > cutoff)
+            return infinity;
+    }
     return totalCost;
 }
@@ -6,6 +6,9 @@
 #include <Drone.hpp>
 #include <Degrees.hpp>
 
+#include <atomic>
+#include <limits>
+
 namespace CostReferences {
 constexpr Quaternion qz                   = eul2quat({22.5_deg, 0, 0});
 constexpr Quaternion qy                   = eul2quat({0, 22.5_deg, 0});
@@ -13,7 +16,8 @@ constexpr Quaternion qx                   = eul2quat({0, 0, 22.5_deg});
 constexpr Quaternion qz3                  = eul2quat({30_deg, 0, 0});
 constexpr Quaternion qy3                  = eul2quat({0, 30_deg, 0});
 constexpr Quaternion qx3                  = eul2quat({0, 0, 30_deg});
-constexpr Array<Quaternion, 7> references = {{
+constexpr size_t numberOfReferences      = 7;
+constexpr Array<Quaternion, numberOfReferences> references = {{
     quatmultiply(qx, quatmultiply(qy, qz)),
     quatmultiply(qx, qy),
     qx,
@@ -22,14 +26,147 @@ constexpr Array<Quaternion, 7> references = {{
     qx3,
     qz3,
 }};
+/// Altitude steps, relative to the initial altitude (m)
+constexpr Array<double, 3> altitudes = {{0.5, -0.5, 2}};
 }  // namespace CostReferences
 
+/// The order in which getCost simulates the attitude references, as indices
+/// into CostReferences::references.
+using ReferenceOrder = Array<size_t, CostReferences::numberOfReferences>;
+
+/// Simulate the references in the order in which they are defined.
+constexpr ReferenceOrder defaultReferenceOrder = {{0, 1, 2, 3, 4, 5, 6}};
+
+/**
+ * @brief   Simulate a step response of the attitude controller and the 
+ *          nonlinear attitude model, and calculate its cost.
+ *
+ * If a lower bound of the cost exceeds the given budget during the
+ * simulation, the simulation is stopped, and the cost is infinite.
+ */
 double getRiseTimeCost(Drone::FixedClampAttitudeController &attctrl,
                        Drone::AttitudeModel &attmodel, Quaternion q_ref,
                        double factor, const DroneAttitudeState &attx0,
-                       const AdaptiveODEOptions &opt, const CostWeights &cost);
+                       const AdaptiveODEOptions &opt, const CostWeights &cost,
+                       double budget = std::numeric_limits<double>::infinity());
 
+/**
+ * @brief   Simulate a step response of the attitude controller and the 
+ *          linearized discrete attitude model, and calculate its cost.
+ *          This is much cheaper than using the nonlinear model, but less
+ *          accurate, so it's used for screening.
+ */
+double getRiseTimeCost(Drone::FixedClampAttitudeController &attctrl,
+                       Drone::LinearAttitudeModel &attmodel, Quaternion q_ref,
+                       double factor, const DroneAttitudeState &attx0,
+                       const AdaptiveODEOptions &opt, const CostWeights &cost,
+                       double budget = std::numeric_limits<double>::infinity());
+
+/**
+ * @brief   Get the sum of the step response costs for all CostReferences.
+ *
+ * All terms of the cost are nonnegative, so as soon as the sum of the
+ * references simulated so far, plus a lower bound of the cost of the
+ * reference that's being simulated, exceeds the cutoff, the evaluation is
+ * aborted and the cost is infinite. Costs below the cutoff are not affected,
+ * they are always summed in the order of CostReferences::references.
+ *
+ * @param   cutoff
+ *          Specimens with a cost higher than the cutoff are not interesting,
+ *          e.g. because they can't beat any of the survivors.
+ * @param   order
+ *          The order in which the references are simulated. References
+ *          with higher costs should come first, so the cutoff is exceeded
+ *          as early as possible.
+ */
 double getCost(Drone::FixedClampAttitudeController &attctrl,
                Drone::AttitudeModel &attmodel, double errorfactor,
                const DroneAttitudeState &attx0, const AdaptiveODEOptions &opt,
-               const CostWeights &cost);
\ No newline at end of file
+               const CostWeights &cost,
+               double cutoff = std::numeric_limits<double>::infinity(),
+               const ReferenceOrder &order = defaultReferenceOrder);
+
+/// Get the sum of the step response costs for all CostReferences, using the
+/// linearized discrete model.
+double getCost(Drone::FixedClampAttitudeController &attctrl,
+               Drone::LinearAttitudeModel &attmodel, double errorfactor,
+               const DroneAttitudeState &attx0, const AdaptiveODEOptions &opt,
+               const CostWeights &cost,
+               double cutoff = std::numeric_limits<double>::infinity(),
+               const ReferenceOrder &order = defaultReferenceOrder);
+
+/**
+ * @brief   The cost of a specimen whose references are simulated concurrently,
+ *          as separate tasks, with the same early abort as getCost.
+ *
+ * The tasks share the partial sum of the references that are done, so the
+ * budget of every task is what's left of the cutoff when it starts, and the
+ * tasks that didn't start yet are skipped once the cutoff is exceeded.
+ * Which tasks are aborted depends on the timing, but a specimen is only ever
+ * aborted if its cost exceeds the cutoff, and the cost of the others is
+ * exactly the cost returned by getCost.
+ */
+class ConcurrentCost {
+  public:
+    explicit ConcurrentCost(
+        double cutoff = std::numeric_limits<double>::infinity())
+        : cutoff{cutoff} {}
+
+    /// Simulate the step response of reference r. This can be called
+    /// concurrently for different references, each with its own controller.
+    void evaluate(size_t r, Drone::FixedClampAttitudeController attctrl,
+                  Drone::AttitudeModel &attmodel, double errorfactor,
+                  const DroneAttitudeState &attx0,
+                  const AdaptiveODEOptions &opt, const CostWeights &cost);
+
+    /// Mark the evaluation as failed, e.g. when the controller couldn't be
+    /// computed. The cost is infinite.
+    void fail() { aborted = true; }
+
+    /// Get the total cost, after all references have been evaluated, or
+    /// infinity if the evaluation was aborted.
+    double get() const;
+
+  private:
+    double cutoff;
+    std::atomic<double> partialCost{0};
+    std::atomic<bool> aborted{false};
+    Array<double, CostReferences::numberOfReferences> costs = {};
+};
+
+/**
+ * @brief   Get an order of the references from the highest to the lowest
+ *          step response cost of the given controller. The ones that
+ *          contribute most to the cost are the most likely to exceed the
+ *          cutoff of getCost.
+ */
+ReferenceOrder getReferenceOrder(Drone::FixedClampAttitudeController &attctrl,
+                                 Drone::AttitudeModel &attmodel,
+                                 double errorfactor,
+                                 const DroneAttitudeState &attx0,
+                                 const AdaptiveODEOptions &opt,
+                                 const CostWeights &cost);
+
+/**
+ * @brief   Simulate a step response of the altitude controller and the
+ *          nonlinear altitude model, and calculate its cost.
+ *          The internal state of the controller is reset first.
+ */
+double getAltitudeStepCost(Drone::ClampAltitudeController &altctrl,
+                           Drone::AltitudeModel &altmodel, double z_ref,
+                           double errorfactor, const ColVector<Nx_alt> &altx0,
+                           const AdaptiveODEOptions &opt,
+                           const CostWeights &cost);
+
+/**
+ * @brief   Get the sum of the altitude step response costs for all
+ *          CostReferences::altitudes.
+ *
+ * As soon as the sum of the steps simulated so far exceeds the cutoff, the
+ * evaluation is aborted and the cost is infinite.
+ */
+double getAltitudeCost(Drone::ClampAltitudeController &altctrl,
+                       Drone::AltitudeModel &altmodel, double errorfactor,
+                       const ColVector<Nx_alt> &altx0,
+                       const AdaptiveODEOptions &opt, const CostWeights &cost,
+                       double cutoff = std::numeric_limits<double>::infinity());
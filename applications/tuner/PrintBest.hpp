@@ -1,9 +1,14 @@
 #pragma once
 
-#include "Weights.hpp"
+#include <Member.hpp>
 #include <filesystem>
 #include <ostream>
 
-void printBest(std::ostream &os, size_t generation, const Weights &best);
+void printBest(std::ostream &os, size_t generation, const AttitudeMember &best);
 void appendBestToFile(const std::filesystem::path &filename, size_t generation,
-                      const Weights &best);
\ No newline at end of file
+                      const AttitudeMember &best);
+
+void printBest(std::ostream &os, size_t generation,
+               const AltitudeMember &best);
+void appendBestToFile(const std::filesystem::path &filename, size_t generation,
+                      const AltitudeMember &best);
@@ -56,10 +56,34 @@ const ColVector<3> Rmin = 1e-2 * ones<3, 1>();
 const ColVector<9> Qmax = 1e6 * ones<9, 1>();
 const ColVector<3> Rmax = 1e2 * ones<3, 1>();
 
+/* ------ Altitude tuning --------------------------------------------------- */
+/** 
+ * Options for the altitude step responses. The altitude controller runs at a
+ * much lower rate than the attitude controller, so it needs a longer horizon.
+ */
+const AdaptiveODEOptions odeoptalt = {
+    .t_start = 0.0,
+    .t_end   = 10.0,
+    .epsilon = 1e-4,
+    .h_start = 1e-4,
+    .h_min   = 1e-7,
+    .maxiter = (unsigned long) 1e5,
+};
+/** Relative standard deviation of the mutations of the PI altitude gains. */
+const double altitudeMutationFactor = 0.1;
+
 /* ------ Genetic algorithm settings ---------------------------------------- */
 const size_t population  = 16 * 64;
 const size_t generations = 50;
 const size_t survivors   = 16;
+/** 
+ * Fraction of the population that is simulated using the nonlinear model, 
+ * after screening the entire population using the linearized model. 
+ * Use 1 to disable screening.
+ */
+const double screeningFraction = 1;
+/** Seed of the random mutations and crossovers. */
+const uint64_t seed = 0;
 
 /* ------ Cost function parameters ------------------------------------------ */
 const CostWeights stepcostweights = {
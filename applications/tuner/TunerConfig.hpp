@@ -3,6 +3,7 @@
 #include "CostWeights.hpp"
 #include <Matrix.hpp>
 #include <ODEOptions.hpp>
+#include <cstdint>
 #include <filesystem>
 
 namespace Config {
@@ -29,10 +30,16 @@ extern const ColVector<3> Rmin;
 extern const ColVector<9> Qmax;
 extern const ColVector<3> Rmax;
 
+/* ------ Altitude tuning --------------------------------------------------- */
+extern const AdaptiveODEOptions odeoptalt;
+extern const double altitudeMutationFactor;
+
 /* ------ Genetic algorithm settings ---------------------------------------- */
 extern const size_t population;
 extern const size_t generations;
 extern const size_t survivors;
+extern const double screeningFraction;
+extern const uint64_t seed;
 
 /* ------ Cost function parameters ------------------------------------------ */
 extern const CostWeights stepcostweights;
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include <AltitudeTuning.hpp>
+#include <Config.hpp>
+#include <TunerConfig.hpp>
+
+#include <algorithm>  // sort
+#include <cmath>      // isfinite
+#include <filesystem>
+
+/// The drone parameters and matrices used by the tests.
+static const std::filesystem::path loadPath =
+    std::filesystem::path(__FILE__).parent_path() / ".." / ".." / ".." /
+    "py-drone" / "test" / "ParamsAndMatrices";
+
+/**
+ * The altitude evaluator should rank a PI controller that settles close to
+ * all altitude steps before one that doesn't rise in time, and abort the
+ * members whose cost exceeds the cutoff.
+ */
+TEST(AltitudeEvaluator, ranksPIGains) {
+    Drone drone                   = {loadPath};
+    Drone::AltitudeModel altmodel = drone.getAltitudeModel();
+    WorkStealingPool pool{2};
+    AltitudeEvaluator evaluator = {
+        drone,
+        altmodel,
+        {0, 0, 0},
+        Config::Tuner::steperrorfactor,
+        Config::Tuner::odeoptalt,
+        Config::Tuner::stepcostweights,
+        Config::Altitude::maxIntegralInfluence,
+        pool,
+    };
+
+    // LQR gains for Q = diag(0.001, 1, 0.5) and Q = diag(1, 100, 10), R = 1,
+    // with a slow and a fast integrator
+    const Matrix<1, 4> good = {{0.00264, 0.158, 0.137, -0.001}};
+    const Matrix<1, 4> bad  = {{0.00140, 0.0754, 0.0573, -0.01}};
+
+    AltitudeMember members[2] = {};
+    members[0].chromosome     = AltitudeMember::toChromosome(bad);
+    members[1].chromosome     = AltitudeMember::toChromosome(good);
+    evaluator.evaluate({members, 2}, std::numeric_limits<double>::infinity());
+    for (const AltitudeMember &m : members) {
+        EXPECT_TRUE(m.costValid);
+        EXPECT_TRUE(std::isfinite(m.cost));
+    }
+    std::sort(std::begin(members), std::end(members));
+    EXPECT_EQ(members[0].getK_pi(), good);
+    EXPECT_EQ(members[1].getK_pi(), bad);
+
+    // The cost is the sum of the altitude step responses
+    Drone::ClampAltitudeController ctrl = evaluator.getController(members[0]);
+    EXPECT_EQ(members[0].cost,
+              getAltitudeCost(ctrl, altmodel, Config::Tuner::steperrorfactor,
+                              {0, 0, 0}, Config::Tuner::odeoptalt,
+                              Config::Tuner::stepcostweights));
+
+    // Only the good controller survives a cutoff between the two costs
+    const double cutoff = 2 * members[0].cost;
+    ASSERT_LT(cutoff, members[1].cost);
+    members[0].costValid = members[1].costValid = false;
+    evaluator.evaluate({members, 2}, cutoff);
+    EXPECT_LE(members[0].cost, cutoff);
+    EXPECT_EQ(members[1].cost, std::numeric_limits<double>::infinity());
+    EXPECT_TRUE(members[1].costValid);
+}
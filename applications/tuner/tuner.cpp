@@ -1,9 +1,10 @@
 #include <pybind11/embed.h>
 
+#include "AltitudeTuning.hpp"
+#include "AttitudeTuning.hpp"
 #include "Cost.hpp"
 #include "DisplayReference.hpp"
 #include "PrintBest.hpp"
-#include "Weights.hpp"
 #include <ANSIColors.hpp>
 #include <AlmostEqual.hpp>
 #include <ArgParser.hpp>
@@ -12,9 +13,11 @@
 #include <PerfTimer.hpp>
 #include <Plot.hpp>
 #include <PlotStepResponse.hpp>
-#include <cstdlib>  // strtoul
+#include <TunerConfig.hpp>
+#include <WorkStealingPool.hpp>
+#include <cmath>    // ceil
+#include <cstdlib>  // strtoul, strtoull, strtod
 #include <iostream>
-#include <parallel/algorithm>
 
 using namespace std;
 
@@ -26,6 +29,55 @@ using namespace std;
 └─────────────────┘
 */
 
+/**
+ * Tune the gains of the PI altitude controller with the genetic algorithm,
+ * starting from the LQR gains of the altitude config. The step responses are
+ * simulated using the nonlinear altitude model.
+ */
+static void tuneAltitude(const Drone &drone, size_t population,
+                         size_t survivors, size_t generations, uint64_t seed,
+                         double steperrorfactor,
+                         const CostWeights &stepcostweights,
+                         const filesystem::path &outPath,
+                         WorkStealingPool &pool) {
+    Drone::AltitudeModel model        = drone.getAltitudeModel();
+    const double maxIntegralInfluence = Config::Altitude::maxIntegralInfluence;
+    Altitude::LQRController initialCtrl = drone.getAltitudeController(
+        Config::Altitude::Q, Config::Altitude::K_i, maxIntegralInfluence);
+    Chromosome<4> initial = AltitudeMember::toChromosome(initialCtrl.K_pi);
+
+    UniformSelection select;
+    SinglePointCrossOver<4> crossOver;
+    RelativeGaussianMutation<4> mutate = {
+        Config::Tuner::altitudeMutationFactor};
+    AltitudeEvaluator evaluator = {
+        drone,
+        model,
+        {0, 0, 0},
+        steperrorfactor,
+        Config::Tuner::odeoptalt,
+        stepcostweights,
+        maxIntegralInfluence,
+        pool,
+    };
+    GeneticAlgorithm<AltitudeMember> ga = {select, crossOver, mutate,
+                                           evaluator, seed};
+
+    Population<AltitudeMember> specimens = {population, survivors};
+    specimens.initialize(initial, mutate, ga.getKey());
+
+    cout << ANSIColors::blueb << "Starting Genetic Algorithm (altitude) ..."
+         << ANSIColors::reset << endl;
+    ga.run(specimens, generations,
+           [&](size_t g, const Population<AltitudeMember> &p) {
+               printBest(cout, g, p.best());
+               appendBestToFile(outPath / "tuner-altitude.output", g,
+                                p.best());
+           });
+    cout << ANSIColors::greenb << endl
+         << "Done. ✔" << ANSIColors::reset << endl;
+}
+
 int main(int argc, char const *argv[]) {
 
     /* ------ Parse command line arguments ---------------------------------- */
@@ -35,9 +87,12 @@ int main(int argc, char const *argv[]) {
     size_t population         = Config::Tuner::population;
     size_t generations        = Config::Tuner::generations;
     size_t survivors          = Config::Tuner::survivors;
+    double screeningFraction  = Config::Tuner::screeningFraction;
+    uint64_t seed             = Config::Tuner::seed;
     size_t px_x               = Config::px_x;
     size_t px_y               = Config::px_y;
     bool showPlot             = true;
+    bool altitude             = false;
 
     double steperrorfactor      = Config::Tuner::steperrorfactor;
     CostWeights stepcostweights = Config::Tuner::stepcostweights;
@@ -64,6 +119,16 @@ int main(int argc, char const *argv[]) {
         survivors = strtoul(argv[1], nullptr, 10);
         cout << "Setting number of survivors to: " << survivors << endl;
     });
+    parser.add("--screen", "-S", [&](const char *argv[]) {
+        screeningFraction = strtod(argv[1], nullptr);
+        cout << "Setting fraction of the population to simulate using the "
+                "nonlinear model to: "
+             << screeningFraction << endl;
+    });
+    parser.add("--seed", "-r", [&](const char *argv[]) {
+        seed = strtoull(argv[1], nullptr, 10);
+        cout << "Setting random seed to: " << seed << endl;
+    });
     parser.add("--width", "-w", [&](const char *argv[]) {
         px_x = strtoul(argv[1], nullptr, 10);
         cout << "Setting the image width to: " << px_x << endl;
@@ -76,12 +141,18 @@ int main(int argc, char const *argv[]) {
         showPlot = false;
         cout << "Not showing the resulting plots" << endl;
     });
+    parser.add<0>("--altitude", [&](const char * /* argv */ []) {
+        altitude = true;
+        cout << "Tuning the altitude controller instead of the attitude "
+                "controller"
+             << endl;
+    });
     cout << ANSIColors::blue;
     parser.parse(argc, argv);
     cout << ANSIColors::reset << endl;
 
-    assert(survivors > 0);
-    assert(population >= survivors);  // TODO!
+    // Throws if the number of survivors is invalid
+    Population<AttitudeMember> specimens = {population, survivors};
 
     if (population == survivors)
         cout << ANSIColors::yellow
@@ -102,34 +173,75 @@ int main(int argc, char const *argv[]) {
          << ANSIColors::reset << endl
          << endl;
 
-    Drone::AttitudeModel model = drone.getAttitudeModel();
+    // The costs of the specimens vary enormously: unstable ones are aborted
+    // early, good ones are simulated until the end. The work is balanced over
+    // all cores by work stealing.
+#ifndef DEBUG
+    WorkStealingPool pool;
+#else
+    WorkStealingPool pool{1};
+#endif
+
+    if (altitude) {
+        tuneAltitude(drone, population, survivors, generations, seed,
+                     steperrorfactor, stepcostweights, outPath, pool);
+        return EXIT_SUCCESS;
+    }
+
+    Drone::AttitudeModel model             = drone.getAttitudeModel();
+    Drone::LinearAttitudeModel linearModel = drone.getLinearAttitudeModel();
 
     DroneState x0            = drone.getStableState();
     DroneAttitudeState attx0 = x0.getAttitude();
 
-    /* ------ Create a population and initialize the random distributions --- */
-
-    vector<Weights> populationWeights;
-    populationWeights.resize(population);
+    /* ------ Initial controller -------------------------------------------- */
+
+    Chromosome<8> initial = AttitudeMember::toChromosome(
+        Config::Tuner::Q_diag_initial, Config::Tuner::R_diag_initial);
+    renormalize(initial);
+
+    // The references that contribute most to the cost of the initial
+    // specimen are simulated first, so hopeless specimens are aborted early
+    ReferenceOrder referenceOrder = defaultReferenceOrder;
+    try {
+        AttitudeMember m = {};
+        m.chromosome     = initial;
+        Drone::FixedClampAttitudeController ctrl =
+            drone.getFixedClampAttitudeController(m.getQ(), m.getR());
+        referenceOrder = getReferenceOrder(ctrl, model, steperrorfactor, attx0,
+                                           odeopt, stepcostweights);
+    } catch (std::runtime_error &) {
+        // Keep the default order if LAPACK fails
+    }
 
-    populationWeights[0].Q_diag = Config::Tuner::Q_diag_initial;
-    populationWeights[0].R_diag = Config::Tuner::R_diag_initial;
-    populationWeights[0].renormalize();
+    // Number of specimens that are simulated using the nonlinear model, the
+    // others are only screened using the linear model
+    size_t fullySimulated = population;
+    if (screeningFraction < 1) {
+        fullySimulated = std::max(
+            survivors, size_t(std::ceil(screeningFraction * population)));
+        fullySimulated = std::min(fullySimulated, population);
+    }
 
-    // Random engine for selecting a random survivor to use in mutations
-    static std::default_random_engine randomGenerator;
-    static std::uniform_int_distribution<size_t>  //
-        randomSurvivorIndex(0, survivors - 1);
+    /* ------ Set up the genetic algorithm ---------------------------------- */
+
+    // Every specimen of every generation has its own random stream, keyed by
+    // the seed, the generation and the index of the specimen, so the results
+    // only depend on the seed, not on the number of threads
+    UniformSelection select;
+    SinglePointCrossOver<8> crossOver;
+    AttitudeMutation mutate;
+    AttitudeEvaluator evaluator = {
+        drone,           model,          linearModel, attx0,
+        steperrorfactor, odeopt,         stepcostweights,
+        referenceOrder,  pool,           population,  fullySimulated,
+    };
+    GeneticAlgorithm<AttitudeMember> ga = {select, crossOver, mutate,
+                                           evaluator, seed};
 
     /* ------ Initialize the entire population with mutations of Specimen 0 - */
-#ifndef DEBUG
-#pragma omp parallel for
-#endif
-    for (size_t i = 1; i < population; ++i) {
-        populationWeights[i] = populationWeights[0];
-        populationWeights[i].mutate();
-        populationWeights[i].renormalize();
-    }
+
+    specimens.initialize(initial, mutate, ga.getKey());
 
     /* ------ Main loop of genetic algorithm -------------------------------- */
 
@@ -143,65 +255,35 @@ int main(int argc, char const *argv[]) {
 
         PerfTimer mutateTimer;
         if (g != 0) {  // If this is not the first generation
-
-#ifndef DEBUG
-#pragma omp parallel for
-#endif
-            for (size_t i = survivors; i < population; ++i) {
-                size_t idx1 = randomSurvivorIndex(randomGenerator);
-                size_t idx2 = randomSurvivorIndex(randomGenerator);
-                populationWeights[i].crossOver(populationWeights[idx1],
-                                               populationWeights[idx2]);
-                populationWeights[i].mutate();
-                populationWeights[i].renormalize();
-            }
+            ga.breed(specimens, g);
             auto mutateTime = mutateTimer.getDuration<chrono::microseconds>();
             cout << endl
-                 << "Mutated " << population << " controllers in " << mutateTime
-                 << " µs." << endl;
+                 << "Mutated " << population - survivors
+                 << " controllers in " << mutateTime << " µs." << endl;
         }
 
-        /* ------ Simulate all controllers and calculate the cost ----------- */
+        /* ------ Simulate all controllers, and sort them by cost ----------- */
 
+        // The survivors keep their costs from the previous generation, only
+        // the specimens whose weights changed are simulated. The simulations
+        // are deterministic, so this doesn't change the results.
         PerfTimer simTimer;
-
-#ifndef DEBUG
-#pragma omp parallel for
-#endif
-        for (size_t i = 0; i < population; ++i) {
-            auto &w = populationWeights[i];
-            try {
-                Drone::FixedClampAttitudeController ctrl =
-                    drone.getFixedClampAttitudeController(w.Q(), w.R());
-                w.cost = getCost(ctrl, model, steperrorfactor, attx0, odeopt,
-                                 stepcostweights);
-            } catch (std::runtime_error &e) {
-                // LAPACK sometimes fails for certain Q and R
-                w.cost = std::numeric_limits<double>::infinity();
-#ifdef DEBUG
-                cerr << ANSIColors::redb << e.what() << ANSIColors::reset
-                     << endl;
-#endif
-            }
-        }
+        ga.evaluate(specimens);
         auto simTime = simTimer.getDuration<chrono::milliseconds>();
-        cout << "Simulated " << population << " controllers in " << simTime
-             << " ms." << endl;
-
-        /* ------ Sort all specimens from low to high cost ------------------ */
-
-        PerfTimer sortTimer;
-#ifndef DEBUG
-        __gnu_parallel::sort(populationWeights.begin(),
-                             populationWeights.end());
-#else
-        sort(populationWeights.begin(), populationWeights.end());
-#endif
-        auto sortTime = sortTimer.getDuration<chrono::microseconds>();
-        cout << "Sorted " << population << " controllers in " << sortTime
-             << " µs." << endl;
 
-        auto &best = populationWeights[0];
+        size_t screenedCount  = evaluator.getScreenedCount();
+        size_t simulatedCount = evaluator.getSimulatedCount();
+        if (screenedCount > 0)
+            cout << "Screened " << screenedCount << " and simulated "
+                 << simulatedCount << " controllers in " << simTime
+                 << " ms (" << population - screenedCount
+                 << " costs cached)." << endl;
+        else
+            cout << "Simulated " << simulatedCount << " controllers in "
+                 << simTime << " ms (" << population - simulatedCount
+                 << " costs cached)." << endl;
+
+        const AttitudeMember &best = specimens.best();
         printBest(cout, g, best);
         appendBestToFile(outPath / "tuner.output", g, best);
 
@@ -211,7 +293,8 @@ int main(int argc, char const *argv[]) {
             DisplayReference reff;
 
             Drone::FixedClampAttitudeController ctrl =
-                drone.getFixedClampAttitudeController(best.Q(), best.R());
+                drone.getFixedClampAttitudeController(best.getQ(),
+                                                      best.getR());
             auto result =
                 model.simulate(ctrl, reff, attx0, Config::Tuner::odeoptdisp);
             result.resultCode.verbose();
@@ -238,15 +321,16 @@ int main(int argc, char const *argv[]) {
         show();
 
     if (Config::Tuner::plotStepResponse) {
-        auto &best = populationWeights[0];
+        const AttitudeMember &best = specimens.best();
         size_t i   = 0;
         for (const Quaternion &ref : CostReferences::references) {
             stringstream ss;
             ss << '$' << asEulerAngles(quat2eul(ref), degreesTeX, 2) << '$';
             auto ax  = axes(px_x, px_y);
             auto fig = ax.attr("figure");
-            plotStepResponseAttitude(drone, best.Q(), best.R(), steperrorfactor,
-                                     ref, Config::Tuner::odeopt, ax, ss.str());
+            plotStepResponseAttitude(drone, best.getQ(), best.getR(),
+                                     steperrorfactor, ref,
+                                     Config::Tuner::odeopt, ax, ss.str());
             std::stringstream filename;
             filename << "stepresponse" << std::setw(4) << std::setfill('0')
                      << (++i) << ".png";
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <DroneLogLoader.hpp>
+#include <DroneParamsAndMatrices.hpp>
+#include <filesystem>
+
+/// The noise model and storage parameters of the log smoother.
+struct LogSmootherOptions {
+    /// Variances of the process noise on the attitude control inputs.
+    RowVector<Nu_att> varDynamics_att = {{{1e-2, 1e-2, 1e-2}}};
+    /// Variances of the reduced attitude sensor readings (orientation, ω).
+    RowVector<Ny_att - 1> varSensors_att = {
+        {{1e-4, 1e-4, 1e-4, 1e-2, 1e-2, 1e-2}}};
+    /// Variance of the process noise on the thrust control input.
+    RowVector<Nu_alt> varDynamics_alt = {{{1e-2}}};
+    /// Variance of the height measurement.
+    RowVector<Ny_alt> varSensors_alt = {{{1e-4}}};
+    /// Initial variance of every (reduced) state.
+    double varInitial = 1;
+
+    /// Number of log entries per block of the spill files.
+    size_t blockSize = 1 << 14;
+    /// Directory of the temporary spill files.
+    std::filesystem::path spillDirectory =
+        std::filesystem::temp_directory_path();
+};
+
+/// Timing of the passes of the log smoother.
+struct LogSmootherStatistics {
+    size_t entries         = 0;
+    double forwardSeconds  = 0;
+    double backwardSeconds = 0;
+    /// Length of the log in seconds, at the attitude sample rate.
+    double flightSeconds = 0;
+};
+
+/**
+ * @brief   Smooth the state estimates of a flight log offline, with a
+ *          Rauch–Tung–Striebel smoother.
+ *
+ * The forward pass streams over the log, runs the UD Kalman observers of the
+ * drone (Attitude::UDKalmanObserver and Altitude::UDKalmanObserver) on the
+ * sensor readings and control signals (the altitude filter runs at its own,
+ * subsampled rate, as on the drone), and spills the filtered estimates, the predictions and the
+ * smoother gains to temporary files, one block at a time. The backward pass
+ * traverses the spill files in reverse through a memory mapping, and writes
+ * the output log, which is a copy of the input log where the observer
+ * estimates are replaced by the smoothed estimates.
+ *
+ * Only a few blocks of the input, the output, and the spill files are
+ * resident at any time, so the memory usage does not depend on the length
+ * of the log.
+ *
+ * Sensor readings that are NaN are ignored.
+ *
+ * @throws  std::runtime_error
+ *          If the input can't be read, or the output can't be written.
+ */
+LogSmootherStatistics smoothDroneLog(const DroneParamsAndMatrices &p,
+                                     const std::filesystem::path &input,
+                                     const std::filesystem::path &output,
+                                     const LogSmootherOptions &options = {});
@@ -0,0 +1,220 @@
+#include <LogSmoother.hpp>
+
+#include <LeastSquares.hpp>
+#include <MappedFile.hpp>
+#include <PerfTimer.hpp>
+#include <QuaternionStateAddSub.hpp>
+#include <ReducedQuaternion.hpp>
+#include <UDKalmanObserver.hpp>
+
+#include <cmath>  // round
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+/**
+ * The smoother gain @f$ P_{k|k} A^\top P_{k+1|k}^{-1} @f$, given the
+ * covariances of the corrected estimate and of the prediction.
+ */
+template <size_t Nx>
+Matrix<Nx, Nx> getSmootherGain(const Matrix<Nx, Nx> &A,
+                               const Matrix<Nx, Nx> &P_filt,
+                               const Matrix<Nx, Nx> &P_pred) {
+    // P_pred and P_filt are symmetric
+    return transpose(solveLeastSquares(P_pred, A * P_filt));
+}
+
+/// What the forward pass spills for every sample.
+template <size_t Nx, size_t Nr>
+struct SpillRecord {
+    /// The estimate using the sensor readings up to and including sample k.
+    ColVector<Nx> x_filt;
+    /// The prediction of sample k + 1, using the same readings.
+    ColVector<Nx> x_pred;
+    /// The smoother gain, in the (reduced) state space.
+    Matrix<Nr, Nr> gain;
+};
+
+using AttitudeRecord = SpillRecord<Nx_att, Nx_att - 1>;
+using AltitudeRecord = SpillRecord<Nx_alt, Nx_alt>;
+
+// The fields of the packed log entries are copied element by element, they
+// can't be bound to references.
+
+ColVector<Nx_att> getAttitudeState(const DroneLogEntry &e) {
+    ColVector<Nx_att> x = {};
+    for (size_t i = 0; i < 4; ++i)
+        x[i][0] = e.observerOrientation[i];
+    for (size_t i = 0; i < 3; ++i)
+        x[4 + i][0] = e.observerAngularVelocity[i];
+    for (size_t i = 0; i < 3; ++i)
+        x[7 + i][0] = e.observerMotorSpeeds[i];
+    return x;
+}
+
+ColVector<Ny_att> getAttitudeMeasurement(const DroneLogEntry &e) {
+    ColVector<Ny_att> y = {};
+    for (size_t i = 0; i < 4; ++i)
+        y[i][0] = e.measurementOrientation[i];
+    for (size_t i = 0; i < 3; ++i)
+        y[4 + i][0] = e.measurementAngularVelocity[i];
+    return y;
+}
+
+ColVector<Nu_att> getAttitudeControl(const DroneLogEntry &e) {
+    ColVector<Nu_att> u = {};
+    for (size_t i = 0; i < 3; ++i)
+        u[i][0] = e.attitudeControlSignals[i];
+    return u;
+}
+
+ColVector<Nx_alt> getAltitudeState(const DroneLogEntry &e) {
+    return {{{e.observerAltitudeMotorSpeed},
+             {e.observerHeight},
+             {e.observerAltitudeVelocity}}};
+}
+
+void setStates(DroneLogEntry &e, const ColVector<Nx_att> &x_att,
+               const ColVector<Nx_alt> &x_alt) {
+    for (size_t i = 0; i < 4; ++i)
+        e.observerOrientation[i] = x_att[i][0];
+    for (size_t i = 0; i < 3; ++i)
+        e.observerAngularVelocity[i] = x_att[4 + i][0];
+    for (size_t i = 0; i < 3; ++i)
+        e.observerMotorSpeeds[i] = x_att[7 + i][0];
+    e.observerAltitudeMotorSpeed = x_alt[0][0];
+    e.observerHeight             = x_alt[1][0];
+    e.observerAltitudeVelocity   = x_alt[2][0];
+}
+
+}  // namespace
+
+LogSmootherStatistics smoothDroneLog(const DroneParamsAndMatrices &p,
+                                     const std::filesystem::path &input,
+                                     const std::filesystem::path &output,
+                                     const LogSmootherOptions &options) {
+    MappedFile inputFile = MappedFile{input};
+    if (inputFile.size() % sizeof(DroneLogEntry) != 0) {
+        std::stringstream sstr;
+        sstr << "Error: size of log file is not a multiple of the size of "
+                "a log entry ("
+             << input << ")";
+        throw std::runtime_error(sstr.str());
+    }
+    const size_t N         = inputFile.size() / sizeof(DroneLogEntry);
+    const size_t block     = options.blockSize;
+    const size_t blockSize = block * sizeof(DroneLogEntry);
+    auto in = static_cast<const DroneLogEntry *>(inputFile.data());
+
+    LogSmootherStatistics stats = {};
+    stats.entries               = N;
+    stats.flightSeconds         = N * p.Ts_att;
+    if (N == 0) {
+        MappedFile{output, MappedFile::ReadWrite, 0};
+        return stats;
+    }
+
+    const size_t subsampleAlt = size_t(std::round(p.Ts_alt / p.Ts_att));
+
+    // The same time-varying Kalman filters as on the drone, the process noise
+    // enters through the control inputs
+    Attitude::UDKalmanObserver<> att = {
+        p.Ad_att_r,
+        p.Bd_att_r,
+        p.Cd_att,
+        p.Cd_att_r,
+        p.Bd_att_r,
+        options.varDynamics_att,
+        options.varSensors_att,
+        options.varInitial * eye<Nx_att - 1>(),
+        p.Ts_att,
+    };
+    Altitude::UDKalmanObserver<> alt = {
+        p.Ad_alt,
+        p.Bd_alt,
+        p.Cd_alt,
+        options.varDynamics_alt,
+        options.varSensors_alt,
+        options.varInitial * eye<Nx_alt>(),
+        p.Ts_alt,
+    };
+    SpillBuffer<AttitudeRecord> attSpill{block, options.spillDirectory};
+    SpillBuffer<AltitudeRecord> altSpill{block, options.spillDirectory};
+
+    /* ------------------------------ Forward ------------------------------- */
+
+    PerfTimer forwardTimer;
+    ColVector<Nx_att> x_att = getAttitudeState(in[0]);
+    ColVector<Nx_alt> x_alt = getAltitudeState(in[0]);
+    for (size_t k = 0; k < N; ++k) {
+        if (k % block == 0) {
+            inputFile.willNeed((k + block) * sizeof(DroneLogEntry), blockSize);
+            if (k > 0)
+                inputFile.dontNeed((k - block) * sizeof(DroneLogEntry),
+                                   blockSize);
+        }
+        const DroneLogEntry &e = in[k];
+
+        if (k % subsampleAlt == 0) {
+            ColVector<Ny_alt> y = {{{e.measurementHeight}}};
+            ColVector<Nu_alt> u = {{{e.altitudeMarginalControlSignal}}};
+            AltitudeRecord rec  = {};
+            rec.x_filt          = alt.correct(x_alt, y);
+            auto P_filt         = alt.getCovariance();
+            rec.x_pred          = alt.predict(rec.x_filt, u);
+            rec.gain = getSmootherGain(alt.A, P_filt, alt.getCovariance());
+            altSpill.push_back(rec);
+            x_alt = rec.x_pred;
+        }
+
+        ColVector<Ny_att> y = getAttitudeMeasurement(e);
+        ColVector<Nu_att> u = getAttitudeControl(e);
+        AttitudeRecord rec  = {};
+        rec.x_filt          = att.correct(x_att, y);
+        auto P_filt         = att.getCovariance();
+        rec.x_pred          = att.predict(rec.x_filt, u);
+        rec.gain = getSmootherGain(att.A_red, P_filt, att.getCovariance());
+        attSpill.push_back(rec);
+        x_att = rec.x_pred;
+    }
+    attSpill.finish();
+    altSpill.finish();
+    inputFile.dontNeed(0, inputFile.size());
+    stats.forwardSeconds = forwardTimer.getDuration() * 1e-6;
+
+    /* ------------------------------ Backward ------------------------------ */
+
+    PerfTimer backwardTimer;
+    MappedFile outputFile = {output, MappedFile::ReadWrite,
+                             N * sizeof(DroneLogEntry)};
+    auto out = static_cast<DroneLogEntry *>(outputFile.data());
+
+    size_t j                  = altSpill.size() - 1;
+    ColVector<Nx_alt> x_s_alt = altSpill[j].x_filt;
+    ColVector<Nx_att> x_s_att = {};
+    attSpill.forEachReverse([&](size_t k, const AttitudeRecord &rec) {
+        if (k + 1 == N) {
+            x_s_att = rec.x_filt;
+        } else {
+            ColVector<Nx_att> diff = quaternionStatesSub(x_s_att, rec.x_pred);
+            x_s_att = quaternionStatesAdd(
+                rec.x_filt, red2quat(rec.gain * quat2red(diff)));
+        }
+        for (; j > k / subsampleAlt; --j) {
+            const AltitudeRecord &prev = altSpill[j - 1];
+            x_s_alt = prev.x_filt + prev.gain * (x_s_alt - prev.x_pred);
+        }
+        out[k] = in[k];
+        setStates(out[k], x_s_att, x_s_alt);
+        // The entries after this block are finished
+        if (k % block == 0) {
+            inputFile.dontNeed((k + block) * sizeof(DroneLogEntry),
+                               blockSize);
+            outputFile.dontNeed((k + block) * sizeof(DroneLogEntry),
+                                blockSize);
+        }
+    });
+    stats.backwardSeconds = backwardTimer.getDuration() * 1e-6;
+    return stats;
+}
@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+
+#include <LogSmoother.hpp>
+#include <ReducedQuaternion.hpp>
+
+#include <cstring>  // memset
+#include <fstream>
+#include <random>
+#include <string>
+#include <unistd.h>  // getpid
+#include <vector>
+
+namespace fs = std::filesystem;
+
+/// The drone parameters and matrices used by the tests.
+static const fs::path loadPath = fs::path(__FILE__).parent_path() / ".." /
+                                 ".." / "py-drone" / "test" /
+                                 "ParamsAndMatrices";
+
+static const double stdSensors  = 1e-2;
+static const double stdDynamics = 1e-5;
+
+struct SyntheticLog {
+    std::vector<DroneLogEntry> entries;
+    std::vector<ColVector<Nx_att - 1>> x_att;
+    std::vector<ColVector<Nx_alt>> x_alt;
+};
+
+/**
+ * Simulate the linear models with random inputs, process noise and sensor
+ * noise, and store the sensor readings and control signals in a log.
+ */
+static SyntheticLog simulate(const DroneParamsAndMatrices &p, size_t N) {
+    std::mt19937 rng(1);
+    std::normal_distribution<double> noise(0, 1);
+    auto random = [&](auto v, double scale) {
+        for (auto &row : v)
+            row[0] = scale * noise(rng);
+        return v;
+    };
+    size_t subsampleAlt = size_t(std::round(p.Ts_alt / p.Ts_att));
+
+    SyntheticLog log;
+    ColVector<Nx_att - 1> x_att = {};
+    ColVector<Nx_alt> x_alt     = {};
+    ColVector<Nu_alt> u_alt     = {};
+    for (size_t k = 0; k < N; ++k) {
+        DroneLogEntry e;  // the constructor doesn't initialize the fields
+        std::memset(static_cast<void *>(&e), 0, sizeof(e));
+        if (k % subsampleAlt == 0) {
+            ColVector<Ny_alt> y = p.Cd_alt * x_alt +
+                                  random(ColVector<Ny_alt>{}, stdSensors);
+            e.measurementHeight = y[0][0];
+            u_alt               = random(ColVector<Nu_alt>{}, 1e-3);
+        }
+        e.altitudeMarginalControlSignal = u_alt[0][0];
+
+        ColVector<Ny_att - 1> y_red = p.Cd_att_r * x_att +
+                                      random(ColVector<Ny_att - 1>{}, stdSensors);
+        ColVector<Ny_att> y = red2quat(y_red);
+        ColVector<Nu_att> u_att     = random(ColVector<Nu_att>{}, 1e-5);
+        for (size_t i = 0; i < 4; ++i)
+            e.measurementOrientation[i] = y[i][0];
+        for (size_t i = 0; i < 3; ++i)
+            e.measurementAngularVelocity[i] = y[4 + i][0];
+        for (size_t i = 0; i < 3; ++i)
+            e.attitudeControlSignals[i] = u_att[i][0];
+        log.entries.push_back(e);
+        log.x_att.push_back(x_att);
+        log.x_alt.push_back(x_alt);
+
+        x_att = p.Ad_att_r * x_att +
+                p.Bd_att_r *
+                    (u_att + random(ColVector<Nu_att>{}, stdDynamics));
+        if ((k + 1) % subsampleAlt == 0)
+            x_alt = p.Ad_alt * x_alt +
+                    p.Bd_alt *
+                        (u_alt + random(ColVector<Nu_alt>{}, stdDynamics));
+    }
+    log.entries[0].observerOrientation[0] = 1;
+    return log;
+}
+
+static void write(const fs::path &path, const std::vector<DroneLogEntry> &v) {
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char *>(v.data()),
+               v.size() * sizeof(DroneLogEntry));
+}
+
+/// A temporary file that is unique to the current test and process, so tests
+/// that run in parallel don't overwrite each other's files.
+static fs::path getTempPath(const std::string &suffix) {
+    const auto *info = ::testing::UnitTest::GetInstance()->current_test_info();
+    std::string name = std::string("test-LogSmoother-") + info->name() + '-' +
+                       std::to_string(getpid()) + '-' + suffix + ".bin";
+    return fs::temp_directory_path() / name;
+}
+
+static LogSmootherOptions getOptions() {
+    LogSmootherOptions opt = {};
+    double varSensors      = stdSensors * stdSensors;
+    double varDynamics     = stdDynamics * stdDynamics;
+    opt.varDynamics_att    = {{{varDynamics, varDynamics, varDynamics}}};
+    opt.varSensors_att     = {{{varSensors, varSensors, varSensors,
+                                varSensors, varSensors, varSensors}}};
+    opt.varDynamics_alt    = {{{varDynamics}}};
+    opt.varSensors_alt     = {{{varSensors}}};
+    opt.varInitial         = 1e-4;
+    return opt;
+}
+
+/**
+ * The smoothed estimates of the orientation and the height are much closer
+ * to the true states than the sensor readings.
+ */
+TEST(LogSmoother, reducesError) {
+    DroneParamsAndMatrices p;
+    p.load(loadPath);
+    const size_t N   = 5000;
+    SyntheticLog log = simulate(p, N);
+    fs::path in      = getTempPath("in");
+    fs::path out     = getTempPath("out");
+    write(in, log.entries);
+
+    LogSmootherStatistics stats = smoothDroneLog(p, in, out, getOptions());
+    EXPECT_EQ(stats.entries, N);
+
+    DroneLogLoader smoothed = {out};
+    ASSERT_EQ(smoothed.size(), N);
+    double sse_att = 0, sse_alt = 0;
+    for (size_t k = 0; k < N; ++k) {
+        for (size_t i = 0; i < 3; ++i) {
+            double e = smoothed[k].observerOrientation[i + 1] - log.x_att[k][i];
+            sse_att += e * e;
+        }
+        double e = smoothed[k].observerHeight - log.x_alt[k][1];
+        sse_alt += e * e;
+        // The other fields are copied from the input
+        EXPECT_EQ(smoothed[k].measurementHeight,
+                  log.entries[k].measurementHeight);
+    }
+    EXPECT_LT(std::sqrt(sse_att / (3 * N)), 0.2 * stdSensors);
+    EXPECT_LT(std::sqrt(sse_alt / N), 0.2 * stdSensors);
+    fs::remove(in);
+    fs::remove(out);
+}
+
+/// The block size of the spill files doesn't affect the result.
+TEST(LogSmoother, blockSize) {
+    DroneParamsAndMatrices p;
+    p.load(loadPath);
+    SyntheticLog log = simulate(p, 1000);
+    fs::path in      = getTempPath("in");
+    fs::path out1    = getTempPath("1");
+    fs::path out2    = getTempPath("2");
+    write(in, log.entries);
+
+    LogSmootherOptions opt = getOptions();
+    smoothDroneLog(p, in, out1, opt);
+    opt.blockSize = 7;
+    smoothDroneLog(p, in, out2, opt);
+
+    DroneLogLoader a = {out1}, b = {out2};
+    ASSERT_EQ(a.size(), b.size());
+    for (size_t k = 0; k < a.size(); ++k)
+        EXPECT_EQ(ColVector<17>(a[k].getState()),
+                  ColVector<17>(b[k].getState()));
+    fs::remove(in);
+    fs::remove(out1);
+    fs::remove(out2);
+}
+
+TEST(LogSmoother, invalidSize) {
+    DroneParamsAndMatrices p;
+    p.load(loadPath);
+    fs::path in = getTempPath("bad");
+    std::ofstream(in, std::ios::binary) << "not a log";
+    fs::path out = getTempPath("out");
+    EXPECT_THROW(smoothDroneLog(p, in, out), std::runtime_error);
+    fs::remove(in);
+}
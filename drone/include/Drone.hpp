@@ -1,11 +1,16 @@
 #pragma once
 
+#include "DroneDynamics.hpp"
 #include "DroneStateControlOutput.hpp"
 
 #include "KalmanObserver.hpp"
 #include "LQRController.hpp"
+#include "MPCController.hpp"
+#include "MotorControl.hpp"
+#include "UDKalmanObserver.hpp"
 
 #include <Model.hpp>
+#include <StaticDispatch.hpp>
 
 #include <DLQE.hpp>
 #include <DLQR.hpp>
@@ -72,9 +77,62 @@ struct Drone : public ContinuousModel<Nx, Nu, Ny> {
      * @param   u 
      *          The current control input u.
      * @return  The derivative of the state, x_dot.
+     * 
+     * @see     DroneDynamics
      */
     VecX_t operator()(const VecX_t &x, const VecU_t &u) override;
 
+    /**
+     * @brief   Calculate the derivative of the state vector, given the current
+     *          state x and the current input u, and write it to x_dot.
+     *          This is the same as the call operator, but it doesn't return
+     *          the result by value.
+     */
+    void getStateChange(const VecX_t &x, const VecU_t &u, VecX_t &x_dot) const {
+        DroneDynamics{p}(x, u, x_dot);
+    }
+
+    /**
+     * @brief   Straightforward implementation of the call operator, using the
+     *          parameters in p directly, without any precomputation.
+     *          Used as a reference for testing the fused implementation in 
+     *          DroneDynamics.
+     */
+    VecX_t referenceStateChange(const VecX_t &x, const VecU_t &u) const;
+
+    /**
+     * @brief   Simulate the drone over the interval [opt.t_start, opt.t_end]
+     *          with a constant input, replacing the given state by the final
+     *          state.
+     * 
+     * If lieGroupIntegration is set, the orientation is integrated on the 
+     * unit sphere, using the exponential map of the quaternion 
+     * (Runge–Kutta–Munthe-Kaas), and the other states use the same 
+     * Dormand–Prince tableau.
+     * 
+     * If splitMotorDynamics is set, the motor speeds @f$ \vec{n} @f$ and
+     * @f$ n_t @f$ are advanced with the exact solution of their linear 
+     * dynamics over half of the interval, then the rest of the state is 
+     * integrated over the entire interval with the motor speeds frozen, and 
+     * finally the motor speeds are advanced over the second half (Strang
+     * splitting). The motor time constant then no longer limits the step 
+     * size of the ODE solver, at the cost of a second-order splitting error.
+     * 
+     * @see     dormandPrinceLie
+     * @see     QuaternionStateChart
+     */
+    std::pair<ODEResultCode, size_t>
+    advance(const VecU_t &u, VecX_t &x, const AdaptiveODEOptions &opt) override;
+
+    /**
+     * @brief   Euler step that moves the orientation along the unit sphere,
+     *          using the exponential map of the quaternion, so the skipped
+     *          control periods don't denormalize it.
+     *
+     * @see     QuaternionStateChart
+     */
+    void eulerStep(VecX_t &x, const VecX_t &x_dot, double h) override;
+
     /** 
      * @brief   Get the sensor output of the drone model.
      * 
@@ -151,6 +209,17 @@ struct Drone : public ContinuousModel<Nx, Nu, Ny> {
         VecX_t operator()(const VecX_t &x, const VecU_t &u) override;
         VecY_t getOutput(const VecX_t &x, const VecU_t &u) override;
 
+        /// @see    Drone::advance
+        std::pair<ODEResultCode, size_t>
+        advance(const VecU_t &u, VecX_t &x,
+                const AdaptiveODEOptions &opt) override;
+        /// @see    Drone::eulerStep
+        void eulerStep(VecX_t &x, const VecX_t &x_dot, double h) override;
+
+        /// Integrate the orientation on the unit sphere. Only used by
+        /// advance, see Drone::lieGroupIntegration.
+        bool lieGroupIntegration = false;
+
         const Matrix<3, 3> gamma_n;
         const Matrix<3, 3> gamma_u;
         const Matrix<3, 3> Id;
@@ -165,9 +234,72 @@ struct Drone : public ContinuousModel<Nx, Nu, Ny> {
     /// Get the continuous model of the attitude of this drone
     AttitudeModel getAttitudeModel() const { return {p}; }
 
-    /// The continuous model of the altitude controller of the drone
-    /// @todo   Implement
-    struct AltitudeModel : public ContinuousModel<Nx_alt, Nu_alt, Ny_alt> {};
+    /**
+     * @brief   The discrete model of the attitude of the drone, linearized
+     *          around the hovering state.
+     * 
+     * The orientation is converted to a reduced quaternion, and the state is 
+     * updated as @f$ x_{r,k+1} = A_{d,r}\,x_{r,k} + B_{d,r}\,u_k @f$.
+     * It is only valid for small angles, but it is a lot cheaper to simulate
+     * than AttitudeModel, so it can be used to quickly screen controllers.
+     */
+    struct LinearAttitudeModel
+        : public DiscreteModel<Nx_att, Nu_att, Ny_att> {
+        LinearAttitudeModel(const DroneParamsAndMatrices &drone);
+
+        VecX_t operator()(const VecX_t &x, const VecU_t &u) override;
+        VecY_t getOutput(const VecX_t &x, const VecU_t &u) override;
+
+        const Matrix<Nx_att - 1, Nx_att - 1> Ad_att_r;
+        const Matrix<Nx_att - 1, Nu_att> Bd_att_r;
+        const Matrix<Ny_att, Nx_att> Cd_att;
+        const Matrix<Ny_att, Nu_att> Dd_att;
+    };
+
+    /// Get the linearized discrete model of the attitude of this drone
+    LinearAttitudeModel getLinearAttitudeModel() const { return {p}; }
+
+    /**
+     * @brief   The continuous model of the altitude of the drone, assuming
+     *          that the drone is level and that the attitude motors are at
+     *          rest.
+     * 
+     * The state is @f$ (n_t, z, v_z) @f$, in the same order as
+     * `DroneState::getAltitude`, and the input is the thrust control @f$ u_t
+     * @f$. Under these assumptions, the altitude states of the full model
+     * evolve exactly like the states of this model, so it can be used to tune
+     * the altitude controller without simulating the attitude dynamics.
+     * 
+     * @f$
+     *  \dot{n_t} = k_2 \left(k_1 u_t - n_t\right)
+     * @f$
+     * 
+     * @f$
+     *  \dot{z} = v_z
+     * @f$
+     * 
+     * @f$
+     *  \dot{v_z} = \frac{C_t \rho D_p^4 N_m}{m} \left(n_t + n_h\right)^2 - g
+     * @f$
+     */
+    struct AltitudeModel : public ContinuousModel<Nx_alt, Nu_alt, Ny_alt> {
+        AltitudeModel(const DroneParamsAndMatrices &drone);
+
+        VecX_t operator()(const VecX_t &x, const VecU_t &u) override;
+        VecY_t getOutput(const VecX_t &x, const VecU_t &u) override;
+
+        const double k1;
+        const double k2;
+        const double nh;
+        const double g;
+        /// Ct ρ Dp⁴ Nm / m, the acceleration per squared motor speed
+        const double thrustFactor;
+        const Matrix<Ny_alt, Nx_alt> Ca_alt;
+        const Matrix<Ny_alt, Nu_alt> Da_alt;
+    };
+
+    /// Get the continuous model of the altitude of this drone
+    AltitudeModel getAltitudeModel() const { return {p}; }
 
 #pragma region Controllers......................................................
 
@@ -242,6 +374,40 @@ struct Drone : public ContinuousModel<Nx, Nu, Ny> {
         const ColVector<1> uh;
     };
 
+    /** 
+     * @brief   Get the MPC attitude controller with a horizon of N samples,
+     *          given the weight matrices Q, R and the terminal weight P.
+     * 
+     * The motor limits are enforced around the (fixed) hover thrust.
+     */
+    template <size_t N>
+    Attitude::MPCController<N> getMPCAttitudeController(
+        const Matrix<Nx_att - 1, Nx_att - 1> &Q,
+        const Matrix<Nu_att, Nu_att> &R,
+        const Matrix<Nx_att - 1, Nx_att - 1> &P,
+        const typename Attitude::MPCController<N>::Solver::Options &opt =
+            {}) const {
+        return {p.G_att, p.Ad_att_r, p.Bd_att_r, Q,  R,
+                P,       p.uh,       p.Ts_att,   opt};
+    }
+
+    /** 
+     * @brief   Get the MPC attitude controller with a horizon of N samples,
+     *          given the weight matrices Q and R. The terminal weight is the
+     *          solution of the discrete algebraic Riccati equation, so it
+     *          behaves like the LQR controller when the motors don't
+     *          saturate.
+     */
+    template <size_t N>
+    Attitude::MPCController<N> getMPCAttitudeController(
+        const Matrix<Nx_att - 1, Nx_att - 1> &Q,
+        const Matrix<Nu_att, Nu_att> &R,
+        const typename Attitude::MPCController<N>::Solver::Options &opt =
+            {}) const {
+        auto P = dlqr(p.Ad_att_r, p.Bd_att_r, Q, R).P;
+        return getMPCAttitudeController<N>(Q, R, P, opt);
+    }
+
     FixedClampAttitudeController
     getFixedClampAttitudeController(const Matrix<Nx_att - 1, Nx_att - 1> &Q,
                                     const Matrix<Nu_att, Nu_att> &R) const {
@@ -257,16 +423,108 @@ struct Drone : public ContinuousModel<Nx, Nu, Ny> {
         return {Attitude::CLQRController{p.Ts_att}, p.uh};
     }
 
+    /// The discrete attitude model in reduced quaternion coordinates.
+    struct LinearizedAttitude {
+        Matrix<Nx_att - 1, Nx_att - 1> Ad_r;
+        Matrix<Nx_att - 1, Nu_att> Bd_r;
+    };
+
+    /**
+     * @brief   Linearize the attitude model around the hovering state with
+     *          the given roll and pitch angles, and discretize it with a
+     *          zero-order hold.
+     * 
+     * The Jacobians are evaluated numerically on the nonlinear AttitudeModel,
+     * in reduced quaternion coordinates. For zero roll and pitch, this is
+     * the system (Ad_att_r, Bd_att_r) of the parameters.
+     */
+    LinearizedAttitude linearizeAttitude(double roll, double pitch) const;
+
+    /** 
+     * @brief   Calculate the gains of the gain-scheduled attitude controller
+     *          for a grid of roll and pitch angles, with the given function
+     *          `synthesize(Ad_r, Bd_r)` that returns the proportional
+     *          controller matrix for a linearized system.
+     * 
+     * The grid points are computed in parallel when OpenMP is enabled.
+     */
+    template <class Synthesize>
+    Attitude::GainScheduledLQRController::Table
+    getAttitudeGainTable(const std::vector<double> &roll,
+                         const std::vector<double> &pitch,
+                         Synthesize synthesize) const {
+        using Table = Attitude::GainScheduledLQRController::Table;
+        return Table::build({roll, pitch}, [&](const Table::Point &op) {
+            LinearizedAttitude sys = linearizeAttitude(op[0], op[1]);
+            return synthesize(sys.Ad_r, sys.Bd_r);
+        });
+    }
+
+    /** 
+     * @brief   Calculate the LQR gains of the gain-scheduled attitude 
+     *          controller for a grid of roll and pitch angles, given the 
+     *          weight matrices Q and R.
+     */
+    Attitude::GainScheduledLQRController::Table
+    getAttitudeGainTable(const std::vector<double> &roll,
+                         const std::vector<double> &pitch,
+                         const Matrix<Nx_att - 1, Nx_att - 1> &Q,
+                         const Matrix<Nu_att, Nu_att> &R) const {
+        auto synthesize = [&](const Matrix<Nx_att - 1, Nx_att - 1> &Ad_r,
+                              const Matrix<Nx_att - 1, Nu_att> &Bd_r) {
+            return Matrix<Nu_att, Nx_att - 1>{-dlqr(Ad_r, Bd_r, Q, R).K};
+        };
+        return getAttitudeGainTable(roll, pitch, synthesize);
+    }
+
+    /** 
+     * @brief   Get the gain-scheduled attitude controller with the given
+     *          table of gains.
+     * 
+     * @note    This controller doesn't clamp the control output!  
+     *          Use FixedClampGainScheduledAttitudeController to wrap it.
+     */
+    Attitude::GainScheduledLQRController getGainScheduledAttitudeController(
+        Attitude::GainScheduledLQRController::Table table) const {
+        return {std::move(table), p.Ts_att};
+    }
+
+    /** 
+     * A stand-alone gain-scheduled attitude controller that clamps the 
+     * control output using the (fixed) hover thrust as the common thrust.
+     */
+    class FixedClampGainScheduledAttitudeController
+        : public Attitude::GainScheduledLQRController {
+      public:
+        FixedClampGainScheduledAttitudeController(
+            Attitude::GainScheduledLQRController ctrl, double uh)
+            : Attitude::GainScheduledLQRController{std::move(ctrl)}, uh{uh} {}
+        VecU_t operator()(const VecX_t &x, const VecR_t &r) override {
+            return Drone::Controller::clampAttitude(
+                getRawControllerOutput(x, r), uh);
+        }
+
+      private:
+        const ColVector<1> uh;
+    };
+
+    FixedClampGainScheduledAttitudeController
+    getFixedClampGainScheduledAttitudeController(
+        Attitude::GainScheduledLQRController::Table table) const {
+        return {getGainScheduledAttitudeController(std::move(table)), p.uh};
+    }
+
     // Altitude
 
-    Altitude::LQRController getAltitudeController(const Matrix<1, 4> &K_pi,
-                                                  double maxIntegralInfluence) {
+    Altitude::LQRController
+    getAltitudeController(const Matrix<1, 4> &K_pi,
+                          double maxIntegralInfluence) const {
         return {p.G_alt, p.Cd_alt, K_pi, p.Ts_alt, maxIntegralInfluence};
     }
 
-    Altitude::LQRController getAltitudeController(const Matrix<3, 3> &Q,
-                                                  const Matrix<1, 1> &K_i,
-                                                  double maxIntegralInfluence) {
+    Altitude::LQRController
+    getAltitudeController(const Matrix<3, 3> &Q, const Matrix<1, 1> &K_i,
+                          double maxIntegralInfluence) const {
         auto K_lqr = dlqr(p.Ad_alt, p.Bd_alt, Q, {{1}}).K;
         auto K_pi  = hcat(K_lqr, K_i);
         return {p.G_alt, p.Cd_alt, K_pi, p.Ts_alt, maxIntegralInfluence};
@@ -274,29 +532,110 @@ struct Drone : public ContinuousModel<Nx, Nu, Ny> {
 
     Altitude::CLQRController getCAltitudeController() { return {p.Ts_alt}; }
 
-    class Controller : public DiscreteController<Nx, Nu, Ny> {
+    /** 
+     * A stand-alone altitude controller that clamps the marginal thrust in
+     * the same way as the cascaded Drone::Controller.
+     */
+    class ClampAltitudeController : public Altitude::LQRController {
       public:
-        using p_attitude_controller_t =
-            std::unique_ptr<DiscreteController<Nx_att, Nu_att, Ny_att>>;
-        using p_altitude_controller_t =
-            std::unique_ptr<DiscreteController<Nx_alt, Nu_alt, Ny_alt>>;
+        ClampAltitudeController(const Altitude::LQRController &ctrl)
+            : Altitude::LQRController{ctrl} {}
+        VecU_t operator()(const VecX_t &x, const VecR_t &r) override {
+            return Drone::Controller::clampThrust(
+                getRawControllerOutput(x, r));
+        }
+    };
 
-        Controller(p_attitude_controller_t attitudeController,
-                   p_altitude_controller_t altitudeController, double uh)
-            : DiscreteController<Nx, Nu, Ny>{attitudeController->Ts},
+    ClampAltitudeController
+    getClampAltitudeController(const Matrix<1, 4> &K_pi,
+                               double maxIntegralInfluence) const {
+        return {getAltitudeController(K_pi, maxIntegralInfluence)};
+    }
+
+    /** 
+     * @brief   Cascade of the attitude controller and the (subsampled) 
+     *          altitude controller.
+     * 
+     * The sub-controllers can be stored either by value or by 
+     * `std::unique_ptr`. When concrete controller types are used, all calls 
+     * to the sub-controllers are resolved at compile time.
+     */
+    template <class AttitudeController, class AltitudeController>
+    class ControllerT : public DiscreteController<Nx, Nu, Ny> {
+      public:
+        ControllerT(AttitudeController attitudeController,
+                    AltitudeController altitudeController, double uh)
+            : DiscreteController<Nx, Nu, Ny>{
+                  StaticDispatch::deref(attitudeController).Ts},
               attitudeController{std::move(attitudeController)},
               altitudeController{std::move(altitudeController)},
-              subsampleAlt{size_t(round(this->altitudeController->Ts /
-                                        this->attitudeController->Ts))},
+              subsampleAlt{size_t(round(altitude().Ts / attitude().Ts))},
               uh{uh} {
-            assert(this->attitudeController->Ts < this->altitudeController->Ts);
+            assert(attitude().Ts < altitude().Ts);
         }
 
         /** Get the controller output */
-        VecU_t operator()(const VecX_t &x, const VecR_t &r) override;
+        VecU_t operator()(const VecX_t &x, const VecR_t &r) override {
+            const DroneState xx     = {x};
+            const DroneReference rr = {r};
+            DroneControl uu;
+
+            if (subsampleCounter == 0) {
+                auto u_alt_raw = StaticDispatch::call(
+                    altitude(), xx.getAltitude(), rr.getAltitude());
+                u_alt            = Controller::clampThrust(u_alt_raw);
+                subsampleCounter = subsampleAlt;
+            }
+            --subsampleCounter;
+
+            auto u_att = StaticDispatch::call(attitude(), xx.getAttitude(),
+                                              rr.getAttitude());
+            u_att = Controller::clampAttitude(u_att, u_alt + uh);
+            uu.setAttitudeControl(u_att);
+            uu.setThrustControl(u_alt);
+            checkControlSignal(uu, uh);
+            return uu;
+        }
 
         /** Reset the internal states of the controllers */
-        void reset() override;
+        void reset() override {
+            subsampleCounter = 0;
+            StaticDispatch::reset(attitude());
+            StaticDispatch::reset(altitude());
+        }
+
+        /** Check whether the last call ran the subsampled altitude controller */
+        bool updatedAltitude() const {
+            return subsampleCounter + 1 == subsampleAlt;
+        }
+
+      private:
+        auto &attitude() { return StaticDispatch::deref(attitudeController); }
+        auto &altitude() { return StaticDispatch::deref(altitudeController); }
+
+        AttitudeController attitudeController;
+        AltitudeController altitudeController;
+        const size_t subsampleAlt;
+        size_t subsampleCounter = 0;
+        Altitude::LQRController::VecU_t u_alt;
+        const Altitude::LQRController::VecU_t uh;
+    };
+
+    /// Controller with polymorphic attitude and altitude controllers.
+    class Controller
+        : public ControllerT<
+              std::unique_ptr<DiscreteController<Nx_att, Nu_att, Ny_att>>,
+              std::unique_ptr<DiscreteController<Nx_alt, Nu_alt, Ny_alt>>> {
+      public:
+        using p_attitude_controller_t =
+            std::unique_ptr<DiscreteController<Nx_att, Nu_att, Ny_att>>;
+        using p_altitude_controller_t =
+            std::unique_ptr<DiscreteController<Nx_alt, Nu_alt, Ny_alt>>;
+
+        Controller(p_attitude_controller_t attitudeController,
+                   p_altitude_controller_t altitudeController, double uh)
+            : ControllerT{std::move(attitudeController),
+                          std::move(altitudeController), uh} {}
 
         /** Clamp the marginal thrust between 0.1 and -0.1 */
         static Altitude::LQRController::VecU_t
@@ -306,14 +645,6 @@ struct Drone : public ContinuousModel<Nx, Nu, Ny> {
         static Attitude::LQRController::VecU_t
         clampAttitude(const Attitude::LQRController::VecU_t &u_raw,
                       const Altitude::LQRController::VecU_t &u_alt);
-
-      private:
-        p_attitude_controller_t attitudeController;
-        p_altitude_controller_t altitudeController;
-        const size_t subsampleAlt;
-        size_t subsampleCounter = 0;
-        Altitude::LQRController::VecU_t u_alt;
-        const Altitude::LQRController::VecU_t uh;
     };
 
     Controller getController(const Matrix<Nx_att - 1, Nx_att - 1> &Q_att,
@@ -415,39 +746,115 @@ struct Drone : public ContinuousModel<Nx, Nu, Ny> {
         return {p.Ad_alt, p.Bd_alt, p.Cd_alt, L, p.Ts_alt};
     }
 
-    class Observer : public DiscreteObserver<Nx, Nu, Ny> {
-      public:
-        using p_attitude_observer_t =
-            std::unique_ptr<DiscreteObserver<Nx_att, Nu_att, Ny_att>>;
-        using p_altitude_observer_t =
-            std::unique_ptr<DiscreteObserver<Nx_alt, Nu_alt, Ny_alt>>;
+    /** 
+     * @brief   Get a time-varying attitude Kalman filter, that recomputes its
+     *          gain every sample, starting from the given covariance of the
+     *          reduced state.
+     */
+    template <class T = double>
+    Attitude::UDKalmanObserver<T>
+    getUDAttitudeObserver(const RowVector<Nu_att> &varDynamics,
+                          const RowVector<Ny_att> &varSensors,
+                          const Matrix<Nx_att - 1, Nx_att - 1> &P0) const {
+        RowVector<Ny_att - 1> varSensors_r =
+            getBlock<0, 1, 1, Ny_att>(varSensors);
+        return {p.Ad_att_r,  p.Bd_att_r,  p.Cd_att, p.Cd_att_r, p.Bd_att_r,
+                varDynamics, varSensors_r, P0,       p.Ts_att};
+    }
 
-        Observer(p_attitude_observer_t attitudeObserver,
-                 p_altitude_observer_t altitudeObserver)
-            : DiscreteObserver<Nx, Nu, Ny>{attitudeObserver->Ts},
+    /** 
+     * @brief   Get a time-varying altitude Kalman filter, that recomputes its
+     *          gain every sample, starting from the given covariance.
+     */
+    template <class T = double>
+    Altitude::UDKalmanObserver<T>
+    getUDAltitudeObserver(const RowVector<Nu_alt> &varDynamics,
+                          const RowVector<Ny_alt> &varSensors,
+                          const Matrix<Nx_alt, Nx_alt> &P0) const {
+        return {p.Ad_alt,   p.Bd_alt, p.Cd_alt, varDynamics,
+                varSensors, P0,       p.Ts_alt};
+    }
+
+    /** 
+     * @brief   Combination of the attitude observer and the (subsampled) 
+     *          altitude observer.
+     * 
+     * The sub-observers can be stored either by value or by 
+     * `std::unique_ptr`. When concrete observer types are used, all calls 
+     * to the sub-observers are resolved at compile time.
+     */
+    template <class AttitudeObserver, class AltitudeObserver>
+    class ObserverT : public DiscreteObserver<Nx, Nu, Ny> {
+      public:
+        ObserverT(AttitudeObserver attitudeObserver,
+                  AltitudeObserver altitudeObserver)
+            : DiscreteObserver<Nx, Nu, Ny>{
+                  StaticDispatch::deref(attitudeObserver).Ts},
               attitudeObserver{std::move(attitudeObserver)},
               altitudeObserver{std::move(altitudeObserver)},
-              subsampleAlt{size_t(round(this->altitudeObserver->Ts /
-                                        this->attitudeObserver->Ts))} {
-            assert(this->attitudeObserver->Ts < this->altitudeObserver->Ts);
+              subsampleAlt{size_t(round(altitude().Ts / attitude().Ts))} {
+            assert(attitude().Ts < altitude().Ts);
         }
 
         void reset() override {
             subsampleCounter = 0;
-            attitudeObserver->reset();
-            altitudeObserver->reset();
+            StaticDispatch::reset(attitude());
+            StaticDispatch::reset(altitude());
         }
 
         VecX_t getStateChange(const VecX_t &x_hat, const VecY_t &y_sensor,
-                              const VecU_t &u) override;
+                              const VecU_t &u) override {
+            DroneState xx_hat = {x_hat};
+            DroneOutput yy    = {y_sensor};
+            DroneControl uu   = {u};
+
+            if (subsampleCounter == 0) {
+                auto new_x_alt = StaticDispatch::getStateChange(
+                    altitude(), xx_hat.getAltitude(), yy.getAltitude(),
+                    uu.getThrustControl());
+                xx_hat.setAltitude(new_x_alt);
+                subsampleCounter = subsampleAlt;
+            }
+            --subsampleCounter;
+
+            xx_hat.setAttitude(StaticDispatch::getStateChange(
+                attitude(), xx_hat.getAttitude(), yy.getAttitude(),
+                uu.getAttitudeControl()));
+            return xx_hat;
+        }
+
+        /** Check whether the last call ran the subsampled altitude observer */
+        bool updatedAltitude() const {
+            return subsampleCounter + 1 == subsampleAlt;
+        }
 
       private:
-        p_attitude_observer_t attitudeObserver;
-        p_altitude_observer_t altitudeObserver;
+        auto &attitude() { return StaticDispatch::deref(attitudeObserver); }
+        auto &altitude() { return StaticDispatch::deref(altitudeObserver); }
+
+        AttitudeObserver attitudeObserver;
+        AltitudeObserver altitudeObserver;
         const size_t subsampleAlt;
         size_t subsampleCounter = 0;
     };
 
+    /// Observer with polymorphic attitude and altitude observers.
+    class Observer
+        : public ObserverT<
+              std::unique_ptr<DiscreteObserver<Nx_att, Nu_att, Ny_att>>,
+              std::unique_ptr<DiscreteObserver<Nx_alt, Nu_alt, Ny_alt>>> {
+      public:
+        using p_attitude_observer_t =
+            std::unique_ptr<DiscreteObserver<Nx_att, Nu_att, Ny_att>>;
+        using p_altitude_observer_t =
+            std::unique_ptr<DiscreteObserver<Nx_alt, Nu_alt, Ny_alt>>;
+
+        Observer(p_attitude_observer_t attitudeObserver,
+                 p_altitude_observer_t altitudeObserver)
+            : ObserverT{std::move(attitudeObserver),
+                        std::move(altitudeObserver)} {}
+    };
+
     Observer getObserver(const RowVector<Nu_att> &varDynamics_att,
                          const RowVector<Ny_att> &varSensors_att,
                          const RowVector<Nu_alt> &varDynamics_alt,
@@ -465,4 +872,20 @@ struct Drone : public ContinuousModel<Nx, Nu, Ny> {
 
     // private: TODO
     DroneParamsAndMatrices p;
+
+    /// Integrate the orientation on the unit sphere, instead of integrating
+    /// the quaternion as a vector. Only used by advance, so by
+    /// simulateRealTime and the stepper, not by simulate.
+    bool lieGroupIntegration = false;
+    /// Solve the linear motor dynamics exactly, and only integrate the rigid
+    /// body adaptively (Strang splitting). Only used by advance.
+    bool splitMotorDynamics = false;
+
+  private:
+    /// Advance the motor speeds over a time h with the exact solution of
+    /// @f$ \dot{n} = k_2 \left(k_1 u - n\right) @f$.
+    void advanceMotors(const VecU_t &u, VecX_t &x, double h) const;
+    /// @see    Drone::advance
+    std::pair<ODEResultCode, size_t>
+    advanceSplit(const VecU_t &u, VecX_t &x, const AdaptiveODEOptions &opt);
 };
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Def.hpp"
+#include "DroneParamsAndMatrices.hpp"
+
+#include <Matrix.hpp>
+
+#include <iosfwd>
+#include <string>
+
+/**
+ * @brief   Generate a self-contained C++ header with the nonlinear dynamics of
+ *          the drone, the attitude controller and the attitude observer,
+ *          specialized for the given parameters and gain matrices.
+ *
+ * All parameters and matrices are written as literal constants in the
+ * generated code, all products of constants are folded, and all terms with a
+ * zero coefficient are omitted, so the compiler sees the fully unrolled,
+ * branch-free expressions. The generated header only depends on `<cmath>` and
+ * `<limits>`, and uses plain arrays for the states, inputs and outputs, with
+ * the same layout as the `Drone` state vectors.
+ *
+ * The generated namespace contains:
+ *
+ *   - `dynamics(x, u, x_dot)`: the same function as `Drone::operator()`
+ *   - `attitudeControllerRaw(x, r, u)`: the same function as
+ *     `Attitude::LQRController::getRawControllerOutput` with gain `K_att`
+ *   - `attitudeController(x, r, u)`: the same function as
+ *     `Drone::FixedClampAttitudeController::operator()` with gain `K_att`
+ *   - `attitudeObserver(x_hat, y, u, x_hat_next)`: the same function as
+ *     `Attitude::KalmanObserver::getStateChange` with gain `L_att`
+ *   - the constants `Ts_att`, `uh`, `K_att` and `L_att`
+ *
+ * The results are equal to those of the reference implementations up to
+ * rounding errors, because the constant folding reorders some operations.
+ *
+ * @param   os
+ *          The stream to write the generated header to.
+ * @param   p
+ *          The parameters and matrices of the drone.
+ * @param   K_att
+ *          The proportional gain matrix of the attitude controller, for the
+ *          reduced state.
+ * @param   L_att
+ *          The gain matrix of the attitude observer, for the reduced state and
+ *          output.
+ * @param   ns
+ *          The namespace to put the generated code in.
+ */
+void generateDroneCode(std::ostream &os, const DroneParamsAndMatrices &p,
+                       const Matrix<Nu_att, Nx_att - 1> &K_att,
+                       const Matrix<Nx_att - 1, Ny_att - 1> &L_att,
+                       const std::string &ns = "GeneratedDrone");
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "Def.hpp"
+#include "DroneParamsAndMatrices.hpp"
+
+#include <Matrix.hpp>
+
+/**
+ * @brief   The nonlinear dynamics of the drone, written once for every type
+ *          of scalar it is evaluated with.
+ *
+ * This is the only implementation of the fused dynamics. DroneDynamics
+ * evaluates it for a single drone, DroneFleet for every drone of a fleet,
+ * and the code generator evaluates it symbolically to write specialized code.
+ *
+ * Compared to the reference implementation `Drone::referenceStateChange`,
+ * the constant combinations of parameters are computed only once per call,
+ * only the z-axis of the rotation matrix is computed to rotate the thrust
+ * vector, and the derivative is written directly into the output, without
+ * temporary state objects.
+ *
+ * @tparam  S
+ *          The type of the states, inputs and derivatives.
+ * @param   ctx
+ *          `ctx.param(p.x)` returns the value of parameter x of the drone
+ *          that is evaluated, and `ctx.let(name, value)` returns a value that
+ *          is used more than once, e.g. to give it a name in generated code.
+ * @param   p
+ *          The parameters, with the same members as DroneParamsAndMatrices.
+ * @param   x, u
+ *          The state and input: `x[i]` and `u[i]` are converted to S.
+ * @param   x_dot
+ *          Output: `x_dot[i]` is assigned the derivative of `x[i]`. It should
+ *          not refer to the same storage as x.
+ */
+template <class S, class Context, class Params, class X, class U, class XDot>
+inline void evaluateDroneDynamics(Context &&ctx, const Params &p, const X &x,
+                                  const U &u, XDot &&x_dot) {
+    const auto k2   = ctx.param(p.k2);
+    const auto k1k2 = ctx.param(p.k1) * k2;
+    // Ct ρ Dp⁴ Nm / m, the acceleration per squared motor speed
+    const auto Dp           = ctx.param(p.Dp);
+    const auto thrustFactor = ctx.param(p.ct) * ctx.param(p.rho) *
+                              (Dp * Dp) * (Dp * Dp) * ctx.param(p.Nm) /
+                              ctx.param(p.m);
+
+    // State: q (0-3), ω (4-6), n (7-9), v (10-12), p (13-15), n_t (16)
+    const S q0 = x[0], q1 = x[1], q2 = x[2], q3 = x[3];
+    const S w[3] = {x[4], x[5], x[6]};
+    const S n[3] = {x[7], x[8], x[9]};
+    const S n_t  = x[16];
+
+    // q̇ = ½ q ⊗ (0, ω)
+    x_dot[0] = 0.5 * (-w[0] * q1 - w[1] * q2 - w[2] * q3);
+    x_dot[1] = 0.5 * (w[0] * q0 - w[1] * q3 + w[2] * q2);
+    x_dot[2] = 0.5 * (w[0] * q3 + w[1] * q0 - w[2] * q1);
+    x_dot[3] = 0.5 * (-w[0] * q2 + w[1] * q1 + w[2] * q0);
+
+    // ω̇ = Γn n + Γu u - I⁻¹ (ω × I ω)
+    S Iw[3];
+    for (size_t i = 0; i < 3; ++i)
+        Iw[i] = ctx.param(p.Id[i][0]) * w[0] + ctx.param(p.Id[i][1]) * w[1] +
+                ctx.param(p.Id[i][2]) * w[2];
+    const S wxIw[3] = {
+        w[1] * Iw[2] - w[2] * Iw[1],
+        w[2] * Iw[0] - w[0] * Iw[2],
+        w[0] * Iw[1] - w[1] * Iw[0],
+    };
+    for (size_t i = 0; i < 3; ++i) {
+        S w_dot = 0;
+        for (size_t j = 0; j < 3; ++j)
+            w_dot += ctx.param(p.gamma_n[i][j]) * n[j] +
+                     ctx.param(p.gamma_u[i][j]) * S(u[j]) -
+                     ctx.param(p.Id_inv[i][j]) * wxIw[j];
+        x_dot[4 + i] = w_dot;
+    }
+
+    // ṅ = k2 (k1 u - n)
+    for (size_t i = 0; i < 3; ++i)
+        x_dot[7 + i] = k1k2 * S(u[i]) - k2 * n[i];
+
+    // v̇ = q* ⋆ (0, 0, F/m) - (0, 0, g), only the z-axis of the rotation
+    // matrix is needed
+    const S nth = n_t + ctx.param(p.nh);
+    const S a_z = ctx.let("a_z", thrustFactor * (nth * nth + n[0] * n[0] +
+                                                 n[1] * n[1] + n[2] * n[2]));
+    x_dot[10] = a_z * 2 * (q1 * q3 + q0 * q2);
+    x_dot[11] = a_z * 2 * (q2 * q3 - q0 * q1);
+    x_dot[12] = a_z * (1 - 2 * q1 * q1 - 2 * q2 * q2) - ctx.param(p.g);
+
+    // ẋ = v
+    x_dot[13] = x[10];
+    x_dot[14] = x[11];
+    x_dot[15] = x[12];
+
+    // ṅ_t = k2 (k1 u_t - n_t)
+    x_dot[16] = k1k2 * S(u[3]) - k2 * n_t;
+}
+
+/**
+ * @brief   Context of evaluateDroneDynamics for a single drone: the
+ *          parameters are used as they are.
+ */
+struct SingleDroneContext {
+    template <class T>
+    T param(T value) const {
+        return value;
+    }
+    template <class T>
+    T let(const char *, T value) const {
+        return value;
+    }
+};
+
+/**
+ * @brief   A column of a matrix, indexed as an array, to pass the columns of
+ *          state and input matrices to evaluateDroneDynamics.
+ */
+template <class M>
+class ColumnView {
+  public:
+    ColumnView(M &matrix, size_t column) : matrix{matrix}, column{column} {}
+    auto &operator[](size_t i) const { return matrix[i][column]; }
+
+  private:
+    M &matrix;
+    size_t column;
+};
+
+/**
+ * @brief   Fused evaluation of the nonlinear dynamics of a single drone.
+ *
+ * The parameters are read from p on every call instead of being cached, so
+ * modifications of p take effect immediately. Computing the two combined
+ * constants costs a handful of multiplications, which is negligible compared
+ * to the rest of the dynamics.
+ *
+ * The results are equal to those of the reference implementation up to
+ * rounding errors, because some operations are reordered.
+ *
+ * @see     evaluateDroneDynamics
+ */
+class DroneDynamics {
+  public:
+    using VecX_t = ColVector<Nx>;
+    using VecU_t = ColVector<Nu>;
+
+    /// @note   The parameters are not copied, so p has to outlive this object.
+    DroneDynamics(const DroneParamsAndMatrices &p) : p{p} {}
+
+    /**
+     * @brief   Calculate the derivative of the state vector, given the current
+     *          state x and the current input u, and write it to x_dot.
+     *
+     * @note    x_dot should not refer to the same vector as x.
+     */
+    void operator()(const VecX_t &x, const VecU_t &u, VecX_t &x_dot) const {
+        evaluateDroneDynamics<double>(SingleDroneContext{}, p,
+                                      ColumnView{x, 0}, ColumnView{u, 0},
+                                      ColumnView{x_dot, 0});
+    }
+
+    /**
+     * @brief   Calculate the derivative of the state vector, given the current
+     *          state x and the current input u.
+     */
+    VecX_t operator()(const VecX_t &x, const VecU_t &u) const {
+        VecX_t x_dot;
+        (*this)(x, u, x_dot);
+        return x_dot;
+    }
+
+  private:
+    const DroneParamsAndMatrices &p;
+};
@@ -0,0 +1,233 @@
+#pragma once
+
+#include "Def.hpp"
+#include "DroneDynamics.hpp"
+#include "DroneParamsAndMatrices.hpp"
+
+#include <DormandPrince.hpp>
+#include <Matrix.hpp>
+#include <ODEOptions.hpp>
+#include <StaticDispatch.hpp>
+#include <Time.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @brief   Relative perturbations of the parameters of an airframe, used for
+ *          robustness studies. A factor of 1 means no perturbation.
+ */
+struct AirframePerturbation {
+    /// Factor for the total mass m.
+    double m = 1;
+    /// Factor for the inertia matrix Id.
+    double Id = 1;
+    /// Factor for the thrust coefficient ct.
+    double ct = 1;
+    /// Factor for the inverse motor time constant k2.
+    double k2 = 1;
+};
+
+/**
+ * @brief   Apply the given perturbation to the parameters of a drone.
+ *
+ * Scaling the inertia scales the angular accelerations, so the inverse of the
+ * inertia matrix and the torque matrices Γn and Γu are scaled inversely. The
+ * thrust coefficient only affects the total thrust, the torques in Γn are
+ * kept as they are. The hover speed nh and hover control uh are not changed,
+ * because the controller doesn't know about the perturbation.
+ */
+inline DroneParamsAndMatrices
+perturbAirframe(const DroneParamsAndMatrices &p,
+                const AirframePerturbation &perturbation) {
+    DroneParamsAndMatrices result = p;
+    result.m                      = p.m * perturbation.m;
+    result.Id                     = p.Id * perturbation.Id;
+    result.Id_inv                 = p.Id_inv / perturbation.Id;
+    result.gamma_n                = p.gamma_n / perturbation.Id;
+    result.gamma_u                = p.gamma_u / perturbation.Id;
+    result.ct                     = p.ct * perturbation.ct;
+    result.k2                     = p.k2 * perturbation.k2;
+    return result;
+}
+
+/**
+ * @brief   The nonlinear dynamics of a fleet of N drones with different
+ *          parameters, stored as a structure of arrays.
+ *
+ * The states and inputs of all drones are stored as the columns of a single
+ * matrix, so the i-th row contains the i-th state or input of all drones.
+ * All derivatives are computed in one loop over the drones, which the
+ * compiler can vectorize, because the states and parameters of neighboring
+ * drones are contiguous in memory.
+ *
+ * Because the entire fleet is a single matrix, it can be integrated by the
+ * existing ODE solvers as one system, with a common adaptive step size. The
+ * error norm is taken over all drones, so each drone is integrated at least
+ * as accurately as it would be by itself.
+ *
+ * Each drone computes the same function as `Drone::operator()` with its own
+ * parameters, using the same implementation, `evaluateDroneDynamics`.
+ */
+template <size_t N>
+class DroneFleet {
+  public:
+    /// The states of all drones, one column per drone.
+    using MatX_t = Matrix<Nx, N>;
+    /// The inputs of all drones, one column per drone.
+    using MatU_t = Matrix<Nu, N>;
+    using VecX_t = ColVector<Nx>;
+    using VecU_t = ColVector<Nu>;
+    using VecR_t = ColVector<Ny>;
+
+    /**
+     * @brief   Create a fleet with the given parameters, one set of
+     *          parameters per drone.
+     *
+     * @throw   std::invalid_argument
+     *          If the number of parameter sets is not equal to N.
+     */
+    DroneFleet(const std::vector<DroneParamsAndMatrices> &p) {
+        if (p.size() != N)
+            throw std::invalid_argument(
+                "Number of parameter sets doesn't match the fleet size");
+        for (size_t d = 0; d < N; ++d) {
+            for (size_t i = 0; i < 3; ++i)
+                for (size_t j = 0; j < 3; ++j) {
+                    params.gamma_n[i][j][d] = p[d].gamma_n[i][j];
+                    params.gamma_u[i][j][d] = p[d].gamma_u[i][j];
+                    params.Id[i][j][d]      = p[d].Id[i][j];
+                    params.Id_inv[i][j][d]  = p[d].Id_inv[i][j];
+                }
+            params.k1[d]  = p[d].k1;
+            params.k2[d]  = p[d].k2;
+            params.nh[d]  = p[d].nh;
+            params.g[d]   = p[d].g;
+            params.ct[d]  = p[d].ct;
+            params.rho[d] = p[d].rho;
+            params.Dp[d]  = p[d].Dp;
+            params.Nm[d]  = p[d].Nm;
+            params.m[d]   = p[d].m;
+        }
+    }
+
+    /**
+     * @brief   Calculate the derivatives of the states of all drones, given
+     *          their current states x and inputs u, and write them to x_dot.
+     *
+     * @note    x_dot should not refer to the same matrix as x.
+     */
+    void operator()(const MatX_t &x, const MatU_t &u, MatX_t &x_dot) const {
+        for (size_t d = 0; d < N; ++d)
+            evaluateDroneDynamics<double>(Lane{d}, params, ColumnView{x, d},
+                                          ColumnView{u, d},
+                                          ColumnView{x_dot, d});
+    }
+
+    /**
+     * @brief   Calculate the derivatives of the states of all drones, given
+     *          their current states x and inputs u.
+     */
+    MatX_t operator()(const MatX_t &x, const MatU_t &u) const {
+        MatX_t x_dot;
+        (*this)(x, u, x_dot);
+        return x_dot;
+    }
+
+    /**
+     * @brief   Integrate the states of all drones over
+     *          [opt.t_start, opt.t_end] with a constant input, in place.
+     *
+     * @return  The result code and the number of iterations.
+     */
+    std::pair<ODEResultCode, size_t> advance(const MatU_t &u, MatX_t &x,
+                                             const AdaptiveODEOptions &opt) {
+        auto f = [this, &u](double, const MatX_t &x) {
+            MatX_t x_dot;
+            (*this)(x, u, x_dot);
+            return x_dot;
+        };
+        return dormandPrinceInPlace(f, x, opt);
+    }
+
+    /**
+     * @brief   Simulate all drones in closed loop, with the same reference,
+     *          without storing the results. Instead, the given callback is
+     *          called as `callback(t, x, u)` at every sample, with the states
+     *          and inputs of all drones. The simulation stops when the
+     *          callback returns false.
+     *
+     * Every drone has its own controller, because controllers can have an
+     * internal state, e.g. an integral action. The controllers are called as
+     * `controllers[i](x_i, r)`, and all of them should have the same sample
+     * time.
+     *
+     * @see     ClosedLoopSimulation::simulateRealTime
+     */
+    template <class Controllers, class Reference, class F>
+    ODEResultCode simulateRealTime(Controllers &controllers, Reference &r,
+                                   const MatX_t &x_start,
+                                   const AdaptiveODEOptions &opt,
+                                   F &&callback) {
+        ODEResultCode resultCode;
+        double Ts = controllers[0].Ts;
+        size_t K  = numberOfSamplesInTimeRange(opt.t_start, Ts, opt.t_end);
+        MatX_t curr_x               = x_start;
+        MatU_t curr_u               = {};
+        AdaptiveODEOptions curr_opt = opt;
+        for (size_t k = 0; k < K; ++k) {
+            double t         = opt.t_start + Ts * k;
+            curr_opt.t_start = t;
+            curr_opt.t_end   = t + Ts;
+            VecR_t curr_ref  = StaticDispatch::call(r, t);
+            for (size_t d = 0; d < N; ++d) {
+                VecU_t u_d = StaticDispatch::call(
+                    controllers[d], getDroneState(curr_x, d), curr_ref);
+                for (size_t i = 0; i < Nu; ++i)
+                    curr_u[i][d] = u_d[i][0];
+            }
+            if (!callback(t, curr_x, curr_u))
+                break;
+            // integrate all drones over [t, t + Ts], updating curr_x in place
+            auto result = advance(curr_u, curr_x, curr_opt);
+            curr_opt.maxiter -= result.second;
+            resultCode |= result.first;
+            if (resultCode & ODEResultCodes::MAXIMUM_ITERATIONS_EXCEEDED)
+                break;
+        }
+        return resultCode;
+    }
+
+    /// Get the state of the d-th drone.
+    static VecX_t getDroneState(const MatX_t &x, size_t d) {
+        VecX_t x_d;
+        for (size_t i = 0; i < Nx; ++i)
+            x_d[i][0] = x[i][d];
+        return x_d;
+    }
+
+    /// Set the state of the d-th drone.
+    static void setDroneState(MatX_t &x, size_t d, const VecX_t &x_d) {
+        for (size_t i = 0; i < Nx; ++i)
+            x[i][d] = x_d[i][0];
+    }
+
+  private:
+    /// The parameters that are used by the dynamics, with the same names as
+    /// in DroneParamsAndMatrices, but with one element per drone.
+    struct Parameters {
+        using Lanes = Array<double, N>;
+        Array<Array<Lanes, 3>, 3> gamma_n, gamma_u, Id, Id_inv;
+        Lanes k1, k2, nh, g, ct, rho, Dp, Nm, m;
+    };
+
+    /// Context of evaluateDroneDynamics that selects the parameters of drone
+    /// d.
+    struct Lane {
+        size_t d;
+        double param(const Array<double, N> &value) const { return value[d]; }
+        double let(const char *, double value) const { return value; }
+    };
+
+    Parameters params = {};
+};
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <Matrix.hpp>
+
+#include <algorithm>  // upper_bound
+#include <cstdint>    // uint32_t
+#include <cstring>    // memcmp
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief   A table of controller gains on a rectilinear grid of operating
+ *          points, for gain scheduling.
+ *
+ * The gains are computed offline, one for every grid point, and the gain at
+ * an arbitrary operating point is found by multilinear interpolation between
+ * the @f$ 2^D @f$ surrounding grid points. Operating points outside of the
+ * grid are clamped to its boundary.
+ *
+ * @tparam  D
+ *          The number of scheduling variables.
+ * @tparam  Nu
+ *          The number of rows of the gain matrices.
+ * @tparam  Nx
+ *          The number of columns of the gain matrices.
+ */
+template <size_t D, size_t Nu, size_t Nx>
+class GainTable {
+  public:
+    using Gain  = Matrix<Nu, Nx>;
+    using Point = Array<double, D>;
+    using Axes  = Array<std::vector<double>, D>;
+
+    /**
+     * @brief   Create a table for the given grid, with all gains set to zero.
+     *
+     * @param   axes
+     *          The grid points along each of the scheduling variables, in
+     *          strictly ascending order.
+     */
+    GainTable(const Axes &axes) : axes{axes} {
+        size_t size = 1;
+        for (const auto &axis : axes) {
+            if (axis.empty())
+                throw std::invalid_argument("GainTable: empty axis");
+            if (!std::is_sorted(axis.begin(), axis.end(),
+                                [](double a, double b) { return a <= b; }))
+                throw std::invalid_argument(
+                    "GainTable: axis not strictly ascending");
+            size *= axis.size();
+        }
+        gains.resize(size);
+    }
+
+    /**
+     * @brief   Create a table for the given grid, computing the gain at every
+     *          grid point with the function `gainAt(const Point &)`.
+     *
+     * The grid points are independent, so they are computed in parallel when
+     * OpenMP is enabled. `gainAt` has to be safe to call from multiple
+     * threads.
+     */
+    template <class F>
+    static GainTable build(const Axes &axes, F gainAt) {
+        GainTable table = {axes};
+        const long size = table.gains.size();
+#pragma omp parallel for
+        for (long i = 0; i < size; ++i)
+            table.gains[i] = gainAt(table.getPoint(i));
+        return table;
+    }
+
+    /// Get the gain at the given operating point.
+    Gain operator()(const Point &p) const {
+        // Find the grid cell, and the relative position inside of it
+        Array<size_t, D> lower;
+        Point weight;
+        for (size_t d = 0; d < D; ++d) {
+            const auto &axis = axes[d];
+            if (axis.size() == 1 || p[d] <= axis.front()) {
+                lower[d]  = 0;
+                weight[d] = 0;
+            } else if (p[d] >= axis.back()) {
+                lower[d]  = axis.size() - 2;
+                weight[d] = 1;
+            } else {
+                auto upper = std::upper_bound(axis.begin(), axis.end(), p[d]);
+                lower[d]   = upper - axis.begin() - 1;
+                weight[d] =
+                    (p[d] - axis[lower[d]]) / (*upper - axis[lower[d]]);
+            }
+        }
+        // Weighted sum over the corners of the cell
+        Gain K = {};
+        for (size_t corner = 0; corner < (1u << D); ++corner) {
+            double w     = 1;
+            size_t index = 0;
+            for (size_t d = 0; d < D; ++d) {
+                bool up = (corner >> d) & 1;
+                if (up && axes[d].size() == 1)
+                    w = 0;
+                w *= up ? weight[d] : 1 - weight[d];
+                index = index * axes[d].size() + lower[d] + (up ? 1 : 0);
+            }
+            if (w != 0)
+                K += w * gains[index];
+        }
+        return K;
+    }
+
+    /// Get the grid points along each of the scheduling variables.
+    const Axes &getAxes() const { return axes; }
+    /// Get the number of grid points.
+    size_t size() const { return gains.size(); }
+
+    /// Get the gain at the grid point with the given flat index. The last
+    /// scheduling variable changes fastest.
+    Gain &operator[](size_t index) { return gains[index]; }
+    /// @copydoc operator[]
+    const Gain &operator[](size_t index) const { return gains[index]; }
+
+    /// Get the operating point of the grid point with the given flat index.
+    Point getPoint(size_t index) const {
+        Point p;
+        for (size_t d = D; d-- > 0;) {
+            p[d] = axes[d][index % axes[d].size()];
+            index /= axes[d].size();
+        }
+        return p;
+    }
+
+    /**
+     * @brief   Write the table to a binary stream.
+     *
+     * The format is a header with the magic bytes, the version and the
+     * dimensions, followed by the grid points of each axis and the gains in
+     * row-major order, as doubles in the native byte order.
+     */
+    void save(std::ostream &os) const {
+        os.write(magic, sizeof(magic));
+        writeInt(os, version);
+        writeInt(os, D);
+        writeInt(os, Nu);
+        writeInt(os, Nx);
+        for (const auto &axis : axes) {
+            writeInt(os, axis.size());
+            os.write(reinterpret_cast<const char *>(axis.data()),
+                     axis.size() * sizeof(double));
+        }
+        for (const Gain &K : gains)
+            for (const auto &row : K)
+                os.write(reinterpret_cast<const char *>(&row[0]),
+                         Nx * sizeof(double));
+        if (!os)
+            throw std::runtime_error("GainTable: error writing table");
+    }
+
+    /// Write the table to the given binary file.
+    void save(const std::filesystem::path &path) const {
+        std::ofstream os(path, std::ios::binary);
+        if (!os)
+            throw std::runtime_error("GainTable: could not open " +
+                                     path.string());
+        save(os);
+    }
+
+    /// Read a table that was written by `save` from a binary stream.
+    static GainTable load(std::istream &is) {
+        char m[sizeof(magic)];
+        is.read(m, sizeof(m));
+        if (!is || std::memcmp(m, magic, sizeof(magic)) != 0)
+            throw std::runtime_error("GainTable: not a gain table");
+        if (readInt(is) != version)
+            throw std::runtime_error("GainTable: unsupported version");
+        if (readInt(is) != D || readInt(is) != Nu || readInt(is) != Nx)
+            throw std::runtime_error("GainTable: dimensions don't match");
+        Axes axes;
+        for (auto &axis : axes) {
+            axis.resize(readInt(is));
+            is.read(reinterpret_cast<char *>(axis.data()),
+                    axis.size() * sizeof(double));
+        }
+        if (!is)
+            throw std::runtime_error("GainTable: unexpected end of file");
+        GainTable table = {axes};
+        for (Gain &K : table.gains)
+            for (auto &row : K)
+                is.read(reinterpret_cast<char *>(&row[0]),
+                        Nx * sizeof(double));
+        if (!is)
+            throw std::runtime_error("GainTable: unexpected end of file");
+        return table;
+    }
+
+    /// Read a table from the given binary file.
+    static GainTable load(const std::filesystem::path &path) {
+        std::ifstream is(path, std::ios::binary);
+        if (!is)
+            throw std::runtime_error("GainTable: could not open " +
+                                     path.string());
+        return load(is);
+    }
+
+  private:
+    static void writeInt(std::ostream &os, size_t value) {
+        uint32_t v = value;
+        os.write(reinterpret_cast<const char *>(&v), sizeof(v));
+    }
+    static size_t readInt(std::istream &is) {
+        uint32_t v = 0;
+        is.read(reinterpret_cast<char *>(&v), sizeof(v));
+        return v;
+    }
+
+    static constexpr char magic[8]   = {'E', 'A', 'G', 'L', 'E', 'G', 'T', 0};
+    static constexpr uint32_t version = 1;
+
+    Axes axes;
+    std::vector<Gain> gains;
+};
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "Def.hpp"
+#include "GainTable.hpp"
 #include <DiscreteController.hpp>
+#include <LeastSquares.hpp>
 #include <QuaternionStateAddSub.hpp>
 #include <ReducedQuaternion.hpp>
 #include <cassert>
@@ -118,6 +120,56 @@ class LQRController : public DiscreteController<Nx, Nu, Ny> {
     const Matrix<Nx + Nu, Ny> G;
 };
 
+/**
+ * @brief   A discrete-time LQR attitude controller with gains that are
+ *          scheduled on the roll and pitch angles of the reference.
+ * 
+ * The gains are calculated for the model linearized around hovering states
+ * with the roll and pitch of the grid points, in reduced quaternion
+ * coordinates (see Drone::getAttitudeGainTable). The attitude dynamics don't
+ * depend on the heading, so the orientations are expressed relative to the
+ * heading of the reference before calculating the error. The equilibrium for
+ * a reference orientation is that orientation with zero angular velocity,
+ * motor speeds and control.
+ * 
+ * @note    This controller doesn't clamp the control output!
+ */
+class GainScheduledLQRController : public DiscreteController<Nx, Nu, Ny> {
+  public:
+    /// Gains as a function of the roll and pitch angles.
+    using Table = GainTable<2, Nu, Nx - 1>;
+
+    GainScheduledLQRController(Table table, double Ts)
+        : DiscreteController<Nx, Nu, Ny>{Ts}, table{std::move(table)} {}
+
+    VecU_t operator()(const VecX_t &x, const VecR_t &r) override {
+        return getRawControllerOutput(x, r);
+    }
+
+    VecU_t getRawControllerOutput(const VecX_t &x, const VecR_t &r) const {
+        const Quaternion q_ref   = getBlock<0, 4, 0, 1>(r);
+        const EulerAngles eul    = quat2eul(q_ref);
+        const Quaternion heading = eul2quat({eul[0], 0, 0});
+
+        // orientations relative to the heading, with a positive real part so
+        // that the reduced quaternions are valid
+        auto relative = [&heading](const Quaternion &q) {
+            Quaternion q_rel = quatmultiply(quatconjugate(heading), q);
+            return q_rel[0] < 0 ? -q_rel : q_rel;
+        };
+        VecX_t x_rel                   = x;
+        assignBlock<0, 4, 0, 1>(x_rel) = relative(getBlock<0, 4, 0, 1>(x));
+        VecX_t x_eq                    = {};
+        assignBlock<0, 4, 0, 1>(x_eq)  = relative(q_ref);
+
+        // controller, with the gain for the roll and pitch of the reference
+        const Matrix<Nu, Nx - 1> K = table({eul[2], eul[1]});
+        return K * (quat2red(x_rel) - quat2red(x_eq));
+    }
+
+    const Table table;
+};
+
 }  // namespace Attitude
 
 namespace Altitude {
@@ -0,0 +1,207 @@
+#pragma once
+
+#include "Def.hpp"
+#include "MotorControl.hpp"
+#include <ADMM.hpp>
+#include <DiscreteController.hpp>
+#include <QuaternionStateAddSub.hpp>
+#include <ReducedQuaternion.hpp>
+
+#include <algorithm>  // max, min
+
+namespace Attitude {
+
+/**
+ * @brief   A discrete-time linear MPC attitude controller that respects the
+ *          limits of the motors.
+ *
+ * The controller minimizes the cost
+ * @f[
+ *  \sum_{k=1}^{N-1} \left( e_k^\top Q e_k \right) + e_N^\top P e_N +
+ *  \sum_{k=0}^{N-1} \delta u_k^\top R\, \delta u_k
+ * @f]
+ * over a horizon of N samples, where @f$ e_k @f$ is the predicted error of
+ * the reduced state with respect to the equilibrium of the reference (the
+ * same error as Attitude::LQRController), and @f$ \delta u_k @f$ is the
+ * control relative to the equilibrium control. The predictions use the
+ * linearized discrete model.
+ *
+ * The motor signals @f$ M \begin{pmatrix} u_k \\ u_c \end{pmatrix} @f$ (see
+ * MotorControlTransformation) have to stay between 0 and 1, where @f$ u_c @f$
+ * is the common thrust, which is assumed to be constant.
+ *
+ * The states are eliminated from the problem (condensed formulation), so the
+ * only variables are the N control signals. The Hessian, the constraint
+ * matrix, and the matrix that maps the initial error to the linear cost are
+ * calculated in the constructor, and the QP is solved by ADMMQPSolver, warm
+ * started with the shifted solution of the previous sample. No memory is
+ * allocated when the controller is called, and the number of ADMM iterations
+ * is bounded, which bounds the execution time.
+ *
+ * With the solution of the discrete algebraic Riccati equation as terminal
+ * weight P, and inactive constraints, this is the same controller as the
+ * infinite-horizon LQR controller.
+ *
+ * The first control signal is scaled towards the equilibrium control if it
+ * violates the motor limits, which happens when the solver runs out of
+ * iterations, so the motor signals that are applied are always within their
+ * limits (unless the equilibrium itself isn't).
+ *
+ * @tparam  N
+ *          The length of the prediction horizon.
+ */
+template <size_t N>
+class MPCController : public DiscreteController<Nx, Nu, Ny> {
+  public:
+    /// The number of states of the reduced model.
+    static constexpr size_t Nr = Nx - 1;
+    /// The number of motors.
+    static constexpr size_t Nm = 4;
+    using Solver               = ADMMQPSolver<Nu * N, Nm * N>;
+
+    /**
+     * @brief   Construct a new MPC controller.
+     *
+     * @param   G
+     *          Equilibrium matrix G (see calculateG).
+     * @param   Ad_r
+     *          Reduced discrete system matrix A.
+     * @param   Bd_r
+     *          Reduced discrete system matrix B.
+     * @param   Q
+     *          Weight matrix of the state errors.
+     * @param   R
+     *          Weight matrix of the control signals.
+     * @param   P
+     *          Weight matrix of the final state error.
+     * @param   uc
+     *          The common thrust control of all motors.
+     * @param   Ts
+     *          The sample time of the discrete controller.
+     * @param   opt
+     *          The options of the QP solver.
+     */
+    MPCController(const Matrix<Nx + Nu, Ny> &G, const Matrix<Nr, Nr> &Ad_r,
+                  const Matrix<Nr, Nu> &Bd_r, const Matrix<Nr, Nr> &Q,
+                  const Matrix<Nu, Nu> &R, const Matrix<Nr, Nr> &P, double uc,
+                  double Ts, const typename Solver::Options &opt = {})
+        : DiscreteController<Nx, Nu, Ny>{Ts}, G{G},
+          condensed{condense(Ad_r, Bd_r, Q, R, P)}, M_att{getMotorMatrix()},
+          uc{uc}, solver{condensed.H, getConstraintMatrix(), opt} {}
+
+    VecU_t operator()(const VecX_t &x, const VecR_t &r) override {
+        // new equilibrium state
+        ColVector<Nx + Nu> eq = G * r;
+        ColVector<Nx> xeq     = getBlock<0, Nx, 0, 1>(eq);
+        ColVector<Nu> ueq     = getBlock<Nx, Nx + Nu, 0, 1>(eq);
+
+        // error
+        ColVector<Nx> x_err       = quaternionStatesSub(x, xeq);
+        ColVector<Nx - 1> x_err_r = quat2red(x_err);
+
+        // linear cost and motor limits relative to the equilibrium control
+        ColVector<Nu * N> f  = condensed.F * x_err_r;
+        ColVector<Nm> m_eq   = M_att * ueq;
+        ColVector<Nm * N> lb = {};
+        ColVector<Nm * N> ub = {};
+        for (size_t k = 0; k < N; ++k) {
+            for (size_t i = 0; i < Nm; ++i) {
+                lb[Nm * k + i][0] = -uc - m_eq[i][0];
+                ub[Nm * k + i][0] = 1 - uc - m_eq[i][0];
+            }
+        }
+
+        solver.template shift<Nu, Nm>();
+        iterations = solver.solve(f, lb, ub);
+
+        // The solution only satisfies the motor limits up to the tolerance,
+        // and not at all if the solver ran out of iterations. The first
+        // control is scaled towards the equilibrium control until all motor
+        // signals are within their limits.
+        ColVector<Nu> du = getBlock<0, Nu, 0, 1>(solver.getSolution());
+        ColVector<Nm> m  = M_att * du;
+        double scale     = 1;
+        for (size_t i = 0; i < Nm; ++i) {
+            if (m[i][0] > ub[i][0])
+                scale = std::min(scale, std::max(ub[i][0], 0.) / m[i][0]);
+            else if (m[i][0] < lb[i][0])
+                scale = std::min(scale, std::min(lb[i][0], 0.) / m[i][0]);
+        }
+        return ueq + scale * du;
+    }
+
+    /// Forget the warm start of the solver.
+    void reset() override { solver.reset(); }
+
+    /// Get the number of iterations of the QP solver of the last call.
+    size_t getIterations() const { return iterations; }
+
+    /// Get the matrix that maps the control signals to the motor signals.
+    static Matrix<Nm, Nu> getMotorMatrix() {
+        return getBlock<0, Nm, 0, Nu>(MotorControlTransformation::M);
+    }
+
+  private:
+    /// The matrices of the condensed QP.
+    struct Condensed {
+        /// The Hessian.
+        Matrix<Nu * N, Nu * N> H;
+        /// Maps the initial error to the linear cost.
+        Matrix<Nu * N, Nr> F;
+    };
+
+    static Condensed condense(const Matrix<Nr, Nr> &A, const Matrix<Nr, Nu> &B,
+                              const Matrix<Nr, Nr> &Q, const Matrix<Nu, Nu> &R,
+                              const Matrix<Nr, Nr> &P) {
+        // Predicted error e_k = A^k e_0 + Gamma_k Δu, for k = 1 ... N, with
+        // Gamma_k = [A^(k-1) B, A^(k-2) B, ..., B, 0, ..., 0]
+        Condensed result           = {};
+        Matrix<Nr, Nr> A_k         = eye<Nr>();
+        Matrix<Nr, Nu * N> Gamma_k = {};
+        for (size_t k = 1; k <= N; ++k) {
+            // Gamma_k = A Gamma_(k-1) + [0, ..., B, ..., 0]
+            Gamma_k = A * Gamma_k;
+            for (size_t i = 0; i < Nr; ++i)
+                for (size_t j = 0; j < Nu; ++j)
+                    Gamma_k[i][Nu * (k - 1) + j] = B[i][j];
+            A_k = A * A_k;
+
+            const Matrix<Nr, Nr> &W     = k == N ? P : Q;
+            Matrix<Nu * N, Nr> GammaT_W = transpose(Gamma_k) * W;
+            result.H += GammaT_W * Gamma_k;
+            result.F += GammaT_W * A_k;
+        }
+        for (size_t k = 0; k < N; ++k)
+            for (size_t i = 0; i < Nu; ++i)
+                for (size_t j = 0; j < Nu; ++j)
+                    result.H[Nu * k + i][Nu * k + j] += R[i][j];
+        // Scale the cost so that the diagonal of the Hessian is one on
+        // average, which doesn't change the minimizer, but makes the
+        // convergence of the solver independent of the scale of the weights
+        double trace = 0;
+        for (size_t i = 0; i < Nu * N; ++i)
+            trace += result.H[i][i];
+        result.H *= Nu * N / trace;
+        result.F *= Nu * N / trace;
+        return result;
+    }
+
+    static Matrix<Nm * N, Nu * N> getConstraintMatrix() {
+        const Matrix<Nm, Nu> M_att   = getMotorMatrix();
+        Matrix<Nm * N, Nu * N> C_all = {};
+        for (size_t k = 0; k < N; ++k)
+            for (size_t i = 0; i < Nm; ++i)
+                for (size_t j = 0; j < Nu; ++j)
+                    C_all[Nm * k + i][Nu * k + j] = M_att[i][j];
+        return C_all;
+    }
+
+    const Matrix<Nx + Nu, Ny> G;
+    const Condensed condensed;
+    const Matrix<Nm, Nu> M_att;
+    const double uc;
+    Solver solver;
+    size_t iterations = 0;
+};
+
+}  // namespace Attitude
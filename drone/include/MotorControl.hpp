@@ -2,6 +2,8 @@
 
 #include <Matrix.hpp>
 #include <algorithm>
+#include <sstream>
+#include <stdexcept>
 #include <vector>
 
 namespace MotorControlTransformation {
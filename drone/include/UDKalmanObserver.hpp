@@ -0,0 +1,254 @@
+#pragma once
+
+#include "Def.hpp"
+#include <DiscreteObserver.hpp>
+#include <QuaternionStateAddSub.hpp>
+#include <ReducedQuaternion.hpp>
+#include <UDFactorization.hpp>
+
+#include <cmath>  // isnan
+
+namespace Attitude {
+
+/**
+ * @brief   Time-varying Kalman filter for the attitude controller, that
+ *          propagates the covariance of the reduced state as UD factors.
+ *
+ * Unlike Attitude::KalmanObserver, which uses the steady-state gain of
+ * `dlqe`, the gain is recomputed every sample, so the filter adapts when the
+ * sensor variances change, or when some of the sensor readings are missing
+ * (NaN). The sensor channels are assumed to be uncorrelated, so they are
+ * processed one at a time by a Bierman update, and the covariance is
+ * propagated by a Thornton update. Neither needs a matrix inversion, and all
+ * storage is fixed-size.
+ *
+ * The covariance is stored as type T, so it can be used in single precision.
+ *
+ * @tparam  T
+ *          The type used for the covariance factors.
+ * @tparam  Nw
+ *          The number of process noise inputs.
+ */
+template <class T = double, size_t Nw = Nu>
+class UDKalmanObserver : public DiscreteObserver<Nx, Nu, Ny> {
+  public:
+    UDKalmanObserver(const Matrix<Nx - 1, Nx - 1> &A_red,
+                     const Matrix<Nx - 1, Nu> &B_red, const Matrix<Ny, Nx> &C,
+                     const Matrix<Ny - 1, Nx - 1> &C_red,
+                     const Matrix<Nx - 1, Nw> &G,
+                     const RowVector<Nw> &varDynamics,
+                     const RowVector<Ny - 1> &varSensors,
+                     const Matrix<Nx - 1, Nx - 1> &P0, double Ts)
+        : DiscreteObserver<Nx, Nu, Ny>{Ts}, A_red{A_red}, B_red{B_red}, C{C},
+          A_red_T{matrixCast<T>(A_red)}, C_red_T{matrixCast<T>(C_red)},
+          G_T{matrixCast<T>(G)}, varDynamics{matrixCast<T>(varDynamics)},
+          varSensors{matrixCast<T>(varSensors)},
+          P0{udFactorize(matrixCast<T>(P0))}, factors{this->P0} {}
+
+    void reset() override { factors = P0; }
+
+    /**
+     * @brief   Get the state change, given the previous estimated state, the
+     *          current sensor reading, and the current control input.
+     *
+     * First corrects the previous estimate with the current sensor reading,
+     * @f$ \hat{x}_{k|k} = \hat{x}_k \oplus K_k \left(y_k \ominus C \hat{x}_k
+     * \right) @f$, then predicts the next state,
+     * @f$ \hat{x}_{k+1} = A \hat{x}_{k|k} + B u_k @f$.
+     *
+     * Sensor readings that are NaN are skipped. This is the same as
+     * `predict(correct(x_hat, y_sensor), u)`.
+     *
+     * @param   x_hat
+     *          The previous estimated state.
+     * @param   y_sensor
+     *          The current sensor reading.
+     * @param   u
+     *          The current control input.
+     */
+    VecX_t getStateChange(const VecX_t &x_hat, const VecY_t &y_sensor,
+                          const VecU_t &u) override {
+        return predict(correct(x_hat, y_sensor), u);
+    }
+
+    /**
+     * @brief   Correct the estimated state with the current sensor reading,
+     *          @f$ \hat{x}_{k|k} = \hat{x}_k \oplus K_k \left(y_k \ominus
+     *          C \hat{x}_k \right) @f$. Sensor readings that are NaN are
+     *          skipped.
+     *
+     * Afterwards, getCovariance returns the covariance of the corrected
+     * estimate, until predict is called.
+     */
+    VecX_t correct(const VecX_t &x_hat, const VecY_t &y_sensor) {
+        VecY_t cx                   = C * x_hat;
+        VecY_t ydiff                = quaternionStatesSub(y_sensor, cx);
+        ColVector<Ny - 1> ydiff_red = getBlock<1, Ny, 0, 1>(ydiff);
+
+        TColVector<T, Nx - 1> dx = {};
+        for (size_t i = 0; i < Ny - 1; ++i) {
+            if (std::isnan(ydiff_red[i][0]))
+                continue;
+            TRowVector<T, Nx - 1> h = {C_red_T[i]};
+            T innovation = T(ydiff_red[i][0]) - (h * dx)[0][0];
+            auto k       = biermanUpdate(factors, h, varSensors[0][i]);
+            dx += k * innovation;
+        }
+        return quaternionStatesAdd(x_hat, red2quat(matrixCast<double>(dx)));
+    }
+
+    /**
+     * @brief   Predict the next state from the corrected estimate,
+     *          @f$ \hat{x}_{k+1} = A \hat{x}_{k|k} + B u_k @f$, and propagate
+     *          the covariance.
+     */
+    VecX_t predict(const VecX_t &x_hat_filt, const VecU_t &u) {
+        ColVector<Nx - 1> x_hat_red       = getBlock<1, Nx, 0, 1>(x_hat_filt);
+        ColVector<Nx - 1> x_hat_model_red = A_red * x_hat_red + B_red * u;
+        thorntonUpdate(factors, A_red_T, G_T, varDynamics);
+        return red2quat(x_hat_model_red);
+    }
+
+    /// Set the variances of the (reduced) sensor readings.
+    void setSensorVariances(const RowVector<Ny - 1> &varSensors) {
+        this->varSensors = matrixCast<T>(varSensors);
+    }
+    /// Set the variances of the process noise.
+    void setDynamicsVariances(const RowVector<Nw> &varDynamics) {
+        this->varDynamics = matrixCast<T>(varDynamics);
+    }
+
+    /// Get the current covariance of the reduced state: of the prediction
+    /// after getStateChange or predict, of the corrected estimate after
+    /// correct.
+    Matrix<Nx - 1, Nx - 1> getCovariance() const {
+        return matrixCast<double>(factors.toMatrix());
+    }
+
+    const Matrix<Nx - 1, Nx - 1> A_red;
+    const Matrix<Nx - 1, Nu> B_red;
+    const Matrix<Ny, Nx> C;
+
+  private:
+    const TMatrix<T, Nx - 1, Nx - 1> A_red_T;
+    const TMatrix<T, Ny - 1, Nx - 1> C_red_T;
+    const TMatrix<T, Nx - 1, Nw> G_T;
+    TRowVector<T, Nw> varDynamics;
+    TRowVector<T, Ny - 1> varSensors;
+    const UDFactors<T, Nx - 1> P0;
+    UDFactors<T, Nx - 1> factors;
+};
+
+}  // namespace Attitude
+
+namespace Altitude {
+
+/**
+ * @brief   Time-varying Kalman filter for the altitude controller, that
+ *          propagates the covariance as UD factors.
+ *
+ * @see     Attitude::UDKalmanObserver
+ */
+template <class T = double>
+class UDKalmanObserver : public DiscreteObserver<Nx, Nu, Ny> {
+  public:
+    UDKalmanObserver(const Matrix<Nx, Nx> &A, const Matrix<Nx, Nu> &B,
+                     const Matrix<Ny, Nx> &C, const RowVector<Nu> &varDynamics,
+                     const RowVector<Ny> &varSensors,
+                     const Matrix<Nx, Nx> &P0, double Ts)
+        : DiscreteObserver<Nx, Nu, Ny>{Ts}, A{A}, B{B}, C{C},
+          A_T{matrixCast<T>(A)}, B_T{matrixCast<T>(B)}, C_T{matrixCast<T>(C)},
+          varDynamics{matrixCast<T>(varDynamics)},
+          varSensors{matrixCast<T>(varSensors)},
+          P0{udFactorize(matrixCast<T>(P0))}, factors{this->P0} {}
+
+    void reset() override { factors = P0; }
+
+    /**
+     * @brief   Get the state change, given the previous estimated state, the
+     *          current sensor reading, and the current control input.
+     *
+     * Calculates   @f$
+     *                  \hat{x}_{k+1} = A \left(\hat{x}_k +
+     *                  K_k \left(y_k - C \hat{x}_k\right)\right) + B u_k
+     *              @f$
+     *
+     * Sensor readings that are NaN are skipped. This is the same as
+     * `predict(correct(x_hat, y_sensor), u)`.
+     *
+     * @param   x_hat
+     *          The previous estimated state.
+     * @param   y_sensor
+     *          The current sensor reading.
+     * @param   u
+     *          The current control input.
+     */
+    VecX_t getStateChange(const VecX_t &x_hat, const VecY_t &y_sensor,
+                          const VecU_t &u) override {
+        return predict(correct(x_hat, y_sensor), u);
+    }
+
+    /**
+     * @brief   Correct the estimated state with the current sensor reading,
+     *          @f$ \hat{x}_{k|k} = \hat{x}_k + K_k \left(y_k - C \hat{x}_k
+     *          \right) @f$. Sensor readings that are NaN are skipped.
+     *
+     * @see     Attitude::UDKalmanObserver::correct
+     */
+    VecX_t correct(const VecX_t &x_hat, const VecY_t &y_sensor) {
+        VecY_t ydiff = y_sensor - C * x_hat;
+
+        TColVector<T, Nx> dx = {};
+        for (size_t i = 0; i < Ny; ++i) {
+            if (std::isnan(ydiff[i][0]))
+                continue;
+            TRowVector<T, Nx> h = {C_T[i]};
+            T innovation        = T(ydiff[i][0]) - (h * dx)[0][0];
+            TColVector<T, Nx> k = biermanUpdate(factors, h, varSensors[0][i]);
+            dx += k * innovation;
+        }
+        return x_hat + matrixCast<double>(dx);
+    }
+
+    /**
+     * @brief   Predict the next state from the corrected estimate, and
+     *          propagate the covariance.
+     *
+     * @see     Attitude::UDKalmanObserver::predict
+     */
+    VecX_t predict(const VecX_t &x_hat_filt, const VecU_t &u) {
+        VecX_t x_hat_model = A * x_hat_filt + B * u;
+        thorntonUpdate(factors, A_T, B_T, varDynamics);
+        return x_hat_model;
+    }
+
+    /// Set the variances of the sensor readings.
+    void setSensorVariances(const RowVector<Ny> &varSensors) {
+        this->varSensors = matrixCast<T>(varSensors);
+    }
+    /// Set the variances of the process noise.
+    void setDynamicsVariances(const RowVector<Nu> &varDynamics) {
+        this->varDynamics = matrixCast<T>(varDynamics);
+    }
+
+    /// Get the current covariance of the state, see
+    /// Attitude::UDKalmanObserver::getCovariance.
+    Matrix<Nx, Nx> getCovariance() const {
+        return matrixCast<double>(factors.toMatrix());
+    }
+
+    const Matrix<Nx, Nx> A;
+    const Matrix<Nx, Nu> B;
+    const Matrix<Ny, Nx> C;
+
+  private:
+    const TMatrix<T, Nx, Nx> A_T;
+    const TMatrix<T, Nx, Nu> B_T;
+    const TMatrix<T, Ny, Nx> C_T;
+    TRowVector<T, Nu> varDynamics;
+    TRowVector<T, Ny> varSensors;
+    const UDFactors<T, Nx> P0;
+    UDFactors<T, Nx> factors;
+};
+
+}  // namespace Altitude
@@ -1,4 +1,5 @@
 #include <CLQRController.hpp>
+#include <DroneStateControlOutput.hpp>
 #include <altitude-controller.h>
 #include <attitude-controller.h>
 
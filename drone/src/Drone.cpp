@@ -1,9 +1,73 @@
 #include "Drone.hpp"
 #include "MotorControl.hpp"
 
+#include <DormandPrinceLie.hpp>
+#include <MatrixExponential.hpp>
+#include <QuaternionStateChart.hpp>
+
 using namespace std;
 
 Drone::VecX_t Drone::operator()(const VecX_t &x, const VecU_t &u) {
+    return DroneDynamics{p}(x, u);
+}
+
+std::pair<ODEResultCode, size_t>
+Drone::advance(const VecU_t &u, VecX_t &x, const AdaptiveODEOptions &opt) {
+    if (splitMotorDynamics)
+        return advanceSplit(u, x, opt);
+    if (!lieGroupIntegration)
+        return ClosedLoopSimulation::advanceDormandPrince(*this, u, x, opt);
+    auto f = [this, &u](double /* t */, const VecX_t &x) {
+        VecX_t x_dot;
+        getStateChange(x, u, x_dot);
+        return x_dot;
+    };
+    return dormandPrinceLieInPlace(f, QuaternionStateChart<Nx>{}, x, opt);
+}
+
+void Drone::eulerStep(VecX_t &x, const VecX_t &x_dot, double h) {
+    using Chart = QuaternionStateChart<Nx>;
+    x = Chart::retract(x, h * Chart::localDerivative({}, x, x_dot));
+}
+
+void Drone::advanceMotors(const VecU_t &u, VecX_t &x, double h) const {
+    // n(t + h) = k1 u + (n(t) - k1 u) exp(-k2 h)
+    const double decay = exp(-p.k2 * h);
+    for (size_t i = 0; i < 3; ++i) {
+        const double n_ss = p.k1 * u[i][0];
+        x[7 + i][0]       = n_ss + (x[7 + i][0] - n_ss) * decay;
+    }
+    const double nt_ss = p.k1 * u[3][0];
+    x[16][0]           = nt_ss + (x[16][0] - nt_ss) * decay;
+}
+
+std::pair<ODEResultCode, size_t>
+Drone::advanceSplit(const VecU_t &u, VecX_t &x, const AdaptiveODEOptions &opt) {
+    // The rigid body, with the motor speeds frozen
+    auto f = [this, &u](double /* t */, const VecX_t &x) {
+        VecX_t x_dot;
+        getStateChange(x, u, x_dot);
+        for (size_t i = 7; i < 10; ++i)
+            x_dot[i][0] = 0;
+        x_dot[16][0] = 0;
+        return x_dot;
+    };
+    const double h_half = (opt.t_end - opt.t_start) / 2;
+    VecX_t x_split      = x;
+    advanceMotors(u, x_split, h_half);
+    auto result = lieGroupIntegration
+                      ? dormandPrinceLieInPlace(f, QuaternionStateChart<Nx>{},
+                                                x_split, opt)
+                      : dormandPrinceInPlace(f, x_split, opt);
+    if (result.first & ODEResultCodes::MAXIMUM_ITERATIONS_EXCEEDED)
+        return result;
+    advanceMotors(u, x_split, h_half);
+    x = x_split;
+    return result;
+}
+
+Drone::VecX_t Drone::referenceStateChange(const VecX_t &x,
+                                          const VecU_t &u) const {
     // Convert the state and input vectors to types with getters and setters
     DroneState xx   = {x};
     DroneControl uu = {u};
@@ -88,42 +152,110 @@ Drone::AttitudeModel::VecX_t Drone::AttitudeModel::operator()(const VecX_t &x,
     return x_dot;
 }
 
+std::pair<ODEResultCode, size_t>
+Drone::AttitudeModel::advance(const VecU_t &u, VecX_t &x,
+                              const AdaptiveODEOptions &opt) {
+    if (!lieGroupIntegration)
+        return ClosedLoopSimulation::advanceDormandPrince(*this, u, x, opt);
+    auto f = [this, &u](double /* t */, const VecX_t &x) {
+        return AttitudeModel::operator()(x, u);
+    };
+    return dormandPrinceLieInPlace(f, QuaternionStateChart<Nx_att>{}, x, opt);
+}
+
+void Drone::AttitudeModel::eulerStep(VecX_t &x, const VecX_t &x_dot,
+                                     double h) {
+    using Chart = QuaternionStateChart<Nx_att>;
+    x = Chart::retract(x, h * Chart::localDerivative({}, x, x_dot));
+}
+
 // TODO: dry?
 Drone::AttitudeModel::VecY_t Drone::AttitudeModel::getOutput(const VecX_t &x,
                                                              const VecU_t &u) {
     return Ca_att * x + Da_att * u;
 }
 
-#pragma region Controllers......................................................
+Drone::LinearAttitudeModel::LinearAttitudeModel(
+    const DroneParamsAndMatrices &drone)
+    : DiscreteModel<Nx_att, Nu_att, Ny_att>{drone.Ts_att},
+      Ad_att_r{drone.Ad_att_r}, Bd_att_r{drone.Bd_att_r},
+      Cd_att{drone.Cd_att}, Dd_att{drone.Dd_att} {}
 
-Drone::Controller::VecU_t Drone::Controller::
-operator()(const Drone::Controller::VecX_t &x,
-           const Drone::Controller::VecR_t &r) {
-    const DroneState xx     = {x};
-    const DroneReference rr = {r};
-    DroneControl uu;
-
-    if (subsampleCounter == 0) {
-        auto u_alt_raw =
-            altitudeController->getOutput(xx.getAltitude(), rr.getAltitude());
-        u_alt            = clampThrust(u_alt_raw);
-        subsampleCounter = subsampleAlt;
-    }
-    --subsampleCounter;
+Drone::LinearAttitudeModel::VecX_t
+Drone::LinearAttitudeModel::operator()(const VecX_t &x, const VecU_t &u) {
+    ColVector<Nx_att - 1> x_r = quat2red(x);
+    return red2quat(Ad_att_r * x_r + Bd_att_r * u);
+}
 
-    auto u_att =
-        attitudeController->getOutput(xx.getAttitude(), rr.getAttitude());
-    u_att = clampAttitude(u_att, u_alt + uh);
-    uu.setAttitudeControl(u_att);
-    uu.setThrustControl(u_alt);
-    checkControlSignal(uu, uh);
-    return uu;
+Drone::LinearAttitudeModel::VecY_t
+Drone::LinearAttitudeModel::getOutput(const VecX_t &x, const VecU_t &u) {
+    return Cd_att * x + Dd_att * u;
 }
 
-void Drone::Controller::reset() {
-    subsampleCounter = 0;
-    attitudeController->reset();
-    altitudeController->reset();
+Drone::AltitudeModel::AltitudeModel(const DroneParamsAndMatrices &drone)
+    : k1{drone.k1}, k2{drone.k2}, nh{drone.nh}, g{drone.g},
+      thrustFactor{drone.ct * drone.rho * sq(sq(drone.Dp)) * drone.Nm /
+                   drone.m},
+      Ca_alt{drone.Ca_alt}, Da_alt{drone.Da_alt} {}
+
+Drone::AltitudeModel::VecX_t Drone::AltitudeModel::operator()(const VecX_t &x,
+                                                              const VecU_t &u) {
+    // State: n_t (0), z (1), v_z (2)
+    double n_t = x[0][0];
+    double v_z = x[2][0];
+    double nth = n_t + nh;
+    return {
+        k2 * (k1 * u[0][0] - n_t),
+        v_z,
+        thrustFactor * nth * nth - g,
+    };
+}
+
+Drone::AltitudeModel::VecY_t Drone::AltitudeModel::getOutput(const VecX_t &x,
+                                                             const VecU_t &u) {
+    return Ca_alt * x + Da_alt[0][0] * u;  // Da_alt is 1×1
+}
+
+#pragma region Controllers......................................................
+
+Drone::LinearizedAttitude Drone::linearizeAttitude(double roll,
+                                                   double pitch) const {
+    constexpr size_t Nr = Nx_att - 1;
+    AttitudeModel model = getAttitudeModel();
+    // Derivative of the reduced state
+    auto f = [&model](const ColVector<Nr> &z, const ColVector<Nu_att> &u) {
+        return quat2red(model(red2quat(z), u));
+    };
+
+    // Hovering with the given roll and pitch is an equilibrium
+    ColVector<Nr> z_op            = {};
+    assignBlock<0, 3, 0, 1>(z_op) = quat2red(eul2quat({0, pitch, roll}));
+    const ColVector<Nu_att> u_op  = {};
+
+    // Jacobians [A B] by central differences
+    constexpr double h                 = 1e-6;
+    Matrix<Nr + Nu_att, Nr + Nu_att> M = {};
+    for (size_t j = 0; j < Nr; ++j) {
+        ColVector<Nr> dz = {};
+        dz[j][0]         = h;
+        ColVector<Nr> df = f(z_op + dz, u_op) - f(z_op - dz, u_op);
+        for (size_t i = 0; i < Nr; ++i)
+            M[i][j] = df[i][0] / (2 * h);
+    }
+    for (size_t j = 0; j < Nu_att; ++j) {
+        ColVector<Nu_att> du = {};
+        du[j][0]             = h;
+        ColVector<Nr> df     = f(z_op, u_op + du) - f(z_op, u_op - du);
+        for (size_t i = 0; i < Nr; ++i)
+            M[i][Nr + j] = df[i][0] / (2 * h);
+    }
+
+    // Zero-order hold: exp([A B; 0 0] Ts) = [Ad Bd; 0 I]
+    Matrix<Nr + Nu_att, Nr + Nu_att> E = expm(p.Ts_att * M);
+    return {
+        getBlock<0, Nr, 0, Nr>(E),
+        getBlock<0, Nr, Nr, Nr + Nu_att>(E),
+    };
 }
 
 ColVector<1> Drone::Controller::clampThrust(ColVector<1> u_thrust) {
@@ -151,25 +283,3 @@ Drone::Controller::clampAttitude(const Attitude::LQRController::VecU_t &u_raw,
     }
     return u;
 }
-
-#pragma region Observers........................................................
-
-Drone::Observer::VecX_t Drone::Observer::getStateChange(const VecX_t &x_hat,
-                                                        const VecY_t &y_sensor,
-                                                        const VecU_t &u) {
-    DroneState xx_hat = {x_hat};
-    DroneOutput yy    = {y_sensor};
-    DroneControl uu   = {u};
-
-    if (subsampleCounter == 0) {
-        auto new_x_alt = altitudeObserver->getStateChange(
-            xx_hat.getAltitude(), yy.getAltitude(), uu.getThrustControl());
-        xx_hat.setAltitude(new_x_alt);
-        subsampleCounter = subsampleAlt;
-    }
-    --subsampleCounter;
-
-    xx_hat.setAttitude(attitudeObserver->getStateChange(
-        xx_hat.getAttitude(), yy.getAttitude(), uu.getAttitudeControl()));
-    return xx_hat;
-}
\ No newline at end of file
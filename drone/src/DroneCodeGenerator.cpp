@@ -0,0 +1,429 @@
+#include "DroneCodeGenerator.hpp"
+#include "DroneDynamics.hpp"
+
+#include <algorithm>  // sort
+#include <array>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+/**
+ * Format a double as a C++ literal that round-trips exactly. Infinities and
+ * NaNs have no literal, they are written as `std::numeric_limits` constants.
+ */
+string literal(double c) {
+    if (isnan(c))
+        return "std::numeric_limits<double>::quiet_NaN()";
+    if (isinf(c))
+        return string(c < 0 ? "-" : "") +
+               "std::numeric_limits<double>::infinity()";
+    ostringstream s;
+    s << setprecision(17) << c;
+    string str = s.str();
+    if (str.find_first_of(".en") == string::npos)
+        str += ".0";
+    return str;
+}
+
+/// Name of the i-th element of the given array.
+string at(const string &array, size_t i) {
+    return array + "[" + to_string(i) + "]";
+}
+
+/// Name of a local variable with an index.
+string var(const string &name, size_t i) { return name + to_string(i); }
+
+/**
+ * A polynomial: a sum of terms with constant coefficients, and a constant.
+ * Every term is a product of symbols. Terms with the same symbols are merged,
+ * terms with a zero coefficient are omitted, and coefficients of ±1 are not
+ * written, so the generated expressions don't contain any multiplications by
+ * constants that are known at compile time. An empty symbol name means that
+ * the symbol is known to be zero.
+ *
+ * The arithmetic operators make it possible to evaluate generic code, such as
+ * evaluateDroneDynamics, symbolically, with all products of constants folded.
+ */
+class Sum {
+  public:
+    Sum() = default;
+    /// A constant.
+    Sum(double c) : constant{c} {}
+
+    Sum &add(double c, const string &term) {
+        if (term.empty())
+            return *this;
+        return add(c, vector<string>{term});
+    }
+    Sum &add(double c) {
+        constant += c;
+        return *this;
+    }
+    Sum &add(const Sum &other) {
+        for (auto &t : other.terms)
+            add(t.first, t.second);
+        return add(other.constant);
+    }
+    Sum &scale(double c) {
+        for (auto &t : terms)
+            t.first *= c;
+        constant *= c;
+        return *this;
+    }
+
+    Sum &operator+=(const Sum &other) { return add(other); }
+    friend Sum operator+(Sum a, const Sum &b) { return a.add(b); }
+    friend Sum operator-(Sum a, const Sum &b) { return a.add(-b); }
+    friend Sum operator-(Sum a) { return a.scale(-1); }
+    friend Sum operator*(const Sum &a, const Sum &b) {
+        Sum product = a.constant * b.constant;
+        for (auto &s : a.terms) {
+            product.add(s.first * b.constant, s.second);
+            for (auto &t : b.terms) {
+                vector<string> symbols = s.second;
+                symbols.insert(symbols.end(), t.second.begin(), t.second.end());
+                product.add(s.first * t.first, symbols);
+            }
+        }
+        for (auto &t : b.terms)
+            product.add(a.constant * t.first, t.second);
+        return product;
+    }
+
+    /// Check whether the sum is identically zero.
+    bool isZero() const {
+        for (auto &t : terms)
+            if (t.first != 0)
+                return false;
+        return constant == 0;
+    }
+
+    string str() const {
+        ostringstream s;
+        bool first = true;
+        auto sign  = [&](bool negative) {
+            if (first)
+                s << (negative ? "-" : "");
+            else
+                s << (negative ? " - " : " + ");
+            first = false;
+        };
+        for (auto &t : terms) {
+            if (t.first == 0)
+                continue;
+            sign(t.first < 0);
+            double c = abs(t.first);
+            if (c != 1)
+                s << literal(c) << " * ";
+            for (size_t i = 0; i < t.second.size(); ++i)
+                s << (i == 0 ? "" : " * ") << t.second[i];
+        }
+        if (constant != 0 || first) {
+            sign(constant < 0);
+            s << literal(abs(constant));
+        }
+        return s.str();
+    }
+
+  private:
+    /// Add a term with the given symbols, in any order.
+    Sum &add(double c, vector<string> symbols) {
+        sort(symbols.begin(), symbols.end());
+        for (auto &t : terms)
+            if (t.second == symbols) {
+                t.first += c;
+                return *this;
+            }
+        terms.push_back({c, move(symbols)});
+        return *this;
+    }
+
+    vector<pair<double, vector<string>>> terms;
+    double constant = 0;
+};
+
+/// Product of two symbols, or an empty name if either is known to be zero.
+string mul(const string &a, const string &b) {
+    return a.empty() || b.empty() ? "" : a + " * " + b;
+}
+
+/**
+ * Hamiltonian product of the quaternions q and r (or the conjugate of r) as
+ * four sums, given the names of their components.
+ */
+array<Sum, 4> quatProduct(const array<string, 4> &q, const array<string, 4> &r,
+                          bool conjugateR = false) {
+    double s = conjugateR ? -1 : 1;
+    array<Sum, 4> p;
+    p[0].add(1, mul(r[0], q[0])).add(-s, mul(r[1], q[1]));
+    p[0].add(-s, mul(r[2], q[2])).add(-s, mul(r[3], q[3]));
+    p[1].add(1, mul(r[0], q[1])).add(s, mul(r[1], q[0]));
+    p[1].add(-s, mul(r[2], q[3])).add(s, mul(r[3], q[2]));
+    p[2].add(1, mul(r[0], q[2])).add(s, mul(r[1], q[3]));
+    p[2].add(s, mul(r[2], q[0])).add(-s, mul(r[3], q[1]));
+    p[3].add(1, mul(r[0], q[3])).add(-s, mul(r[1], q[2]));
+    p[3].add(s, mul(r[2], q[1])).add(s, mul(r[3], q[0]));
+    return p;
+}
+
+/**
+ * Write `const double name = sum;` and return the name, or return an empty
+ * name without writing anything if the sum is identically zero.
+ */
+string define(ostream &os, const string &name, const Sum &sum) {
+    if (sum.isZero())
+        return "";
+    os << "    const double " << name << " = " << sum.str() << ";\n";
+    return name;
+}
+
+void assign(ostream &os, const string &name, const Sum &sum) {
+    os << "    " << name << " = " << sum.str() << ";\n";
+}
+
+/// The real part of the quaternion with the given reduced quaternion.
+string red2quat(const array<string, 3> &r) {
+    string s = "std::sqrt(1.0";
+    for (auto &ri : r)
+        if (!ri.empty())
+            s += " - " + ri + " * " + ri;
+    return s + ")";
+}
+
+template <size_t R, size_t C>
+void writeMatrix(ostream &os, const string &name, const Matrix<R, C> &M) {
+    os << "constexpr double " << name << "[" << R << "][" << C << "] = {\n";
+    for (size_t r = 0; r < R; ++r) {
+        os << "    {";
+        for (size_t c = 0; c < C; ++c)
+            os << (c == 0 ? "" : ", ") << literal(M[r][c]);
+        os << "},\n";
+    }
+    os << "};\n";
+}
+
+/* ------ Dynamics ---------------------------------------------------------- */
+
+/**
+ * Context of evaluateDroneDynamics for symbolic evaluation: the parameters
+ * are constants, and values that are used more than once are written as
+ * local variables.
+ */
+class SymbolicContext {
+  public:
+    SymbolicContext(ostream &os) : os{os} {}
+    template <class T>
+    double param(T value) const {
+        return value;
+    }
+    Sum let(const string &name, const Sum &value) const {
+        return Sum().add(1, define(os, name, value));
+    }
+
+  private:
+    ostream &os;
+};
+
+void writeDynamics(ostream &os, const DroneParamsAndMatrices &p) {
+    os << "/// Derivative of the state vector x, given the input u, written to "
+          "x_dot.\n"
+          "inline void dynamics(const double x[17], const double u[4],\n"
+          "                     double x_dot[17]) {\n";
+    array<Sum, Nx> x, x_dot;
+    array<Sum, Nu> u;
+    for (size_t i = 0; i < Nx; ++i)
+        x[i].add(1, at("x", i));
+    for (size_t i = 0; i < Nu; ++i)
+        u[i].add(1, at("u", i));
+    evaluateDroneDynamics<Sum>(SymbolicContext{os}, p, x, u, x_dot);
+    for (size_t i = 0; i < Nx; ++i)
+        assign(os, at("x_dot", i), x_dot[i]);
+    os << "}\n\n";
+}
+
+/* ------ Controller -------------------------------------------------------- */
+
+void writeController(ostream &os, const DroneParamsAndMatrices &p,
+                     const Matrix<Nu_att, Nx_att - 1> &K) {
+    const auto &G = p.G_att;
+    os << "/// Attitude LQR controller output for state x and reference r, "
+          "without clamping.\n"
+          "inline void attitudeControllerRaw(const double x[10], "
+          "const double r[7],\n"
+          "                                  double u[3]) {\n";
+
+    // Equilibrium orientation q_eq = G_q r
+    array<string, 4> qeq;
+    for (size_t i = 0; i < 4; ++i) {
+        Sum s;
+        for (size_t j = 0; j < Ny_att; ++j)
+            s.add(G[i][j], at("r", j));
+        qeq[i] = define(os, var("qeq", i), s);
+    }
+
+    // Vector part of the orientation error q ⊗ q_eq*
+    array<string, 4> q = {"x[0]", "x[1]", "x[2]", "x[3]"};
+    array<Sum, 4> qe   = quatProduct(q, qeq, true);
+    array<string, 3> e;
+    for (size_t i = 0; i < 3; ++i)
+        e[i] = define(os, var("e", i), qe[i + 1]);
+
+    // u = K_q e_q + K_x (x - G_x r) + G_u r
+    //   = K_q e_q + K_x x + (G_u - K_x G_x) r
+    for (size_t k = 0; k < Nu_att; ++k) {
+        Sum u;
+        for (size_t i = 0; i < 3; ++i)
+            u.add(K[k][i], e[i]);
+        for (size_t i = 3; i < Nx_att - 1; ++i)
+            u.add(K[k][i], at("x", i + 1));
+        for (size_t j = 0; j < Ny_att; ++j) {
+            double c = G[Nx_att + k][j];
+            for (size_t i = 3; i < Nx_att - 1; ++i)
+                c -= K[k][i] * G[i + 1][j];
+            u.add(c, at("r", j));
+        }
+        assign(os, at("u", k), u);
+    }
+    os << "}\n\n";
+
+    double uh       = p.uh;
+    double otherMax = 1 - abs(uh);
+    double e_       = numeric_limits<double>::epsilon() + 1.0;
+    os << "/// Attitude LQR controller output for state x and reference r, "
+          "clamped using\n"
+          "/// the hover thrust as the common thrust.\n"
+          "inline void attitudeController(const double x[10], "
+          "const double r[7],\n"
+          "                               double u[3]) {\n"
+          "    attitudeControllerRaw(x, r, u);\n"
+          "    double other_actual = "
+          "std::abs(u[0]) + std::abs(u[1]) + std::abs(u[2]);\n"
+          "    if (other_actual > "
+       << literal(otherMax)
+       << ") {\n"
+          "        const double s = "
+       << literal(otherMax)
+       << " / other_actual;\n"
+          "        for (int i = 0; i < 3; ++i)\n"
+          "            u[i] = s * u[i];\n"
+          "        other_actual = "
+          "std::abs(u[0]) + std::abs(u[1]) + std::abs(u[2]);\n"
+          "    }\n"
+          "    if (other_actual > "
+       << literal(abs(uh))
+       << ")\n"
+          "        for (int i = 0; i < 3; ++i)\n"
+          "            u[i] = "
+       << literal(uh) << " / other_actual * u[i] / " << literal(e_)
+       << ";\n"
+          "}\n\n";
+}
+
+/* ------ Observer ---------------------------------------------------------- */
+
+void writeObserver(ostream &os, const DroneParamsAndMatrices &p,
+                   const Matrix<Nx_att - 1, Ny_att - 1> &L) {
+    const auto &A = p.Ad_att_r;
+    const auto &B = p.Bd_att_r;
+    const auto &C = p.Cd_att;
+    os << "/// Next estimated state, given the estimated state x_hat, the "
+          "measurement y\n"
+          "/// and the control input u.\n"
+          "inline void attitudeObserver(const double x_hat[10], "
+          "const double y[7],\n"
+          "                             const double u[3], "
+          "double x_hat_next[10]) {\n";
+
+    // Estimated orientation C_q x̂
+    array<string, 4> cx;
+    for (size_t i = 0; i < 4; ++i) {
+        Sum s;
+        for (size_t j = 0; j < Nx_att; ++j)
+            s.add(C[i][j], at("x_hat", j));
+        cx[i] = define(os, var("cx", i), s);
+    }
+
+    // Vector part of the orientation error y_q ⊗ (C_q x̂)*
+    array<string, 4> yq = {"y[0]", "y[1]", "y[2]", "y[3]"};
+    array<Sum, 4> yqd   = quatProduct(yq, cx, true);
+    array<string, 3> yd;
+    for (size_t i = 0; i < 3; ++i)
+        yd[i] = define(os, var("yd", i), yqd[i + 1]);
+
+    // Correction L (y ⊖ C x̂) and model prediction A x̂_r + B u, where the
+    // linear part of the output error is folded into the coefficients of y
+    // and x̂
+    array<Sum, Nx_att - 1> corr, model;
+    for (size_t j = 0; j < Nx_att - 1; ++j) {
+        for (size_t k = 0; k < 3; ++k)
+            corr[j].add(L[j][k], yd[k]);
+        for (size_t k = 3; k < Ny_att - 1; ++k) {
+            corr[j].add(L[j][k], at("y", k + 1));
+            for (size_t m = 0; m < Nx_att; ++m)
+                corr[j].add(-L[j][k] * C[k + 1][m], at("x_hat", m));
+        }
+        for (size_t i = 0; i < Nx_att - 1; ++i)
+            model[j].add(A[j][i], at("x_hat", i + 1));
+        for (size_t i = 0; i < Nu_att; ++i)
+            model[j].add(B[j][i], at("u", i));
+    }
+
+    // Orientation: (red2quat(A x̂_r + B u)) ⊗ red2quat(L (y ⊖ C x̂))
+    array<string, 4> mq, lq;
+    array<string, 3> mr, lr;
+    for (size_t i = 0; i < 3; ++i) {
+        mr[i] = define(os, var("m", i), model[i]);
+        lr[i] = define(os, var("l", i), corr[i]);
+    }
+    os << "    const double mq = " << red2quat(mr) << ";\n"
+       << "    const double lq = " << red2quat(lr) << ";\n";
+    mq = {"mq", mr[0], mr[1], mr[2]};
+    lq = {"lq", lr[0], lr[1], lr[2]};
+    array<Sum, 4> qnext = quatProduct(mq, lq);
+    for (size_t i = 0; i < 4; ++i)
+        assign(os, at("x_hat_next", i), qnext[i]);
+
+    // Angular velocity and motor speeds: (A x̂_r + B u) + L (y - C x̂)
+    for (size_t j = 3; j < Nx_att - 1; ++j)
+        assign(os, at("x_hat_next", j + 1), Sum(model[j]).add(corr[j]));
+    os << "}\n\n";
+}
+
+}  // namespace
+
+void generateDroneCode(ostream &os, const DroneParamsAndMatrices &p,
+                       const Matrix<Nu_att, Nx_att - 1> &K_att,
+                       const Matrix<Nx_att - 1, Ny_att - 1> &L_att,
+                       const string &ns) {
+    os << "// Generated by generateDroneCode, do not edit.\n"
+          "#pragma once\n\n"
+          "#include <cmath>\n"
+          "#include <limits>\n\n"
+          "namespace "
+       << ns
+       << " {\n\n"
+          "/// Sample time of the attitude controller and observer.\n"
+          "constexpr double Ts_att = "
+       << literal(p.Ts_att)
+       << ";\n"
+          "/// Hover control signal.\n"
+          "constexpr double uh = "
+       << literal(p.uh) << ";\n";
+    os << "/// Gain of the attitude controller.\n";
+    writeMatrix(os, "K_att", K_att);
+    os << "/// Gain of the attitude observer.\n";
+    writeMatrix(os, "L_att", L_att);
+    os << "\n";
+    writeDynamics(os, p);
+    writeController(os, p, K_att);
+    writeObserver(os, p, L_att);
+    os << "}  // namespace " << ns << "\n";
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <Drone.hpp>
+#include <LeastSquares.hpp>
+
+#include <filesystem>
+
+/// The drone parameters and matrices used by the tests.
+static const std::filesystem::path loadPath =
+    std::filesystem::path(__FILE__).parent_path() / ".." / ".." / "py-drone" /
+    "test" / "ParamsAndMatrices";
+
+/**
+ * Solve the discrete algebraic Riccati equation by fixed-point iteration,
+ * so the tests don't depend on LAPACK.
+ */
+template <size_t Nx, size_t Nu>
+Matrix<Nx, Nx> iterativeDARE(const Matrix<Nx, Nx> &A, const Matrix<Nx, Nu> &B,
+                             const Matrix<Nx, Nx> &Q,
+                             const Matrix<Nu, Nu> &R) {
+    Matrix<Nx, Nx> P = Q;
+    for (size_t i = 0; i < 5000; ++i) {
+        Matrix<Nu, Nx> K =
+            solveLeastSquares(R + transpose(B) * P * B, transpose(B) * P * A);
+        P = Q + transpose(A) * P * (A - B * K);
+    }
+    return P;
+}
+
+/// The LQR gain, using iterativeDARE.
+template <size_t Nx, size_t Nu>
+Matrix<Nu, Nx> iterativeDLQR(const Matrix<Nx, Nx> &A, const Matrix<Nx, Nu> &B,
+                             const Matrix<Nx, Nx> &Q,
+                             const Matrix<Nu, Nu> &R) {
+    Matrix<Nx, Nx> P = iterativeDARE(A, B, Q, R);
+    return solveLeastSquares(R + transpose(B) * P * B, transpose(B) * P * A);
+}
+
+/// An attitude controller with reasonably fast step responses.
+inline Drone::FixedClampAttitudeController
+getTestAttitudeController(const Drone &drone) {
+    const RowVector<Nx_att - 1> Q = {1e3, 1e3, 1e3, 1, 1, 1, 1, 1, 1};
+    Matrix<Nu_att, Nx_att - 1> K  = -iterativeDLQR(
+        drone.p.Ad_att_r, drone.p.Bd_att_r, diag(Q), eye<Nu_att>());
+    return drone.getFixedClampAttitudeController(K);
+}
@@ -0,0 +1,118 @@
+// Generated by generateDroneCode, do not edit.
+#pragma once
+
+#include <cmath>
+#include <limits>
+
+namespace GeneratedDrone {
+
+/// Sample time of the attitude controller and observer.
+constexpr double Ts_att = 0.0042016806722689074;
+/// Hover control signal.
+constexpr double uh = 0.56205669417021442;
+/// Gain of the attitude controller.
+constexpr double K_att[3][9] = {
+    {-3.589571247330416, 0.0, 0.0, -0.37069907706570948, 0.0, 0.0, -0.020104316630490872, 0.0, 0.0},
+    {0.0, -3.6081669580346802, 0.0, 0.0, -0.37390514770211941, 0.0, 0.0, -0.01946929207394112, 0.0},
+    {0.0, 0.0, -1.3271458118996871, 0.0, 0.0, -0.16378984534002183, 0.0, 0.0, 0.0067651028492788472},
+};
+/// Gain of the attitude observer.
+constexpr double L_att[9][6] = {
+    {0.0015945548368076195, 0.0, 0.0, 0.0019440150349009672, 0.0, 0.0},
+    {0.0, 0.0015806945743726266, 0.0, 0.0, 0.0019488064181058474, 0.0},
+    {0.0, 0.0, 0.0013322245099290123, 0.0, 0.0, 0.00094289680536189342},
+    {0.0011237443024994377, 0.0, 0.0, 0.1331592928764391, 0.0, 0.0},
+    {0.0, 0.0011070222024167093, 0.0, 0.0, 0.12805114935578957, 0.0},
+    {0.0, 0.0, 0.00054504460811658569, 0.0, 0.0, 0.0019561842814922216},
+    {-0.00038206150009946406, 0.0, 0.0, 0.68774137385211165, 0.0, 0.0},
+    {0.0, -0.00036382980558204365, 0.0, 0.0, 0.67173143057607643, 0.0},
+    {0.0, 0.0, 6.8250273732944005e-05, 0.0, 0.0, 0.012993026598640838},
+};
+
+/// Derivative of the state vector x, given the input u, written to x_dot.
+inline void dynamics(const double x[17], const double u[4],
+                     double x_dot[17]) {
+    const double a_z = 0.29950674030899088 * x[16] + 0.0022860419849775053 * x[16] * x[16] + 0.0022860419849775053 * x[7] * x[7] + 0.0022860419849775053 * x[8] * x[8] + 0.0022860419849775053 * x[9] * x[9] + 9.8100000000000005;
+    x_dot[0] = -0.5 * x[1] * x[4] - 0.5 * x[2] * x[5] - 0.5 * x[3] * x[6];
+    x_dot[1] = 0.5 * x[0] * x[4] - 0.5 * x[3] * x[5] + 0.5 * x[2] * x[6];
+    x_dot[2] = 0.5 * x[3] * x[4] + 0.5 * x[0] * x[5] - 0.5 * x[1] * x[6];
+    x_dot[3] = -0.5 * x[2] * x[4] + 0.5 * x[1] * x[5] + 0.5 * x[0] * x[6];
+    x_dot[4] = 3.2955056672349254 * x[7] - 0.7320872274143303 * x[5] * x[6];
+    x_dot[5] = 0.74705882352941189 * x[4] * x[6] + 3.1113450564188558 * x[8];
+    x_dot[6] = -0.033043478260869667 * x[4] * x[5] - 1.9360346773861661 * x[9] + 247.43788324154383 * u[2];
+    x_dot[7] = 3329.9999999999995 * u[0] - 28.571428571428569 * x[7];
+    x_dot[8] = 3329.9999999999995 * u[1] - 28.571428571428569 * x[8];
+    x_dot[9] = 3329.9999999999995 * u[2] - 28.571428571428569 * x[9];
+    x_dot[10] = 2.0 * a_z * x[1] * x[3] + 2.0 * a_z * x[0] * x[2];
+    x_dot[11] = 2.0 * a_z * x[2] * x[3] - 2.0 * a_z * x[0] * x[1];
+    x_dot[12] = a_z - 2.0 * a_z * x[1] * x[1] - 2.0 * a_z * x[2] * x[2] - 9.8100000000000005;
+    x_dot[13] = x[10];
+    x_dot[14] = x[11];
+    x_dot[15] = x[12];
+    x_dot[16] = 3329.9999999999995 * u[3] - 28.571428571428569 * x[16];
+}
+
+/// Attitude LQR controller output for state x and reference r, without clamping.
+inline void attitudeControllerRaw(const double x[10], const double r[7],
+                                  double u[3]) {
+    const double qeq0 = r[0];
+    const double qeq1 = r[1];
+    const double qeq2 = r[2];
+    const double qeq3 = r[3];
+    const double e0 = qeq0 * x[1] - qeq1 * x[0] + qeq2 * x[3] - qeq3 * x[2];
+    const double e1 = qeq0 * x[2] - qeq1 * x[3] - qeq2 * x[0] + qeq3 * x[1];
+    const double e2 = qeq0 * x[3] + qeq1 * x[2] - qeq2 * x[1] - qeq3 * x[0];
+    u[0] = -3.589571247330416 * e0 - 0.37069907706570948 * x[4] - 0.020104316630490872 * x[7] + 0.37069286985266636 * r[4];
+    u[1] = -3.6081669580346802 * e1 - 0.37390514770211941 * x[5] - 0.01946929207394112 * x[8] + 0.37389876293401952 * r[5];
+    u[2] = -1.3271458118996871 * e2 - 0.16378984534002183 * x[6] + 0.0067651028492788472 * x[9] + 0.1637840249845447 * r[6];
+}
+
+/// Attitude LQR controller output for state x and reference r, clamped using
+/// the hover thrust as the common thrust.
+inline void attitudeController(const double x[10], const double r[7],
+                               double u[3]) {
+    attitudeControllerRaw(x, r, u);
+    double other_actual = std::abs(u[0]) + std::abs(u[1]) + std::abs(u[2]);
+    if (other_actual > 0.43794330582978558) {
+        const double s = 0.43794330582978558 / other_actual;
+        for (int i = 0; i < 3; ++i)
+            u[i] = s * u[i];
+        other_actual = std::abs(u[0]) + std::abs(u[1]) + std::abs(u[2]);
+    }
+    if (other_actual > 0.56205669417021442)
+        for (int i = 0; i < 3; ++i)
+            u[i] = 0.56205669417021442 / other_actual * u[i] / 1.0000000000000002;
+}
+
+/// Next estimated state, given the estimated state x_hat, the measurement y
+/// and the control input u.
+inline void attitudeObserver(const double x_hat[10], const double y[7],
+                             const double u[3], double x_hat_next[10]) {
+    const double cx0 = x_hat[0];
+    const double cx1 = x_hat[1];
+    const double cx2 = x_hat[2];
+    const double cx3 = x_hat[3];
+    const double yd0 = cx0 * y[1] - cx1 * y[0] + cx2 * y[3] - cx3 * y[2];
+    const double yd1 = cx0 * y[2] - cx1 * y[3] - cx2 * y[0] + cx3 * y[1];
+    const double yd2 = cx0 * y[3] + cx1 * y[2] - cx2 * y[1] - cx3 * y[0];
+    const double m0 = x_hat[1] + 0.0021008403361344537 * x_hat[4] + 1.3979844768739008e-05 * x_hat[7] + 6.5847107510608714e-05 * u[0];
+    const double l0 = 0.0015945548368076195 * yd0 + 0.0019440150349009672 * y[4] - 0.0019440150349009672 * x_hat[4];
+    const double m1 = x_hat[2] + 0.0021008403361344537 * x_hat[5] + 1.3198618149309471e-05 * x_hat[8] + 6.2167416208545293e-05 * u[1];
+    const double l1 = 0.0015806945743726266 * yd1 - 0.0019488064181058474 * x_hat[5] + 0.0019488064181058474 * y[5];
+    const double m2 = x_hat[3] + 0.0021008403361344537 * x_hat[6] - 8.2128410598254026e-06 * x_hat[9] + 0.0010533908709510554 * u[2];
+    const double l2 = 0.0013322245099290123 * yd2 - 0.00094289680536189342 * x_hat[6] + 0.00094289680536189342 * y[6];
+    const double mq = std::sqrt(1.0 - m0 * m0 - m1 * m1 - m2 * m2);
+    const double lq = std::sqrt(1.0 - l0 * l0 - l1 * l1 - l2 * l2);
+    x_hat_next[0] = lq * mq - l0 * m0 - l1 * m1 - l2 * m2;
+    x_hat_next[1] = lq * m0 + l0 * mq - l1 * m2 + l2 * m1;
+    x_hat_next[2] = lq * m1 + l0 * m2 + l1 * mq - l2 * m0;
+    x_hat_next[3] = lq * m2 - l0 * m1 + l1 * m0 + l2 * mq;
+    x_hat_next[4] = 0.86684070712356087 * x_hat[4] + 0.013047814194874266 * x_hat[7] + 0.093105766159801776 * u[0] + 0.0011237443024994377 * yd0 + 0.1331592928764391 * y[4];
+    x_hat_next[5] = 0.87194885064421046 * x_hat[5] + 0.012318671636925406 * x_hat[8] + 0.087902796874401098 * u[1] + 0.0011070222024167093 * yd1 + 0.12805114935578957 * y[5];
+    x_hat_next[6] = 0.99804381571850775 * x_hat[6] - 0.0076652942813972298 * x_hat[9] + 0.98495745014468827 * u[2] + 0.00054504460811658569 * yd2 + 0.0019561842814922216 * y[6];
+    x_hat_next[7] = -0.68774137385211165 * x_hat[4] + 0.8868778485230423 * x_hat[7] + 13.184386754639419 * u[0] - 0.00038206150009946406 * yd0 + 0.68774137385211165 * y[4];
+    x_hat_next[8] = -0.67173143057607643 * x_hat[5] + 0.8868778485230423 * x_hat[8] + 13.184386754639421 * u[1] - 0.00036382980558204365 * yd1 + 0.67173143057607643 * y[5];
+    x_hat_next[9] = -0.012993026598640838 * x_hat[6] + 0.8868778485230423 * x_hat[9] + 13.184386754639419 * u[2] + 6.8250273732944005e-05 * yd2 + 0.012993026598640838 * y[6];
+}
+
+}  // namespace GeneratedDrone
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include <Degrees.hpp>
+#include <Drone.hpp>
+#include <StepResponseAnalyzer.hpp>
+
+#include "DroneTestHelpers.hpp"
+
+#include <cstdlib>
+#include <new>
+
+/* ------ Count all heap allocations ---------------------------------------- */
+
+static bool countAllocations = false;
+static size_t allocations    = 0;
+
+void *operator new(size_t size) {
+    if (countAllocations)
+        ++allocations;
+    if (void *ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+    throw std::bad_alloc();
+}
+// Not inlined, otherwise newer versions of GCC warn about calling free on a
+// pointer returned by operator new.
+[[gnu::noinline]] void operator delete(void *ptr) noexcept { std::free(ptr); }
+[[gnu::noinline]] void operator delete(void *ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+/* ------ Tests ------------------------------------------------------------- */
+
+/**
+ * Simulates a step response of the attitude model in exactly the same way as
+ * `getRiseTimeCost` in the tuner, and checks that the simulation loop doesn't
+ * allocate any memory.
+ */
+TEST(AllocationFree, tunerInnerLoop) {
+    Drone drone                    = {loadPath};
+    Drone::AttitudeModel attmodel  = drone.getAttitudeModel();
+    const DroneAttitudeState attx0 = drone.getStableState().getAttitude();
+    Drone::FixedClampAttitudeController attctrl =
+        getTestAttitudeController(drone);
+
+    AdaptiveODEOptions opt = {};
+    opt.t_start            = 0;
+    opt.t_end              = 1;
+    opt.epsilon            = 1e-4;
+    opt.h_start            = 1e-4;
+    opt.h_min              = 1e-7;
+    opt.maxiter            = 1e5;
+
+    const Quaternion q_ref = eul2quat({0, 0, 22.5_deg});
+    DroneAttitudeOutput y_ref;
+    y_ref.setOrientation(q_ref);
+    const DroneAttitudeOutput atty0 = attmodel.getOutput(attx0, {});
+    const Quaternion q0             = atty0.getOrientation();
+    ConstantTimeFunctionT<ColVector<Ny_att>> y_ref_f = {y_ref};
+    StepResponseAnalyzer<4> analyzer = {q_ref, 0.01, q0};
+
+    size_t samples = 0;
+    auto f         = [&](double t, const ColVector<Nx_att> &x,
+                 const ColVector<Nu_att> &u) {
+        ++samples;
+        DroneAttitudeOutput y = attmodel.getOutput(x, u);
+        return analyzer(t, y.getOrientation());
+    };
+
+    allocations      = 0;
+    countAllocations = true;
+    ODEResultCode resultCode =
+        attmodel.simulateRealTime(attctrl, y_ref_f, attx0, opt, f);
+    countAllocations = false;
+
+    EXPECT_EQ(allocations, 0);
+    EXPECT_FALSE(resultCode & ODEResultCodes::MAXIMUM_ITERATIONS_EXCEEDED);
+    EXPECT_GT(samples, 10);
+    // The controller should actually track the reference
+    auto result = analyzer.getResult();
+    EXPECT_NE(result.risetime[1], -1.0);
+}
+
+/**
+ * The in-place integration should give exactly the same result as the
+ * allocating end-result integration.
+ */
+TEST(AllocationFree, advanceEqualsSimulateEndResult) {
+    Drone drone                   = {loadPath};
+    Drone::AttitudeModel attmodel = drone.getAttitudeModel();
+    DroneAttitudeState x          = drone.getStableState().getAttitude();
+    x.setAngularVelocity({1, -2, 0.5});
+    const ColVector<Nu_att> u = {0.01, -0.02, 0.005};
+
+    AdaptiveODEOptions opt = {};
+    opt.t_start            = 0;
+    opt.t_end              = drone.p.Ts_att;
+    opt.epsilon            = 1e-6;
+    opt.h_start            = 1e-4;
+    opt.h_min              = 1e-8;
+    opt.maxiter            = 1e5;
+
+    auto expected = attmodel.simulateEndResult(u, x, opt);
+
+    ColVector<Nx_att> x_adv = x;
+    allocations             = 0;
+    countAllocations        = true;
+    auto result             = attmodel.advance(u, x_adv, opt);
+    countAllocations        = false;
+
+    EXPECT_EQ(allocations, 0);
+    EXPECT_EQ(result.first, expected.resultCode);
+    EXPECT_EQ(result.second, expected.iterations);
+    EXPECT_EQ(x_adv, expected.solution[0]);
+}
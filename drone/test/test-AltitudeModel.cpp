@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <Drone.hpp>
+
+#include "DroneTestHelpers.hpp"
+
+#include <vector>
+
+/**
+ * For a level drone with the attitude motors at rest, the altitude model
+ * should have the same dynamics as the altitude states of the full model.
+ */
+TEST(AltitudeModel, stateChange) {
+    Drone drone                   = {loadPath};
+    Drone::AltitudeModel altmodel = drone.getAltitudeModel();
+    DroneState x                  = drone.getStableState();
+    x.setAltitude({3.5, 1.2, -0.4});
+    x.setVelocity({0.3, -0.2, -0.4});
+    DroneControl u = {{0, 0, 0}, {0.05}};
+
+    DroneState x_dot              = drone(x, u);
+    ColVector<Nx_alt> x_dot_alt   = altmodel(x.getAltitude(), {0.05});
+    ColVector<Nx_alt> expected    = x_dot.getAltitude();
+    EXPECT_TRUE(isAlmostEqual(x_dot_alt, expected, 1e-12));
+    EXPECT_EQ(altmodel.getOutput(x.getAltitude(), {0.05}), ColVector<1>{1.2});
+
+    // Hovering is an equilibrium
+    EXPECT_TRUE(isAlmostEqual(altmodel({0, 0, 0}, {0}), {0, 0, 0}, 1e-12));
+}
+
+/**
+ * A step response of the altitude controller with the altitude model should
+ * be the same as the altitude response of the full model, when the attitude
+ * is kept level.
+ */
+TEST(AltitudeModel, stepResponse) {
+    Drone drone                   = {loadPath};
+    Drone::AltitudeModel altmodel = drone.getAltitudeModel();
+
+    const auto Q             = diag(RowVector<Nx_alt>{1, 100, 10});
+    Matrix<Nu_alt, Nx_alt> K = iterativeDLQR(drone.p.Ad_alt, drone.p.Bd_alt, Q,
+                                             eye<Nu_alt>());
+    Matrix<1, 4> K_pi = hcat(K, Matrix<1, 1>{-0.01});
+    Drone::ClampAltitudeController altctrl =
+        drone.getClampAltitudeController(K_pi, 0.1);
+
+    AdaptiveODEOptions opt = {};
+    opt.t_start            = 0;
+    opt.t_end              = 5;
+    opt.epsilon            = 1e-8;
+    opt.h_start            = 1e-4;
+    opt.h_min              = 1e-10;
+    opt.maxiter            = 1e6;
+
+    const ColVector<Ny_alt> z_ref = {0.5};
+    ConstantTimeFunctionT<ColVector<Ny_alt>> z_ref_f = {z_ref};
+
+    std::vector<double> z_alt;
+    auto f_alt = [&](double, const ColVector<Nx_alt> &x,
+                     const ColVector<Nu_alt> &) {
+        z_alt.push_back(x[1][0]);
+        return true;
+    };
+    ODEResultCode resultCode = altmodel.simulateRealTime(
+        altctrl, z_ref_f, {0, 0, 0}, opt, f_alt);
+    EXPECT_FALSE(resultCode & ODEResultCodes::MAXIMUM_ITERATIONS_EXCEEDED);
+
+    // The full model, with the same altitude controller and a level attitude
+    altctrl.reset();
+    Drone::FixedClampAttitudeController attctrl =
+        getTestAttitudeController(drone);
+    Drone::ControllerT<Drone::FixedClampAttitudeController,
+                       Drone::ClampAltitudeController>
+        ctrl = {attctrl, altctrl, drone.p.uh};
+    DroneReference r;
+    r.setOrientation(eul2quat({0, 0, 0}));
+    r.setPosition({0, 0, z_ref[0][0]});
+    ConstantTimeFunctionT<ColVector<Ny>> r_f = {r};
+
+    std::vector<double> z_full;
+    const size_t subsample = round(drone.p.Ts_alt / drone.p.Ts_att);
+    size_t k               = 0;
+    auto f_full = [&](double, const ColVector<Nx> &x, const ColVector<Nu> &) {
+        if (k++ % subsample == 0)
+            z_full.push_back(DroneState{x}.getPosition()[2][0]);
+        return true;
+    };
+    drone.simulateRealTime(ctrl, r_f, drone.getStableState(), opt, f_full);
+
+    ASSERT_GT(z_alt.size(), 10);
+    ASSERT_GE(z_full.size(), z_alt.size());
+    for (size_t i = 0; i < z_alt.size(); ++i)
+        EXPECT_NEAR(z_alt[i], z_full[i], 1e-6) << i;
+    // The controller should actually reach the reference
+    EXPECT_NEAR(z_alt.back(), z_ref[0][0], 0.05);
+}
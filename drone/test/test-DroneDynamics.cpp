@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include <Drone.hpp>
+
+#include "DroneTestHelpers.hpp"
+
+#include <random>
+
+/**
+ * The fused dynamics should give the same result as the straightforward
+ * reference implementation, up to rounding errors.
+ */
+TEST(DroneDynamics, equalsReference) {
+    Drone drone = {loadPath};
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> dist(-1, 1);
+    auto random = [&](double scale) { return scale * dist(rng); };
+
+    for (size_t i = 0; i < 1000; ++i) {
+        DroneState x;
+        Quaternion q = {random(1), random(1), random(1), random(1)};
+        x.setOrientation(q / norm(q));
+        x.setAngularVelocity({random(5), random(5), random(5)});
+        x.setMotorSpeed({random(20), random(20), random(20)});
+        x.setVelocity({random(2), random(2), random(2)});
+        x.setPosition({random(10), random(10), random(10)});
+        x.setThrustMotorSpeed(random(20));
+        DroneControl u = {{random(0.5), random(0.5), random(0.5)},
+                          {random(0.5)}};
+
+        Drone::VecX_t expected = drone.referenceStateChange(x, u);
+        Drone::VecX_t result   = drone(x, u);
+        Drone::VecX_t result_inplace;
+        drone.getStateChange(x, u, result_inplace);
+
+        for (size_t j = 0; j < Nx; ++j)
+            EXPECT_NEAR(result[j][0], expected[j][0],
+                        1e-12 * std::max(1.0, std::abs(expected[j][0])))
+                << "i = " << i << ", j = " << j;
+        EXPECT_EQ(result, result_inplace);
+    }
+}
+
+/**
+ * Modifications of the parameters take effect immediately, the dynamics don't
+ * cache any constants.
+ */
+TEST(DroneDynamics, parametersModified) {
+    Drone drone            = {loadPath};
+    DroneState x           = drone.getStableState();
+    DroneControl u         = {{0.1, 0.2, 0.3}, {0.1}};
+    Drone::VecX_t original = drone(x, u);
+
+    drone.p.m *= 2;
+    drone.p.k2 *= 3;
+    EXPECT_NE(drone(x, u), original);
+    EXPECT_TRUE(isAlmostEqual(drone(x, u), drone.referenceStateChange(x, u),
+                              1e-12));
+}
+
+/**
+ * A default-constructed drone uses the parameters that are loaded later.
+ */
+TEST(DroneDynamics, defaultConstructed) {
+    Drone loaded   = {loadPath};
+    Drone drone    = {};
+    DroneState x   = loaded.getStableState();
+    DroneControl u = {{0.1, 0.2, 0.3}, {0.1}};
+    drone.p.load(loadPath);
+    EXPECT_EQ(drone(x, u), loaded(x, u));
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include <Degrees.hpp>
+#include <Drone.hpp>
+#include <DroneFleet.hpp>
+
+#include "DroneTestHelpers.hpp"
+
+#include <random>
+
+/// Parameters of N airframes with random perturbations of up to 20 %.
+static std::vector<DroneParamsAndMatrices>
+getPerturbedParameters(const DroneParamsAndMatrices &p, size_t N) {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> dist(0.8, 1.2);
+    std::vector<DroneParamsAndMatrices> result;
+    for (size_t i = 0; i < N; ++i)
+        result.push_back(perturbAirframe(
+            p, {dist(rng), dist(rng), dist(rng), dist(rng)}));
+    return result;
+}
+
+/**
+ * Every drone in the fleet should have the same dynamics as a single drone
+ * with the same parameters.
+ */
+TEST(DroneFleet, stateChange) {
+    constexpr size_t N  = 8;
+    Drone drone         = {loadPath};
+    auto params         = getPerturbedParameters(drone.p, N);
+    DroneFleet<N> fleet = {params};
+
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<double> dist(-1, 1);
+    DroneFleet<N>::MatX_t x;
+    DroneFleet<N>::MatU_t u;
+    for (size_t d = 0; d < N; ++d) {
+        DroneState x_d = drone.getStableState();
+        x_d.setOrientation(eul2quat({dist(rng), dist(rng), dist(rng)}));
+        x_d.setAngularVelocity({dist(rng), dist(rng), dist(rng)});
+        x_d.setMotorSpeed({10 * dist(rng), 10 * dist(rng), 10 * dist(rng)});
+        x_d.setThrustMotorSpeed(10 * dist(rng));
+        DroneFleet<N>::setDroneState(x, d, x_d);
+        for (size_t i = 0; i < Nu; ++i)
+            u[i][d] = 0.5 * dist(rng);
+    }
+
+    DroneFleet<N>::MatX_t x_dot = fleet(x, u);
+    for (size_t d = 0; d < N; ++d) {
+        Drone drone_d          = {params[d]};
+        Drone::VecX_t x_d      = DroneFleet<N>::getDroneState(x, d);
+        Drone::VecX_t expected = drone_d.referenceStateChange(
+            x_d, {u[0][d], u[1][d], u[2][d], u[3][d]});
+        Drone::VecX_t result = DroneFleet<N>::getDroneState(x_dot, d);
+        EXPECT_TRUE(isAlmostEqual(result, expected, 1e-12)) << d;
+    }
+}
+
+TEST(DroneFleet, wrongNumberOfParameters) {
+    Drone drone = {loadPath};
+    std::vector<DroneParamsAndMatrices> params(3, drone.p);
+    EXPECT_THROW(DroneFleet<4>{params}, std::invalid_argument);
+}
+
+/// Proportional controller for the angular velocity, that counts its calls.
+struct AngularVelocityController {
+    double Ts;
+    size_t calls = 0;
+    Drone::VecU_t operator()(const Drone::VecX_t &x, const Drone::VecR_t &) {
+        ++calls;
+        return {-0.01 * x[4][0], -0.01 * x[5][0], -0.01 * x[6][0], 0};
+    }
+};
+
+/**
+ * Simulating the fleet in closed loop should give the same result as
+ * simulating all drones separately.
+ */
+TEST(DroneFleet, simulateRealTime) {
+    constexpr size_t N  = 4;
+    Drone drone         = {loadPath};
+    auto params         = getPerturbedParameters(drone.p, N);
+    DroneFleet<N> fleet = {params};
+
+    AdaptiveODEOptions opt = {};
+    opt.t_start            = 0;
+    opt.t_end              = 0.25;
+    opt.epsilon            = 1e-8;
+    opt.h_start            = 1e-4;
+    opt.h_min              = 1e-10;
+    opt.maxiter            = 1e6;
+
+    DroneFleet<N>::MatX_t x0;
+    for (size_t d = 0; d < N; ++d) {
+        DroneState x0_d = drone.getStableState();
+        x0_d.setAngularVelocity({0.5, -0.5, 0.1 * d});
+        DroneFleet<N>::setDroneState(x0, d, x0_d);
+    }
+    ConstantTimeFunctionT<Drone::VecR_t> r = {Drone::VecR_t{}};
+
+    std::array<AngularVelocityController, N> controllers;
+    controllers.fill({drone.p.Ts_att});
+    DroneFleet<N>::MatX_t x_end;
+    auto store = [&](double, const DroneFleet<N>::MatX_t &x,
+                     const DroneFleet<N>::MatU_t &) {
+        x_end = x;
+        return true;
+    };
+    ODEResultCode resultCode =
+        fleet.simulateRealTime(controllers, r, x0, opt, store);
+    EXPECT_FALSE(resultCode & ODEResultCodes::MAXIMUM_ITERATIONS_EXCEEDED);
+
+    for (size_t d = 0; d < N; ++d) {
+        Drone drone_d                        = {params[d]};
+        AngularVelocityController controller = {drone.p.Ts_att};
+        Drone::VecX_t x_end_d;
+        auto store_d = [&](double, const Drone::VecX_t &x,
+                           const Drone::VecU_t &) {
+            x_end_d = x;
+            return true;
+        };
+        ClosedLoopSimulation::simulateRealTime(
+            drone_d, controller, r, DroneFleet<N>::getDroneState(x0, d), opt,
+            store_d);
+        EXPECT_EQ(controllers[d].calls, controller.calls);
+        EXPECT_TRUE(isAlmostEqual(DroneFleet<N>::getDroneState(x_end, d),
+                                  x_end_d, 1e-7))
+            << d;
+    }
+}
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include <Drone.hpp>
+
+#include "DroneTestHelpers.hpp"
+
+#include <sstream>
+#include <vector>
+
+using Table = Attitude::GainScheduledLQRController::Table;
+
+/**
+ * Around the level hovering state, the linearization of the nonlinear model
+ * should match the linearized model of the parameters.
+ */
+TEST(GainSchedule, linearizeHover) {
+    Drone drone                   = {loadPath};
+    Drone::LinearizedAttitude sys = drone.linearizeAttitude(0, 0);
+    EXPECT_LT(norm(sys.Ad_r - drone.p.Ad_att_r), 1e-6 * norm(drone.p.Ad_att_r));
+    EXPECT_LT(norm(sys.Bd_r - drone.p.Bd_att_r), 1e-6 * norm(drone.p.Bd_att_r));
+
+    // Tilting the drone changes the kinematics of the reduced quaternion
+    Drone::LinearizedAttitude tilted = drone.linearizeAttitude(0.4, -0.3);
+    EXPECT_GT(norm(tilted.Ad_r - sys.Ad_r), 1e-4);
+}
+
+/**
+ * Multilinear interpolation is exact for gains that are multilinear in the
+ * scheduling variables, and the operating point is clamped to the grid.
+ */
+TEST(GainSchedule, interpolation) {
+    const Matrix<Nu_att, Nx_att - 1> A = ones<Nu_att, Nx_att - 1>();
+    Matrix<Nu_att, Nx_att - 1> B       = {};
+    B[1][2]                            = 3;
+    auto gainAt = [&](const Table::Point &p) {
+        return (1 + p[0]) * A + p[1] * B + p[0] * p[1] * A;
+    };
+    Table table = Table::build({{{-1, -0.2, 0.5, 1}, {-2, 0, 3}}}, gainAt);
+    ASSERT_EQ(table.size(), 12);
+
+    for (Table::Point p : {Table::Point{-0.2, 0}, Table::Point{0.3, -1.5},
+                           Table::Point{0.9, 2.9}, Table::Point{-1, 3}})
+        EXPECT_LT(norm(table(p) - gainAt(p)), 1e-12)
+            << p[0] << ", " << p[1];
+    // Outside of the grid
+    EXPECT_LT(norm(table({2, -5}) - gainAt({1, -2})), 1e-12);
+    EXPECT_LT(norm(table({-3, 0.5}) - gainAt({-1, 0.5})), 1e-12);
+
+    // A single grid point along an axis
+    GainTable<1, 1, 1> constant = {{{{0.5}}}};
+    constant[0]                 = {{{7}}};
+    EXPECT_EQ(constant({-1}), (Matrix<1, 1>{{{7}}}));
+    EXPECT_EQ(constant({2}), (Matrix<1, 1>{{{7}}}));
+
+    EXPECT_THROW((Table{{{{0, 0}, {1}}}}), std::invalid_argument);
+}
+
+TEST(GainSchedule, serialization) {
+    auto gainAt = [](const Table::Point &p) {
+        return (p[0] - 2 * p[1]) * ones<Nu_att, Nx_att - 1>();
+    };
+    Table table = Table::build({{{-0.3, 0, 0.3}, {-0.3, 0.3}}}, gainAt);
+
+    std::stringstream ss;
+    table.save(ss);
+    Table loaded = Table::load(ss);
+    EXPECT_EQ(loaded.getAxes()[0], table.getAxes()[0]);
+    EXPECT_EQ(loaded.getAxes()[1], table.getAxes()[1]);
+    ASSERT_EQ(loaded.size(), table.size());
+    for (size_t i = 0; i < table.size(); ++i)
+        EXPECT_EQ(loaded[i], table[i]);
+
+    // Wrong dimensions and truncated files are rejected
+    std::stringstream other;
+    GainTable<2, 1, 1>{{{{0}, {0}}}}.save(other);
+    EXPECT_THROW(Table::load(other), std::runtime_error);
+    std::string bytes = ss.str();
+    std::stringstream truncated(bytes.substr(0, bytes.size() - 8));
+    EXPECT_THROW(Table::load(truncated), std::runtime_error);
+    std::stringstream garbage("not a gain table");
+    EXPECT_THROW(Table::load(garbage), std::runtime_error);
+}
+
+/**
+ * The gain-scheduled controller should stabilize the attitude at a tilted
+ * reference, with an arbitrary heading.
+ */
+TEST(GainSchedule, tiltedStepResponse) {
+    Drone drone                   = {loadPath};
+    Drone::AttitudeModel attmodel = drone.getAttitudeModel();
+
+    const RowVector<Nx_att - 1> Q = {1e3, 1e3, 1e3, 1, 1, 1, 1, 1, 1};
+    auto synthesize = [&](const Matrix<Nx_att - 1, Nx_att - 1> &Ad_r,
+                          const Matrix<Nx_att - 1, Nu_att> &Bd_r) {
+        return Matrix<Nu_att, Nx_att - 1>{
+            -iterativeDLQR(Ad_r, Bd_r, diag(Q), eye<Nu_att>())};
+    };
+    std::vector<double> grid = {-0.4, -0.2, 0, 0.2, 0.4};
+    Table table = drone.getAttitudeGainTable(grid, grid, synthesize);
+    // At level hover, the gain is the same as the one of the fixed controller
+    Matrix<Nu_att, Nx_att - 1> K_hover =
+        synthesize(drone.p.Ad_att_r, drone.p.Bd_att_r);
+    EXPECT_LT(norm(table({0, 0}) - K_hover), 1e-4 * norm(K_hover));
+
+    Drone::FixedClampGainScheduledAttitudeController attctrl =
+        drone.getFixedClampGainScheduledAttitudeController(table);
+
+    AdaptiveODEOptions opt = {};
+    opt.t_start            = 0;
+    opt.t_end              = 3;
+    opt.epsilon            = 1e-6;
+    opt.h_start            = 1e-4;
+    opt.h_min              = 1e-10;
+    opt.maxiter            = 1e6;
+
+    const Quaternion q_ref = eul2quat({0.8, -0.25, 0.3});
+    ConstantTimeFunctionT<ColVector<Ny_att>> r = {vcat(q_ref, zeros<3, 1>())};
+    DroneAttitudeState x0 = {};
+    x0.setOrientation(eul2quat({0.8, 0, 0}));
+
+    ColVector<Nx_att> x_end = {};
+    auto f = [&](double, const ColVector<Nx_att> &x,
+                 const ColVector<Nu_att> &) {
+        x_end = x;
+        return true;
+    };
+    ODEResultCode resultCode =
+        attmodel.simulateRealTime(attctrl, r, x0, opt, f);
+    EXPECT_FALSE(resultCode & ODEResultCodes::MAXIMUM_ITERATIONS_EXCEEDED);
+
+    Quaternion q_end = getBlock<0, 4, 0, 1>(x_end);
+    Quaternion dq    = quatmultiply(quatconjugate(q_ref), q_end);
+    EXPECT_LT(norm(quat2red(dq)), 1e-3);
+    EXPECT_LT(norm(getBlock<4, 7, 0, 1>(x_end)), 1e-2);
+}
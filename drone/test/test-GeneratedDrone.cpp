@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+
+#include <Degrees.hpp>
+#include <Drone.hpp>
+#include <DroneCodeGenerator.hpp>
+
+#include "DroneTestHelpers.hpp"
+
+// Generated by drone-codegen from the test parameters, using the default
+// weights. Regenerate it from the root of the repository when the code
+// generator changes:
+//   drone-codegen -l py-drone/test/ParamsAndMatrices
+//                 -o drone/test/GeneratedDrone.hpp
+#include "GeneratedDrone.hpp"
+
+#include <array>
+#include <random>
+#include <sstream>
+
+/* ------ Helpers ----------------------------------------------------------- */
+
+template <size_t R, size_t C>
+static Matrix<R, C> toMatrix(const double (&a)[R][C]) {
+    Matrix<R, C> M;
+    for (size_t r = 0; r < R; ++r)
+        for (size_t c = 0; c < C; ++c)
+            M[r][c] = a[r][c];
+    return M;
+}
+
+template <size_t N>
+static std::array<double, N> toArray(const ColVector<N> &v) {
+    std::array<double, N> a;
+    for (size_t i = 0; i < N; ++i)
+        a[i] = v[i][0];
+    return a;
+}
+
+template <size_t N>
+static void expectNear(const double (&result)[N],
+                       const ColVector<N> &expected, double eps) {
+    for (size_t i = 0; i < N; ++i)
+        EXPECT_NEAR(result[i], expected[i][0],
+                    eps * std::max(1.0, std::abs(expected[i][0])))
+            << i;
+}
+
+/// Random states, inputs and outputs around the hover state.
+class RandomSignals {
+  public:
+    RandomSignals(const Drone &drone) : drone(drone) {}
+
+    DroneState state() {
+        DroneState x = drone.getStableState();
+        x.setOrientation(eul2quat({random(30_deg), random(30_deg), //
+                                   random(30_deg)}));
+        x.setAngularVelocity({random(2), random(2), random(2)});
+        x.setMotorSpeed({random(10), random(10), random(10)});
+        x.setVelocity({random(2), random(2), random(2)});
+        x.setThrustMotorSpeed(random(10));
+        return x;
+    }
+
+    ColVector<Ny_att> attitudeOutput() {
+        DroneAttitudeOutput y;
+        y.setOrientation(eul2quat({random(30_deg), random(30_deg), //
+                                   random(30_deg)}));
+        y.setAngularVelocity({random(2), random(2), random(2)});
+        return y;
+    }
+
+    double random(double scale) { return scale * dist(rng); }
+
+  private:
+    const Drone &drone;
+    std::mt19937 rng{1};
+    std::uniform_real_distribution<double> dist{-1, 1};
+};
+
+/* ------ Tests ------------------------------------------------------------- */
+
+/**
+ * The generated dynamics should be equal to the reference implementation, up
+ * to rounding errors.
+ */
+TEST(GeneratedDrone, dynamics) {
+    Drone drone          = {loadPath};
+    RandomSignals random = {drone};
+    for (size_t i = 0; i < 100; ++i) {
+        ColVector<Nx> x = random.state();
+        ColVector<Nu> u = {random.random(0.5), random.random(0.5),
+                           random.random(0.5), random.random(0.5)};
+        double x_dot[Nx];
+        GeneratedDrone::dynamics(toArray(x).data(), toArray(u).data(), x_dot);
+        expectNear(x_dot, drone.referenceStateChange(x, u), 1e-12);
+    }
+}
+
+/**
+ * The generated controller should be equal to the reference LQR controller
+ * with the same gain matrix, both with and without clamping.
+ */
+TEST(GeneratedDrone, attitudeController) {
+    Drone drone                  = {loadPath};
+    RandomSignals random         = {drone};
+    Matrix<Nu_att, Nx_att - 1> K = toMatrix(GeneratedDrone::K_att);
+    Attitude::LQRController ctrl = drone.getAttitudeController(K);
+    Drone::FixedClampAttitudeController clampctrl =
+        drone.getFixedClampAttitudeController(K);
+    EXPECT_EQ(GeneratedDrone::Ts_att, drone.p.Ts_att);
+
+    for (size_t i = 0; i < 100; ++i) {
+        ColVector<Nx_att> x = random.state().getAttitude();
+        ColVector<Ny_att> r = random.attitudeOutput();
+        double u[Nu_att];
+        GeneratedDrone::attitudeControllerRaw(toArray(x).data(),
+                                              toArray(r).data(), u);
+        expectNear(u, ctrl.getRawControllerOutput(x, r), 1e-12);
+        GeneratedDrone::attitudeController(toArray(x).data(),
+                                           toArray(r).data(), u);
+        expectNear(u, clampctrl(x, r), 1e-12);
+    }
+}
+
+/**
+ * The generated observer should be equal to the reference Kalman observer
+ * with the same gain matrix.
+ */
+TEST(GeneratedDrone, attitudeObserver) {
+    Drone drone                      = {loadPath};
+    RandomSignals random             = {drone};
+    Matrix<Nx_att - 1, Ny_att - 1> L = toMatrix(GeneratedDrone::L_att);
+    Attitude::KalmanObserver obsv    = {drone.p.Ad_att_r, drone.p.Bd_att_r,
+                                        drone.p.Cd_att, L, drone.p.Ts_att};
+
+    for (size_t i = 0; i < 100; ++i) {
+        ColVector<Nx_att> x_hat = random.state().getAttitude();
+        ColVector<Ny_att> y     = random.attitudeOutput();
+        ColVector<Nu_att> u     = {random.random(0.1), random.random(0.1),
+                                   random.random(0.1)};
+        double x_hat_next[Nx_att];
+        GeneratedDrone::attitudeObserver(toArray(x_hat).data(),
+                                         toArray(y).data(),
+                                         toArray(u).data(), x_hat_next);
+        expectNear(x_hat_next, obsv.getStateChange(x_hat, y, u), 1e-12);
+    }
+}
+
+/**
+ * Infinities and NaNs have no C++ literal, so they have to be written as
+ * constants from the standard library.
+ */
+TEST(GeneratedDrone, nonFiniteConstants) {
+    Drone drone                      = {loadPath};
+    Matrix<Nu_att, Nx_att - 1> K     = toMatrix(GeneratedDrone::K_att);
+    Matrix<Nx_att - 1, Ny_att - 1> L = toMatrix(GeneratedDrone::L_att);
+    K[0][0] = std::numeric_limits<double>::infinity();
+    K[1][1] = -std::numeric_limits<double>::infinity();
+    L[0][0] = std::numeric_limits<double>::quiet_NaN();
+
+    std::ostringstream os;
+    generateDroneCode(os, drone.p, K, L);
+    std::string code = os.str();
+    EXPECT_NE(code.find("{std::numeric_limits<double>::infinity(), "),
+              std::string::npos);
+    EXPECT_NE(code.find(", -std::numeric_limits<double>::infinity(), "),
+              std::string::npos);
+    EXPECT_NE(code.find("{std::numeric_limits<double>::quiet_NaN(), "),
+              std::string::npos);
+    EXPECT_EQ(code.find("inf,"), std::string::npos);
+    EXPECT_EQ(code.find("nan,"), std::string::npos);
+}
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+#include <Drone.hpp>
+
+#include "DroneTestHelpers.hpp"
+
+#include <cmath>
+
+/// A drone that is tumbling without any control input.
+static DroneState getTumblingState(const Drone &drone) {
+    DroneState x = drone.getStableState();
+    x.setAngularVelocity({3, -2, 5});
+    return x;
+}
+
+static AdaptiveODEOptions getOptions(double epsilon) {
+    AdaptiveODEOptions opt = {};
+    opt.t_start            = 0;
+    opt.t_end              = 2;
+    opt.epsilon            = epsilon;
+    opt.h_start            = 1e-2;
+    opt.h_min              = 1e-12;
+    opt.maxiter            = 1e6;
+    return opt;
+}
+
+/**
+ * Integrating the orientation on the unit sphere should be at least as
+ * accurate as integrating the quaternion as a vector, with fewer steps, and
+ * the quaternion should stay normalized.
+ */
+TEST(LieGroupIntegration, tumbling) {
+    Drone drone          = {loadPath};
+    const DroneState x0  = getTumblingState(drone);
+    const DroneControl u = {{0, 0, 0}, {0}};
+
+    Drone::VecX_t reference = x0;
+    drone.advance(u, reference, getOptions(1e-10));
+    Quaternion q_ref = DroneState{reference}.getOrientation();
+
+    Drone::VecX_t x_euclidean = x0;
+    auto euclidean = drone.advance(u, x_euclidean, getOptions(1e-6));
+
+    drone.lieGroupIntegration = true;
+    Drone::VecX_t x_lie       = x0;
+    auto lie                  = drone.advance(u, x_lie, getOptions(1e-6));
+
+    EXPECT_EQ(lie.first, ODEResultCodes::SUCCESS);
+    EXPECT_LT(lie.second, euclidean.second);
+    Quaternion q_lie = DroneState{x_lie}.getOrientation();
+    EXPECT_NEAR(norm(q_lie), 1, 1e-13);
+    EXPECT_TRUE(isAlmostEqual(q_lie, q_ref, 1e-10));
+    EXPECT_TRUE(isAlmostEqual(x_lie, reference, 1e-8));
+}
+
+/**
+ * The closed-loop simulations should use the geometric integrator as well,
+ * and the result should be the same as with the default integrator.
+ */
+TEST(LieGroupIntegration, attitudeStepResponse) {
+    Drone drone                   = {loadPath};
+    Drone::AttitudeModel attmodel = drone.getAttitudeModel();
+    Drone::FixedClampAttitudeController attctrl =
+        getTestAttitudeController(drone);
+
+    AdaptiveODEOptions opt = getOptions(1e-8);
+    opt.t_end              = 1;
+    opt.h_start            = 1e-4;
+
+    ConstantTimeFunctionT<ColVector<Ny_att>> r = {
+        vcat(eul2quat({M_PI / 4, M_PI / 8, -M_PI / 8}), zeros<3, 1>())};
+    DroneAttitudeState x0 = {};
+    x0.setOrientation(eul2quat({0, 0, 0}));
+
+    std::vector<ColVector<Nx_att>> euclidean;
+    auto f_euclidean = [&](double, const ColVector<Nx_att> &x,
+                           const ColVector<Nu_att> &) {
+        euclidean.push_back(x);
+        return true;
+    };
+    attmodel.simulateRealTime(attctrl, r, x0, opt, f_euclidean);
+
+    attmodel.lieGroupIntegration = true;
+    std::vector<ColVector<Nx_att>> lie;
+    auto f_lie = [&](double, const ColVector<Nx_att> &x,
+                     const ColVector<Nu_att> &) {
+        lie.push_back(x);
+        return true;
+    };
+    attmodel.simulateRealTime(attctrl, r, x0, opt, f_lie);
+
+    ASSERT_EQ(lie.size(), euclidean.size());
+    for (size_t i = 0; i < lie.size(); ++i) {
+        Quaternion q = getBlock<0, 4, 0, 1>(lie[i]);
+        EXPECT_NEAR(norm(q), 1, 1e-13) << i;
+        EXPECT_TRUE(isAlmostEqual(lie[i], euclidean[i], 1e-6)) << i;
+    }
+}
+
+namespace {
+/// A model that inherits Drone::advance instead of declaring it.
+struct DerivedDrone : Drone {
+    using Drone::Drone;
+};
+}  // namespace
+
+/**
+ * The closed-loop simulations should call the integrator of the drone, even
+ * if the concrete model type only inherits it.
+ */
+TEST(LieGroupIntegration, inheritedAdvance) {
+    DerivedDrone drone        = {loadPath};
+    drone.lieGroupIntegration = true;
+    const DroneState x0       = getTumblingState(drone);
+    const DroneControl u      = {{0, 0, 0}, {0}};
+
+    Drone::VecX_t expected = x0;
+    drone.Drone::advance(u, expected, getOptions(1e-6));
+
+    Drone::VecX_t x = x0;
+    ClosedLoopSimulation::advance(drone, u, x, getOptions(1e-6));
+    EXPECT_EQ(x, expected);
+    EXPECT_NEAR(norm(DroneState{x}.getOrientation()), 1, 1e-13);
+}
+
+/**
+ * Skipping a control period with an Euler step should keep the quaternion
+ * normalized, and agree with the Euler step of the state vector up to second
+ * order.
+ */
+TEST(LieGroupIntegration, eulerStep) {
+    Drone drone          = {loadPath};
+    const DroneState x0  = getTumblingState(drone);
+    const DroneControl u = {{0, 0, 0}, {0}};
+    const double h       = 1e-3;
+
+    Drone::VecX_t x_dot = drone(x0, u);
+    Drone::VecX_t x     = x0;
+    drone.eulerStep(x, x_dot, h);
+    EXPECT_NEAR(norm(DroneState{x}.getOrientation()), 1, 1e-15);
+    Drone::VecX_t x_vector = x0;
+    x_vector += h * x_dot;
+    EXPECT_TRUE(isAlmostEqual(x, x_vector, 1e-4));
+
+    Drone::AttitudeModel attmodel  = drone.getAttitudeModel();
+    const DroneAttitudeState attx0 = x0.getAttitude();
+    ColVector<Nx_att> attx         = attx0;
+    attmodel.eulerStep(attx, attmodel(attx0, {0, 0, 0}), h);
+    EXPECT_NEAR(norm(getBlock<0, 4, 0, 1>(attx)), 1, 1e-15);
+}
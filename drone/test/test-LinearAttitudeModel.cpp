@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include <Degrees.hpp>
+#include <Drone.hpp>
+#include <StepResponseAnalyzer.hpp>
+
+#include "DroneTestHelpers.hpp"
+
+/**
+ * The linear model should be the reduced discrete state space model.
+ */
+TEST(LinearAttitudeModel, stateChange) {
+    Drone drone                       = {loadPath};
+    Drone::LinearAttitudeModel linear = drone.getLinearAttitudeModel();
+    DroneAttitudeState x              = drone.getStableState().getAttitude();
+    x.setOrientation(eul2quat({2_deg, -1_deg, 3_deg}));
+    x.setAngularVelocity({0.1, -0.2, 0.05});
+    const ColVector<Nu_att> u = {0.01, -0.02, 0.005};
+
+    ColVector<Nx_att> x_next      = linear(x, u);
+    ColVector<Nx_att - 1> x_r     = quat2red(ColVector<Nx_att>(x));
+    ColVector<Nx_att - 1> x_r_exp = drone.p.Ad_att_r * x_r + //
+                                    drone.p.Bd_att_r * u;
+
+    EXPECT_TRUE(isAlmostEqual(quat2red(x_next), x_r_exp, 1e-15));
+    EXPECT_NEAR(norm(getBlock<0, 4, 0, 1>(x_next)), 1, 1e-15);
+    EXPECT_EQ(linear.Ts, drone.p.Ts_att);
+}
+
+/**
+ * For small steps, the step response of the linear model should be close to
+ * the response of the nonlinear model.
+ */
+TEST(LinearAttitudeModel, stepResponse) {
+    Drone drone                       = {loadPath};
+    Drone::AttitudeModel model        = drone.getAttitudeModel();
+    Drone::LinearAttitudeModel linear = drone.getLinearAttitudeModel();
+    const DroneAttitudeState attx0    = drone.getStableState().getAttitude();
+    Drone::FixedClampAttitudeController attctrl =
+        getTestAttitudeController(drone);
+
+    AdaptiveODEOptions opt = {};
+    opt.t_start            = 0;
+    opt.t_end              = 1;
+    opt.epsilon            = 1e-6;
+    opt.h_start            = 1e-4;
+    opt.h_min              = 1e-8;
+    opt.maxiter            = 1e6;
+
+    const Quaternion q_ref = eul2quat({0, 0, 2_deg});
+    DroneAttitudeOutput y_ref;
+    y_ref.setOrientation(q_ref);
+    ConstantTimeFunctionT<ColVector<Ny_att>> y_ref_f = {y_ref};
+
+    std::vector<Quaternion> q_nonlinear;
+    auto f_nonlinear = [&](double, const ColVector<Nx_att> &x,
+                           const ColVector<Nu_att> &) {
+        q_nonlinear.push_back(getBlock<0, 4, 0, 1>(x));
+        return true;
+    };
+    std::vector<Quaternion> q_linear;
+    auto f_linear = [&](double, const ColVector<Nx_att> &x,
+                        const ColVector<Nu_att> &) {
+        q_linear.push_back(getBlock<0, 4, 0, 1>(x));
+        return true;
+    };
+
+    model.simulateRealTime(attctrl, y_ref_f, attx0, opt, f_nonlinear);
+    linear.simulateRealTime(attctrl, y_ref_f, attx0, opt, f_linear);
+
+    ASSERT_EQ(q_linear.size(), q_nonlinear.size());
+    ASSERT_GT(q_linear.size(), 10);
+    for (size_t i = 0; i < q_linear.size(); ++i)
+        EXPECT_TRUE(isAlmostEqual(q_linear[i], q_nonlinear[i], 1e-3)) << i;
+    EXPECT_TRUE(isAlmostEqual(q_linear.back(), q_ref, 1e-3));
+
+    // Both models should be usable with the step response analyzer
+    const Quaternion q0              = attx0.getOrientation();
+    StepResponseAnalyzer<4> analyzer = {q_ref, 0.01, q0};
+    auto f_analyzer = [&](double t, const ColVector<Nx_att> &x,
+                          const ColVector<Nu_att> &u) {
+        DroneAttitudeOutput y = linear.getOutput(x, u);
+        return analyzer(t, y.getOrientation());
+    };
+    linear.simulateRealTime(attctrl, y_ref_f, attx0, opt, f_analyzer);
+    EXPECT_NE(analyzer.getResult().risetime[1], -1.0);
+}
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include <Drone.hpp>
+
+#include "DroneTestHelpers.hpp"
+
+static const RowVector<Nx_att - 1> Qdiag = {1e3, 1e3, 1e3, 1, 1, 1, 1, 1, 1};
+
+static Attitude::MPCController<10>::Solver::Options getSolverOptions() {
+    Attitude::MPCController<10>::Solver::Options opt = {};
+    opt.tolerance                                    = 1e-9;
+    opt.maxIterations                                = 5000;
+    return opt;
+}
+
+/**
+ * When the motors don't saturate, the MPC controller with the solution of the
+ * Riccati equation as terminal weight is the same as the LQR controller.
+ */
+TEST(MPCController, unconstrainedIsLQR) {
+    Drone drone  = {loadPath};
+    const auto Q = diag(Qdiag);
+    const auto R = eye<Nu_att>();
+    const auto P = iterativeDARE(drone.p.Ad_att_r, drone.p.Bd_att_r, Q, R);
+    Matrix<Nu_att, Nx_att - 1> K =
+        -iterativeDLQR(drone.p.Ad_att_r, drone.p.Bd_att_r, Q, R);
+    Attitude::LQRController lqr = drone.getAttitudeController(K);
+    Attitude::MPCController<10> mpc =
+        drone.getMPCAttitudeController<10>(Q, R, P, getSolverOptions());
+
+    DroneAttitudeState x = {};
+    x.setOrientation(eul2quat({0.002, -0.001, 0.003}));
+    x.setAngularVelocity({0.01, 0, -0.02});
+    ColVector<Ny_att> r = vcat(eul2quat({0, 0, 0}), zeros<3, 1>());
+
+    ColVector<Nu_att> u_lqr = lqr(x, r);
+    ColVector<Nu_att> u_mpc = mpc(x, r);
+    EXPECT_LT(mpc.getIterations(), getSolverOptions().maxIterations);
+    EXPECT_LT(norm(u_mpc - u_lqr), 1e-5 * norm(u_lqr)) << u_mpc << u_lqr;
+}
+
+/**
+ * For a large step of the reference, the motor signals should stay within
+ * their limits, and the controller should still reach the reference.
+ */
+TEST(MPCController, motorLimits) {
+    Drone drone                   = {loadPath};
+    Drone::AttitudeModel attmodel = drone.getAttitudeModel();
+    const auto Q                  = diag(Qdiag);
+    const auto R                  = eye<Nu_att>();
+    const auto P = iterativeDARE(drone.p.Ad_att_r, drone.p.Bd_att_r, Q, R);
+    Attitude::MPCController<10>::Solver::Options solverOpt = {};
+    Attitude::MPCController<10> mpc =
+        drone.getMPCAttitudeController<10>(Q, R, P, solverOpt);
+
+    AdaptiveODEOptions opt = {};
+    opt.t_start            = 0;
+    opt.t_end              = 4;
+    opt.epsilon            = 1e-6;
+    opt.h_start            = 1e-4;
+    opt.h_min              = 1e-10;
+    opt.maxiter            = 1e6;
+
+    const Quaternion q_ref = eul2quat({0.5, 0.2, -0.15});
+    ConstantTimeFunctionT<ColVector<Ny_att>> r = {vcat(q_ref, zeros<3, 1>())};
+    DroneAttitudeState x0 = {};
+    x0.setOrientation(eul2quat({0, 0, 0}));
+
+    const auto M_att        = Attitude::MPCController<10>::getMotorMatrix();
+    const double tolerance  = 10 * solverOpt.tolerance;
+    double largest          = 0;
+    ColVector<Nx_att> x_end = {};
+    size_t maxIterations    = 0;
+    auto f = [&](double, const ColVector<Nx_att> &x,
+                 const ColVector<Nu_att> &u) {
+        ColVector<4> motors = M_att * u;
+        for (size_t i = 0; i < 4; ++i) {
+            EXPECT_GE(motors[i][0] + drone.p.uh, -tolerance);
+            EXPECT_LE(motors[i][0] + drone.p.uh, 1 + tolerance);
+            largest = std::max(largest, motors[i][0] + drone.p.uh);
+        }
+        maxIterations = std::max(maxIterations, mpc.getIterations());
+        x_end         = x;
+        return true;
+    };
+    ODEResultCode resultCode = attmodel.simulateRealTime(mpc, r, x0, opt, f);
+    EXPECT_FALSE(resultCode & ODEResultCodes::MAXIMUM_ITERATIONS_EXCEEDED);
+
+    // The motors actually saturate
+    EXPECT_GT(largest, 1 - 1e-3);
+    EXPECT_LE(maxIterations, solverOpt.maxIterations);
+    Quaternion q_end = getBlock<0, 4, 0, 1>(x_end);
+    Quaternion dq    = quatmultiply(quatconjugate(q_ref), q_end);
+    EXPECT_LT(norm(quat2red(dq)), 1e-3);
+}
+
+/**
+ * If the solver runs out of iterations, the control signal should still
+ * respect the motor limits.
+ */
+TEST(MPCController, motorLimitsWithoutConvergence) {
+    Drone drone  = {loadPath};
+    const auto Q = diag(Qdiag);
+    const auto R = eye<Nu_att>();
+    const auto P = iterativeDARE(drone.p.Ad_att_r, drone.p.Bd_att_r, Q, R);
+    Attitude::MPCController<10>::Solver::Options solverOpt = {};
+    solverOpt.maxIterations                                = 2;
+    Attitude::MPCController<10> mpc =
+        drone.getMPCAttitudeController<10>(Q, R, P, solverOpt);
+
+    DroneAttitudeState x = {};
+    x.setOrientation(eul2quat({0, 0, 0}));
+    ColVector<Ny_att> r = vcat(eul2quat({0.5, 0.2, -0.15}), zeros<3, 1>());
+
+    const auto M_att = Attitude::MPCController<10>::getMotorMatrix();
+    double largest   = 0;
+    for (size_t k = 0; k < 20; ++k) {
+        ColVector<4> motors = M_att * mpc(x, r);
+        EXPECT_EQ(mpc.getIterations(), solverOpt.maxIterations);
+        for (size_t i = 0; i < 4; ++i) {
+            EXPECT_GE(motors[i][0] + drone.p.uh, -1e-12) << k;
+            EXPECT_LE(motors[i][0] + drone.p.uh, 1 + 1e-12) << k;
+            largest = std::max(largest, motors[i][0] + drone.p.uh);
+        }
+    }
+    // The limits are active
+    EXPECT_GT(largest, 1 - 1e-9);
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <Drone.hpp>
+
+#include "DroneTestHelpers.hpp"
+
+#include <cmath>
+
+/**
+ * The motor dynamics don't depend on the rest of the state, so the two half
+ * steps of the splitting should give the exact motor speeds at the end of the
+ * interval.
+ */
+TEST(MotorSplitting, motorSpeedsAreExact) {
+    Drone drone              = {loadPath};
+    drone.splitMotorDynamics = true;
+    DroneState x             = drone.getStableState();
+    x.setAngularVelocity({0.3, -0.2, 0.1});
+    x.setMotorSpeed({10, -5, 2});
+    x.setThrustMotorSpeed(-3);
+    const DroneControl u = {{0.1, -0.05, 0.02}, {0.03}};
+
+    AdaptiveODEOptions opt = {};
+    opt.t_start            = 0;
+    opt.t_end              = drone.p.Ts_att;
+    opt.epsilon            = 1e-8;
+    opt.h_start            = 1e-4;
+    opt.h_min              = 1e-10;
+    opt.maxiter            = 1e5;
+
+    Drone::VecX_t x_end = x;
+    drone.advance(u, x_end, opt);
+
+    const double decay   = std::exp(-drone.p.k2 * drone.p.Ts_att);
+    ColVector<3> n_ss    = drone.p.k1 * u.getAttitudeControl();
+    ColVector<3> n_exact = n_ss + (x.getMotorSpeed() - n_ss) * decay;
+    double nt_ss         = drone.p.k1 * u.getThrustControl();
+    double nt_exact      = nt_ss + (x.getThrustMotorSpeed() - nt_ss) * decay;
+    EXPECT_TRUE(
+        isAlmostEqual(DroneState{x_end}.getMotorSpeed(), n_exact, 1e-12));
+    EXPECT_NEAR(DroneState{x_end}.getThrustMotorSpeed(), nt_exact, 1e-12);
+}
+
+/**
+ * A closed-loop step response with splitting should stay close to the one
+ * without, and it should need fewer steps.
+ */
+TEST(MotorSplitting, stepResponse) {
+    Drone drone = {loadPath};
+    Drone::FixedClampAttitudeController attctrl =
+        getTestAttitudeController(drone);
+    Matrix<1, 4> K_pi = {};
+    Drone::ClampAltitudeController altctrl =
+        drone.getClampAltitudeController(K_pi, 0);
+    Drone::ControllerT<Drone::FixedClampAttitudeController,
+                       Drone::ClampAltitudeController>
+        ctrl = {attctrl, altctrl, drone.p.uh};
+
+    DroneReference r;
+    r.setOrientation(eul2quat({M_PI / 8, M_PI / 16, -M_PI / 16}));
+    r.setPosition({0, 0, 0});
+    ConstantTimeFunctionT<ColVector<Ny>> r_f = {r};
+
+    AdaptiveODEOptions opt = {};
+    opt.t_start            = 0;
+    opt.t_end              = 1;
+    opt.epsilon            = 1e-6;
+    opt.h_start            = 1e-6;
+    opt.h_min              = 1e-8;
+    opt.maxiter            = 1e6;
+
+    auto simulate = [&](std::vector<Drone::VecX_t> &xs) {
+        size_t iterations = 0;
+        Drone::VecX_t x   = drone.getStableState();
+        double Ts         = drone.p.Ts_att;
+        size_t N = numberOfSamplesInTimeRange(opt.t_start, Ts, opt.t_end);
+        AdaptiveODEOptions curr_opt = opt;
+        for (size_t k = 0; k < N; ++k) {
+            curr_opt.t_start = Ts * k;
+            curr_opt.t_end   = Ts * (k + 1);
+            Drone::VecU_t u  = ctrl(x, r_f(curr_opt.t_start));
+            xs.push_back(x);
+            iterations += drone.advance(u, x, curr_opt).second;
+        }
+        return iterations;
+    };
+
+    std::vector<Drone::VecX_t> xs, xs_split;
+    size_t iterations        = simulate(xs);
+    drone.splitMotorDynamics = true;
+    size_t iterations_split  = simulate(xs_split);
+
+    EXPECT_LT(iterations_split, iterations);
+    ASSERT_EQ(xs.size(), xs_split.size());
+    for (size_t k = 0; k < xs.size(); ++k) {
+        DroneState x = xs[k], x_split = xs_split[k];
+        EXPECT_TRUE(isAlmostEqual(x_split.getOrientation(),
+                                  x.getOrientation(), 1e-4))
+            << k;
+    }
+    // The drone should actually turn towards the reference
+    Quaternion q_end = DroneState{xs_split.back()}.getOrientation();
+    EXPECT_LT(norm(q_end - r.getOrientation()), 0.05);
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include <Drone.hpp>
+
+#include "DroneTestHelpers.hpp"
+
+static const RowVector<Nu_att> varDynamics_att = {{{1e-2, 1e-2, 1e-2}}};
+static const RowVector<Ny_att> varSensors_att  = {
+    {{0, 1e-4, 1e-4, 1e-4, 1e-2, 1e-2, 1e-2}}};
+static const RowVector<Nu_alt> varDynamics_alt = {{{1e-2}}};
+static const RowVector<Ny_alt> varSensors_alt  = {{{1e-4}}};
+
+/**
+ * The covariance of the time-varying filter converges to the solution of the
+ * discrete algebraic Riccati equation of the steady-state filter.
+ */
+template <class T>
+void testAttitudeConvergence(double tolerance) {
+    Drone drone = {loadPath};
+    auto &p     = drone.p;
+    auto observer =
+        drone.getUDAttitudeObserver<T>(varDynamics_att, varSensors_att,
+                                       eye<Nx_att - 1>());
+    ColVector<Nx_att> x_hat = {{{1}}};
+    ColVector<Ny_att> y     = p.Cd_att * x_hat;
+    ColVector<Nu_att> u     = {};
+    for (size_t i = 0; i < 2000; ++i)
+        x_hat = observer.getStateChange(x_hat, y, u);
+
+    Matrix<Nx_att - 1, Nx_att - 1> P_expected = iterativeDARE(
+        transpose(p.Ad_att_r), transpose(p.Cd_att_r),
+        p.Bd_att_r * diag(varDynamics_att) * transpose(p.Bd_att_r),
+        diag(getBlock<0, 1, 1, Ny_att>(varSensors_att)));
+    Matrix<Nx_att - 1, Nx_att - 1> P = observer.getCovariance();
+    EXPECT_LT(norm(P - P_expected), tolerance * norm(P_expected));
+    EXPECT_LT(norm(x_hat - ColVector<Nx_att>{{{1}}}), 1e-6);
+}
+
+TEST(UDKalmanObserver, attitudeConvergence) {
+    testAttitudeConvergence<double>(1e-6);
+}
+
+TEST(UDKalmanObserver, attitudeConvergenceFloat) {
+    testAttitudeConvergence<float>(1e-3);
+}
+
+TEST(UDKalmanObserver, altitudeConvergence) {
+    Drone drone   = {loadPath};
+    auto &p       = drone.p;
+    auto observer = drone.getUDAltitudeObserver(varDynamics_alt,
+                                                varSensors_alt, eye<Nx_alt>());
+    ColVector<Nx_alt> x_hat = {};
+    ColVector<Ny_alt> y     = {};
+    ColVector<Nu_alt> u     = {};
+    for (size_t i = 0; i < 2000; ++i)
+        x_hat = observer.getStateChange(x_hat, y, u);
+
+    Matrix<Nx_alt, Nx_alt> P_expected = iterativeDARE(
+        transpose(p.Ad_alt), transpose(p.Cd_alt),
+        p.Bd_alt * diag(varDynamics_alt) * transpose(p.Bd_alt),
+        diag(varSensors_alt));
+    EXPECT_LT(norm(observer.getCovariance() - P_expected),
+              1e-6 * norm(P_expected));
+}
+
+/**
+ * When a sensor reading is missing, the uncertainty of the estimate grows,
+ * and it shrinks again when the readings come back. Resetting the filter
+ * restores the initial covariance.
+ */
+TEST(UDKalmanObserver, sensorDropout) {
+    Drone drone   = {loadPath};
+    auto &p       = drone.p;
+    auto observer = drone.getUDAttitudeObserver(varDynamics_att,
+                                                varSensors_att, eye<9>());
+    ColVector<Nx_att> x_hat = {{{1}}};
+    ColVector<Ny_att> y     = p.Cd_att * x_hat;
+    ColVector<Nu_att> u     = {};
+    for (size_t i = 0; i < 500; ++i)
+        x_hat = observer.getStateChange(x_hat, y, u);
+    Matrix<9, 9> P_steady = observer.getCovariance();
+
+    // Lose the angular velocity readings
+    ColVector<Ny_att> y_dropout = y;
+    for (size_t i = 4; i < Ny_att; ++i)
+        y_dropout[i][0] = std::numeric_limits<double>::quiet_NaN();
+    for (size_t i = 0; i < 10; ++i)
+        x_hat = observer.getStateChange(x_hat, y_dropout, u);
+    Matrix<9, 9> P_dropout = observer.getCovariance();
+    EXPECT_TRUE(std::isfinite(norm(x_hat)));
+    for (size_t i = 3; i < 6; ++i)
+        EXPECT_GT(P_dropout[i][i], P_steady[i][i]);
+
+    for (size_t i = 0; i < 500; ++i)
+        x_hat = observer.getStateChange(x_hat, y, u);
+    EXPECT_LT(norm(observer.getCovariance() - P_steady),
+              1e-4 * norm(P_steady));
+
+    observer.reset();
+    EXPECT_LT(norm(observer.getCovariance() - eye<9>()), 1e-12);
+}
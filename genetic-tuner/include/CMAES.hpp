@@ -0,0 +1,344 @@
+#pragma once
+
+#include <GeneticAlgorithm.hpp>
+#include <SearchSpace.hpp>
+#include <UDFactorization.hpp>
+
+#include <algorithm>  // max, min, minmax_element, sort
+#include <cmath>      // exp, log, sqrt, pow, ceil
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <numeric>  // iota
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+/** The settings of CMAES. */
+struct CMAESOptions {
+    /// The initial step size, in the coordinates of the search space (e.g.
+    /// the natural logarithms of the genes).
+    double sigma = 1;
+    /// The number of samples per generation of the first run, or 0 for the
+    /// default of 4 + ⌊3 ln n⌋ for n free genes.
+    size_t populationSize = 0;
+    /// The factor by which the number of samples grows at every restart.
+    double populationGrowth = 2;
+    /// The maximum number of restarts.
+    size_t maxRestarts = 9;
+    /// Restart when the step size is smaller than this tolerance in all
+    /// directions.
+    double tolX = 1e-9;
+    /// Restart when the best costs of the recent generations differ by less
+    /// than this fraction.
+    double tolFun = 1e-12;
+    /// Restart when the condition number of the covariance matrix exceeds
+    /// this limit.
+    double maxCondition = 1e14;
+};
+
+template <class M>
+/**
+ * The covariance matrix adaptation evolution strategy (CMA-ES, Hansen), with
+ * restarts with increasing population sizes (IPOP-CMA-ES, Auger and Hansen).
+ *
+ * Every generation, the samples are drawn from a normal distribution around
+ * the mean, and evaluated as one batch. The mean moves to the weighted mean
+ * of the best half of the samples, and the covariance matrix and the step
+ * size adapt to the steps that were successful, so the distribution learns
+ * the scale of, and the correlations between the weights.
+ *
+ * The samples are drawn using the UD factors of the covariance matrix,
+ * @f$ C = U D U^\top @f$, as @f$ y = U D^{1/2} z @f$, so no eigenvalue
+ * decomposition is needed. The step size path uses the weighted mean of z,
+ * as in the Cholesky-CMA-ES (Suttorp, Hansen and Igel). Genes that are fixed
+ * by the search space get no variance. Samples outside of the bounds are
+ * clamped, and the distribution is updated with the clamped samples.
+ *
+ * When the distribution has converged or stagnates, the search restarts
+ * with more samples per generation, at the initial chromosome, or at a random
+ * point if there is none. The best member of all runs is kept.
+ *
+ * Every sample has its own Philox stream, keyed by the seed, the generation
+ * (counted over all runs) and the index of the sample.
+ */
+class CMAES {
+  public:
+    constexpr static size_t N = M::Genes;
+
+    CMAES(const SearchSpace<N> &space, Evaluator<M> &evaluator,
+          const CMAESOptions &options = {}, uint64_t seed = 0)
+        : space{space}, evaluator{evaluator}, options{options},
+          key{Philox::makeKey(seed)}, n{space.getDimension()} {
+        if (n == 0)
+            throw std::invalid_argument("Error: all genes are fixed");
+    }
+
+    /** Start the first run, and all restarts, at the given chromosome. */
+    void initialize(const Chromosome<N> &chromosome) {
+        reset();
+        origin = space.toCoordinates(chromosome);
+        start(getOrigin(), getInitialPopulationSize());
+    }
+
+    /** Start the first run, and all restarts, at random points. */
+    void initialize() {
+        reset();
+        randomOrigin = true;
+        start(getOrigin(), getInitialPopulationSize());
+    }
+
+    /**
+     * Sample and evaluate a generation, and update the distribution. Restart
+     * if a stopping criterion is met.
+     */
+    void step() {
+        ++generation;
+        ++runGeneration;
+        ColVector<N> sqrtD = {};
+        for (size_t j = 0; j < N; ++j)
+            sqrtD[j][0] = std::sqrt(std::max(factors.d[j][0], 0.0));
+
+#pragma omp parallel for
+        for (size_t k = 0; k < lambda; ++k) {
+            Philox::Stream rng  = {key, uint32_t(generation), uint32_t(k)};
+            ColVector<N> scaled = {};
+            for (size_t j = 0; j < N; ++j) {
+                z[k][j][0]   = space.isFixed(j) ? 0 : rng.normal();
+                scaled[j][0] = sqrtD[j][0] * z[k][j][0];
+            }
+            y[k] = factors.U * scaled;
+
+            // Samples outside of the bounds are repaired, and the
+            // distribution is updated with the repaired sample, otherwise the
+            // step size diverges if the optimum lies on a bound
+            ColVector<N> x        = mean + sigma * y[k];
+            ColVector<N> repaired = space.clamp(x);
+            if (!(repaired == x)) {
+                y[k] = (1 / sigma) * (repaired - mean);
+                z[k] = solve(y[k], sqrtD);
+            }
+            samples[k]            = M{};
+            samples[k].chromosome = space.toChromosome(repaired);
+        }
+        // The ranking of the samples beyond the best half doesn't matter,
+        // but it isn't known in advance which samples those are
+        evaluator.evaluate({samples.data(), lambda},
+                           std::numeric_limits<double>::infinity());
+        evaluations += lambda;
+
+        std::vector<size_t> order(lambda);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            if (samples[a] < samples[b] || samples[b] < samples[a])
+                return samples[a] < samples[b];
+            return a < b;
+        });
+        if (!bestValid || samples[order[0]] < best) {
+            best      = samples[order[0]];
+            bestValid = true;
+        }
+        history.push_back(samples[order[0]].cost);
+        if (history.size() > getHistoryLength())
+            history.pop_front();
+
+        update(order);
+        if (shouldRestart() && restarts < options.maxRestarts) {
+            ++restarts;
+            start(getOrigin(),
+                  size_t(std::ceil(lambda * options.populationGrowth)));
+        }
+    }
+
+    /** The best member of all runs so far. */
+    const M &getBest() const { return best; }
+    /** The number of generations of all runs. */
+    size_t getGeneration() const { return generation; }
+    /** The number of evaluated samples of all runs. */
+    size_t getEvaluations() const { return evaluations; }
+    /** The number of restarts so far. */
+    size_t getRestarts() const { return restarts; }
+    /** The number of samples per generation of the current run. */
+    size_t getPopulationSize() const { return lambda; }
+    /** The step size of the current run. */
+    double getSigma() const { return sigma; }
+    /** The mean of the current run, in the coordinates of the search space. */
+    const ColVector<N> &getMean() const { return mean; }
+
+  private:
+    size_t getInitialPopulationSize() const {
+        if (options.populationSize > 0)
+            return options.populationSize;
+        return 4 + size_t(3 * std::log(double(n)));
+    }
+
+    size_t getHistoryLength() const {
+        return 10 + size_t(std::ceil(30.0 * n / lambda));
+    }
+
+    void reset() {
+        generation   = 0;
+        evaluations  = 0;
+        restarts     = 0;
+        bestValid    = false;
+        randomOrigin = false;
+    }
+
+    /** The mean of a new run. */
+    ColVector<N> getOrigin() const {
+        if (!randomOrigin)
+            return origin;
+        Philox::Stream rng = {key, uint32_t(generation), 0, 1};
+        return space.random(rng);
+    }
+
+    /** Start a new run with the given mean and number of samples. */
+    void start(const ColVector<N> &mean, size_t lambda) {
+        this->mean   = space.clamp(mean);
+        this->lambda = std::max<size_t>(lambda, 2);
+        sigma        = options.sigma;
+        mu           = this->lambda / 2;
+
+        weights.resize(mu);
+        double sum = 0;
+        for (size_t i = 0; i < mu; ++i)
+            sum += weights[i] = std::log(mu + 0.5) - std::log(i + 1.0);
+        double sumSq = 0;
+        for (double &w : weights) {
+            w /= sum;
+            sumSq += w * w;
+        }
+        mueff = 1 / sumSq;
+
+        const double nd = n;
+        cc    = (4 + mueff / nd) / (nd + 4 + 2 * mueff / nd);
+        cs    = (mueff + 2) / (nd + mueff + 5);
+        c1    = 2 / ((nd + 1.3) * (nd + 1.3) + mueff);
+        cmu   = std::min(1 - c1, 2 * (mueff - 2 + 1 / mueff) /
+                                     ((nd + 2) * (nd + 2) + mueff));
+        damps = 1 + 2 * std::max(0.0, std::sqrt((mueff - 1) / (nd + 1)) - 1) +
+                cs;
+        chiN  = std::sqrt(nd) * (1 - 1 / (4 * nd) + 1 / (21 * nd * nd));
+
+        C = {};
+        for (size_t j = 0; j < N; ++j)
+            C[j][j] = space.isFixed(j) ? 0 : 1;
+        factors       = udFactorize(C);
+        pc            = {};
+        ps            = {};
+        runGeneration = 0;
+        history.clear();
+        samples.assign(this->lambda, M{});
+        z.assign(this->lambda, ColVector<N>{});
+        y.assign(this->lambda, ColVector<N>{});
+    }
+
+    /**
+     * Update the mean, the evolution paths, the covariance and the step size,
+     * given the indices of the samples sorted from low to high cost.
+     */
+    void update(const std::vector<size_t> &order) {
+        ColVector<N> yw = {}, zw = {};
+        for (size_t i = 0; i < mu; ++i) {
+            yw += weights[i] * y[order[i]];
+            zw += weights[i] * z[order[i]];
+        }
+        mean = space.clamp(mean + sigma * yw);
+
+        ps = (1 - cs) * ps + std::sqrt(cs * (2 - cs) * mueff) * zw;
+        const double psNorm = norm(ps);
+        const double psScale =
+            std::sqrt(1 - std::pow(1 - cs, 2.0 * runGeneration));
+        const bool hsig = psNorm / psScale / chiN < 1.4 + 2 / (n + 1.0);
+        pc              = (1 - cc) * pc;
+        if (hsig)
+            pc += std::sqrt(cc * (2 - cc) * mueff) * yw;
+
+        const double oldWeight = 1 - c1 - cmu + (hsig ? 0 : c1 * cc * (2 - cc));
+        Matrix<N, N> rankMu    = {};
+        for (size_t i = 0; i < mu; ++i)
+            rankMu += weights[i] * y[order[i]] * transpose(y[order[i]]);
+        C = oldWeight * C + c1 * pc * transpose(pc) + cmu * rankMu;
+        factors = udFactorize(C);
+
+        sigma *= std::exp(std::min(1.0, cs / damps * (psNorm / chiN - 1)));
+    }
+
+    bool shouldRestart() const {
+        if (history.size() == getHistoryLength()) {
+            auto range = std::minmax_element(history.begin(), history.end());
+            double lo = *range.first, hi = *range.second;
+            if (lo == hi || hi - lo <= options.tolFun * std::abs(lo))
+                return true;
+        }
+        double maxVar = 0, maxD = 0;
+        double minD   = std::numeric_limits<double>::infinity();
+        for (size_t j = 0; j < N; ++j) {
+            if (space.isFixed(j))
+                continue;
+            maxVar = std::max(maxVar, C[j][j]);
+            minD   = std::min(minD, factors.d[j][0]);
+            maxD   = std::max(maxD, factors.d[j][0]);
+        }
+        if (sigma * std::sqrt(maxVar) < options.tolX)
+            return true;
+        return !(minD > 0) || maxD / minD > options.maxCondition;
+    }
+
+    /** Solve @f$ y = U D^{1/2} z @f$ for z. */
+    ColVector<N> solve(const ColVector<N> &y, const ColVector<N> &sqrtD) const {
+        ColVector<N> z = {};
+        for (size_t i = N; i-- > 0;) {
+            double w = y[i][0];
+            for (size_t j = i + 1; j < N; ++j)
+                w -= factors.U[i][j] * z[j][0] * sqrtD[j][0];
+            z[i][0] = sqrtD[i][0] > 0 ? w / sqrtD[i][0] : 0;
+        }
+        return z;
+    }
+
+    static double norm(const ColVector<N> &v) {
+        double sum = 0;
+        for (size_t j = 0; j < N; ++j)
+            sum += v[j][0] * v[j][0];
+        return std::sqrt(sum);
+    }
+
+    const SearchSpace<N> space;
+    Evaluator<M> &evaluator;
+    const CMAESOptions options;
+    const Philox::Key key;
+    /// The number of free genes.
+    const size_t n;
+    /// The mean of the first run and of the restarts.
+    ColVector<N> origin = {};
+    bool randomOrigin   = false;
+
+    // The state of the current run
+    ColVector<N> mean    = {};
+    double sigma         = 1;
+    Matrix<N, N> C       = {};
+    ColVector<N> pc      = {};
+    ColVector<N> ps      = {};
+    size_t runGeneration = 0;
+    UDFactors<double, N> factors;
+    /// The best costs of the most recent generations.
+    std::deque<double> history;
+
+    // The strategy parameters of the current run
+    size_t lambda = 0;
+    size_t mu     = 0;
+    std::vector<double> weights;
+    double mueff = 0, cc = 0, cs = 0, c1 = 0, cmu = 0, damps = 0, chiN = 0;
+
+    // The samples of the current generation
+    std::vector<M> samples;
+    std::vector<ColVector<N>> z;
+    std::vector<ColVector<N>> y;
+
+    M best             = {};
+    bool bestValid     = false;
+    size_t generation  = 0;
+    size_t evaluations = 0;
+    size_t restarts    = 0;
+};
@@ -1,7 +1,7 @@
 #pragma once
 
 #include <Matrix.hpp>
-#include <random>
+#include <Philox.hpp>
 #include <sstream>
 
 
@@ -12,27 +12,16 @@ template <size_t N>
  */
 using Chromosome = ColVector<N>;
 
-/**
- * Generator used to choose random indices. This generator is also used to
- * perform mutations.
- */
-static std::random_device rd;
-static std::mt19937 gen(rd());  // Mersenne_twister_engine seeded with rd()
-
 
 template <size_t N>
 /**
  * Perform crossing-over between two parent chromosomes to create two child
- * chromosomes.
+ * chromosomes, drawing the index from the given random stream.
  */
 void crossOver(const Chromosome<N> &parent1, const Chromosome<N> &parent2,
-               Chromosome<N> &child1, Chromosome<N> &child2) {
-
-    // Choose a random index in [0,N].
-    std::uniform_int_distribution<size_t> distr(0, N);
-    size_t idx = distr(gen);
-
-    // Flip the genes starting at that random index.
+               Chromosome<N> &child1, Chromosome<N> &child2,
+               Philox::Stream &rng) {
+    size_t idx = rng.index(N + 1);
     for (size_t i = 0; i < idx; i++) {
         child1[i] = parent1[i];
         child2[i] = parent2[i];
@@ -47,17 +36,12 @@ void crossOver(const Chromosome<N> &parent1, const Chromosome<N> &parent2,
 template <size_t N>
 /**
  * Mutate the given chromosome by adding an extra dChrom to the chromosome,
- * where `dChrom[i] = factor*randn*chrom[i]`.
+ * where `dChrom[i] = factor*randn*chrom[i]`, drawing the normal numbers from
+ * the given random stream.
  */
-void mutate(Chromosome<N> &chrom, double factor) {
-
-    // Standard normal distribution
-    std::normal_distribution<double> distribution(0.0, 1.0);
-
-    for (size_t i = 0; i < N; i++) {
-        double random = distribution(gen);
-        chrom[i] += factor * random * chrom[i];
-    }
+void mutate(Chromosome<N> &chrom, double factor, Philox::Stream &rng) {
+    for (size_t i = 0; i < N; i++)
+        chrom[i][0] += factor * rng.normal() * chrom[i][0];
 }
 
 
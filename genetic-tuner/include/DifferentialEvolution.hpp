@@ -0,0 +1,188 @@
+#pragma once
+
+#include <GeneticAlgorithm.hpp>
+#include <SearchSpace.hpp>
+
+#include <algorithm>  // max, min_element
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+/** The settings of DifferentialEvolution. */
+struct DifferentialEvolutionOptions {
+    /// The number of members, at least 4.
+    size_t populationSize = 64;
+    /// The differential weight F, that scales the difference vectors.
+    double weight = 0.5;
+    /// The probability CR that a coordinate of the trial vector is taken from
+    /// the mutant vector instead of the target vector.
+    double crossOverProbability = 0.9;
+};
+
+template <class M>
+/**
+ * Differential evolution (DE/rand/1/bin, Storn and Price).
+ *
+ * Every generation, a trial vector is created for every member of the
+ * population: the difference of two random members, times the weight F, is
+ * added to a third random member, and the result is crossed over with the
+ * member (binomial crossover). All trials are evaluated as one batch, and
+ * every trial replaces its member if it's at least as good.
+ *
+ * The vectors are the coordinates of the given search space, usually the
+ * logarithms of the genes. Coordinates of a mutant that fall outside of the
+ * bounds are moved halfway between the bound and the member.
+ *
+ * A trial with a higher cost than the worst member can't replace any member,
+ * so the evaluation of the trials is aborted at that cutoff.
+ *
+ * As in the GeneticAlgorithm, every trial has its own Philox stream, keyed by
+ * the seed, the generation and the index of the member.
+ */
+class DifferentialEvolution {
+  public:
+    constexpr static size_t N = M::Genes;
+
+    DifferentialEvolution(const SearchSpace<N> &space, Evaluator<M> &evaluator,
+                          const DifferentialEvolutionOptions &options = {},
+                          uint64_t seed = 0)
+        : space{space}, evaluator{evaluator}, options{options},
+          key{Philox::makeKey(seed)}, members(options.populationSize),
+          coordinates(options.populationSize), trials(options.populationSize),
+          trialCoordinates(options.populationSize) {
+        if (options.populationSize < 4) {
+            std::stringstream sstr;
+            sstr << "Error: differential evolution needs at least 4 members ("
+                 << options.populationSize << ")";
+            throw std::invalid_argument(sstr.str());
+        }
+    }
+
+    /**
+     * Initialize the population uniformly in the search space, and evaluate
+     * it.
+     */
+    void initialize() {
+        reset([&](size_t, Philox::Stream &rng) {
+            return space.random(rng);
+        });
+    }
+
+    /**
+     * Initialize the population around the given chromosome, and evaluate
+     * it. The first member is the chromosome itself, the coordinates of the
+     * others have a normal distribution with the given standard deviation.
+     */
+    void initialize(const Chromosome<N> &chromosome, double stddev) {
+        const ColVector<N> x0 = space.toCoordinates(chromosome);
+        reset([&](size_t i, Philox::Stream &rng) {
+            ColVector<N> x = x0;
+            if (i > 0)
+                for (size_t j = 0; j < N; ++j)
+                    x[j][0] += stddev * rng.normal();
+            return x;
+        });
+    }
+
+    /** Create and evaluate the trials, and select the next generation. */
+    void step() {
+        ++generation;
+        const size_t P = members.size();
+        double cutoff  = -std::numeric_limits<double>::infinity();
+        for (const M &m : members)
+            cutoff = std::max(cutoff, m.cost);
+
+#pragma omp parallel for
+        for (size_t i = 0; i < P; ++i) {
+            Philox::Stream rng = {key, uint32_t(generation), uint32_t(i)};
+            size_t r1, r2, r3;
+            do
+                r1 = rng.index(P);
+            while (r1 == i);
+            do
+                r2 = rng.index(P);
+            while (r2 == i || r2 == r1);
+            do
+                r3 = rng.index(P);
+            while (r3 == i || r3 == r1 || r3 == r2);
+
+            // At least one coordinate is taken from the mutant
+            const size_t jrand = rng.index(N);
+            ColVector<N> &x    = trialCoordinates[i];
+            x                  = coordinates[i];
+            for (size_t j = 0; j < N; ++j) {
+                if (j != jrand && rng.uniform() > options.crossOverProbability)
+                    continue;
+                double diff = coordinates[r2][j][0] - coordinates[r3][j][0];
+                double v    = coordinates[r1][j][0] + options.weight * diff;
+                double lo   = space.getLower()[j][0];
+                double hi   = space.getUpper()[j][0];
+                if (v < lo)
+                    v = (lo + coordinates[i][j][0]) / 2;
+                else if (v > hi)
+                    v = (hi + coordinates[i][j][0]) / 2;
+                x[j][0] = v;
+            }
+            trials[i]            = M{};
+            trials[i].chromosome = space.toChromosome(x);
+        }
+        evaluator.evaluate({trials.data(), P}, cutoff);
+        evaluations += P;
+
+        for (size_t i = 0; i < P; ++i) {
+            if (!(members[i].cost < trials[i].cost)) {
+                members[i]     = trials[i];
+                coordinates[i] = trialCoordinates[i];
+            }
+        }
+        updateBest();
+    }
+
+    /** The best member so far. */
+    const M &getBest() const { return members[best]; }
+    const std::vector<M> &getMembers() const { return members; }
+    /** The number of generations since the initialization. */
+    size_t getGeneration() const { return generation; }
+    /** The number of evaluated members, including the initial population. */
+    size_t getEvaluations() const { return evaluations; }
+
+  private:
+    template <class F>
+    void reset(F getCoordinates) {
+        generation     = 0;
+        evaluations    = 0;
+        const size_t P = members.size();
+#pragma omp parallel for
+        for (size_t i = 0; i < P; ++i) {
+            Philox::Stream rng    = {key, 0, uint32_t(i)};
+            coordinates[i]        = space.clamp(getCoordinates(i, rng));
+            members[i]            = M{};
+            members[i].chromosome = space.toChromosome(coordinates[i]);
+        }
+        evaluator.evaluate({members.data(), P},
+                           std::numeric_limits<double>::infinity());
+        evaluations += P;
+        updateBest();
+    }
+
+    void updateBest() {
+        best = std::min_element(members.begin(), members.end()) -
+               members.begin();
+    }
+
+    const SearchSpace<N> space;
+    Evaluator<M> &evaluator;
+    const DifferentialEvolutionOptions options;
+    const Philox::Key key;
+
+    std::vector<M> members;
+    std::vector<ColVector<N>> coordinates;
+    std::vector<M> trials;
+    std::vector<ColVector<N>> trialCoordinates;
+
+    size_t best        = 0;
+    size_t generation  = 0;
+    size_t evaluations = 0;
+};
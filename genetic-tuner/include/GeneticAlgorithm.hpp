@@ -1,56 +1,144 @@
 #pragma once
 #include <Chromosome.hpp>
+#include <GeneticOperators.hpp>
 #include <Member.hpp>
-#include <cmath>
+#include <Population.hpp>
+#include <Span.hpp>
 
-template <size_t N>
+#include <cstdint>
+#include <limits>
+#include <utility>  // move
+
+template <class M>
+/**
+ * Calculates the costs of a batch of members. Engines that evaluate the
+ * members in parallel, or that share work between members, implement this
+ * interface.
+ */
+class Evaluator {
+  public:
+    virtual ~Evaluator() = default;
+
+    /**
+     * Calculate the costs of all given members, and mark them as valid.
+     *
+     * @param   members
+     *          The members to evaluate.
+     * @param   cutoff
+     *          Members with a higher cost than the cutoff can't survive, so
+     *          their evaluation can be aborted, and their cost set to
+     *          infinity.
+     */
+    virtual void evaluate(Span<M> members, double cutoff) = 0;
+};
+
+template <class M, class F>
+/**
+ * Evaluates the members one by one, using the given cost function.
+ */
+class SerialEvaluator : public Evaluator<M> {
+  public:
+    SerialEvaluator(F cost) : cost{std::move(cost)} {}
+
+    void evaluate(Span<M> members, double /* cutoff */) override {
+        for (M &m : members) {
+            m.cost      = cost(m);
+            m.costValid = true;
+        }
+    }
+
+  private:
+    F cost;
+};
+
+template <class M, class F>
+/**
+ * Create a SerialEvaluator for members of type M with the given cost
+ * function `double(const M &)`.
+ */
+SerialEvaluator<M, F> makeSerialEvaluator(F cost) {
+    return {std::move(cost)};
+}
+
+template <class M>
 /**
  * Class providing the structure for the GA.
+ *
+ * Every generation, all members but the survivors are replaced by children
+ * of two survivors chosen by the selection, which are crossed over and
+ * mutated, and the new members are evaluated as one batch. Then the
+ * population is sorted by cost.
+ *
+ * All random numbers of a child are drawn from its own Philox stream, keyed
+ * by the seed, the generation and the index of the child, so the results
+ * only depend on the seed, not on the order in which the children are
+ * created or evaluated.
  */
 class GeneticAlgorithm {
-
   public:
+    constexpr static size_t N = M::Genes;
+
+    GeneticAlgorithm(const Selection &select, const CrossOver<N> &crossOver,
+                     const Mutation<N> &mutate, Evaluator<M> &evaluator,
+                     uint64_t seed = 0)
+        : select{select}, crossOver{crossOver}, mutate{mutate},
+          evaluator{evaluator}, key{Philox::makeKey(seed)} {}
+
+    /** The key of the random streams. */
+    Philox::Key getKey() const { return key; }
 
-    //!!! MOVE THIS TO POPULATION CLASS!!!
-    // Population should know how to 
-    //   - initialize itself across a given domain
-    //   - calculate (and remember) its members' scores
-    //   - return a sub-population with the top x members
     /**
-     * Initialize the population with a given size and spread the population
-     * uniformly across the domain, either using a normal scale or a logarithmic
-     * scale.
+     * Replace all members but the survivors by children of the survivors.
+     * Generation 0 is the initial population, so the generation should be
+     * at least 1.
      */
-    void initializePopulation(ColVector<N> minValues, ColVector<N> maxValues,
-                              size_t size, bool useLogarithm) {
-        population.resize(size);
-
-        if (useLogarithmicDistribution) {
-            // Uniformly distribute members across logarithmic scale.
-            double logValue;
-            for (size_t member = 0; member < size; member++) {
-                for (size_t gene = 0; gene < N; gene++) {
-                    logValue = (double) member / (double) size *
-                               (log(maxValues[gene]) - log(minValues[gene]));
-                    population[member][gene] = pow(10, logValue);
-                }
-            }
-        } else {
-            // Uniformly distribute members across normal scale.
-            for (size_t member = 0; member < size; member++) {
-                for (size_t gene = 0; gene < N; gene++) {
-                    population[member][gene] =
-                        (double) member / (double) size *
-                        (maxValues[gene] - minValues[gene]);
-                }
-            }
+    void breed(Population<M> &population, size_t generation) const {
+        const std::vector<double> costs = population.getSurvivorCosts();
+#pragma omp parallel for
+        for (size_t i = population.getSurvivors(); i < population.size();
+             ++i) {
+            Philox::Stream rng = {key, uint32_t(generation), uint32_t(i)};
+            const M &parent1   = population[select(costs, rng)];
+            const M &parent2   = population[select(costs, rng)];
+            M &child           = population[i];
+            child.chromosome =
+                crossOver(parent1.chromosome, parent2.chromosome, rng);
+            mutate(child.chromosome, rng);
+            child.cost      = std::numeric_limits<double>::infinity();
+            child.costValid = false;
         }
     }
 
     /**
-     * Generate 
+     * Evaluate all members that don't have a valid cost yet, and sort the
+     * population.
+     */
+    void evaluate(Population<M> &population) const {
+        double cutoff = population.cutoff();
+        evaluator.evaluate(population.unevaluated(), cutoff);
+        population.sort();
+    }
+
+    /**
+     * Evaluate the given (initialized) population, and breed and evaluate
+     * the given number of generations. The callback is called with the
+     * generation number and the population after every evaluation.
+     */
+    template <class Callback>
+    void run(Population<M> &population, size_t generations,
+             Callback &&callback) const {
+        for (size_t g = 0; g < generations; ++g) {
+            if (g != 0)
+                breed(population, g);
+            evaluate(population);
+            callback(g, population);
+        }
+    }
 
-  protected:
-    vector<Member> population;
-    vector<Member> allChildren;
-}
\ No newline at end of file
+  private:
+    const Selection &select;
+    const CrossOver<N> &crossOver;
+    const Mutation<N> &mutate;
+    Evaluator<M> &evaluator;
+    const Philox::Key key;
+};
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <Chromosome.hpp>
+
+#include <algorithm>  // clamp
+#include <cmath>      // sqrt
+#include <vector>
+
+/**
+ * Selects a parent among the survivors of a generation.
+ */
+class Selection {
+  public:
+    virtual ~Selection() = default;
+    /**
+     * Return the index of the selected parent, given the costs of the
+     * survivors, sorted from low to high.
+     */
+    virtual size_t operator()(const std::vector<double> &survivorCosts,
+                              Philox::Stream &rng) const = 0;
+};
+
+/**
+ * Selects every survivor with the same probability.
+ */
+class UniformSelection : public Selection {
+  public:
+    size_t operator()(const std::vector<double> &survivorCosts,
+                      Philox::Stream &rng) const override {
+        return rng.index(survivorCosts.size());
+    }
+};
+
+/**
+ * Selects the best of k survivors, chosen uniformly (with replacement).
+ */
+class TournamentSelection : public Selection {
+  public:
+    TournamentSelection(size_t k) : k{k} {}
+
+    size_t operator()(const std::vector<double> &survivorCosts,
+                      Philox::Stream &rng) const override {
+        size_t best = rng.index(survivorCosts.size());
+        for (size_t i = 1; i < k; ++i)
+            // The survivors are sorted, so a lower index is at least as good
+            best = std::min(best, rng.index(survivorCosts.size()));
+        return best;
+    }
+
+  private:
+    size_t k;
+};
+
+template <size_t N>
+/**
+ * Creates a child chromosome from two parent chromosomes.
+ */
+class CrossOver {
+  public:
+    virtual ~CrossOver() = default;
+    virtual Chromosome<N> operator()(const Chromosome<N> &parent1,
+                                     const Chromosome<N> &parent2,
+                                     Philox::Stream &rng) const = 0;
+};
+
+template <size_t N>
+/**
+ * Takes the genes before a random index from the first parent, and the rest
+ * from the second parent.
+ */
+class SinglePointCrossOver : public CrossOver<N> {
+  public:
+    Chromosome<N> operator()(const Chromosome<N> &parent1,
+                             const Chromosome<N> &parent2,
+                             Philox::Stream &rng) const override {
+        Chromosome<N> child1, child2;
+        crossOver(parent1, parent2, child1, child2, rng);
+        return child1;
+    }
+};
+
+template <size_t N>
+/**
+ * Takes every gene from a random parent.
+ */
+class UniformCrossOver : public CrossOver<N> {
+  public:
+    Chromosome<N> operator()(const Chromosome<N> &parent1,
+                             const Chromosome<N> &parent2,
+                             Philox::Stream &rng) const override {
+        Chromosome<N> child;
+        for (size_t i = 0; i < N; ++i)
+            child[i] = rng.index(2) == 0 ? parent1[i] : parent2[i];
+        return child;
+    }
+};
+
+template <size_t N>
+/**
+ * Changes a chromosome in place.
+ */
+class Mutation {
+  public:
+    virtual ~Mutation() = default;
+    virtual void operator()(Chromosome<N> &chromosome,
+                            Philox::Stream &rng) const = 0;
+};
+
+template <size_t N>
+/**
+ * Adds `factor*randn*chrom[i]` to every gene, see `mutate`.
+ */
+class RelativeGaussianMutation : public Mutation<N> {
+  public:
+    RelativeGaussianMutation(double factor) : factor{factor} {}
+
+    void operator()(Chromosome<N> &chromosome,
+                    Philox::Stream &rng) const override {
+        mutate(chromosome, factor, rng);
+    }
+
+  private:
+    double factor;
+};
+
+template <size_t N>
+/**
+ * Adds normally distributed noise with the given variance to every gene, and
+ * clamps the genes to the given bounds.
+ */
+class GaussianMutation : public Mutation<N> {
+  public:
+    GaussianMutation(const ColVector<N> &variance, const ColVector<N> &min,
+                     const ColVector<N> &max)
+        : stddev{map(variance, [](double v) { return std::sqrt(v); })},
+          min{min}, max{max} {}
+
+    void operator()(Chromosome<N> &chromosome,
+                    Philox::Stream &rng) const override {
+        for (size_t i = 0; i < N; ++i)
+            chromosome[i][0] = std::clamp(
+                chromosome[i][0] + stddev[i][0] * rng.normal(), min[i][0],
+                max[i][0]);
+    }
+
+  private:
+    ColVector<N> stddev;
+    ColVector<N> min;
+    ColVector<N> max;
+};
@@ -1,27 +1,38 @@
 #pragma once
 #include <Chromosome.hpp>
+#include <limits>
 
 template <size_t N>
 /**
- * A member is an abstract class containing genetic data and some function to
- * evaluate the fitness of that chromosome. The fitness function (simulation)
- * must be specified by the subclass.
+ * A member of a population, containing genetic data and its cost. The cost
+ * is calculated by an Evaluator, lower is better.
  */
-class Member {
+struct Member {
+    /** The number of genes. */
+    constexpr static size_t Genes = N;
 
-  public:
-    /** Fitness function provided by subclass's simulation. */
-    virtual double getFitness();
+    /** This member's genetic data. */
+    Chromosome<N> chromosome = {};
+    /** The cost of the chromosome, infinity if it can't be evaluated. */
+    double cost = std::numeric_limits<double>::infinity();
+    /** Whether cost is up to date with the chromosome. */
+    bool costValid = false;
 
     /** Get this member's genetic data. */
-    Chromosome<N> getChromosome() { return chromosome; }
-
-    /** Mutate this member's chromosome by a given factor. */
-    void mutateChromosome(double factor) { mutate(chromosome, factor); }
+    const Chromosome<N> &getChromosome() const { return chromosome; }
 
-  protected:
-    /** This member's genetic data. */
-    Chromosome<N> chromosome;
+    /**
+     * Order by cost. Ties are broken by the chromosome, so sorting gives the
+     * same order for any (e.g. parallel) sorting algorithm.
+     */
+    bool operator<(const Member &rhs) const {
+        if (cost != rhs.cost)
+            return cost < rhs.cost;
+        for (size_t i = 0; i < N; ++i)
+            if (chromosome[i][0] != rhs.chromosome[i][0])
+                return chromosome[i][0] < rhs.chromosome[i][0];
+        return false;
+    }
 };
 
 /**
@@ -31,18 +42,9 @@ class Member {
  * n3, u12, u3. We assume symmetry in the x- and y-direction, so Q = diag([q12,
  * q12,q3,w12,w12,w3,n12,n12,n3]) and R = diag([u12,u12,u3]).
  */
-class AttitudeMember : Member<8> {
-
-  public:
-
-    /**
-     * Return the fitness of this AttitudeMember based on simulation results.
-     * TODO: `return 0.0;`
-     */
-    double getFitness() { return 0.0; }
-
+struct AttitudeMember : Member<8> {
     /** Return the diagonal of this AttitudeMember's Q cost matrix. */
-    ColVector<9> getQDiag() {
+    ColVector<9> getQDiag() const {
         return ColVector<9>{
             chromosome[0], chromosome[0], chromosome[1],  // q1, q2, q3
             chromosome[2], chromosome[2], chromosome[3],  // w1, w2, w3
@@ -51,45 +53,44 @@ class AttitudeMember : Member<8> {
     }
 
     /** Return the diagonal of this AttitudeMember's R cost matrix. */
-    ColVector<3> getRDiag() {  // ux, uy, uz
+    ColVector<3> getRDiag() const {  // ux, uy, uz
         return ColVector<3>{chromosome[6], chromosome[6], chromosome[7]};
     }
 
     /** Return this AttitudeMember's Q cost matrix (9x9). */
-    auto getQ() { return diag(getQDiag()); }
+    auto getQ() const { return diag(getQDiag()); }
 
     /** Return this AttitudeMember's R cost matrix (3x3). */
-    auto getR() { return diag(getRDiag()); }
-};
-
-/**
- * Member of the "altitude" population used to determine the LQR cost matrices
- * for the altitude controller. Chromosome contains 3 values for the cost matrix
- * Q and 1 value for the cost matrix R. These values are nt, vz, z, ut. Thus Q =
- * diag([nt,vz,z]) and R = ut.
- */
-class AltitudeMember : Member<4> {
+    auto getR() const { return diag(getRDiag()); }
 
-  public:
     /**
-     * Return the fitness of this AltitudeMember based on simulation results.
-     * TODO: `return 0.0;`
+     * Return the chromosome for the given diagonals of Q and R, which should
+     * be symmetric in the x- and y-direction.
      */
-    double getFitness() { return 0.0; }
-
-    /** Return the diagonal of this AltitudeMember's Q cost matrix. */
-    ColVector<3> getQDiag() {  // nt, vz, z
-        return ColVector<3>{chromosome[0], chromosome[1], chromosome[2]};
+    static Chromosome<8> toChromosome(const ColVector<9> &Q_diag,
+                                      const ColVector<3> &R_diag) {
+        return Chromosome<8>{
+            Q_diag[0], Q_diag[2], Q_diag[3], Q_diag[5],
+            Q_diag[6], Q_diag[8], R_diag[0], R_diag[2],
+        };
     }
+};
 
-    /** Return the diagonal of this AltitudeMember's R cost matrix. */
-    ColVector<1> getRDiag() { return ColVector<1>{chromosome[3]}; }  // ut
-
-    /** Return this AltitudeMember's Q cost matrix (3x3). */
-    auto getQ() { return diag(getQDiag()); }
+/**
+ * Member of the "altitude" population used to determine the gains of the PI
+ * altitude controller. Chromosome contains the 3 proportional gains of the
+ * states nt, z, vz and the integral gain of the height error, in the order of
+ * the columns of K_pi (see Altitude::LQRController). The sign of every gain is
+ * kept by relative mutations.
+ */
+struct AltitudeMember : Member<4> {
+    /** Return the gain matrix K_pi = [K_p, K_i] of this AltitudeMember. */
+    Matrix<1, 4> getK_pi() const { return transpose(chromosome); }
 
-    /** Return this AltitudeMember's R cost matrix (1x1). */
-    auto getR() { return diag(getRDiag()); }
+    /** Return the chromosome for the given gain matrix K_pi. */
+    static Chromosome<4> toChromosome(const Matrix<1, 4> &K_pi) {
+        return transpose(K_pi);
+    }
 };
 
 /**
@@ -99,17 +100,9 @@ class AltitudeMember : Member<4> {
  * q12ref. We assume symmetry in the x- and y-direction, so Q = diag([q12,q12,
  * xy,xy,vxy,vxy]) and R = diag([q12ref,q12ref]).
  */
-class NavigationMember : Member<4> {
-
-  public:
-    /**
-     * Return the fitness of this NavigationMember based on simulation results.
-     * TODO: `return 0.0;`
-     */
-    double getFitness() { return 0.0; }
-
+struct NavigationMember : Member<4> {
     /** Return the diagonal of this NavigationMember's Q cost matrix. */
-    ColVector<6> getQDiag() {
+    ColVector<6> getQDiag() const {
         return ColVector<6>{
             chromosome[0], chromosome[0],  // q1, q2
             chromosome[1], chromosome[1],  // x, y
@@ -118,13 +111,13 @@ class NavigationMember : Member<4> {
     }
 
     /** Return the diagonal of this NavigationMember's R cost matrix. */
-    ColVector<2> getRDiag() {
+    ColVector<2> getRDiag() const {
         return ColVector<2>{chromosome[3], chromosome[3]};  // qref1, qref2
     }
 
     /** Return this NavigationMember's Q cost matrix (6x6). */
-    auto getQ() { return diag(getQDiag()); }
+    auto getQ() const { return diag(getQDiag()); }
 
     /** Return this NavigationMember's R cost matrix (2x2). */
-    auto getR() { return diag(getRDiag()); }
+    auto getR() const { return diag(getRDiag()); }
 };
\ No newline at end of file
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <GeneticOperators.hpp>
+#include <Member.hpp>
+#include <Span.hpp>
+
+#include <algorithm>  // nth_element, sort
+#include <cmath>      // exp, log
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _OPENMP
+#include <parallel/algorithm>
+#endif
+
+template <class M>
+/**
+ * A population of members of type M (a Member or a subclass of Member).
+ *
+ * After every generation, the population is sorted from low to high cost,
+ * and the first members are the survivors. The members that still have to be
+ * evaluated are always at the end of the population.
+ */
+class Population {
+  public:
+    constexpr static size_t N = M::Genes;
+
+    Population(size_t size, size_t survivors)
+        : members(size), survivors(survivors) {
+        if (survivors == 0 || survivors > size) {
+            std::stringstream sstr;
+            sstr << "Error: the number of survivors (" << survivors
+                 << ") should be between 1 and the size of the population ("
+                 << size << ")";
+            throw std::invalid_argument(sstr.str());
+        }
+    }
+
+    /**
+     * Initialize the population with the given chromosome, and with
+     * mutations of it for all members but the first.
+     */
+    void initialize(const Chromosome<N> &chromosome, const Mutation<N> &mutate,
+                    Philox::Key key) {
+#pragma omp parallel for
+        for (size_t i = 0; i < members.size(); ++i) {
+            Philox::Stream rng    = {key, 0, uint32_t(i)};
+            members[i]            = {};
+            members[i].chromosome = chromosome;
+            if (i > 0)
+                mutate(members[i].chromosome, rng);
+        }
+    }
+
+    /**
+     * Initialize the population with random chromosomes, uniformly spread
+     * across the given domain, either using a normal scale or a logarithmic
+     * scale.
+     */
+    void initialize(const ColVector<N> &minValues,
+                    const ColVector<N> &maxValues, bool useLogarithm,
+                    Philox::Key key) {
+#pragma omp parallel for
+        for (size_t i = 0; i < members.size(); ++i) {
+            Philox::Stream rng = {key, 0, uint32_t(i)};
+            members[i]         = {};
+            for (size_t gene = 0; gene < N; gene++) {
+                double lo = minValues[gene][0], hi = maxValues[gene][0];
+                double u  = rng.uniform();
+                members[i].chromosome[gene][0] =
+                    useLogarithm
+                        ? std::exp(std::log(lo) + u * std::log(hi / lo))
+                        : lo + u * (hi - lo);
+            }
+        }
+    }
+
+    size_t size() const { return members.size(); }
+    size_t getSurvivors() const { return survivors; }
+
+    M &operator[](size_t i) { return members[i]; }
+    const M &operator[](size_t i) const { return members[i]; }
+    auto begin() { return members.begin(); }
+    auto end() { return members.end(); }
+    auto begin() const { return members.begin(); }
+    auto end() const { return members.end(); }
+
+    /** The best member, after sorting. */
+    const M &best() const { return members[0]; }
+
+    /** The members at the end of the population that need to be evaluated. */
+    Span<M> unevaluated() {
+        size_t first = 0;
+        while (first < members.size() && members[first].costValid)
+            ++first;
+        return {members.data() + first, members.size() - first};
+    }
+
+    /**
+     * Get the cost of the worst survivor among the evaluated members, or
+     * infinity if fewer members than the number of survivors were evaluated.
+     * Members whose cost exceeds it can never survive.
+     */
+    double cutoff() const {
+        std::vector<double> costs;
+        for (const M &m : members)
+            if (m.costValid)
+                costs.push_back(m.cost);
+        if (costs.size() < survivors)
+            return std::numeric_limits<double>::infinity();
+        std::nth_element(costs.begin(), costs.begin() + survivors - 1,
+                         costs.end());
+        return costs[survivors - 1];
+    }
+
+    /** Sort the population from low to high cost. */
+    void sort() {
+#ifdef _OPENMP
+        __gnu_parallel::sort(members.begin(), members.end());
+#else
+        std::sort(members.begin(), members.end());
+#endif
+    }
+
+    /** Get the costs of the survivors. */
+    std::vector<double> getSurvivorCosts() const {
+        std::vector<double> costs(survivors);
+        for (size_t i = 0; i < survivors; ++i)
+            costs[i] = members[i].cost;
+        return costs;
+    }
+
+  private:
+    std::vector<M> members;
+    size_t survivors;
+};
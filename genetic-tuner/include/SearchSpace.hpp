@@ -0,0 +1,100 @@
+#pragma once
+
+#include <Chromosome.hpp>
+
+#include <algorithm>  // clamp
+#include <cmath>      // exp, log
+#include <sstream>
+#include <stdexcept>
+
+template <size_t N>
+/**
+ * The bounds of the genes, and the mapping between the chromosomes and the
+ * coordinates that the CMA-ES and differential evolution optimizers work
+ * with.
+ *
+ * On a logarithmic scale, the coordinates are the logarithms of the genes,
+ * so a step in the coordinates changes a gene by a factor instead of an
+ * amount. This suits weights, such as the diagonals of the LQR matrices Q and
+ * R, that span many orders of magnitude. Genes with equal lower and upper
+ * bounds are fixed, the optimizers don't search along them.
+ */
+class SearchSpace {
+  public:
+    SearchSpace(const ColVector<N> &min, const ColVector<N> &max,
+                bool logarithmic = true)
+        : logarithmic{logarithmic} {
+        for (size_t i = 0; i < N; ++i) {
+            if (!(min[i][0] <= max[i][0]) ||
+                (logarithmic && !(min[i][0] > 0))) {
+                std::stringstream sstr;
+                sstr << "Error: invalid bounds for gene " << i << " ("
+                     << min[i][0] << ", " << max[i][0] << ")";
+                throw std::invalid_argument(sstr.str());
+            }
+            lower[i][0] = toCoordinate(min[i][0]);
+            upper[i][0] = toCoordinate(max[i][0]);
+        }
+    }
+
+    /** Get the coordinates of the given chromosome. */
+    ColVector<N> toCoordinates(const Chromosome<N> &chromosome) const {
+        ColVector<N> x = {};
+        for (size_t i = 0; i < N; ++i)
+            x[i][0] = toCoordinate(chromosome[i][0]);
+        return x;
+    }
+
+    /**
+     * Get the chromosome at the given coordinates, after clamping them to the
+     * bounds.
+     */
+    Chromosome<N> toChromosome(const ColVector<N> &x) const {
+        Chromosome<N> chromosome = {};
+        for (size_t i = 0; i < N; ++i) {
+            double c = std::clamp(x[i][0], lower[i][0], upper[i][0]);
+            chromosome[i][0] = logarithmic ? std::exp(c) : c;
+        }
+        return chromosome;
+    }
+
+    /** Clamp the given coordinates to the bounds. */
+    ColVector<N> clamp(ColVector<N> x) const {
+        for (size_t i = 0; i < N; ++i)
+            x[i][0] = std::clamp(x[i][0], lower[i][0], upper[i][0]);
+        return x;
+    }
+
+    /** Draw coordinates uniformly between the bounds. */
+    ColVector<N> random(Philox::Stream &rng) const {
+        ColVector<N> x = {};
+        for (size_t i = 0; i < N; ++i)
+            x[i][0] =
+                lower[i][0] + rng.uniform() * (upper[i][0] - lower[i][0]);
+        return x;
+    }
+
+    /** Check whether the given gene is fixed by its bounds. */
+    bool isFixed(size_t i) const { return lower[i][0] == upper[i][0]; }
+
+    /** The number of genes that aren't fixed. */
+    size_t getDimension() const {
+        size_t n = 0;
+        for (size_t i = 0; i < N; ++i)
+            n += !isFixed(i);
+        return n;
+    }
+
+    const ColVector<N> &getLower() const { return lower; }
+    const ColVector<N> &getUpper() const { return upper; }
+    bool isLogarithmic() const { return logarithmic; }
+
+  private:
+    double toCoordinate(double gene) const {
+        return logarithmic ? std::log(gene) : gene;
+    }
+
+    ColVector<N> lower;
+    ColVector<N> upper;
+    bool logarithmic;
+};
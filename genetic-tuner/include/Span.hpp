@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * A view of a contiguous range of elements, e.g. a part of a std::vector.
+ * (C++17 doesn't have std::span yet.)
+ */
+template <class T>
+class Span {
+  public:
+    constexpr Span(T *data, size_t size) : first{data}, count{size} {}
+
+    constexpr T *begin() const { return first; }
+    constexpr T *end() const { return first + count; }
+    constexpr size_t size() const { return count; }
+    constexpr bool empty() const { return count == 0; }
+    constexpr T &operator[](size_t i) const { return first[i]; }
+
+  private:
+    T *first;
+    size_t count;
+};
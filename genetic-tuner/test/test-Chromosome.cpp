@@ -27,7 +27,8 @@ TEST(Chromosome, crossOver) {
     // Chromosome<6> sum = {30.0, 32.0, 34.0, 36.0, 38.0, 40.0};
     Chromosome<6> child1;
     Chromosome<6> child2;
-    crossOver(parent1, parent2, child1, child2);
+    Philox::Stream rng = {Philox::makeKey(0), 0};
+    crossOver(parent1, parent2, child1, child2, rng);
     // for (int i = 0; i < 6; i++)
     //     EXPECT_EQ(child1[i] + child2[i], sum[i]);
     EXPECT_EQ(child1 + child2, parent1 + parent2);
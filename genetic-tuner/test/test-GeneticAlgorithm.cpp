@@ -0,0 +1,118 @@
+#include <GeneticAlgorithm.hpp>
+#include <gtest/gtest.h>
+
+namespace {
+
+double sphere(const Member<3> &m) {
+    const Chromosome<3> target = {1, -2, 3};
+    double cost                = 0;
+    for (size_t i = 0; i < 3; ++i)
+        cost += (m.chromosome[i][0] - target[i][0]) *
+                (m.chromosome[i][0] - target[i][0]);
+    return cost;
+}
+
+Chromosome<3> optimize(uint64_t seed, double &bestCost) {
+    UniformSelection select;
+    SinglePointCrossOver<3> crossOver;
+    GaussianMutation<3> mutate = {0.01 * ones<3, 1>(), -10 * ones<3, 1>(),
+                                  10 * ones<3, 1>()};
+    auto evaluator             = makeSerialEvaluator<Member<3>>(sphere);
+    GeneticAlgorithm<Member<3>> ga = {select, crossOver, mutate, evaluator,
+                                      seed};
+    Population<Member<3>> population = {64, 8};
+    population.initialize(-5 * ones<3, 1>(), 5 * ones<3, 1>(), false,
+                          ga.getKey());
+    double previous = std::numeric_limits<double>::infinity();
+    ga.run(population, 50, [&](size_t, const Population<Member<3>> &p) {
+        // The survivors are kept, so the best cost never increases
+        EXPECT_LE(p.best().cost, previous);
+        previous = p.best().cost;
+    });
+    bestCost = population.best().cost;
+    return population.best().chromosome;
+}
+
+}  // namespace
+
+TEST(GeneticAlgorithm, sphere) {
+    double cost;
+    optimize(1, cost);
+    EXPECT_LT(cost, 1e-2);
+}
+
+TEST(GeneticAlgorithm, reproducible) {
+    double cost1, cost2, cost3;
+    Chromosome<3> a = optimize(42, cost1);
+    Chromosome<3> b = optimize(42, cost2);
+    Chromosome<3> c = optimize(43, cost3);
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(cost1, cost2);
+    EXPECT_NE(a, c);
+}
+
+namespace {
+
+/// Checks the batches and cutoffs that the GA passes to the evaluator.
+struct RecordingEvaluator : Evaluator<Member<1>> {
+    void evaluate(Span<Member<1>> members, double cutoff) override {
+        batchSizes.push_back(members.size());
+        cutoffs.push_back(cutoff);
+        for (Member<1> &m : members) {
+            EXPECT_FALSE(m.costValid);
+            m.cost      = std::abs(m.chromosome[0][0]);
+            m.costValid = true;
+        }
+    }
+    std::vector<size_t> batchSizes;
+    std::vector<double> cutoffs;
+};
+
+}  // namespace
+
+TEST(GeneticAlgorithm, batchesAndCutoff) {
+    UniformSelection select;
+    UniformCrossOver<1> crossOver;
+    RelativeGaussianMutation<1> mutate = {0.1};
+    RecordingEvaluator evaluator;
+    GeneticAlgorithm<Member<1>> ga     = {select, crossOver, mutate, evaluator};
+    Population<Member<1>> population   = {10, 3};
+    population.initialize(Chromosome<1>{1}, mutate, ga.getKey());
+
+    ga.evaluate(population);
+    ga.breed(population, 1);
+    double worstSurvivor = population[2].cost;
+    ga.evaluate(population);
+
+    std::vector<size_t> expectedSizes = {10, 7};
+    EXPECT_EQ(evaluator.batchSizes, expectedSizes);
+    EXPECT_EQ(evaluator.cutoffs[0], std::numeric_limits<double>::infinity());
+    EXPECT_EQ(evaluator.cutoffs[1], worstSurvivor);
+    for (size_t i = 1; i < population.size(); ++i)
+        EXPECT_LE(population[i - 1].cost, population[i].cost);
+}
+
+TEST(GeneticAlgorithm, tournamentPrefersBetterSurvivors) {
+    TournamentSelection select = {3};
+    Philox::Stream rng         = {Philox::makeKey(0), 0};
+    std::vector<double> costs  = {1, 2, 3, 4};
+    std::vector<size_t> counts(costs.size());
+    for (size_t i = 0; i < 4000; ++i)
+        ++counts[select(costs, rng)];
+    for (size_t i = 1; i < counts.size(); ++i)
+        EXPECT_GT(counts[i - 1], counts[i]);
+}
+
+TEST(GeneticAlgorithm, invalidSurvivors) {
+    EXPECT_THROW((Population<Member<1>>{10, 0}), std::invalid_argument);
+    EXPECT_THROW((Population<Member<1>>{10, 11}), std::invalid_argument);
+}
+
+TEST(AttitudeMember, chromosome) {
+    AttitudeMember m;
+    ColVector<9> Q = {1, 1, 2, 3, 3, 4, 5, 5, 6};
+    ColVector<3> R = {7, 7, 8};
+    m.chromosome   = AttitudeMember::toChromosome(Q, R);
+    EXPECT_EQ(m.getQDiag(), Q);
+    EXPECT_EQ(m.getRDiag(), R);
+}
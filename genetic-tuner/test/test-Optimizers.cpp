@@ -0,0 +1,173 @@
+#include <CMAES.hpp>
+#include <DifferentialEvolution.hpp>
+#include <gtest/gtest.h>
+
+namespace {
+
+/**
+ * Ill-conditioned ellipsoid in the logarithms of the first four genes, with
+ * its minimum at genes {10, 0.1, 1000, 1e-3}. The last gene is fixed.
+ */
+double ellipsoid(const Member<5> &m) {
+    const double target[] = {10, 0.1, 1000, 1e-3};
+    double cost           = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        double d = std::log(m.chromosome[i][0] / target[i]);
+        cost += std::pow(10, 2.0 * i) * d * d;
+    }
+    return cost;
+}
+
+SearchSpace<5> getSpace() {
+    return {{1e-6, 1e-6, 1e-6, 1e-6, 1}, {1e6, 1e6, 1e6, 1e6, 1}};
+}
+
+}  // namespace
+
+TEST(SearchSpace, coordinates) {
+    SearchSpace<2> space = {{1e-2, 1}, {1e2, 1}};
+    Chromosome<2> c      = {10, 1};
+    EXPECT_NEAR(space.toCoordinates(c)[0][0], std::log(10), 1e-15);
+    EXPECT_NEAR(space.toChromosome(space.toCoordinates(c))[0][0], 10, 1e-12);
+    // Coordinates outside of the bounds are clamped
+    EXPECT_NEAR(space.toChromosome({10, 3})[0][0], 1e2, 1e-10);
+    EXPECT_EQ(space.toChromosome({10, 3})[1][0], 1);
+    EXPECT_FALSE(space.isFixed(0));
+    EXPECT_TRUE(space.isFixed(1));
+    EXPECT_EQ(space.getDimension(), 1);
+}
+
+TEST(SearchSpace, invalidBounds) {
+    EXPECT_THROW((SearchSpace<1>{{2}, {1}}), std::invalid_argument);
+    EXPECT_THROW((SearchSpace<1>{{0}, {1}}), std::invalid_argument);
+    EXPECT_NO_THROW((SearchSpace<1>{{0}, {1}, false}));
+}
+
+TEST(CMAES, ellipsoid) {
+    auto evaluator       = makeSerialEvaluator<Member<5>>(ellipsoid);
+    CMAES<Member<5>> cma = {getSpace(), evaluator};
+    cma.initialize(Chromosome<5>{1, 1, 1, 1, 1});
+    double previous = std::numeric_limits<double>::infinity();
+    for (size_t g = 0; g < 400 && cma.getBest().cost > 1e-10; ++g) {
+        cma.step();
+        EXPECT_LE(cma.getBest().cost, previous);
+        previous = cma.getBest().cost;
+    }
+    EXPECT_LT(cma.getBest().cost, 1e-10);
+    EXPECT_EQ(cma.getBest().chromosome[4][0], 1);
+    EXPECT_EQ(cma.getRestarts(), 0);
+}
+
+TEST(CMAES, optimumBeyondBound) {
+    // The optimum of the first gene, 1e9, lies beyond its upper bound
+    auto evaluator = makeSerialEvaluator<Member<3>>([](const Member<3> &m) {
+        double cost = 0;
+        for (size_t i = 0; i < 3; ++i) {
+            double d = std::log(m.chromosome[i][0] / (i == 0 ? 1e9 : 1));
+            cost += d * d;
+        }
+        return cost;
+    });
+    SearchSpace<3> space = {{1e-6, 1e-6, 1e-6}, {1e6, 1e6, 1e6}};
+    CMAES<Member<3>> cma = {space, evaluator};
+    cma.initialize(Chromosome<3>{1, 1, 1});
+    for (size_t g = 0; g < 100; ++g)
+        cma.step();
+    const double d = std::log(1e3);
+    EXPECT_NEAR(cma.getBest().cost, d * d, 1e-6);
+    EXPECT_NEAR(cma.getBest().chromosome[0][0], 1e6, 1e-3);
+    // The step size converges instead of diverging along the bound
+    EXPECT_LT(cma.getSigma(), 1e-2);
+    EXPECT_EQ(cma.getRestarts(), 0);
+}
+
+TEST(CMAES, reproducible) {
+    auto evaluator = makeSerialEvaluator<Member<5>>(ellipsoid);
+    auto optimize  = [&](uint64_t seed) {
+        CMAES<Member<5>> cma = {getSpace(), evaluator, {}, seed};
+        cma.initialize();
+        for (size_t g = 0; g < 20; ++g)
+            cma.step();
+        return cma.getBest();
+    };
+    EXPECT_EQ(optimize(42).chromosome, optimize(42).chromosome);
+    EXPECT_NE(optimize(42).chromosome, optimize(43).chromosome);
+}
+
+TEST(CMAES, restartsWithLargerPopulation) {
+    // A flat cost function stagnates immediately
+    auto evaluator = makeSerialEvaluator<Member<5>>(
+        [](const Member<5> &) { return 1.0; });
+    CMAESOptions options   = {};
+    options.populationSize = 6;
+    options.maxRestarts    = 2;
+    CMAES<Member<5>> cma   = {getSpace(), evaluator, options};
+    cma.initialize();
+    for (size_t g = 0; g < 200; ++g)
+        cma.step();
+    EXPECT_EQ(cma.getRestarts(), 2);
+    EXPECT_EQ(cma.getPopulationSize(), 24);
+}
+
+namespace {
+
+/// Checks the batches and cutoffs that DE passes to the evaluator.
+struct RecordingEvaluator : Evaluator<Member<2>> {
+    void evaluate(Span<Member<2>> members, double cutoff) override {
+        batchSizes.push_back(members.size());
+        cutoffs.push_back(cutoff);
+        for (Member<2> &m : members) {
+            double x = m.chromosome[0][0] - 1, y = m.chromosome[1][0] + 2;
+            m.cost      = x * x + y * y;
+            m.costValid = true;
+        }
+    }
+    std::vector<size_t> batchSizes;
+    std::vector<double> cutoffs;
+};
+
+}  // namespace
+
+TEST(DifferentialEvolution, sphere) {
+    SearchSpace<2> space = {{-5, -5}, {5, 5}, false};
+    RecordingEvaluator evaluator;
+    DifferentialEvolutionOptions options = {};
+    options.populationSize               = 20;
+    DifferentialEvolution<Member<2>> de  = {space, evaluator, options, 3};
+    de.initialize();
+    double previous = std::numeric_limits<double>::infinity();
+    for (size_t g = 0; g < 100; ++g) {
+        double worst = 0;
+        for (const Member<2> &m : de.getMembers())
+            worst = std::max(worst, m.cost);
+        de.step();
+        // Trials that are worse than all members are aborted
+        EXPECT_EQ(evaluator.cutoffs.back(), worst);
+        EXPECT_LE(de.getBest().cost, previous);
+        previous = de.getBest().cost;
+    }
+    EXPECT_LT(de.getBest().cost, 1e-12);
+    EXPECT_EQ(evaluator.batchSizes.size(), 101);
+    EXPECT_EQ(evaluator.batchSizes.back(), 20);
+    EXPECT_EQ(de.getEvaluations(), 101 * 20);
+}
+
+TEST(DifferentialEvolution, fixedGenes) {
+    auto evaluator = makeSerialEvaluator<Member<5>>(ellipsoid);
+    DifferentialEvolution<Member<5>> de = {getSpace(), evaluator};
+    de.initialize(Chromosome<5>{1, 1, 1, 1, 1}, 1);
+    for (size_t g = 0; g < 20; ++g)
+        de.step();
+    for (const Member<5> &m : de.getMembers())
+        EXPECT_EQ(m.chromosome[4][0], 1);
+    EXPECT_LT(de.getBest().cost, ellipsoid({{1, 1, 1, 1, 1}}));
+}
+
+TEST(DifferentialEvolution, invalidPopulationSize) {
+    auto evaluator = makeSerialEvaluator<Member<5>>(ellipsoid);
+    DifferentialEvolutionOptions options = {};
+    options.populationSize               = 3;
+    EXPECT_THROW((DifferentialEvolution<Member<5>>{getSpace(), evaluator,
+                                                    options}),
+                 std::invalid_argument);
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "LeastSquares.hpp"  // inv
+
+#include <algorithm>  // max, min
+#include <cmath>      // abs
+
+/**
+ * @brief   Solver for convex quadratic programs with linear inequality
+ *          constraints, using the alternating direction method of multipliers
+ *          (ADMM), as in OSQP.
+ *
+ * Solves
+ * @f[
+ *  \min_z \frac{1}{2} z^\top H z + f^\top z \quad \text{s.t.} \quad
+ *  l \le C z \le u,
+ * @f]
+ * where the matrices H and C are fixed, and the linear cost f and the bounds
+ * l and u can change between solves. The matrix of the linear system that is
+ * solved in every iteration only depends on H and C, so it is inverted once
+ * in the constructor, and every iteration is a fixed number of matrix-vector
+ * products on fixed-size matrices, without any allocations.
+ *
+ * The solution, the constraint values and the multipliers of the previous
+ * solve are used as the initial guess for the next one (warm start).
+ *
+ * @tparam  Nz
+ *          The number of variables.
+ * @tparam  Nc
+ *          The number of constraints.
+ */
+template <size_t Nz, size_t Nc>
+class ADMMQPSolver {
+  public:
+    struct Options {
+        /// Penalty parameter of the constraints.
+        double rho = 1;
+        /// Regularization of the variables.
+        double sigma = 1e-6;
+        /// Over-relaxation parameter, in (0, 2).
+        double alpha = 1.6;
+        /// Tolerance on the infinity norm of the primal and dual residuals.
+        double tolerance = 1e-5;
+        /// Maximum number of iterations of a single solve, which bounds its
+        /// execution time.
+        size_t maxIterations = 200;
+    };
+
+    ADMMQPSolver(const Matrix<Nz, Nz> &H, const Matrix<Nc, Nz> &C,
+                 const Options &opt = {})
+        : H{H}, C{C}, CT{transpose(C)},
+          KKT_inv{inv(H + opt.sigma * eye<Nz>() +
+                      opt.rho * transpose(C) * C)},
+          opt{opt} {}
+
+    /**
+     * @brief   Solve the quadratic program with the given linear cost and
+     *          bounds, starting from the previous solution.
+     *
+     * @return  The number of iterations.
+     */
+    size_t solve(const ColVector<Nz> &f, const ColVector<Nc> &l,
+                 const ColVector<Nc> &u) {
+        const double rho = opt.rho, sigma = opt.sigma, alpha = opt.alpha;
+        // C z is updated with the same relaxation as z, which saves a
+        // matrix-vector product per iteration
+        ColVector<Nc> Cz = C * z;
+        size_t i         = 0;
+        while (i < opt.maxIterations) {
+            ++i;
+            ColVector<Nz> rhs     = sigma * z - f + CT * (rho * s - y);
+            ColVector<Nz> z_tilde = KKT_inv * rhs;
+            ColVector<Nc> s_tilde = C * z_tilde;
+            z  = alpha * z_tilde + (1 - alpha) * z;
+            Cz = alpha * s_tilde + (1 - alpha) * Cz;
+            ColVector<Nc> s_relax = alpha * s_tilde + (1 - alpha) * s;
+            ColVector<Nc> s_prev  = s;
+            for (size_t j = 0; j < Nc; ++j)
+                s[j][0] = std::min(std::max(s_relax[j][0] + y[j][0] / rho,
+                                            l[j][0]),
+                                   u[j][0]);
+            y += rho * (s_relax - s);
+            // Residuals of the optimality conditions
+            if (infNorm(Cz - s) <= opt.tolerance &&
+                infNorm(rho * (CT * (s - s_prev))) <= opt.tolerance)
+                break;
+        }
+        return i;
+    }
+
+    /// Get the solution of the last solve.
+    const ColVector<Nz> &getSolution() const { return z; }
+
+    /**
+     * @brief   Shift the warm start by one stage, for problems with a
+     *          receding horizon where the variables and the constraints
+     *          consist of blocks of Bz variables and Bc constraints per
+     *          stage. The last stage is repeated.
+     */
+    template <size_t Bz, size_t Bc>
+    void shift() {
+        static_assert(Nz % Bz == 0 && Nc % Bc == 0, "Invalid block size");
+        shiftBlocks<Bz>(z);
+        shiftBlocks<Bc>(s);
+        shiftBlocks<Bc>(y);
+    }
+
+    /// Forget the warm start.
+    void reset() {
+        z = {};
+        s = {};
+        y = {};
+    }
+
+    const Matrix<Nz, Nz> H;
+    const Matrix<Nc, Nz> C;
+
+  private:
+    template <size_t N>
+    static double infNorm(const ColVector<N> &v) {
+        double result = 0;
+        for (size_t j = 0; j < N; ++j)
+            result = std::max(result, std::abs(v[j][0]));
+        return result;
+    }
+
+    template <size_t B, size_t N>
+    static void shiftBlocks(ColVector<N> &v) {
+        for (size_t j = 0; j + B < N; ++j)
+            v[j] = v[j + B];
+    }
+
+    const Matrix<Nz, Nc> CT;
+    const Matrix<Nz, Nz> KKT_inv;
+    const Options opt;
+    ColVector<Nz> z = {};
+    ColVector<Nc> s = {};
+    ColVector<Nc> y = {};
+};
@@ -81,6 +81,16 @@ ColVector<R> ColVectorFromCppArray(const U (&a)[R]) {
     return result;
 }
 
+// Convert the elements of a matrix to a different type
+template <class T, class U, size_t R, size_t C>
+constexpr TMatrix<T, R, C> matrixCast(const TMatrix<U, R, C> &src) {
+    TMatrix<T, R, C> result = {};
+    for (size_t r = 0; r < R; ++r)
+        for (size_t c = 0; c < C; ++c)
+            result[r][c] = static_cast<T>(src[r][c]);
+    return result;
+}
+
 namespace Matrices {
 
 struct TransposeStruct {
@@ -297,6 +307,21 @@ constexpr double norm(const TColVector<T, C> &colvector) {
     return sqrt(normsq(colvector));
 }
 
+template <class T, size_t R, size_t C>
+constexpr double normsq(const TMatrix<T, R, C> &matrix) {
+    double sumsq = 0;
+    for (const auto &row : matrix)
+        for (const auto &el : row)
+            sumsq += el * el;
+    return sumsq;
+}
+
+/// Frobenius norm
+template <class T, size_t R, size_t C>
+constexpr double norm(const TMatrix<T, R, C> &matrix) {
+    return sqrt(normsq(matrix));
+}
+
 template <class T, size_t N>
 constexpr double normsq(const Array<T, N> &vector) {
     double sumsq = 0;
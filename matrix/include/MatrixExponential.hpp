@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Matrix.hpp"
+
+#include <cmath>  // ceil, log2
+
+/**
+ * @brief   Calculate the matrix exponential @f$ e^A @f$, using scaling and
+ *          squaring with a truncated Taylor series.
+ *
+ * The matrix is scaled by @f$ 2^{-s} @f$ so that its norm is at most 1/2, and
+ * the result is squared s times. With 16 terms, the truncation error of the
+ * scaled exponential is below the machine precision.
+ */
+template <size_t N>
+Matrix<N, N> expm(const Matrix<N, N> &A) {
+    const double a = norm(A);
+    const int s    = a > 0.5 ? int(std::ceil(std::log2(a / 0.5))) : 0;
+    const Matrix<N, N> As = A / double(1ul << s);
+    // Taylor series, evaluated with Horner's scheme
+    Matrix<N, N> E = eye<N>();
+    for (size_t k = 16; k > 0; --k)
+        E = eye<N>() + As * E / double(k);
+    for (int i = 0; i < s; ++i)
+        E = E * E;
+    return E;
+}
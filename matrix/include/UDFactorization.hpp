@@ -0,0 +1,147 @@
+#pragma once
+
+#include "Matrix.hpp"
+
+/**
+ * @brief   A symmetric positive semidefinite matrix @f$ P = U D U^\top @f$,
+ *          stored as a unit upper triangular matrix U and the diagonal d of
+ *          the diagonal matrix D.
+ *
+ * Propagating the factors instead of P keeps P symmetric and positive
+ * semidefinite by construction, and the factors have about half the dynamic
+ * range of P, which makes Kalman filters in single precision well-behaved.
+ * All operations are in place, on fixed-size matrices, without allocations.
+ */
+template <class T, size_t N>
+struct UDFactors {
+    TMatrix<T, N, N> U = Teye<T, N>();
+    TColVector<T, N> d = {};
+
+    /// Calculate @f$ U D U^\top @f$.
+    TMatrix<T, N, N> toMatrix() const {
+        TMatrix<T, N, N> P = {};
+        for (size_t i = 0; i < N; ++i)
+            for (size_t j = i; j < N; ++j) {
+                T sum = 0;
+                for (size_t k = j; k < N; ++k)
+                    sum += U[i][k] * d[k][0] * U[j][k];
+                P[i][j] = sum;
+                P[j][i] = sum;
+            }
+        return P;
+    }
+};
+
+/**
+ * @brief   Factorize a symmetric positive semidefinite matrix as
+ *          @f$ P = U D U^\top @f$. Only the upper triangle of P is used.
+ */
+template <class T, size_t N>
+UDFactors<T, N> udFactorize(const TMatrix<T, N, N> &P) {
+    UDFactors<T, N> f = {};
+    for (size_t jj = N; jj-- > 0;) {
+        T djj = P[jj][jj];
+        for (size_t k = jj + 1; k < N; ++k)
+            djj -= f.d[k][0] * f.U[jj][k] * f.U[jj][k];
+        f.d[jj][0] = djj;
+        for (size_t i = 0; i < jj; ++i) {
+            T uij = P[i][jj];
+            for (size_t k = jj + 1; k < N; ++k)
+                uij -= f.d[k][0] * f.U[i][k] * f.U[jj][k];
+            f.U[i][jj] = djj > 0 ? uij / djj : T{0};
+        }
+    }
+    return f;
+}
+
+/**
+ * @brief   Bierman's measurement update of the factors of the covariance of
+ *          a Kalman filter, for a scalar measurement @f$ z = h x + v @f$,
+ *          where v has variance r.
+ *
+ * Measurements with a diagonal covariance are processed one element at a
+ * time, which avoids any matrix inversion.
+ *
+ * @return  The Kalman gain k, so that the updated estimate is
+ *          @f$ \hat{x} + k\,(z - h \hat{x}) @f$.
+ */
+template <class T, size_t N>
+TColVector<T, N> biermanUpdate(UDFactors<T, N> &f, const TRowVector<T, N> &h,
+                               T r) {
+    // fv = U^T h^T, v = D fv
+    TColVector<T, N> fv = {}, v = {}, b = {};
+    for (size_t j = 0; j < N; ++j) {
+        T sum = h[0][j];
+        for (size_t i = 0; i < j; ++i)
+            sum += f.U[i][j] * h[0][i];
+        fv[j][0] = sum;
+        v[j][0]  = f.d[j][0] * sum;
+    }
+    T alpha = r;
+    for (size_t j = 0; j < N; ++j) {
+        T alpha_prev = alpha;
+        alpha += fv[j][0] * v[j][0];
+        f.d[j][0] *= alpha_prev / alpha;
+        b[j][0]        = v[j][0];
+        const T lambda = -fv[j][0] / alpha_prev;
+        for (size_t i = 0; i < j; ++i) {
+            T uij     = f.U[i][j];
+            f.U[i][j] = uij + b[i][0] * lambda;
+            b[i][0] += uij * v[j][0];
+        }
+    }
+    for (size_t i = 0; i < N; ++i)
+        b[i][0] /= alpha;
+    return b;
+}
+
+/**
+ * @brief   Thornton's time update of the factors of the covariance of a
+ *          Kalman filter, @f$ P \leftarrow A P A^\top + G Q G^\top @f$, with
+ *          diagonal process noise covariance @f$ Q = \operatorname{diag}(q)
+ *          @f$, using a modified weighted Gram-Schmidt orthogonalization.
+ */
+template <class T, size_t N, size_t M>
+void thorntonUpdate(UDFactors<T, N> &f, const TMatrix<T, N, N> &A,
+                    const TMatrix<T, N, M> &G, const TRowVector<T, M> &q) {
+    // Rows of W = [A U, G], with weights [d, q]. U is unit upper triangular,
+    // so A U only needs the upper triangle.
+    TMatrix<T, N, N + M> W       = {};
+    TRowVector<T, N + M> weights = {};
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t j = 0; j < N; ++j) {
+            T sum = A[i][j];
+            for (size_t k = 0; k < j; ++k)
+                sum += A[i][k] * f.U[k][j];
+            W[i][j] = sum;
+        }
+        for (size_t j = 0; j < M; ++j)
+            W[i][N + j] = G[i][j];
+    }
+    for (size_t j = 0; j < N; ++j)
+        weights[0][j] = f.d[j][0];
+    for (size_t j = 0; j < M; ++j)
+        weights[0][N + j] = q[0][j];
+
+    TRowVector<T, N + M> c = {};
+    for (size_t k = N; k-- > 0;) {
+        T dk = 0;
+        for (size_t j = 0; j < N + M; ++j) {
+            c[0][j] = weights[0][j] * W[k][j];
+            dk += W[k][j] * c[0][j];
+        }
+        f.d[k][0] = dk;
+        f.U[k][k] = 1;
+        for (size_t i = 0; i < k; ++i) {
+            T uik = 0;
+            if (dk > 0) {
+                for (size_t j = 0; j < N + M; ++j)
+                    uik += W[i][j] * c[0][j];
+                uik /= dk;
+                for (size_t j = 0; j < N + M; ++j)
+                    W[i][j] -= uik * W[k][j];
+            }
+            f.U[i][k] = uik;
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+
+#include <ADMM.hpp>
+#include <AlmostEqual.hpp>
+
+/**
+ * Without active constraints, the solution is the unconstrained minimum
+ * @f$ -H^{-1} f @f$.
+ */
+TEST(ADMM, unconstrained) {
+    Matrix<3, 3> H = {{{4, 1, 0}, {1, 3, -1}, {0, -1, 2}}};
+    Matrix<3, 3> C = eye<3>();
+    ColVector<3> f = {1, -2, 0.5};
+    ColVector<3> l = -1e3 * ones<3, 1>();
+    ColVector<3> u = 1e3 * ones<3, 1>();
+
+    ADMMQPSolver<3, 3>::Options opt = {};
+    opt.tolerance                   = 1e-10;
+    opt.maxIterations               = 1000;
+    ADMMQPSolver<3, 3> solver       = {H, C, opt};
+    size_t iterations               = solver.solve(f, l, u);
+    EXPECT_LT(iterations, opt.maxIterations);
+    EXPECT_TRUE(isAlmostEqual(solver.getSolution(), -(inv(H) * f), 1e-8));
+}
+
+/**
+ * Projection of a point onto a box and a half plane, with a known solution.
+ */
+TEST(ADMM, constrained) {
+    // min ½‖z - p‖² s.t. 0 ≤ z ≤ 1, z₀ + z₁ ≤ 1
+    Matrix<2, 2> H = eye<2>();
+    Matrix<3, 2> C = {{{1, 0}, {0, 1}, {1, 1}}};
+    ColVector<2> p = {2, 0.5};
+    ColVector<3> l = {0, 0, -1e3};
+    ColVector<3> u = {1, 1, 1};
+
+    ADMMQPSolver<2, 3>::Options opt = {};
+    opt.tolerance                   = 1e-10;
+    opt.maxIterations               = 1000;
+    ADMMQPSolver<2, 3> solver       = {H, C, opt};
+    size_t cold                     = solver.solve(-p, l, u);
+    EXPECT_LT(cold, opt.maxIterations);
+    EXPECT_TRUE(isAlmostEqual(solver.getSolution(), {1, 0}, 1e-8));
+
+    // Warm start from the previous solution
+    size_t warm = solver.solve(-p, l, u);
+    EXPECT_LT(warm, cold);
+    solver.reset();
+    EXPECT_EQ(solver.solve(-p, l, u), cold);
+
+    // The iterations are limited
+    opt.maxIterations                = 3;
+    ADMMQPSolver<2, 3> limitedSolver = {H, C, opt};
+    EXPECT_EQ(limitedSolver.solve(-p, l, u), 3);
+}
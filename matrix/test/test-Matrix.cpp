@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include <Matrix.hpp>
+#include <MatrixExponential.hpp>
 
 using Matrices::T;
 using std::cout;
@@ -409,4 +410,29 @@ TEST(Matrix, innerProduct) {
     ColVector<3> y  = {4, 5, 6};
     double expected = 1 * 4 + 2 * 5 + 3 * 6;
     ASSERT_EQ(x * y, expected);
-}
\ No newline at end of file
+}
+
+TEST(Matrix, frobeniusNorm) {
+    Matrix<2, 3> m = {{
+        {1, 2, 3},
+        {4, 5, 6},
+    }};
+    double expected = 1 + 4 + 9 + 16 + 25 + 36;
+    ASSERT_EQ(normsq(m), expected);
+    ASSERT_EQ(norm(m), std::sqrt(expected));
+    ColVector<3> v = {1, 2, 3};
+    ASSERT_EQ(norm(v), std::sqrt(14));
+}
+
+TEST(Matrix, expm) {
+    // The exponential of a rotation generator is a rotation matrix
+    const double t = 2.5;
+    Matrix<2, 2> W = {{{0, -t}, {t, 0}}};
+    Matrix<2, 2> R = {{{cos(t), -sin(t)}, {sin(t), cos(t)}}};
+    EXPECT_LT(norm(expm(W) - R), 1e-14);
+    // The series of a nilpotent matrix terminates
+    Matrix<3, 3> N    = {{{0, 1, 0}, {0, 0, 1}, {0, 0, 0}}};
+    Matrix<3, 3> expN = {{{1, 1, 0.5}, {0, 1, 1}, {0, 0, 1}}};
+    EXPECT_LT(norm(expm(N) - expN), 1e-15);
+    EXPECT_EQ(expm(zeros<3, 3>()), eye<3>());
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include <UDFactorization.hpp>
+
+static const Matrix<4, 4> A = {{
+    {1.0, 0.1, 0.0, 0.0},
+    {0.0, 1.0, 0.1, 0.0},
+    {0.0, 0.0, 0.9, 0.2},
+    {0.3, 0.0, 0.0, 0.8},
+}};
+static const Matrix<4, 2> G = {{
+    {0.0, 0.1},
+    {0.2, 0.0},
+    {0.0, 1.0},
+    {1.0, 0.5},
+}};
+static const Matrix<4, 4> P = {{
+    {4.0, 1.0, 0.5, 0.2},
+    {1.0, 3.0, 0.3, 0.1},
+    {0.5, 0.3, 2.0, 0.4},
+    {0.2, 0.1, 0.4, 1.0},
+}};
+
+TEST(UDFactorization, factorize) {
+    UDFactors<double, 4> f = udFactorize(P);
+    for (size_t i = 0; i < 4; ++i) {
+        EXPECT_DOUBLE_EQ(f.U[i][i], 1.0);
+        for (size_t j = 0; j < i; ++j)
+            EXPECT_EQ(f.U[i][j], 0.0);
+        EXPECT_GT(f.d[i][0], 0.0);
+    }
+    EXPECT_LT(norm(f.toMatrix() - P), 1e-14);
+}
+
+/// Compare to @f$ K = P h^\top / (h P h^\top + r),\ P' = P - K h P @f$.
+TEST(UDFactorization, biermanUpdate) {
+    UDFactors<double, 4> f = udFactorize(P);
+    RowVector<4> h         = {{{1.0, 0.0, -0.5, 2.0}}};
+    double r               = 0.3;
+
+    ColVector<4> k = biermanUpdate(f, h, r);
+
+    double s                = (h * P * transpose(h))[0][0] + r;
+    ColVector<4> k_expected = P * transpose(h) * (1.0 / s);
+    Matrix<4, 4> P_expected = P - k_expected * h * P;
+    EXPECT_LT(norm(k - k_expected), 1e-14);
+    EXPECT_LT(norm(f.toMatrix() - P_expected), 1e-13);
+}
+
+/// Compare to @f$ P' = A P A^\top + G Q G^\top @f$.
+TEST(UDFactorization, thorntonUpdate) {
+    UDFactors<double, 4> f = udFactorize(P);
+    RowVector<2> q         = {{{0.5, 2.0}}};
+
+    thorntonUpdate(f, A, G, q);
+
+    Matrix<4, 4> P_expected =
+        A * P * transpose(A) + G * diag(q) * transpose(G);
+    EXPECT_LT(norm(f.toMatrix() - P_expected), 1e-13);
+    for (size_t i = 0; i < 4; ++i)
+        for (size_t j = 0; j < i; ++j)
+            EXPECT_EQ(f.U[i][j], 0.0);
+}
+
+/**
+ * A long sequence of updates in single precision stays close to the same
+ * updates in double precision, and the covariance stays positive definite.
+ */
+TEST(UDFactorization, singlePrecision) {
+    UDFactors<double, 4> fd = udFactorize(P);
+    UDFactors<float, 4> ff  = udFactorize(matrixCast<float>(P));
+    RowVector<4> h          = {{{1.0, 0.0, 0.0, 0.0}}};
+    RowVector<2> q          = {{{1e-4, 1e-4}}};
+    for (size_t i = 0; i < 1000; ++i) {
+        biermanUpdate(fd, h, 1e-6);
+        biermanUpdate(ff, matrixCast<float>(h), 1e-6f);
+        thorntonUpdate(fd, A, G, q);
+        thorntonUpdate(ff, matrixCast<float>(A), matrixCast<float>(G),
+                       matrixCast<float>(q));
+    }
+    Matrix<4, 4> Pd = fd.toMatrix();
+    Matrix<4, 4> Pf = matrixCast<double>(ff.toMatrix());
+    EXPECT_LT(norm(Pf - Pd), 1e-4 * norm(Pd));
+    for (size_t i = 0; i < 4; ++i)
+        EXPECT_GT(ff.d[i][0], 0.0f);
+}
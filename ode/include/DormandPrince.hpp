@@ -4,6 +4,7 @@
 #include <cstddef>  // size_t
 #include <exception>
 #include <limits>  // epsilon
+#include <stdexcept>
 
 #include "DormandPrinceConstants.hpp"
 #include "ODEOptions.hpp"
@@ -11,16 +12,46 @@
 
 inline double norm(double x) { return fabs(x); }
 
-template <class IteratorTimeBegin, class IteratorXBegin, class F, class T,
-          bool StoreIntermediate = true>
+/**
+ * @brief   The local coordinates of a vector space: the state itself is
+ *          integrated, so dormandPrinceChart reduces to the classic
+ *          Dormand–Prince method.
+ */
+template <class T>
+struct IdentityChart {
+    using Local = T;
+    T retract(const T &x, const T &z) const { return x + z; }
+    const T &localDerivative(const T & /* z */, const T & /* x */,
+                             const T &x_dot) const {
+        return x_dot;
+    }
+};
+
+/**
+ * @brief   Dormand–Prince integration in local coordinates.
+ *
+ * Every step integrates local coordinates z around the state @f$ x_0 @f$ at
+ * the start of that step, where @f$ x = \texttt{chart.retract}(x_0, z) @f$ and
+ * z = 0 corresponds to @f$ x_0 @f$. The chart maps the derivative of the
+ * state to the derivative of the local coordinates, as
+ * `chart.localDerivative(z, x, f(t, x))`, and defines the type of the local
+ * coordinates as `Chart::Local`. The error is measured in the local
+ * coordinates.
+ *
+ * @see     IdentityChart, dormandPrinceLie
+ */
+template <class IteratorTimeBegin, class IteratorXBegin, class F, class Chart,
+          class T, bool StoreIntermediate = true>
 std::pair<ODEResultCode, size_t>
-dormandPrince(IteratorTimeBegin timeresult, IteratorXBegin xresult,
-              F f,                           // function f(double t, T x)
-              T x_start,                     // initial value
-              const AdaptiveODEOptions &opt  // options
+dormandPrinceChart(IteratorTimeBegin timeresult, IteratorXBegin xresult,
+                   F f,                           // function f(double t, T x)
+                   const Chart &chart,            // local coordinates
+                   T x_start,                     // initial value
+                   const AdaptiveODEOptions &opt  // options
 ) {
     using namespace DormandPrinceConstants;
     using std::isfinite;
+    using Z  = typename Chart::Local;
     double t = opt.t_start;
     T x      = x_start;
     double h = opt.h_start;
@@ -45,26 +76,29 @@ dormandPrince(IteratorTimeBegin timeresult, IteratorXBegin xresult,
 #endif  // TODO: this is slow, and not really necessary, because K1 is checked 
         //       later
 
+        // Derivative of the local coordinates around x
+        auto g = [&](double t, const Z &z) -> Z {
+            T x_z = chart.retract(x, z);
+            return chart.localDerivative(z, x_z, f(t, x_z));
+        };
+
         // Calculate all seven slopes
-        T K1 = f(t, x);
-        T K2 = f(t + c2 * h, x + h * (a21 * K1));
-        T K3 = f(t + c3 * h, x + h * (a31 * K1 + a32 * K2));
-        T K4 = f(t + c4 * h, x + h * (a41 * K1 + a42 * K2 + a43 * K3));
-        T K5 =
-            f(t + c5 * h, x + h * (a51 * K1 + a52 * K2 + a53 * K3 + a54 * K4));
-        T K6 = f(t + h, x + h * (a61 * K1 + a62 * K2 + a63 * K3 + a64 * K4 +
-                                 a65 * K5));
-        T K7 = f(t + h, x + h * (a71 * K1 + a72 * K2 + a73 * K3 + a74 * K4 +
-                                 a75 * K5 + a76 * K6));
+        Z K1 = chart.localDerivative(Z{}, x, f(t, x));
+        Z K2 = g(t + c2 * h, h * (a21 * K1));
+        Z K3 = g(t + c3 * h, h * (a31 * K1 + a32 * K2));
+        Z K4 = g(t + c4 * h, h * (a41 * K1 + a42 * K2 + a43 * K3));
+        Z K5 = g(t + c5 * h, h * (a51 * K1 + a52 * K2 + a53 * K3 + a54 * K4));
+        Z K6 = g(t + h,
+                 h * (a61 * K1 + a62 * K2 + a63 * K3 + a64 * K4 + a65 * K5));
+        Z K7 = g(t + h, h * (a71 * K1 + a72 * K2 + a73 * K3 + a74 * K4 +
+                             a75 * K5 + a76 * K6));
 
         double error =
             norm((b1 - b1p) * K1 + (b3 - b3p) * K3 + (b4 - b4p) * K4 +
                  (b5 - b5p) * K5 + (b6 - b6p) * K6 + (b7 - b7p) * K7);
 
-        if (!isfinite(K1)) {
-            std::cerr << "Error: K1 is not finite" << std::endl;
+        if (!isfinite(K1))
             throw std::runtime_error("Error: K1 is not finite");
-        }
 
         double s = pow(h * opt.epsilon / 2.0 / error, 1.0 / 5.0);
 
@@ -87,7 +121,8 @@ dormandPrince(IteratorTimeBegin timeresult, IteratorXBegin xresult,
 
         if (error < opt.epsilon) {
             t_new += h;
-            x_new += h * (b1 * K1 + b3 * K3 + b4 * K4 + b5 * K5 + b6 * K6);
+            x_new = chart.retract(
+                x, h * (b1 * K1 + b3 * K3 + b4 * K4 + b5 * K5 + b6 * K6));
             if constexpr (StoreIntermediate) {
                 *timeresult++ = {t_new};
                 *xresult++    = {x_new};
@@ -114,6 +149,19 @@ dormandPrince(IteratorTimeBegin timeresult, IteratorXBegin xresult,
     return {resultCode, opt.maxiter};
 }
 
+template <class IteratorTimeBegin, class IteratorXBegin, class F, class T,
+          bool StoreIntermediate = true>
+std::pair<ODEResultCode, size_t>
+dormandPrince(IteratorTimeBegin timeresult, IteratorXBegin xresult,
+              F f,                           // function f(double t, T x)
+              T x_start,                     // initial value
+              const AdaptiveODEOptions &opt  // options
+) {
+    return dormandPrinceChart<IteratorTimeBegin, IteratorXBegin, F,
+                              IdentityChart<T>, T, StoreIntermediate>(
+        timeresult, xresult, f, IdentityChart<T>{}, x_start, opt);
+}
+
 template <class F, class T>
 ODEResultX<T> dormandPrince(F f,        // function f(double t, T x)
                             T x_start,  // initial value
@@ -137,4 +185,24 @@ ODEResultX<T> dormandPrinceEndResult(F f,        // function f(double t, T x)
         dormandPrince<decltype(t_v.begin()), decltype(x_v.begin()), F, T,
                       false>(t_v.begin(), x_v.begin(), f, x_start, opt);
     return {t_v, x_v, result.first, result.second};
-}
\ No newline at end of file
+}
+
+/**
+ * @brief   Integrate over [opt.t_start, opt.t_end], replacing the given
+ *          initial state by the final state.
+ * 
+ * Unlike dormandPrinceEndResult, this doesn't allocate any memory, so it can
+ * be used in tight simulation loops.  
+ * If the maximum number of iterations is exceeded, x is left unchanged.
+ * 
+ * @return  The result code and the number of iterations.
+ */
+template <class F, class T>
+std::pair<ODEResultCode, size_t>
+dormandPrinceInPlace(F f,   // function f(double t, T x)
+                     T &x,  // initial value, replaced by the final value
+                     const AdaptiveODEOptions &opt  // options
+) {
+    double t_end;
+    return dormandPrince<double *, T *, F, T, false>(&t_end, &x, f, x, opt);
+}
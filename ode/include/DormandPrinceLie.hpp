@@ -0,0 +1,51 @@
+#pragma once
+
+#include "DormandPrince.hpp"
+
+/**
+ * @brief   Runge–Kutta–Munthe-Kaas integration with the Dormand–Prince
+ *          tableau, for states that don't live in a vector space, e.g.
+ *          states that contain a unit quaternion.
+ *
+ * Instead of integrating the state x itself, every step integrates local
+ * coordinates z around the state at the start of that step, see
+ * dormandPrinceChart. For a Lie group, the retraction is the exponential map,
+ * and the local derivative is the inverse of its differential applied to the
+ * Lie algebra element.
+ *
+ * Every state is constructed by the retraction, so it never leaves the
+ * manifold, and the step size is only limited by the accuracy of the
+ * solution, not by the drift away from the manifold.
+ */
+template <class F, class Chart, class T>
+ODEResultX<T> dormandPrinceLie(F f,                // function f(double t, T x)
+                               const Chart &chart,  // local coordinates
+                               T x_start,           // initial value
+                               const AdaptiveODEOptions &opt  // options
+) {
+    std::vector<double> t_v;
+    std::vector<T> x_v;
+    auto result = dormandPrinceChart(std::back_inserter(t_v),
+                                     std::back_inserter(x_v), f, chart,
+                                     x_start, opt);
+    return {t_v, x_v, result.first, result.second};
+}
+
+/**
+ * @brief   Integrate over [opt.t_start, opt.t_end] using local coordinates,
+ *          replacing the given initial state by the final state, without
+ *          allocating any memory.
+ *
+ * @see     dormandPrinceInPlace
+ */
+template <class F, class Chart, class T>
+std::pair<ODEResultCode, size_t>
+dormandPrinceLieInPlace(F f,                // function f(double t, T x)
+                        const Chart &chart,  // local coordinates
+                        T &x,  // initial value, replaced by the final value
+                        const AdaptiveODEOptions &opt  // options
+) {
+    double t_end;
+    return dormandPrinceChart<double *, T *, F, Chart, T, false>(
+        &t_end, &x, f, chart, x, opt);
+}
@@ -38,6 +38,39 @@ TEST(DoPri, euler) {
     ASSERT_EQ(endresult.time.size(), 1);
 }
 
+TEST(DoPri, inPlace) {
+    using Type = ColVector<3>;
+    auto func  = [](double t, const Type &x) {
+        (void) t;
+        return x;
+    };  // x'(t) = x(t) → x(t) = e^t
+
+    AdaptiveODEOptions opt = {};
+    opt.t_start            = 0;
+    opt.t_end              = 1;
+    opt.epsilon            = 1e-12;
+    opt.h_start            = 1e-2;
+    opt.h_min              = 1e-6;
+    opt.maxiter            = 1e6;
+
+    Type x_start = {{{1}, {2}, {3}}};
+    Type x       = x_start;
+
+    auto endresult = dormandPrinceEndResult(func, x_start, opt);
+    auto result    = dormandPrinceInPlace(func, x, opt);
+
+    ASSERT_EQ(result.first, endresult.resultCode);
+    ASSERT_EQ(result.second, endresult.iterations);
+    ASSERT_EQ(x, endresult.solution[0]);
+
+    // When the maximum number of iterations is exceeded, x is not modified
+    opt.maxiter = 2;
+    x           = x_start;
+    result      = dormandPrinceInPlace(func, x, opt);
+    ASSERT_TRUE(result.first & ODEResultCodes::MAXIMUM_ITERATIONS_EXCEEDED);
+    ASSERT_EQ(x, x_start);
+}
+
 TEST(DoPri, eulerVector) {
     using Type = ColVector<3>;
     auto func  = [](double t, Type x) {
@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+
+#include <DormandPrinceLie.hpp>
+#include <Matrix.hpp>
+
+#include <cmath>
+
+/// The unit circle, with the angle as local coordinate.
+struct CircleChart {
+    using Local = double;
+
+    static ColVector<2> retract(const ColVector<2> &x0, Local z) {
+        const double c = std::cos(z), s = std::sin(z);
+        return {c * x0[0][0] - s * x0[1][0], s * x0[0][0] + c * x0[1][0]};
+    }
+
+    static Local localDerivative(Local, const ColVector<2> &x,
+                                 const ColVector<2> &x_dot) {
+        return x[0][0] * x_dot[1][0] - x[1][0] * x_dot[0][0];
+    }
+};
+
+TEST(DoPriLie, circle) {
+    // Rotation with a time-varying angular velocity ω(t) = 1 + sin(t)
+    auto func = [](double t, const ColVector<2> &x) {
+        double w = 1 + std::sin(t);
+        return ColVector<2>{-w * x[1][0], w * x[0][0]};
+    };
+    auto angle = [](double t) { return t + 1 - std::cos(t); };
+
+    AdaptiveODEOptions opt = {};
+    opt.t_start            = 0;
+    opt.t_end              = 10;
+    opt.epsilon            = 1e-10;
+    opt.h_start            = 1e-1;
+    opt.h_min              = 1e-10;
+    opt.maxiter            = 1e6;
+
+    ColVector<2> x_start = {1, 0};
+
+    auto result = dormandPrinceLie(func, CircleChart{}, x_start, opt);
+    ASSERT_EQ(result.resultCode, ODEResultCodes::SUCCESS);
+    ASSERT_EQ(result.time.back(), 10.0);
+    for (size_t i = 0; i < result.time.size(); ++i) {
+        const ColVector<2> &x = result.solution[i];
+        double phi            = angle(result.time[i]);
+        // The solution never leaves the circle
+        EXPECT_NEAR(norm(x), 1, 1e-13) << i;
+        EXPECT_NEAR(x[0][0], std::cos(phi), 1e-8) << i;
+        EXPECT_NEAR(x[1][0], std::sin(phi), 1e-8) << i;
+    }
+
+    ColVector<2> x = x_start;
+    auto endresult = dormandPrinceLieInPlace(func, CircleChart{}, x, opt);
+    EXPECT_EQ(x, result.solution.back());
+    EXPECT_EQ(endresult.first, result.resultCode);
+    EXPECT_EQ(endresult.second, result.iterations);
+}
@@ -6,19 +6,73 @@
 #include <PyMatrix.hpp>
 #include <iostream>  // cerr
 #include <pybind11/embed.h>
+#include <stdexcept>
+#include <string>
 
+/**
+ * @brief   Reference function that calls a Python callable.
+ * 
+ * If the callable is vectorized, it is called with a one-dimensional NumPy 
+ * array of times, and it should return a two-dimensional array with one row 
+ * per time. This way, a whole grid of samples can be evaluated with a single
+ * call into Python (see Drone::SampledReference).
+ */
 class __attribute__((visibility("hidden"))) PythonDroneReferenceFunction
     : public Drone::ReferenceFunction {
   public:
-    PythonDroneReferenceFunction(pybind11::object callable)
-        : callable(callable) {}
+    PythonDroneReferenceFunction(pybind11::object callable,
+                                 bool vectorized = false)
+        : callable(callable), vectorized(vectorized) {}
 
     Drone::VecR_t operator()(double t) override {
+        if (vectorized) {
+            Drone::VecR_t r;
+            evaluate(&t, &r, 1);
+            return r;
+        }
         return callable(t).cast<Drone::VecR_t>();
     }
 
+    void evaluate(const double *t, Drone::VecR_t *result, size_t n) override {
+        if (!vectorized)
+            return Drone::ReferenceFunction::evaluate(t, result, n);
+        constexpr auto flags = pybind11::array::c_style |  //
+                               pybind11::array::forcecast;
+        pybind11::array_t<double> times(n, t);
+        auto values = pybind11::array_t<double, flags>::ensure(callable(times));
+        if (!values || values.ndim() != 2 || size_t(values.shape(0)) != n ||
+            size_t(values.shape(1)) != Ny)
+            throw std::runtime_error(
+                "Error: vectorized reference function should return an array "
+                "of shape (len(t), " +
+                std::to_string(Ny) + ")");
+        auto v = values.unchecked<2>();
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < Ny; ++j)
+                result[i][j] = {v(i, j)};
+    }
+
+    /// Evaluate the reference at all given times, one row per time.
+    pybind11::array_t<double> sample(pybind11::array_t<double> times) {
+        constexpr auto flags = pybind11::array::c_style |  //
+                               pybind11::array::forcecast;
+        auto t = pybind11::array_t<double, flags>::ensure(times);
+        if (!t || t.ndim() != 1)
+            throw std::runtime_error("Error: expected a 1D array of times");
+        size_t n = t.shape(0);
+        std::vector<Drone::VecR_t> values(n);
+        evaluate(t.data(), values.data(), n);
+        pybind11::array_t<double> result({n, Ny});
+        auto r = result.mutable_unchecked<2>();
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < Ny; ++j)
+                r(i, j) = values[i][j][0];
+        return result;
+    }
+
   private:
     pybind11::object callable;
+    bool vectorized;
 };
 
 PYBIND11_EMBEDDED_MODULE(PyDrone, pydronemodule) {
@@ -150,8 +204,10 @@ PYBIND11_EMBEDDED_MODULE(PyDrone, pydronemodule) {
 
     pybind11::class_<PythonDroneReferenceFunction>(pydronemodule,
                                                    "DroneReferenceFunction")
-        .def(pybind11::init<pybind11::object>())
-        .def("__call__", &PythonDroneReferenceFunction::operator());
+        .def(pybind11::init<pybind11::object, bool>(),
+             pybind11::arg("callable"), pybind11::arg("vectorized") = false)
+        .def("__call__", &PythonDroneReferenceFunction::operator())
+        .def("sample", &PythonDroneReferenceFunction::sample);
 
     pybind11::class_<AdaptiveODEOptions>(pydronemodule, "AdaptiveODEOptions")
         .def(pybind11::init<>())
@@ -184,7 +240,11 @@ PYBIND11_EMBEDDED_MODULE(PyDrone, pydronemodule) {
         .def("simulate", [](Drone &drone, Drone::Controller &controller,
                             PythonDroneReferenceFunction &reference,
                             const DroneState &x0, AdaptiveODEOptions odeopt) {
-            return drone.simulate(controller, reference, x0, odeopt);
+            // Evaluate the reference for all samples at once, instead of
+            // calling into Python at every time step
+            Drone::SampledReference sampled = {reference, odeopt.t_start,
+                                               controller.Ts, odeopt.t_end};
+            return drone.simulate(controller, sampled, x0, odeopt);
         });
 
     pydronemodule.def("plot",
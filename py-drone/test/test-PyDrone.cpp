@@ -118,4 +118,27 @@ TEST(PyDrone, DroneStateGettersPython) {
     )",
                    pybind11::globals(), locals);
     EXPECT_TRUE(locals["success"].cast<bool>());
-}
\ No newline at end of file
+}
+TEST(PyDrone, vectorizedReference) {
+    using namespace pybind11::literals;
+    auto module = py::module::import("PyDrone");
+    auto locals = pybind11::dict{"pydrone"_a = module};
+    pybind11::exec(R"(
+        import numpy as np
+        def scalar(t):
+            return np.array([1, 0, 0, 0, 0, 0, 0, 0, 0, t])
+        def vectorized(t):
+            r = np.zeros((len(t), 10))
+            r[:, 0] = 1
+            r[:, 9] = t
+            return r
+        s = pydrone.DroneReferenceFunction(scalar)
+        v = pydrone.DroneReferenceFunction(vectorized, vectorized=True)
+        t = np.linspace(0, 1, 11)
+        success = np.array_equal(s.sample(t), v.sample(t)) \
+              and s.sample(t).shape == (11, 10) \
+              and np.array_equal(v(0.5), s(0.5))
+    )",
+                   pybind11::globals(), locals);
+    EXPECT_TRUE(locals["success"].cast<bool>());
+}
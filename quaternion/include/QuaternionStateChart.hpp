@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Quaternion.hpp"
+
+#include <cmath>
+
+/**
+ * @brief   Local coordinates around state vectors where the first 4 elements
+ *          are a unit quaternion, for geometric integration with
+ *          dormandPrinceLie.
+ *
+ * The orientation is parametrized by a rotation vector @f$ \vec{\theta} @f$
+ * in the body frame, @f$ \boldsymbol{q} = \boldsymbol{q}_0 \otimes
+ * \exp(\vec{\theta}) @f$, and the other elements are ordinary vector
+ * differences, so the local coordinates have N - 1 elements.
+ *
+ * If the derivative of the quaternion is
+ * @f$ \boldsymbol{\dot{q}} = \frac{1}{2} \boldsymbol{q} \otimes
+ * \begin{pmatrix} 0 \\ \vec{\omega} \end{pmatrix} @f$, the derivative of the
+ * rotation vector is @f$ \dot{\vec{\theta}} = \operatorname{dexp}^{-1}
+ * _{\vec{\theta}}(\vec{\omega}) \approx \vec{\omega} + \frac{1}{2}
+ * \vec{\theta} \times \vec{\omega} + \frac{1}{12} \vec{\theta} \times
+ * (\vec{\theta} \times \vec{\omega}) @f$. The rotation vector is of the order
+ * of the step size, so truncating the series after the second commutator
+ * keeps the fifth order of the Dormand–Prince method.
+ */
+template <size_t N>
+struct QuaternionStateChart {
+    using State = ColVector<N>;
+    using Local = ColVector<N - 1>;
+
+    /// Get the state with local coordinates z around x0.
+    static State retract(const State &x0, const Local &z) {
+        const ColVector<3> theta = getBlock<0, 3, 0, 1>(z);
+        const double angle       = norm(theta);
+        // sin(angle / 2) / angle, which tends to 1/2 for small angles
+        const double s     = angle > 1e-8 ? std::sin(angle / 2) / angle : 0.5;
+        const Quaternion e = vcat(std::cos(angle / 2), s * theta);
+        State x;
+        assignBlock<0, 4, 0, 1>(x) = quatmultiply(getBlock<0, 4, 0, 1>(x0), e);
+        assignBlock<4, N, 0, 1>(x) =
+            getBlock<4, N, 0, 1>(x0) + getBlock<3, N - 1, 0, 1>(z);
+        return x;
+    }
+
+    /**
+     * @brief   Get the derivative of the local coordinates z, given the state
+     *          @f$ x = \texttt{retract}(x_0, z) @f$ and its derivative.
+     */
+    static Local localDerivative(const Local &z, const State &x,
+                                 const State &x_dot) {
+        const Quaternion q     = getBlock<0, 4, 0, 1>(x);
+        const Quaternion q_dot = getBlock<0, 4, 0, 1>(x_dot);
+        // (0, ω) = 2 q* ⊗ q̇, because q is a unit quaternion
+        const ColVector<3> omega = getBlock<1, 4, 0, 1>(
+            2 * quatmultiply(quatconjugate(q), q_dot));
+        const ColVector<3> theta = getBlock<0, 3, 0, 1>(z);
+        const ColVector<3> thxw  = cross(theta, omega);
+        Local z_dot;
+        assignBlock<0, 3, 0, 1>(z_dot) =
+            omega + 0.5 * thxw + (1.0 / 12) * cross(theta, thxw);
+        assignBlock<3, N - 1, 0, 1>(z_dot) = getBlock<4, N, 0, 1>(x_dot);
+        return z_dot;
+    }
+};
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include <AlmostEqual.hpp>
+#include <QuaternionStateChart.hpp>
 #include <ReducedQuaternion.hpp>
 
 TEST(Quaternion, quatmultiply) {
@@ -102,4 +103,38 @@ TEST(ReducedQuaternion, convertAndBack) {
     Quaternion result   = red2quat(r);
     Quaternion expected = q;
     ASSERT_TRUE(isAlmostEqual(result, expected, 1e-15));
-}
\ No newline at end of file
+}
+
+TEST(QuaternionStateChart, retract) {
+    using Chart          = QuaternionStateChart<5>;
+    ColVector<5> x0      = vcat(eul2quat({0.1, 0.2, 0.3}), ColVector<1>{2});
+    Chart::Local z       = {0, 0, 0.5, 1};
+    ColVector<5> x       = Chart::retract(x0, z);
+    Quaternion rotation  = {std::cos(0.25), 0, 0, std::sin(0.25)};
+    ColVector<5> expected =
+        vcat(quatmultiply(eul2quat({0.1, 0.2, 0.3}), rotation),
+             ColVector<1>{3});
+    EXPECT_TRUE(isAlmostEqual(x, expected, 1e-15));
+    EXPECT_EQ(Chart::retract(x0, {}), x0);
+}
+
+/**
+ * Moving the local coordinates along their derivative should move the state
+ * along its derivative.
+ */
+TEST(QuaternionStateChart, localDerivative) {
+    using Chart            = QuaternionStateChart<5>;
+    ColVector<5> x0        = vcat(eul2quat({0.1, 0.2, 0.3}), ColVector<1>{2});
+    Chart::Local z         = {0.01, -0.02, 0.015, 0.5};
+    ColVector<5> x         = Chart::retract(x0, z);
+    ColVector<3> omega     = {0.3, -0.2, 0.5};
+    Quaternion q_omega     = vcat(0.0, omega);
+    ColVector<5> x_dot     = vcat(0.5 * quatmultiply(getBlock<0, 4, 0, 1>(x),
+                                                     q_omega),
+                                  ColVector<1>{-1});
+    Chart::Local z_dot     = Chart::localDerivative(z, x, x_dot);
+    const double h         = 1e-6;
+    ColVector<5> x_forward = Chart::retract(x0, z + h * z_dot);
+    ColVector<5> x_back    = Chart::retract(x0, z - h * z_dot);
+    EXPECT_TRUE(isAlmostEqual((x_forward - x_back) / (2 * h), x_dot, 1e-8));
+}
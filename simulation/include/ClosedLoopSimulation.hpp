@@ -0,0 +1,414 @@
+#pragma once
+
+#include "Quiescence.hpp"
+#include "StaticDispatch.hpp"
+#include <DormandPrince.hpp>
+#include <Time.hpp>
+
+#include <cassert>
+#include <iterator>
+#include <type_traits>
+
+template <size_t Nx, size_t Nu, size_t Ny>
+class ContinuousModel;
+
+/**
+ * @brief   Closed-loop simulation, parameterized on the concrete types of the
+ *          model, controller, observer, noise generators and reference
+ *          function.
+ *
+ * These functions implement the closed-loop simulations of ContinuousModel.
+ * When they are called with concrete (non-abstract) types, all calls in the
+ * control loop and in the stages of the ODE solver are resolved at compile
+ * time, so they can be inlined. When they are called with the abstract base
+ * classes, the behavior is identical to the virtual API of ContinuousModel,
+ * which is a thin adapter around these functions.
+ *
+ * @note    When a concrete type is used, it has to be the dynamic type of the
+ *          object that is passed in (this is checked in debug builds).
+ */
+namespace ClosedLoopSimulation {
+
+/**
+ * @brief   Simulate the model over the interval [opt.t_start, opt.t_end] with
+ *          a constant input u, appending all intermediate points of the ODE
+ *          solver to the given output iterators.
+ */
+template <class Model, class TimeIt, class XIt>
+std::pair<ODEResultCode, size_t>
+simulate(Model &model, TimeIt timeresult, XIt xresult,
+         const typename Model::VecU_t &u,
+         const typename Model::VecX_t &x_start, const AdaptiveODEOptions &opt) {
+    using VecX_t = typename Model::VecX_t;
+    auto f       = [&model, &u](double /* t */, const VecX_t &x) {
+        return StaticDispatch::call(model, x, u);
+    };
+    return dormandPrince(timeresult, xresult, f, x_start, opt);
+}
+
+/**
+ * @brief   Simulate the model over the interval [opt.t_start, opt.t_end] with
+ *          a constant input u, only returning the final state.
+ */
+template <class Model>
+ODEResultX<typename Model::VecX_t>
+simulateEndResult(Model &model, const typename Model::VecU_t &u,
+                  const typename Model::VecX_t &x_start,
+                  const AdaptiveODEOptions &opt) {
+    using VecX_t = typename Model::VecX_t;
+    auto f       = [&model, &u](double /* t */, const VecX_t &x) {
+        return StaticDispatch::call(model, x, u);
+    };
+    return dormandPrinceEndResult(f, x_start, opt);
+}
+
+/**
+ * @brief   Simulate the model over the interval [opt.t_start, opt.t_end] with
+ *          a constant input u, replacing the state x by the final state,
+ *          using the Dormand–Prince method on the state vector.
+ *          No memory is allocated.
+ *
+ * @see     dormandPrinceInPlace
+ */
+template <class Model>
+std::pair<ODEResultCode, size_t>
+advanceDormandPrince(Model &model, const typename Model::VecU_t &u,
+                     typename Model::VecX_t &x, const AdaptiveODEOptions &opt) {
+    using VecX_t = typename Model::VecX_t;
+    auto f       = [&model, &u](double /* t */, const VecX_t &x) {
+        return StaticDispatch::call(model, x, u);
+    };
+    return dormandPrinceInPlace(f, x, opt);
+}
+
+namespace detail {
+
+template <class MemberFunction>
+struct MemberClass;
+template <class R, class C, class... Args>
+struct MemberClass<R (C::*)(Args...)> {
+    using type = C;
+};
+
+template <class T>
+constexpr bool isContinuousModel = false;
+template <size_t Nx, size_t Nu, size_t Ny>
+constexpr bool isContinuousModel<ContinuousModel<Nx, Nu, Ny>> = true;
+
+/// True if the `advance` member function of the concrete type T is the
+/// default ContinuousModel::advance, i.e. if neither T nor any of its bases
+/// override it.
+template <class T>
+constexpr bool usesDefaultAdvance =
+    !std::is_abstract_v<T> &&
+    isContinuousModel<typename MemberClass<decltype(&T::advance)>::type>;
+
+}  // namespace detail
+
+/**
+ * @brief   Simulate the model over the interval [opt.t_start, opt.t_end] with
+ *          a constant input u, replacing the state x by the final state.
+ *          No memory is allocated.
+ *
+ * Models can use their own integrator by overriding ContinuousModel::advance,
+ * e.g. to integrate the orientation on the unit sphere. The override of the
+ * dynamic type is called, whether it is declared by Model itself or
+ * inherited from one of its bases. Only if the model uses the default
+ * implementation, the dynamics of the concrete model are integrated by
+ * advanceDormandPrince directly, so that they can be inlined.
+ */
+template <class Model>
+std::pair<ODEResultCode, size_t> advance(Model &model,
+                                         const typename Model::VecU_t &u,
+                                         typename Model::VecX_t &x,
+                                         const AdaptiveODEOptions &opt) {
+    if constexpr (detail::usesDefaultAdvance<Model>)
+        return advanceDormandPrince(model, u, x, opt);
+    else
+        return StaticDispatch::advance(model, u, x, opt);
+}
+
+/**
+ * @brief   Skip the integration of the control period [t, t + Ts] if the
+ *          closed loop is at rest, by advancing the state x with a single
+ *          Euler step of the model.
+ *
+ * This has to be called for every control period, because the detector
+ * remembers the control signal and the reference of the previous periods.
+ *
+ * @return  True if the period was skipped, false if it still has to be
+ *          integrated, in which case x is not modified.
+ *
+ * @see     QuiescenceOptions
+ */
+template <class Model, class Detector>
+bool skipIfQuiescent(Model &model, Detector &quiescence,
+                     const typename Model::VecU_t &u,
+                     const typename Model::VecR_t &r,
+                     typename Model::VecX_t &x, double Ts) {
+    if (!quiescence.isSteady(u, r))
+        return false;
+    typename Model::VecX_t x_dot = StaticDispatch::call(model, x, u);
+    if (!quiescence.isAtRest(x_dot))
+        return false;
+    StaticDispatch::eulerStep(model, x, x_dot, Ts);
+    quiescence.skip();
+    return true;
+}
+
+/**
+ * @brief   Simulate the closed-loop model using the given discrete
+ *          controller.
+ *
+ * All intermediate points of the ODE solver are stored, so the state vector
+ * is integrated by the Dormand–Prince method, even if the model overrides
+ * ContinuousModel::advance.
+ *
+ * @see     ContinuousModel::simulate
+ */
+template <class Model, class Controller, class Reference>
+typename Model::ControllerSimulationResult
+simulate(Model &model, Controller &controller, Reference &r,
+         typename Model::VecX_t x_start, const AdaptiveODEOptions &opt) {
+    using VecX_t = typename Model::VecX_t;
+    using VecU_t = typename Model::VecU_t;
+    using VecR_t = typename Model::VecR_t;
+
+    typename Model::ControllerSimulationResult result = {};
+    double Ts                                         = controller.Ts;
+    size_t N = numberOfSamplesInTimeRange(opt.t_start, Ts, opt.t_end);
+    // pre-allocate memory for result vectors
+    result.sampledTime.reserve(N);
+    result.control.reserve(N);
+    result.reference.reserve(N);
+
+    // actual state = inital state
+    VecX_t curr_x               = x_start;
+    AdaptiveODEOptions curr_opt = opt;
+    QuiescenceDetector<VecU_t, VecR_t> quiescence = {model.quiescence};
+    // For each time step
+    for (size_t i = 0; i < N; ++i) {
+        // current time, and integration range
+        double t         = opt.t_start + Ts * i;
+        curr_opt.t_start = t;
+        curr_opt.t_end   = t + Ts;
+        curr_opt.maxiter = opt.maxiter - result.iterations;
+        // reference signal
+        VecR_t curr_ref = StaticDispatch::call(r, t);
+        // calculate the control signal, based on current state
+        // and current reference
+        VecU_t curr_u = StaticDispatch::call(controller, curr_x, curr_ref);
+        // add the time, control signal and reference to the
+        // result vectors
+        result.sampledTime.push_back(t);
+        result.control.push_back(curr_u);
+        result.reference.push_back(curr_ref);
+        // if the closed loop is at rest, only the start point is stored
+        VecX_t x_prev = curr_x;
+        if (skipIfQuiescent(model, quiescence, curr_u, curr_ref, curr_x, Ts)) {
+            result.time.push_back(t);
+            result.solution.push_back(x_prev);
+            continue;
+        }
+        // simulate the continuous system over this time step [t, t + Ts]
+        // and add the time points and states to the result
+        auto curr_result = simulate(model, std::back_inserter(result.time),
+                                    std::back_inserter(result.solution),
+                                    curr_u, curr_x, curr_opt);
+        result.resultCode |= curr_result.first;
+        result.iterations += curr_result.second;
+        // update the actual state using the result of the continuous
+        // simulation at t + Ts
+        curr_x = result.solution.back();
+        // start and end point are included by `simulate`, so remove doubles
+        result.time.pop_back();
+        result.solution.pop_back();
+    }
+    result.skippedPeriods = quiescence.getSkippedPeriods();
+    return result;
+}
+
+/**
+ * @brief   Simulate the closed-loop model using the given discrete
+ *          controller, without storing the results. Instead, the given
+ *          callback is called as `callback(t, x, u)` at every sample.
+ *          The simulation stops when the callback returns false.
+ *          The simulation loop itself doesn't allocate any memory.
+ *
+ * If `skippedPeriods` is not null, the number of control periods that were
+ * skipped because the closed loop was at rest is written to it.
+ *
+ * @see     ContinuousModel::simulateRealTime
+ * @see     QuiescenceOptions
+ */
+template <class Model, class Controller, class Reference, class F>
+ODEResultCode simulateRealTime(Model &model, Controller &controller,
+                               Reference &r, typename Model::VecX_t x_start,
+                               const AdaptiveODEOptions &opt, F &callback,
+                               size_t *skippedPeriods = nullptr) {
+    using VecX_t = typename Model::VecX_t;
+    using VecU_t = typename Model::VecU_t;
+    using VecR_t = typename Model::VecR_t;
+
+    ODEResultCode resultCode;
+    double Ts     = controller.Ts;
+    size_t N      = numberOfSamplesInTimeRange(opt.t_start, Ts, opt.t_end);
+    VecX_t curr_x = x_start;
+    AdaptiveODEOptions curr_opt = opt;
+    QuiescenceDetector<VecU_t, VecR_t> quiescence = {model.quiescence};
+    for (size_t i = 0; i < N; ++i) {
+        double t         = opt.t_start + Ts * i;
+        curr_opt.t_start = t;
+        curr_opt.t_end   = t + Ts;
+        VecR_t curr_ref  = StaticDispatch::call(r, t);
+        VecU_t curr_u    = StaticDispatch::call(controller, curr_x, curr_ref);
+        if (!callback(t, curr_x, curr_u))
+            break;
+        if (skipIfQuiescent(model, quiescence, curr_u, curr_ref, curr_x, Ts))
+            continue;
+        // integrate over [t, t + Ts], updating curr_x in place
+        auto result = advance(model, curr_u, curr_x, curr_opt);
+        curr_opt.maxiter -= result.second;
+        resultCode |= result.first;
+        if (resultCode & ODEResultCodes::MAXIMUM_ITERATIONS_EXCEEDED)
+            break;
+    }
+    if (skippedPeriods)
+        *skippedPeriods = quiescence.getSkippedPeriods();
+    return resultCode;
+}
+
+/**
+ * @brief   Simulate the closed-loop discrete-time model using the given
+ *          discrete controller, without storing the results. The callback is
+ *          called as `callback(t, x, u)` at every sample, and the simulation
+ *          stops when the callback returns false.
+ *
+ * The model is evaluated as `x[k+1] = model(x[k], u[k])`. Its sample time has
+ * to be the same as the sample time of the controller. Only the start and end
+ * time of the options are used.
+ *
+ * @see     DiscreteModel::simulateRealTime
+ */
+template <class Model, class Controller, class Reference, class F>
+ODEResultCode simulateRealTimeDiscrete(Model &model, Controller &controller,
+                                       Reference &r,
+                                       typename Model::VecX_t x_start,
+                                       const AdaptiveODEOptions &opt,
+                                       F &callback) {
+    using VecX_t = typename Model::VecX_t;
+    using VecU_t = typename Model::VecU_t;
+    using VecR_t = typename Model::VecR_t;
+
+    assert(model.Ts == controller.Ts);
+    double Ts     = controller.Ts;
+    size_t N      = numberOfSamplesInTimeRange(opt.t_start, Ts, opt.t_end);
+    VecX_t curr_x = x_start;
+    for (size_t i = 0; i < N; ++i) {
+        double t        = opt.t_start + Ts * i;
+        VecR_t curr_ref = StaticDispatch::call(r, t);
+        VecU_t curr_u   = StaticDispatch::call(controller, curr_x, curr_ref);
+        if (!callback(t, curr_x, curr_u))
+            break;
+        curr_x = StaticDispatch::call(model, curr_x, curr_u);
+    }
+    return ODEResultCodes::SUCCESS;
+}
+
+/**
+ * @brief   Simulate the closed-loop model using the given discrete
+ *          controller and observer, with system disturbances and sensor
+ *          noise.
+ *
+ * Like the simulation without observer, this always uses the Dormand–Prince
+ * method on the state vector.
+ *
+ * @see     ContinuousModel::simulate
+ */
+template <class Model, class Controller, class Observer, class NoiseW,
+          class NoiseV, class Reference>
+typename Model::ObserverControllerSimulationResult
+simulate(Model &model, Controller &controller, Observer &observer,
+         NoiseW &randFnW, NoiseV &randFnV, Reference &r,
+         typename Model::VecX_t x_start, const AdaptiveODEOptions &opt) {
+    using VecX_t = typename Model::VecX_t;
+    using VecU_t = typename Model::VecU_t;
+    using VecY_t = typename Model::VecY_t;
+    using VecR_t = typename Model::VecR_t;
+
+    assert(controller.Ts == observer.Ts);
+    typename Model::ObserverControllerSimulationResult result = {};
+    double Ts                                                 = controller.Ts;
+    size_t N = numberOfSamplesInTimeRange(opt.t_start, Ts, opt.t_end);
+    // pre-allocate memory for result vectors
+    result.sampledTime.reserve(N);
+    result.control.reserve(N);
+    result.reference.reserve(N);
+    result.estimatedSolution.reserve(N);
+    result.output.reserve(N);
+
+    // actual state = inital state
+    VecX_t curr_x = x_start;
+    // estimated state = inital state
+    VecX_t curr_x_hat = x_start;
+    // For each time step
+    AdaptiveODEOptions curr_opt = opt;
+    QuiescenceDetector<VecU_t, VecR_t> quiescence = {model.quiescence};
+    for (size_t k = 0; k < N; ++k) {
+        // current time, and integration range
+        double t         = opt.t_start + Ts * k;
+        curr_opt.t_start = t;
+        curr_opt.t_end   = t + Ts;
+        curr_opt.maxiter = opt.maxiter - result.iterations;
+        // reference signal
+        VecR_t curr_ref = StaticDispatch::call(r, t);
+        // calculate the control signal, based on current estimated state
+        // and current reference
+        VecU_t curr_u = StaticDispatch::call(controller, curr_x_hat, curr_ref);
+        // the output of the real system is the output of the system, given
+        // the actual state and the control signal, plus the sensor
+        // noise
+        VecY_t clean_y = StaticDispatch::getOutput(model, curr_x, curr_u);
+        VecY_t y       = StaticDispatch::call(randFnV, t, clean_y);
+        // add the time, estimate state, control signal and output to the
+        // result vectors
+        result.sampledTime.push_back(t);
+        result.estimatedSolution.push_back(curr_x_hat);
+        result.control.push_back(curr_u);
+        result.output.push_back(y);
+        result.reference.push_back(curr_ref);
+
+        // calculate the estimated state for the next time step
+        //  k+1                                   k      k    k
+        curr_x_hat =
+            StaticDispatch::getStateChange(observer, curr_x_hat, y, curr_u);
+
+        // disturbances
+        VecU_t disturbed_u = StaticDispatch::call(randFnW, t, curr_u);
+        // if the closed loop is at rest, only the start point is stored
+        VecX_t x_prev = curr_x;
+        if (skipIfQuiescent(model, quiescence, disturbed_u, curr_ref, curr_x,
+                            Ts)) {
+            result.time.push_back(t);
+            result.solution.push_back(x_prev);
+            continue;
+        }
+        // simulate the continuous system over this time step [t, t + Ts]
+        // and add the time points and states to the result
+        auto curr_result = simulate(model, std::back_inserter(result.time),
+                                    std::back_inserter(result.solution),
+                                    disturbed_u, curr_x, curr_opt);
+        result.resultCode |= curr_result.first;
+        result.iterations += curr_result.second;
+        // update the actual state using the result of the continuous
+        // simulation at t + Ts
+        curr_x = result.solution.back();
+        // start and end point are included by `simulate`, so remove doubles
+        result.time.pop_back();
+        result.solution.pop_back();
+    }
+    result.skippedPeriods = quiescence.getSkippedPeriods();
+    return result;
+}
+
+}  // namespace ClosedLoopSimulation
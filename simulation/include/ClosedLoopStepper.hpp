@@ -0,0 +1,150 @@
+#pragma once
+
+#include "ClosedLoopSimulation.hpp"
+
+namespace ClosedLoopSimulation {
+
+/**
+ * @brief   A resumable closed-loop simulation with an observer, system
+ *          disturbances and sensor noise, that is advanced one control
+ *          period at a time.
+ *
+ * Instead of simulating the entire time range at once, the caller pulls the
+ * samples one by one using `next`. The simulation can be paused and resumed
+ * at any point, and only the samples that are actually needed are computed.
+ * The samples are exactly the same as the ones of the corresponding
+ * `ClosedLoopSimulation::simulate` function, and no memory is allocated.
+ *
+ * Usage:
+ * ~~~cpp
+ * ClosedLoopStepper stepper = {model, controller, observer,
+ *                              randFnW, randFnV, r, x_start, opt};
+ * ClosedLoopStepper<...>::Sample s;
+ * while (stepper.next(s))
+ *     consume(s.t, s.x, s.x_hat, s.u, s.y, s.r);
+ * ~~~
+ *
+ * @note    The stepper keeps references to all of its arguments, except for
+ *          the initial state and the options, so they have to outlive it.
+ */
+template <class Model, class Controller, class Observer, class NoiseW,
+          class NoiseV, class Reference>
+class ClosedLoopStepper {
+  public:
+    using VecX_t = typename Model::VecX_t;
+    using VecU_t = typename Model::VecU_t;
+    using VecY_t = typename Model::VecY_t;
+    using VecR_t = typename Model::VecR_t;
+
+    /// The signals of a single control period.
+    struct Sample {
+        /// The time at the start of the control period.
+        double t;
+        /// The actual state at time t.
+        VecX_t x;
+        /// The estimated state at time t.
+        VecX_t x_hat;
+        /// The control signal over [t, t + Ts].
+        VecU_t u;
+        /// The (noisy) measurement of the output at time t.
+        VecY_t y;
+        /// The reference at time t.
+        VecR_t r;
+    };
+
+    ClosedLoopStepper(Model &model, Controller &controller, Observer &observer,
+                      NoiseW &randFnW, NoiseV &randFnV, Reference &r,
+                      const VecX_t &x_start, const AdaptiveODEOptions &opt)
+        : model(model), controller(controller), observer(observer),
+          randFnW(randFnW), randFnV(randFnV), r(r), opt(opt),
+          Ts(controller.Ts),
+          N(numberOfSamplesInTimeRange(opt.t_start, Ts, opt.t_end)),
+          x(x_start), x_hat(x_start), quiescence(model.quiescence) {
+        assert(controller.Ts == observer.Ts);
+    }
+
+    /**
+     * @brief   Simulate the next control period.
+     *
+     * @param   sample
+     *          Output: the time, states, control signal, output and reference
+     *          at the start of the control period.
+     * @return  False if the simulation was already finished, in which case
+     *          `sample` is not modified, true otherwise.
+     */
+    bool next(Sample &sample) {
+        if (done())
+            return false;
+        // current time, and integration range
+        double t                    = getTime();
+        AdaptiveODEOptions curr_opt = opt;
+        curr_opt.t_start            = t;
+        curr_opt.t_end              = t + Ts;
+        curr_opt.maxiter            = opt.maxiter - iterations;
+
+        // reference, control signal and noisy measurement of the output
+        VecR_t curr_ref = StaticDispatch::call(r, t);
+        VecU_t curr_u   = StaticDispatch::call(controller, x_hat, curr_ref);
+        VecY_t clean_y  = StaticDispatch::getOutput(model, x, curr_u);
+        VecY_t y        = StaticDispatch::call(randFnV, t, clean_y);
+
+        sample = {t, x, x_hat, curr_u, y, curr_ref};
+
+        // estimated state for the next time step
+        x_hat = StaticDispatch::getStateChange(observer, x_hat, y, curr_u);
+        // simulate the continuous system with disturbances over [t, t + Ts]
+        VecU_t disturbed_u = StaticDispatch::call(randFnW, t, curr_u);
+        if (!skipIfQuiescent(model, quiescence, disturbed_u, curr_ref, x, Ts)) {
+            auto result = advance(model, disturbed_u, x, curr_opt);
+            resultCode |= result.first;
+            iterations += result.second;
+        }
+        ++k;
+        return true;
+    }
+
+    /// Check whether the end time was reached, or if the ODE solver failed.
+    bool done() const {
+        return k >= N ||
+               (resultCode & ODEResultCodes::MAXIMUM_ITERATIONS_EXCEEDED);
+    }
+
+    /// Get the time of the next sample.
+    double getTime() const { return opt.t_start + Ts * k; }
+    /// Get the index of the next sample.
+    size_t getSampleIndex() const { return k; }
+    /// Get the total number of samples in the time range.
+    size_t getNumberOfSamples() const { return N; }
+    /// Get the actual state at the time of the next sample.
+    const VecX_t &getState() const { return x; }
+    /// Get the estimated state at the time of the next sample.
+    const VecX_t &getEstimatedState() const { return x_hat; }
+    /// Get the combined result codes of the ODE solver so far.
+    ODEResultCode getResultCode() const { return resultCode; }
+    /// Get the total number of iterations of the ODE solver so far.
+    size_t getIterations() const { return iterations; }
+    /// Get the number of control periods that were skipped because the
+    /// closed loop was at rest.
+    /// @see    QuiescenceOptions
+    size_t getSkippedPeriods() const { return quiescence.getSkippedPeriods(); }
+
+  private:
+    Model &model;
+    Controller &controller;
+    Observer &observer;
+    NoiseW &randFnW;
+    NoiseV &randFnV;
+    Reference &r;
+    const AdaptiveODEOptions opt;
+    const double Ts;
+    const size_t N;
+
+    size_t k = 0;
+    VecX_t x;
+    VecX_t x_hat;
+    ODEResultCode resultCode;
+    size_t iterations = 0;
+    QuiescenceDetector<VecU_t, VecR_t> quiescence;
+};
+
+}  // namespace ClosedLoopSimulation
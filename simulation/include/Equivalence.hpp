@@ -0,0 +1,239 @@
+#pragma once
+
+#include "DiscreteController.hpp"
+#include "DiscreteObserver.hpp"
+
+#include <CycleCounter.hpp>
+
+#include <algorithm>  // max, nth_element
+#include <cmath>      // abs, isnan, sqrt
+#include <limits>     // infinity
+#include <numeric>    // accumulate
+#include <stdexcept>  // invalid_argument
+#include <vector>
+
+/// The distribution of the execution times of the calls of an implementation.
+struct LatencyStatistics {
+    /// The median, in the unit of readCycleCounter.
+    uint64_t p50 = 0;
+    /// The 99th percentile.
+    uint64_t p99 = 0;
+    uint64_t max = 0;
+    double mean  = 0;
+
+    static LatencyStatistics from(std::vector<uint64_t> times) {
+        LatencyStatistics result = {};
+        if (times.empty())
+            return result;
+        const size_t n = times.size();
+        auto at        = [&](size_t i) {
+            std::nth_element(times.begin(), times.begin() + i, times.end());
+            return times[i];
+        };
+        result.mean = std::accumulate(times.begin(), times.end(), 0.0) / n;
+        result.max  = at(n - 1);
+        result.p99  = at(n * 99 / 100);
+        result.p50  = at(n / 2);
+        return result;
+    }
+};
+
+struct EquivalenceOptions {
+    /// The size of the buffer that is written before every call of the cold
+    /// pass, to evict the code and the data of the implementations from the
+    /// caches. It should be larger than the last level cache.
+    size_t evictionBytes = 32 << 20;
+    /// Run the cold pass.
+    bool cold = true;
+};
+
+/**
+ * @brief   The result of replaying the same stream through two
+ *          implementations: the difference of their outputs, and the
+ *          latency of every implementation with warm and with cold caches.
+ */
+struct EquivalenceResult {
+    /// The largest absolute difference of an element of the outputs.
+    double maxDifference = 0;
+    /// The root mean square of the differences of all elements.
+    double rmsDifference = 0;
+    /// The index in the stream of the largest difference.
+    size_t maxDifferenceIndex = 0;
+    /// The latency of the first and the second implementation when their code
+    /// and data are in the caches, because they were just called.
+    LatencyStatistics warm[2];
+    /// The latency of the first and the second implementation after the
+    /// caches were flushed.
+    LatencyStatistics cold[2];
+};
+
+namespace Equivalence {
+
+/// Evicts everything else from the caches by writing to a large buffer.
+class CacheEvictor {
+  public:
+    CacheEvictor(size_t bytes) : buffer(bytes) {}
+
+    void evict() {
+        // Read and write every cache line, and keep the sum, so the writes
+        // can't be optimized out
+        for (size_t i = 0; i < buffer.size(); i += 64)
+            checksum += ++buffer[i];
+    }
+
+    unsigned char checksum = 0;
+
+  private:
+    std::vector<unsigned char> buffer;
+};
+
+/**
+ * @brief   Replay the stream through one implementation, and time every
+ *          call.
+ *
+ * The implementation is reset before every pass, so implementations with
+ * internal state see the same stream every pass. The outputs are those of the
+ * warm pass, which runs after an untimed pass that warms up the caches and
+ * the branch predictors.
+ *
+ * @param   reset
+ *          Resets the implementation.
+ * @param   call
+ *          Calls the implementation with the i-th element of the stream, and
+ *          returns its output.
+ */
+template <class VecOut_t, class Reset, class Call>
+std::vector<VecOut_t> replay(Reset reset, Call call, size_t n,
+                             CacheEvictor *evictor, LatencyStatistics &warm,
+                             LatencyStatistics &cold) {
+    std::vector<VecOut_t> outputs(n);
+    std::vector<uint64_t> times(n);
+
+    reset();
+    for (size_t i = 0; i < n; ++i)
+        outputs[i] = call(i);
+
+    reset();
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t start = readCycleCounter();
+        outputs[i]     = call(i);
+        times[i]       = readCycleCounter() - start;
+    }
+    warm = LatencyStatistics::from(times);
+
+    if (evictor) {
+        reset();
+        for (size_t i = 0; i < n; ++i) {
+            evictor->evict();
+            uint64_t start = readCycleCounter();
+            call(i);
+            times[i] = readCycleCounter() - start;
+        }
+        cold = LatencyStatistics::from(times);
+    }
+    return outputs;
+}
+
+template <size_t N>
+void compareOutputs(const std::vector<ColVector<N>> &a,
+                    const std::vector<ColVector<N>> &b,
+                    EquivalenceResult &result) {
+    double sumSq = 0;
+    size_t count = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        for (size_t j = 0; j < N; ++j) {
+            double diff = std::abs(a[i][j][0] - b[i][j][0]);
+            // NaN in only one of the outputs is the largest difference
+            if (std::isnan(a[i][j][0]) != std::isnan(b[i][j][0]))
+                diff = std::numeric_limits<double>::infinity();
+            else if (std::isnan(diff))
+                diff = 0;
+            if (diff > result.maxDifference) {
+                result.maxDifference      = diff;
+                result.maxDifferenceIndex = i;
+            }
+            sumSq += diff * diff;
+            ++count;
+        }
+    }
+    result.rmsDifference = std::sqrt(sumSq / count);
+}
+
+template <class Stream>
+void checkLength(const Stream &stream, size_t n) {
+    if (stream.size() != n)
+        throw std::invalid_argument("The streams have different lengths");
+}
+
+}  // namespace Equivalence
+
+/**
+ * @brief   Replay the same stream of states and references through two
+ *          controllers, compare the control signals, and measure the latency
+ *          of every call.
+ *
+ * Controllers with internal state, such as integral action, are reset before
+ * every pass over the stream, so consecutive elements of the stream should be
+ * consecutive samples of a closed loop (e.g. a recorded flight), unless the
+ * controllers are stateless.
+ */
+template <size_t Nx, size_t Nu, size_t Nr>
+EquivalenceResult
+compareControllers(DiscreteController<Nx, Nu, Nr> &a,
+                   DiscreteController<Nx, Nu, Nr> &b,
+                   const std::vector<ColVector<Nx>> &xs,
+                   const std::vector<ColVector<Nr>> &rs,
+                   const EquivalenceOptions &opt = {}) {
+    const size_t n = xs.size();
+    if (n == 0)
+        throw std::invalid_argument("The streams are empty");
+    Equivalence::checkLength(rs, n);
+
+    Equivalence::CacheEvictor evictor   = {opt.cold ? opt.evictionBytes : 0};
+    Equivalence::CacheEvictor *pEvictor = opt.cold ? &evictor : nullptr;
+    EquivalenceResult result            = {};
+    auto outputs = [&](DiscreteController<Nx, Nu, Nr> &ctrl, size_t k) {
+        return Equivalence::replay<ColVector<Nu>>(
+            [&] { ctrl.reset(); }, [&](size_t i) { return ctrl(xs[i], rs[i]); },
+            n, pEvictor, result.warm[k], result.cold[k]);
+    };
+    auto outputs_a = outputs(a, 0);
+    auto outputs_b = outputs(b, 1);
+    Equivalence::compareOutputs(outputs_a, outputs_b, result);
+    return result;
+}
+
+/**
+ * @brief   Replay the same stream of estimated states, sensor readings and
+ *          control signals through two observers, compare the new estimated
+ *          states, and measure the latency of every call.
+ */
+template <size_t Nx, size_t Nu, size_t Ny>
+EquivalenceResult compareObservers(DiscreteObserver<Nx, Nu, Ny> &a,
+                                   DiscreteObserver<Nx, Nu, Ny> &b,
+                                   const std::vector<ColVector<Nx>> &x_hats,
+                                   const std::vector<ColVector<Ny>> &ys,
+                                   const std::vector<ColVector<Nu>> &us,
+                                   const EquivalenceOptions &opt = {}) {
+    const size_t n = x_hats.size();
+    if (n == 0)
+        throw std::invalid_argument("The streams are empty");
+    Equivalence::checkLength(ys, n);
+    Equivalence::checkLength(us, n);
+
+    Equivalence::CacheEvictor evictor   = {opt.cold ? opt.evictionBytes : 0};
+    Equivalence::CacheEvictor *pEvictor = opt.cold ? &evictor : nullptr;
+    EquivalenceResult result            = {};
+    auto outputs = [&](DiscreteObserver<Nx, Nu, Ny> &obsv, size_t k) {
+        return Equivalence::replay<ColVector<Nx>>(
+            [&] { obsv.reset(); },
+            [&](size_t i) {
+                return obsv.getStateChange(x_hats[i], ys[i], us[i]);
+            },
+            n, pEvictor, result.warm[k], result.cold[k]);
+    };
+    auto outputs_a = outputs(a, 0);
+    auto outputs_b = outputs(b, 1);
+    Equivalence::compareOutputs(outputs_a, outputs_b, result);
+    return result;
+}
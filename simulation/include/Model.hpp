@@ -1,9 +1,12 @@
 #pragma once
 
+#include "ClosedLoopSimulation.hpp"
+#include "ClosedLoopStepper.hpp"
 #include "DiscreteController.hpp"
 #include "DiscreteObserver.hpp"
 #include "NoiseGenerator.hpp"
 #include <DormandPrince.hpp>
+#include <SampledTimeFunction.hpp>
 #include <Time.hpp>
 #include <TimeFunction.hpp>
 
@@ -46,12 +49,21 @@ class ContinuousModel : public Model<Nx, Nu, Ny> {
 
     typedef TimeFunctionT<VecU_t> InputFunction;
     typedef TimeFunctionT<VecR_t> ReferenceFunction;
+    typedef SampledTimeFunctionT<VecR_t> SampledReference;
     typedef ODEResultX<VecX_t> SimulationResult;
+    typedef ClosedLoopSimulation::ClosedLoopStepper<
+        ContinuousModel, DiscreteController<Nx, Nu, Ny>,
+        DiscreteObserver<Nx, Nu, Ny>, NoiseGenerator<Nu>, NoiseGenerator<Ny>,
+        ReferenceFunction>
+        Stepper;
 
     struct ControllerSimulationResult : public SimulationResult {
         std::vector<double> sampledTime;
         std::vector<VecU_t> control;
         std::vector<VecY_t> reference;
+        /// The number of control periods that weren't integrated, because
+        /// the closed loop was at rest. @see QuiescenceOptions
+        size_t skippedPeriods = 0;
     };
 
     struct ObserverControllerSimulationResult
@@ -216,11 +228,51 @@ class ContinuousModel : public Model<Nx, Nu, Ny> {
      */
     SimulationResult simulateEndResult(VecU_t u, VecX_t x_start,
                                        const AdaptiveODEOptions &opt) {
-        ContinuousModel &model = *this;
-        auto f                 = [&model, u](double /* t */, const VecX_t &x) {
-            return model(x, u);
-        };
-        return dormandPrinceEndResult(f, x_start, opt);
+        return ClosedLoopSimulation::simulateEndResult(*this, u, x_start, opt);
+    }
+
+    /**
+     * @brief   Simulate the continuous model over the interval 
+     *          [opt.t_start, opt.t_end] with a constant input, replacing the
+     *          given state by the final state. This version doesn't allocate
+     *          any memory.
+     * 
+     * @param   u
+     *          The constant input.
+     * @param   x
+     *          The inital state, which is overwritten by the final state.
+     *          If the maximum number of iterations is exceeded, it is left 
+     *          unchanged.
+     * @param   opt
+     *          A struct of options for the ODE solver.
+     * 
+     * @return
+     *          The result code of the ODE solver, and the number of iterations.
+     * 
+     * The default implementation uses the Dormand–Prince method on the state
+     * vector. Models can override it to use a different integrator, which is
+     * then used by simulateRealTime and the stepper as well. The simulations
+     * that store every intermediate point of the ODE solver (simulate) always
+     * use the Dormand–Prince method on the state vector.
+     */
+    virtual std::pair<ODEResultCode, size_t>
+    advance(const VecU_t &u, VecX_t &x, const AdaptiveODEOptions &opt) {
+        return ClosedLoopSimulation::advanceDormandPrince(*this, u, x, opt);
+    }
+
+    /**
+     * @brief   Advance the state x by a single Euler step of size h, given its
+     *          derivative x_dot. Used to skip the integration of control
+     *          periods in which the closed loop is at rest.
+     *
+     * The default implementation adds h * x_dot to the state vector. Models
+     * whose state doesn't live in a vector space override it, e.g. to keep a
+     * quaternion normalized.
+     *
+     * @see     QuiescenceOptions
+     */
+    virtual void eulerStep(VecX_t &x, const VecX_t &x_dot, double h) {
+        x += h * x_dot;
     }
 
     /**
@@ -250,11 +302,8 @@ class ContinuousModel : public Model<Nx, Nu, Ny> {
     simulate(typename std::back_insert_iterator<std::vector<double>> timeresult,
              typename std::back_insert_iterator<std::vector<VecX_t>> xresult,
              VecU_t u, VecX_t x_start, const AdaptiveODEOptions &opt) {
-        ContinuousModel &model = *this;
-        auto f                 = [&model, &u](double /* t */, const VecX_t &x) {
-            return model(x, u);
-        };
-        return dormandPrince(timeresult, xresult, f, x_start, opt);
+        return ClosedLoopSimulation::simulate(*this, timeresult, xresult, u,
+                                              x_start, opt);
     }
 
     /**
@@ -284,76 +333,22 @@ class ContinuousModel : public Model<Nx, Nu, Ny> {
     ControllerSimulationResult
     simulate(DiscreteController<Nx, Nu, Ny> &controller, ReferenceFunction &r,
              VecX_t x_start, const AdaptiveODEOptions &opt) {
-        ControllerSimulationResult result = {};
-        double Ts                         = controller.Ts;
-        size_t N = numberOfSamplesInTimeRange(opt.t_start, Ts, opt.t_end);
-        // pre-allocate memory for result vectors
-        result.sampledTime.reserve(N);
-        result.control.reserve(N);
-        result.reference.reserve(N);
-
-        // actual state = inital state
-        VecX_t curr_x               = x_start;
-        AdaptiveODEOptions curr_opt = opt;
-        // For each time step
-        for (size_t i = 0; i < N; ++i) {
-            // current time, and integration range
-            double t         = opt.t_start + Ts * i;
-            curr_opt.t_start = t;
-            curr_opt.t_end   = t + Ts;
-            curr_opt.maxiter = opt.maxiter - result.iterations;
-            // reference signal
-            VecR_t curr_ref = r(t);
-            // calculate the control signal, based on current state
-            // and current reference
-            VecU_t curr_u = controller(curr_x, curr_ref);
-            // add the time, control signal and reference to the
-            // result vectors
-            result.sampledTime.push_back(t);
-            result.control.push_back(curr_u);
-            result.reference.push_back(curr_ref);
-            // simulate the continuous system over this time step [t, t + Ts]
-            // and add the time points and states to the result
-            auto curr_result = this->simulate(
-                std::back_inserter(result.time),
-                std::back_inserter(result.solution), curr_u, curr_x, curr_opt);
-            result.resultCode |= curr_result.first;
-            result.iterations += curr_result.second;
-            // update the actual state using the result of the continuous
-            // simulation at t + Ts
-            curr_x = result.solution.back();
-            // start and end point are included by `simulate`, so remove doubles
-            result.time.pop_back();
-            result.solution.pop_back();
-        }
-        return result;
+        return ClosedLoopSimulation::simulate(*this, controller, r, x_start,
+                                              opt);
     }
 
+    /**
+     * @brief   Simulate the closed-loop continuous model using the given 
+     *          discrete controller, without storing the results.
+     *          Instead, `callback(t, x, u)` is called at every time step, 
+     *          and the simulation is stopped when it returns false.
+     */
     template <class F>
     ODEResultCode simulateRealTime(DiscreteController<Nx, Nu, Ny> &controller,
                                    ReferenceFunction &r, VecX_t x_start,
                                    const AdaptiveODEOptions &opt, F &callback) {
-        ODEResultCode resultCode;
-        double Ts     = controller.Ts;
-        size_t N      = numberOfSamplesInTimeRange(opt.t_start, Ts, opt.t_end);
-        VecX_t curr_x = x_start;
-        AdaptiveODEOptions curr_opt = opt;
-        for (size_t i = 0; i < N; ++i) {
-            double t         = opt.t_start + Ts * i;
-            curr_opt.t_start = t;
-            curr_opt.t_end   = t + Ts;
-            VecR_t curr_ref  = r(t);
-            VecU_t curr_u    = controller(curr_x, curr_ref);
-            if (!callback(t, curr_x, curr_u))
-                break;
-            auto result = this->simulateEndResult(curr_u, curr_x, curr_opt);
-            curr_opt.maxiter -= result.iterations;
-            resultCode |= result.resultCode;
-            if (resultCode & ODEResultCodes::MAXIMUM_ITERATIONS_EXCEEDED)
-                break;
-            curr_x = result.solution[0];
-        }
-        return resultCode;
+        return ClosedLoopSimulation::simulateRealTime(*this, controller, r,
+                                                      x_start, opt, callback);
     }
 
     /**
@@ -396,70 +391,70 @@ class ContinuousModel : public Model<Nx, Nu, Ny> {
              NoiseGenerator<Nu> &randFnW, NoiseGenerator<Ny> &randFnV,
              ReferenceFunction &r, VecX_t x_start,
              const AdaptiveODEOptions &opt) {
-        assert(controller.Ts == observer.Ts);
-        ObserverControllerSimulationResult result = {};
-        double Ts                                 = controller.Ts;
-        size_t N = numberOfSamplesInTimeRange(opt.t_start, Ts, opt.t_end);
-        // pre-allocate memory for result vectors
-        result.sampledTime.reserve(N);
-        result.control.reserve(N);
-        result.reference.reserve(N);
-        result.estimatedSolution.reserve(N);
-        result.output.reserve(N);
-
-        // actual state = inital state
-        VecX_t curr_x = x_start;
-        // estimated state = inital state
-        VecX_t curr_x_hat = x_start;
-        // For each time step
-        AdaptiveODEOptions curr_opt = opt;
-        for (size_t k = 0; k < N; ++k) {
-            // current time, and integration range
-            double t         = opt.t_start + Ts * k;
-            curr_opt.t_start = t;
-            curr_opt.t_end   = t + Ts;
-            curr_opt.maxiter = opt.maxiter - result.iterations;
-            // reference signal
-            VecR_t curr_ref = r(t);
-            // calculate the control signal, based on current estimated state
-            // and current reference
-            VecU_t curr_u = controller(curr_x_hat, curr_ref);
-            // the output of the real system is the output of the system, given
-            // the actual state and the control signal, plus the sensor
-            // noise
-            VecY_t clean_y = this->getOutput(curr_x, curr_u);  // no noise
-            VecY_t y       = randFnV(t, clean_y);  // add sensor noise
-            // add the time, estimate state, control signal and output to the
-            // result vectors
-            result.sampledTime.push_back(t);
-            result.estimatedSolution.push_back(curr_x_hat);
-            result.control.push_back(curr_u);
-            result.output.push_back(y);
-            result.reference.push_back(curr_ref);
-
-            // calculate the estimated state for the next time step
-            //  k+1                                   k      k    k
-            curr_x_hat = observer.getStateChange(curr_x_hat, y, curr_u);
-
-            // disturbances
-            VecU_t disturbed_u = randFnW(t, curr_u);
-            // simulate the continuous system over this time step [t, t + Ts]
-            // and add the time points and states to the result
-            auto curr_result =
-                this->simulate(std::back_inserter(result.time),
-                               std::back_inserter(result.solution), disturbed_u,
-                               curr_x, curr_opt);
-            result.resultCode |= curr_result.first;
-            result.iterations += curr_result.second;
-            // update the actual state using the result of the continuous
-            // simulation at t + Ts
-            curr_x = result.solution.back();
-            // start and end point are included by `simulate`, so remove doubles
-            result.time.pop_back();
-            result.solution.pop_back();
-        }
-        return result;
+        return ClosedLoopSimulation::simulate(*this, controller, observer,
+                                              randFnW, randFnV, r, x_start,
+                                              opt);
     }
+
+    /**
+     * @brief   Get a resumable closed-loop simulation, using the given discrete
+     *          controller and observer, with system disturbances and sensor
+     *          noise. It is advanced one control period at a time by calling
+     *          `Stepper::next`.
+     * 
+     * The arguments are the same as for the simulate function above. The
+     * stepper keeps references to all arguments except for the initial state
+     * and the options.
+     */
+    Stepper getStepper(DiscreteController<Nx, Nu, Ny> &controller,
+                       DiscreteObserver<Nx, Nu, Ny> &observer,
+                       NoiseGenerator<Nu> &randFnW, NoiseGenerator<Ny> &randFnV,
+                       ReferenceFunction &r, const VecX_t &x_start,
+                       const AdaptiveODEOptions &opt) {
+        return {*this, controller, observer, randFnW, randFnV,
+                r,     x_start,    opt};
+    }
+
+    /// When to skip the integration of control periods in which the closed
+    /// loop is at rest. Disabled by default.
+    QuiescenceOptions quiescence;
+};
+
+/** 
+ * @brief   An abstract class for Discrete-Time models, where the call operator
+ *          returns the state at the next time step, @f$ x_{k+1} @f$.
+ */
+template <size_t Nx, size_t Nu, size_t Ny>
+class DiscreteModel : public Model<Nx, Nu, Ny> {
+  public:
+    using VecX_t = typename Model<Nx, Nu, Ny>::VecX_t;
+    using VecU_t = typename Model<Nx, Nu, Ny>::VecU_t;
+    using VecY_t = typename Model<Nx, Nu, Ny>::VecY_t;
+    using VecR_t = typename Model<Nx, Nu, Ny>::VecR_t;
+
+    typedef TimeFunctionT<VecR_t> ReferenceFunction;
+
+    DiscreteModel(double Ts) : Ts{Ts} {}
+
+    /**
+     * @brief   Simulate the closed-loop discrete model using the given 
+     *          discrete controller, without storing the results.
+     *          Instead, `callback(t, x, u)` is called at every time step, 
+     *          and the simulation is stopped when it returns false.
+     *          
+     * This has the same interface as ContinuousModel::simulateRealTime, so
+     * the discrete model can be used as a drop-in replacement. Only the start
+     * and end times of the options are used.
+     */
+    template <class F>
+    ODEResultCode simulateRealTime(DiscreteController<Nx, Nu, Ny> &controller,
+                                   ReferenceFunction &r, VecX_t x_start,
+                                   const AdaptiveODEOptions &opt, F &callback) {
+        return ClosedLoopSimulation::simulateRealTimeDiscrete(
+            *this, controller, r, x_start, opt, callback);
+    }
+
+    const double Ts;
 };
 
 #include <System.hpp>
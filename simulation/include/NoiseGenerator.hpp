@@ -1,6 +1,8 @@
 #pragma once
 
 #include <Matrix.hpp>
+#include <Philox.hpp>
+#include <cmath>
 #include <random>
 
 template <size_t N>
@@ -47,6 +49,118 @@ class GaussianNoiseGenerator : public NoiseGenerator<N> {
     Array<std::normal_distribution<double>, N> distributions;
 };
 
+/**
+ * @brief   Gaussian noise generator based on the Philox counter-based random
+ *          number generator.
+ *
+ * The noise that is added at time t is a pure function of the seed, the run
+ * number and the sample index round(t / Ts). It doesn't depend on the order
+ * in which samples are requested, or on how many threads are used: two
+ * generators with the same seed and run always produce the same noise for
+ * the same sample. Different runs give independent streams.
+ *
+ * Normal numbers are generated using a vectorized Box–Muller transform, for
+ * blocks of `BlockSize` consecutive samples at a time. A single instance
+ * caches the current block, so it should not be shared between threads;
+ * create one generator per thread instead.
+ */
+template <size_t N, size_t BlockSize = 64>
+class CounterBasedGaussianNoiseGenerator : public NoiseGenerator<N> {
+    static_assert(BlockSize > 0 && (BlockSize & (BlockSize - 1)) == 0,
+                  "BlockSize should be a power of two");
+
+  public:
+    CounterBasedGaussianNoiseGenerator(const Array<double, N> &variances,
+                                       double Ts, uint64_t seed = 1,
+                                       uint32_t run = 0)
+        : stddev(varianceToStandardDeviation(variances)), Ts(Ts),
+          key(Philox::makeKey(seed)), run(run) {}
+    CounterBasedGaussianNoiseGenerator(const RowVector<N> &variances,
+                                       double Ts, uint64_t seed = 1,
+                                       uint32_t run = 0)
+        : CounterBasedGaussianNoiseGenerator(variances[0], Ts, seed, run) {}
+
+    ColVector<N> operator()(double t, const ColVector<N> &v) override {
+        return v + randomVector(getSampleIndex(t));
+    }
+
+    /** @brief   Get the index of the sample at time t. */
+    uint64_t getSampleIndex(double t) const {
+        return t <= 0 ? 0 : uint64_t(std::llround(t / Ts));
+    }
+
+    /** @brief   Get the noise vector for the given sample index. */
+    ColVector<N> randomVector(uint64_t sample) {
+        uint64_t offset = sample % BlockSize;
+        if (!cacheValid || sample - offset != cacheStart) {
+            cacheStart = sample - offset;
+            fillStandardNormal(cacheStart, BlockSize, cache);
+            cacheValid = true;
+        }
+        ColVector<N> result;
+        for (size_t i = 0; i < N; ++i)
+            result[i] = stddev[i] * cache[i][offset];
+        return result;
+    }
+
+    /**
+     * @brief   Write the noise vectors of `count` consecutive samples,
+     *          starting at sample `first`, to the given output.
+     */
+    template <class OutputIt>
+    void fill(uint64_t first, size_t count, OutputIt out) {
+        for (size_t k = 0; k < count; ++k)
+            *out++ = randomVector(first + k);
+    }
+
+    /** @brief   Select a different independent stream of noise. */
+    void setRun(uint32_t run) {
+        this->run  = run;
+        cacheValid = false;
+    }
+    uint32_t getRun() const { return run; }
+
+    static Array<double, N>
+    varianceToStandardDeviation(const Array<double, N> &variances) {
+        Array<double, N> stddev;
+        std::transform(variances.begin(), variances.end(), stddev.begin(),
+                       [](double variance) { return std::sqrt(variance); });
+        return stddev;
+    }
+
+  private:
+    using Block_t = Array<Array<double, BlockSize>, N>;
+
+    /**
+     * @brief   Generate standard normal numbers for `count` samples, starting
+     *          at sample `first`, in element-major order.
+     *
+     * Counter layout: {sample (low word), sample (high word), ⌊i / 4⌋, run},
+     * where i is the element index. Every counter yields the normal numbers
+     * of four consecutive elements of one sample.
+     */
+    void fillStandardNormal(uint64_t first, size_t count, Block_t &out) const {
+        double buffer[4 * BlockSize];
+        for (size_t chunk = 0; chunk < (N + 3) / 4; ++chunk) {
+            Philox::generateStandardNormal(key, uint32_t(first),
+                                           uint32_t(first >> 32),
+                                           uint32_t(chunk), run, buffer,
+                                           4 * count);
+            for (size_t i = 4 * chunk; i < std::min(N, 4 * chunk + 4); ++i)
+                for (size_t k = 0; k < count; ++k)
+                    out[i][k] = buffer[4 * k + i % 4];
+        }
+    }
+
+    const Array<double, N> stddev;
+    const double Ts;
+    const Philox::Key key;
+    uint32_t run;
+    uint64_t cacheStart = 0;
+    bool cacheValid     = false;
+    Block_t cache;
+};
+
 template <size_t N>
 struct NoNoiseGenerator : public NoiseGenerator<N> {
     ColVector<N> operator()(double /* t */, const ColVector<N> &v) override {
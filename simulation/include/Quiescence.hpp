@@ -0,0 +1,93 @@
+#pragma once
+
+#include <Matrix.hpp>
+
+#include <cmath>  // sqrt
+
+/**
+ * @brief   Options for skipping the integration of the control periods in
+ *          which the closed loop is at rest.
+ *
+ * A control period is skipped if the reference is the same as in the
+ * previous period, the control signal differs by at most `controlTolerance`
+ * from the one at the start of the steady interval, and the norm of the
+ * derivative of the state at the start of the period is at most
+ * `derivativeTolerance`. Instead of running the ODE solver, the state is then
+ * advanced by a single Euler step over the entire period, see
+ * ContinuousModel::eulerStep.
+ *
+ * The control signal is compared to the start of the steady interval rather
+ * than to the previous period, so a slow drift of the control signal can't
+ * keep the integration disabled indefinitely.
+ *
+ * This is disabled by default.
+ */
+struct QuiescenceOptions {
+    /// The largest norm of the state derivative of a system at rest.
+    double derivativeTolerance = 0;
+    /// The largest change of the control signal of a system at rest.
+    double controlTolerance = 0;
+
+    bool enabled() const { return derivativeTolerance > 0; }
+};
+
+namespace ClosedLoopSimulation {
+
+/**
+ * @brief   Remembers the control signal and the reference at the start of the
+ *          steady interval, to detect when the closed loop is at rest, and
+ *          counts the skipped periods.
+ *
+ * @see     QuiescenceOptions
+ */
+template <class VecU_t, class VecR_t>
+class QuiescenceDetector {
+  public:
+    QuiescenceDetector(const QuiescenceOptions &opt) : opt(opt) {}
+
+    /**
+     * @brief   Check whether the control signal and the reference didn't
+     *          change since the start of the steady interval. If they did,
+     *          a new steady interval starts with the given ones.
+     */
+    bool isSteady(const VecU_t &u, const VecR_t &r) {
+        bool steady = opt.enabled() && haveSteady && r == steady_r &&
+                      distance(u, steady_u) <= opt.controlTolerance;
+        if (!steady) {
+            steady_u   = u;
+            steady_r   = r;
+            haveSteady = true;
+        }
+        return steady;
+    }
+
+    /// Check whether the state derivative is small enough to skip the
+    /// integration.
+    template <class VecX_t>
+    bool isAtRest(const VecX_t &x_dot) const {
+        return distance(x_dot, VecX_t{}) <= opt.derivativeTolerance;
+    }
+
+    /// Count a skipped control period.
+    void skip() { ++skipped; }
+    /// Get the number of skipped control periods.
+    size_t getSkippedPeriods() const { return skipped; }
+
+  private:
+    /// The Euclidean distance between two column vectors.
+    template <size_t N>
+    static double distance(const ColVector<N> &a, const ColVector<N> &b) {
+        double sum = 0;
+        for (size_t i = 0; i < N; ++i)
+            sum += (a[i][0] - b[i][0]) * (a[i][0] - b[i][0]);
+        return std::sqrt(sum);
+    }
+
+    QuiescenceOptions opt;
+    bool haveSteady = false;
+    VecU_t steady_u = {};
+    VecR_t steady_r = {};
+    size_t skipped  = 0;
+};
+
+}  // namespace ClosedLoopSimulation
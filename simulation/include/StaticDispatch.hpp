@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cassert>
+#include <memory>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+/**
+ * @brief   Helpers to call the (possibly virtual) member functions of models,
+ *          controllers, observers, noise generators and reference functions
+ *          without dynamic dispatch, when the concrete type is known at
+ *          compile time.
+ *
+ * If `T` is an abstract class, the call goes through the vtable as usual.
+ * Otherwise, `T` has to be the dynamic type of the object, and the member
+ * function of `T` is called directly, so it can be inlined.
+ */
+namespace StaticDispatch {
+
+/// True if the member functions of T should be called through the vtable.
+template <class T>
+constexpr bool isDynamic = std::is_abstract_v<T>;
+
+/// True if calling the member functions of T by their qualified name would
+/// skip an override.
+template <class T>
+constexpr bool needsQualifiedCall =
+    std::is_polymorphic_v<T> && !std::is_abstract_v<T>;
+
+template <class T>
+inline void checkDynamicType([[maybe_unused]] const T &t) {
+    if constexpr (needsQualifiedCall<T>)
+        assert(typeid(t) == typeid(T) &&
+               "The static type should be the dynamic type of the object");
+}
+
+/// Call `t(args...)`.
+template <class T, class... Args>
+inline decltype(auto) call(T &t, Args &&... args) {
+    if constexpr (needsQualifiedCall<T>) {
+        checkDynamicType(t);
+        return t.T::operator()(std::forward<Args>(args)...);
+    } else {
+        return t(std::forward<Args>(args)...);
+    }
+}
+
+/// Call `t.getOutput(args...)`.
+template <class T, class... Args>
+inline decltype(auto) getOutput(T &t, Args &&... args) {
+    if constexpr (needsQualifiedCall<T>) {
+        checkDynamicType(t);
+        return t.T::getOutput(std::forward<Args>(args)...);
+    } else {
+        return t.getOutput(std::forward<Args>(args)...);
+    }
+}
+
+/// Call `t.getStateChange(args...)`.
+template <class T, class... Args>
+inline decltype(auto) getStateChange(T &t, Args &&... args) {
+    if constexpr (needsQualifiedCall<T>) {
+        checkDynamicType(t);
+        return t.T::getStateChange(std::forward<Args>(args)...);
+    } else {
+        return t.getStateChange(std::forward<Args>(args)...);
+    }
+}
+
+/// Call `t.advance(args...)`.
+template <class T, class... Args>
+inline decltype(auto) advance(T &t, Args &&... args) {
+    if constexpr (needsQualifiedCall<T>) {
+        checkDynamicType(t);
+        return t.T::advance(std::forward<Args>(args)...);
+    } else {
+        return t.advance(std::forward<Args>(args)...);
+    }
+}
+
+/// Call `t.eulerStep(args...)`.
+template <class T, class... Args>
+inline decltype(auto) eulerStep(T &t, Args &&... args) {
+    if constexpr (needsQualifiedCall<T>) {
+        checkDynamicType(t);
+        return t.T::eulerStep(std::forward<Args>(args)...);
+    } else {
+        return t.eulerStep(std::forward<Args>(args)...);
+    }
+}
+
+/// Call `t.reset()`.
+template <class T>
+inline void reset(T &t) {
+    if constexpr (needsQualifiedCall<T>) {
+        checkDynamicType(t);
+        t.T::reset();
+    } else {
+        t.reset();
+    }
+}
+
+/// Get a reference to an object that is stored by value or by pointer.
+template <class T>
+inline T &deref(T &t) {
+    return t;
+}
+template <class T>
+inline T &deref(std::unique_ptr<T> &t) {
+    return *t;
+}
+template <class T>
+inline T &deref(const std::unique_ptr<T> &t) {
+    return *t;
+}
+
+}  // namespace StaticDispatch
@@ -0,0 +1,315 @@
+#include <gtest/gtest.h>
+
+#include <AlmostEqual.hpp>
+#include <Model.hpp>
+
+using namespace std;
+
+using Model_t = CTLTIModel<2, 2, 2>;
+
+// Double integrator (with a disturbance input on the position) with a state
+// feedback controller and a Luenberger observer, using concrete types for
+// everything.
+
+static const Matrix<2, 2> A = {{{0, 1}, {0, 0}}};
+static const Matrix<2, 2> B = eye<2>();
+static const Matrix<2, 2> C = eye<2>();
+static const Matrix<2, 2> D = zeros<2, 2>();
+
+class StateFeedback final : public DiscreteController<2, 2, 2> {
+  public:
+    StateFeedback() : DiscreteController<2, 2, 2>{0.05} {}
+    VecU_t operator()(const VecX_t &x, const VecR_t &r) override {
+        ++calls;
+        return -K * (x - r);
+    }
+    const Matrix<2, 2> K = {{{0, 0}, {4, 2.5}}};
+    size_t calls         = 0;
+};
+
+class Luenberger final : public DiscreteObserver<2, 2, 2> {
+  public:
+    Luenberger() : DiscreteObserver<2, 2, 2>{0.05} {}
+    VecX_t getStateChange(const VecX_t &x_hat, const VecY_t &y,
+                          const VecU_t &u) override {
+        VecX_t x_dot = A * x_hat + B * u + L * (y - C * x_hat);
+        return x_hat + Ts * x_dot;
+    }
+    const Matrix<2, 2> L = {{{10, 0}, {0, 20}}};
+};
+
+struct Step final : public TimeFunctionT<ColVector<2>> {
+    ColVector<2> operator()(double t) override {
+        return {t < 0.5 ? 0. : 1., 0};
+    }
+};
+
+static AdaptiveODEOptions getOptions() {
+    AdaptiveODEOptions opt = {};
+    opt.t_start            = 0;
+    opt.t_end              = 2;
+    opt.epsilon            = 1e-8;
+    opt.h_start            = 1e-3;
+    opt.h_min              = 1e-8;
+    opt.maxiter            = 1e6;
+    return opt;
+}
+
+TEST(ClosedLoopSimulation, controllerEquivalence) {
+    Model_t model = {A, B, C, D};
+    StateFeedback ctrl1, ctrl2;
+    Step ref;
+    ColVector<2> x0 = {0.1, -0.2};
+    auto opt        = getOptions();
+
+    // Virtual API
+    ContinuousModel<2, 2, 2> &base = model;
+    DiscreteController<2, 2, 2> &c = ctrl1;
+    TimeFunctionT<ColVector<2>> &r = ref;
+    auto expected                  = base.simulate(c, r, x0, opt);
+    // Static path
+    auto result = ClosedLoopSimulation::simulate(model, ctrl2, ref, x0, opt);
+
+    ASSERT_EQ(result.time, expected.time);
+    ASSERT_EQ(result.solution, expected.solution);
+    ASSERT_EQ(result.sampledTime, expected.sampledTime);
+    ASSERT_EQ(result.control, expected.control);
+    ASSERT_EQ(result.reference, expected.reference);
+    ASSERT_EQ(result.resultCode, expected.resultCode);
+    ASSERT_EQ(result.iterations, expected.iterations);
+    ASSERT_EQ(ctrl1.calls, ctrl2.calls);
+}
+
+TEST(ClosedLoopSimulation, realTimeEquivalence) {
+    Model_t model = {A, B, C, D};
+    StateFeedback ctrl1, ctrl2;
+    Step ref;
+    ColVector<2> x0 = {0.1, -0.2};
+    auto opt        = getOptions();
+
+    vector<ColVector<2>> expected, result;
+    auto record = [](vector<ColVector<2>> &v) {
+        return [&v](double t, const ColVector<2> &x, const ColVector<2> &) {
+            v.push_back(x);
+            return t < 1.5;
+        };
+    };
+    auto f1 = record(expected);
+    auto f2 = record(result);
+
+    ContinuousModel<2, 2, 2> &base = model;
+    DiscreteController<2, 2, 2> &c = ctrl1;
+    TimeFunctionT<ColVector<2>> &r = ref;
+    auto code1 = base.simulateRealTime(c, r, x0, opt, f1);
+    auto code2 =
+        ClosedLoopSimulation::simulateRealTime(model, ctrl2, ref, x0, opt, f2);
+
+    ASSERT_EQ(code1, code2);
+    ASSERT_FALSE(result.empty());
+    ASSERT_EQ(result, expected);
+}
+
+TEST(ClosedLoopSimulation, observerEquivalence) {
+    Model_t model = {A, B, C, D};
+    StateFeedback ctrl1, ctrl2;
+    Luenberger obs1, obs2;
+    Array<double, 2> varW                    = {0, 1e-4};
+    Array<double, 2> varV                    = {1e-6, 1e-6};
+    CounterBasedGaussianNoiseGenerator<2> w1 = {varW, 0.05, 1};
+    CounterBasedGaussianNoiseGenerator<2> w2 = {varW, 0.05, 1};
+    CounterBasedGaussianNoiseGenerator<2> v1 = {varV, 0.05, 2};
+    CounterBasedGaussianNoiseGenerator<2> v2 = {varV, 0.05, 2};
+    Step ref;
+    ColVector<2> x0 = {0.1, -0.2};
+    auto opt        = getOptions();
+
+    ContinuousModel<2, 2, 2> &base = model;
+    DiscreteController<2, 2, 2> &c = ctrl1;
+    DiscreteObserver<2, 2, 2> &o   = obs1;
+    NoiseGenerator<2> &w           = w1;
+    NoiseGenerator<2> &v           = v1;
+    TimeFunctionT<ColVector<2>> &r = ref;
+    auto expected                  = base.simulate(c, o, w, v, r, x0, opt);
+    auto result = ClosedLoopSimulation::simulate(model, ctrl2, obs2, w2, v2,
+                                                 ref, x0, opt);
+
+    ASSERT_EQ(result.time, expected.time);
+    ASSERT_EQ(result.solution, expected.solution);
+    ASSERT_EQ(result.estimatedSolution, expected.estimatedSolution);
+    ASSERT_EQ(result.output, expected.output);
+    ASSERT_EQ(result.control, expected.control);
+    ASSERT_EQ(result.reference, expected.reference);
+    ASSERT_EQ(result.resultCode, expected.resultCode);
+}
+
+TEST(ClosedLoopSimulation, lambdaReference) {
+    Model_t model = {A, B, C, D};
+    StateFeedback ctrl1, ctrl2;
+    Step ref;
+    auto lambda = [](double t) { return ColVector<2>{t < 0.5 ? 0. : 1., 0}; };
+    ColVector<2> x0 = {};
+    auto opt        = getOptions();
+
+    auto expected = ClosedLoopSimulation::simulate(model, ctrl1, ref, x0, opt);
+    auto result = ClosedLoopSimulation::simulate(model, ctrl2, lambda, x0, opt);
+    ASSERT_EQ(result.solution, expected.solution);
+    ASSERT_EQ(result.control, expected.control);
+}
+
+TEST(ClosedLoopSimulation, stepperEquivalence) {
+    Model_t model = {A, B, C, D};
+    StateFeedback ctrl1, ctrl2;
+    Luenberger obs1, obs2;
+    Array<double, 2> varW                    = {0, 1e-4};
+    Array<double, 2> varV                    = {1e-6, 1e-6};
+    CounterBasedGaussianNoiseGenerator<2> w1 = {varW, 0.05, 1};
+    CounterBasedGaussianNoiseGenerator<2> w2 = {varW, 0.05, 1};
+    CounterBasedGaussianNoiseGenerator<2> v1 = {varV, 0.05, 2};
+    CounterBasedGaussianNoiseGenerator<2> v2 = {varV, 0.05, 2};
+    Step ref;
+    ColVector<2> x0 = {0.1, -0.2};
+    auto opt        = getOptions();
+
+    auto expected = ClosedLoopSimulation::simulate(model, ctrl1, obs1, w1, v1,
+                                                   ref, x0, opt);
+
+    ContinuousModel<2, 2, 2> &base = model;
+    auto stepper = base.getStepper(ctrl2, obs2, w2, v2, ref, x0, opt);
+    ContinuousModel<2, 2, 2>::Stepper::Sample s;
+    size_t k = 0;
+    while (stepper.next(s)) {
+        ASSERT_LT(k, expected.sampledTime.size());
+        EXPECT_EQ(s.t, expected.sampledTime[k]);
+        EXPECT_EQ(s.x_hat, expected.estimatedSolution[k]);
+        EXPECT_EQ(s.u, expected.control[k]);
+        EXPECT_EQ(s.y, expected.output[k]);
+        EXPECT_EQ(s.r, expected.reference[k]);
+        // The actual state at the sample time is one of the intermediate
+        // points of the ODE solver
+        auto it = find(expected.time.begin(), expected.time.end(), s.t);
+        ASSERT_NE(it, expected.time.end());
+        EXPECT_EQ(s.x, expected.solution[it - expected.time.begin()]);
+        ++k;
+    }
+    EXPECT_EQ(k, expected.sampledTime.size());
+    EXPECT_EQ(stepper.getResultCode(), expected.resultCode);
+    EXPECT_EQ(stepper.getIterations(), expected.iterations);
+    EXPECT_TRUE(stepper.done());
+    EXPECT_FALSE(stepper.next(s));
+}
+
+TEST(ClosedLoopSimulation, stepperPauseResume) {
+    Model_t model = {A, B, C, D};
+    StateFeedback ctrl1, ctrl2;
+    Luenberger obs1, obs2;
+    NoNoiseGenerator<2> w, v;
+    Step ref;
+    ColVector<2> x0 = {0.1, -0.2};
+    auto opt        = getOptions();
+
+    ClosedLoopSimulation::ClosedLoopStepper paused = {
+        model, ctrl1, obs1, w, v, ref, x0, opt};
+    ClosedLoopSimulation::ClosedLoopStepper uninterrupted = {
+        model, ctrl2, obs2, w, v, ref, x0, opt};
+    using Sample = decltype(paused)::Sample;
+    vector<Sample> pausedSamples, expected;
+    Sample s;
+
+    // Run the first stepper until the step in the reference, and pause it
+    while (paused.getTime() < 0.5) {
+        ASSERT_TRUE(paused.next(s));
+        pausedSamples.push_back(s);
+    }
+    const ColVector<2> x_paused = paused.getState();
+
+    // While it's paused, run the entire simulation using the same model
+    while (uninterrupted.next(s))
+        expected.push_back(s);
+    EXPECT_EQ(paused.getState(), x_paused);
+
+    // Resuming gives exactly the same samples as the uninterrupted run
+    while (paused.next(s))
+        pausedSamples.push_back(s);
+    ASSERT_EQ(pausedSamples.size(), expected.size());
+    for (size_t k = 0; k < expected.size(); ++k) {
+        EXPECT_EQ(pausedSamples[k].t, expected[k].t);
+        EXPECT_EQ(pausedSamples[k].x, expected[k].x);
+        EXPECT_EQ(pausedSamples[k].x_hat, expected[k].x_hat);
+        EXPECT_EQ(pausedSamples[k].u, expected[k].u);
+    }
+    EXPECT_EQ(paused.getState(), uninterrupted.getState());
+    EXPECT_EQ(paused.getIterations(), uninterrupted.getIterations());
+}
+
+TEST(ClosedLoopSimulation, quiescence) {
+    Model_t model = {A, B, C, D};
+    StateFeedback ctrl;
+    Step ref;
+    ColVector<2> x0 = {0.1, -0.2};
+    auto opt        = getOptions();
+    opt.t_end       = 12;
+
+    auto expected = ClosedLoopSimulation::simulate(model, ctrl, ref, x0, opt);
+    EXPECT_EQ(expected.skippedPeriods, 0);
+
+    model.quiescence.derivativeTolerance = 1e-4;
+    model.quiescence.controlTolerance    = 1e-4;
+    auto result = ClosedLoopSimulation::simulate(model, ctrl, ref, x0, opt);
+
+    // The closed loop settles long before the end, and the periods around
+    // the step of the reference are still integrated
+    EXPECT_GT(result.skippedPeriods, 50);
+    EXPECT_LT(result.skippedPeriods, result.sampledTime.size());
+    EXPECT_LT(result.iterations, expected.iterations);
+    // Results are reported the same way, and stay close to the full solution
+    ASSERT_EQ(result.sampledTime, expected.sampledTime);
+    ASSERT_EQ(result.reference, expected.reference);
+    ASSERT_EQ(result.time.size(), result.solution.size());
+    for (size_t i = 0; i < expected.control.size(); ++i)
+        EXPECT_TRUE(
+            isAlmostEqual(result.control[i], expected.control[i], 1e-4))
+            << i;
+    EXPECT_TRUE(isAlmostEqual(result.solution.back(), expected.solution.back(),
+                              1e-4));
+
+    // The real-time simulation skips the same periods
+    size_t skipped = 0;
+    auto f = [](double, const ColVector<2> &, const ColVector<2> &) {
+        return true;
+    };
+    ClosedLoopSimulation::simulateRealTime(model, ctrl, ref, x0, opt, f,
+                                           &skipped);
+    EXPECT_EQ(skipped, result.skippedPeriods);
+
+    // With an observer, the stepper skips the same periods as simulate
+    Luenberger obs1, obs2;
+    NoNoiseGenerator<2> w, v;
+    auto withObserver =
+        ClosedLoopSimulation::simulate(model, ctrl, obs1, w, v, ref, x0, opt);
+    EXPECT_GT(withObserver.skippedPeriods, 0);
+    ContinuousModel<2, 2, 2>::Stepper stepper = {model, ctrl, obs2, w,
+                                                 v,     ref,  x0,   opt};
+    ContinuousModel<2, 2, 2>::Stepper::Sample sample;
+    while (stepper.next(sample))
+        continue;
+    EXPECT_EQ(stepper.getSkippedPeriods(), withObserver.skippedPeriods);
+    EXPECT_EQ(stepper.getIterations(), withObserver.iterations);
+}
+
+TEST(ClosedLoopSimulation, quiescenceControlDrift) {
+    QuiescenceOptions opt   = {};
+    opt.derivativeTolerance = 1e-4;
+    opt.controlTolerance    = 1e-4;
+    ClosedLoopSimulation::QuiescenceDetector<ColVector<1>, ColVector<1>>
+        detector = {opt};
+    const ColVector<1> r = {1};
+
+    EXPECT_FALSE(detector.isSteady({0}, r));
+    // Every period changes by less than the tolerance, but the control
+    // signal is compared to the start of the steady interval
+    EXPECT_TRUE(detector.isSteady({0.6e-4}, r));
+    EXPECT_FALSE(detector.isSteady({1.2e-4}, r));
+    // A new steady interval starts at the last control signal
+    EXPECT_TRUE(detector.isSteady({1.8e-4}, r));
+    EXPECT_FALSE(detector.isSteady({1.8e-4}, {2}));
+}
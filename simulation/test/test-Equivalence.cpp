@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include <Equivalence.hpp>
+
+#include <cmath>
+#include <vector>
+
+using namespace std;
+
+// A proportional-integral controller in two implementations: the integral of
+// the second one is rounded to single precision, like on-board code would do.
+template <class Integral>
+class PIController final : public DiscreteController<1, 1, 1> {
+  public:
+    PIController() : DiscreteController<1, 1, 1>{0.01} {}
+    VecU_t operator()(const VecX_t &x, const VecR_t &r) override {
+        integral = Integral(integral + (r[0][0] - x[0][0]));
+        return {3 * (r[0][0] - x[0][0]) + 0.5 * integral};
+    }
+    void reset() override { integral = 0; }
+    Integral integral = 0;
+};
+
+class Complementary final : public DiscreteObserver<2, 1, 2> {
+  public:
+    Complementary(double gain) : DiscreteObserver<2, 1, 2>{0.01}, gain{gain} {}
+    VecX_t getStateChange(const VecX_t &x_hat, const VecY_t &y,
+                          const VecU_t &u) override {
+        return x_hat + gain * (y - x_hat) + VecX_t{u[0][0], 0};
+    }
+    const double gain;
+};
+
+static EquivalenceOptions getOptions() {
+    EquivalenceOptions opt = {};
+    opt.evictionBytes      = 1 << 16;
+    return opt;
+}
+
+TEST(Equivalence, controllers) {
+    vector<ColVector<1>> xs, rs;
+    for (size_t i = 0; i < 200; ++i) {
+        xs.push_back({sin(0.1 * i)});
+        rs.push_back({1});
+    }
+
+    PIController<double> a, b;
+    PIController<float> c;
+    EquivalenceResult same = compareControllers(a, b, xs, rs, getOptions());
+    // Both implementations are reset before every pass, so the integral
+    // doesn't accumulate over the passes
+    EXPECT_EQ(same.maxDifference, 0);
+    EXPECT_EQ(same.rmsDifference, 0);
+
+    EquivalenceResult single = compareControllers(a, c, xs, rs, getOptions());
+    EXPECT_GT(single.maxDifference, 0);
+    EXPECT_LT(single.maxDifference, 1e-4);
+    EXPECT_LE(single.rmsDifference, single.maxDifference);
+    EXPECT_LT(single.maxDifferenceIndex, xs.size());
+
+    for (const auto &stats : {single.warm[0], single.warm[1], single.cold[0],
+                              single.cold[1]}) {
+        EXPECT_LE(stats.p50, stats.p99);
+        EXPECT_LE(stats.p99, stats.max);
+        EXPECT_LE(stats.mean, stats.max);
+        EXPECT_GT(stats.max, 0);
+    }
+
+    rs.pop_back();
+    EXPECT_THROW(compareControllers(a, b, xs, rs), std::invalid_argument);
+}
+
+TEST(Equivalence, observers) {
+    vector<ColVector<2>> x_hats = {{0, 0}, {1, 2}, {-1, 3}};
+    vector<ColVector<2>> ys     = {{1, 1}, {1, 1}, {2, 2}};
+    vector<ColVector<1>> us     = {{0}, {1}, {2}};
+
+    Complementary a        = {0.5};
+    Complementary b        = {0.25};
+    EquivalenceOptions opt = getOptions();
+    opt.cold               = false;
+
+    EquivalenceResult result = compareObservers(a, b, x_hats, ys, us, opt);
+    // Differences: 0.25 * (y - x_hat)
+    EXPECT_DOUBLE_EQ(result.maxDifference, 0.75);
+    EXPECT_EQ(result.maxDifferenceIndex, 2);
+    double rms = 0.25 * sqrt((1 + 1 + 0 + 1 + 9 + 1) / 6.);
+    EXPECT_DOUBLE_EQ(result.rmsDifference, rms);
+    EXPECT_EQ(result.cold[0].max, 0);
+}
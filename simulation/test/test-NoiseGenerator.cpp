@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <NoiseGenerator.hpp>
+#include <vector>
+
+using namespace std;
+
+static const Array<double, 5> variances = {1e-2, 2e-4, 0.5, 3, 1e-6};
+constexpr double Ts                     = 0.01;
+
+TEST(CounterBasedGaussianNoiseGenerator, orderIndependent) {
+    CounterBasedGaussianNoiseGenerator<5> forward  = {variances, Ts, 7, 2};
+    CounterBasedGaussianNoiseGenerator<5> backward = {variances, Ts, 7, 2};
+    constexpr size_t N                             = 300;
+    vector<ColVector<5>> f(N), b(N);
+    for (size_t k = 0; k < N; ++k)
+        f[k] = forward.randomVector(k);
+    for (size_t k = N; k-- > 0;)
+        b[k] = backward.randomVector(k);
+    ASSERT_EQ(f, b);
+}
+
+TEST(CounterBasedGaussianNoiseGenerator, blockSizeIndependent) {
+    CounterBasedGaussianNoiseGenerator<5, 64> a = {variances, Ts, 3};
+    CounterBasedGaussianNoiseGenerator<5, 4> b  = {variances, Ts, 3};
+    vector<ColVector<5>> va, vb;
+    a.fill(1000, 200, back_inserter(va));
+    b.fill(1000, 200, back_inserter(vb));
+    ASSERT_EQ(va, vb);
+}
+
+TEST(CounterBasedGaussianNoiseGenerator, time) {
+    CounterBasedGaussianNoiseGenerator<5> gen = {variances, Ts, 3};
+    ColVector<5> v                            = {1, 2, 3, 4, 5};
+    // Slightly off the sample grid still maps to sample 123
+    ColVector<5> result   = gen(123 * Ts + 1e-12, v);
+    ColVector<5> expected = v + gen.randomVector(123);
+    ASSERT_EQ(result, expected);
+}
+
+TEST(CounterBasedGaussianNoiseGenerator, runsAndSeedsDiffer) {
+    CounterBasedGaussianNoiseGenerator<5> gen  = {variances, Ts, 3, 0};
+    CounterBasedGaussianNoiseGenerator<5> seed = {variances, Ts, 4, 0};
+    ColVector<5> run0                          = gen.randomVector(10);
+    gen.setRun(1);
+    ColVector<5> run1 = gen.randomVector(10);
+    for (size_t i = 0; i < 5; ++i) {
+        ASSERT_NE(run0[i], run1[i]);
+        ASSERT_NE(run0[i], seed.randomVector(10)[i]);
+    }
+}
+
+TEST(CounterBasedGaussianNoiseGenerator, variance) {
+    CounterBasedGaussianNoiseGenerator<5> gen = {variances, Ts, 11};
+    constexpr size_t N                        = 1 << 15;
+    ColVector<5> sum                          = {};
+    ColVector<5> sumsq                        = {};
+    for (size_t k = 0; k < N; ++k) {
+        ColVector<5> v = gen.randomVector(k);
+        for (size_t i = 0; i < 5; ++i) {
+            sum[i] += v[i];
+            sumsq[i] += v[i] * v[i];
+        }
+    }
+    for (size_t i = 0; i < 5; ++i) {
+        double mean = sum[i] / N;
+        ASSERT_NEAR(mean, 0, 0.05 * sqrt(variances[i]));
+        ASSERT_NEAR(sumsq[i] / N - mean * mean, variances[i],
+                    0.05 * variances[i]);
+    }
+}
@@ -1,5 +1,4 @@
 #include "StepResponseAnalyzer.hpp"
-#include <Plot.hpp>
 
 template <size_t N>
 bool StepResponseAnalyzer<N>::calculate(double t, const ColVector<N> &x) {
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>  // __rdtsc, _mm_lfence
+#endif
+
+/**
+ * @brief   Read a monotonic counter for timing short sections of code.
+ *
+ * On x86, this is the time stamp counter, in reference cycles. The reads are
+ * fenced, so the timed instructions can't be reordered around them. On other
+ * architectures, the steady clock is used, in nanoseconds.
+ */
+inline uint64_t readCycleCounter() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_lfence();
+    uint64_t cycles = __rdtsc();
+    _mm_lfence();
+    return cycles;
+#else
+    using namespace std::chrono;
+    auto now = steady_clock::now().time_since_epoch();
+    return duration_cast<nanoseconds>(now).count();
+#endif
+}
+
+/// The unit of readCycleCounter.
+constexpr const char *cycleCounterUnit() {
+#if defined(__x86_64__) || defined(__i386__)
+    return "cycles";
+#else
+    return "ns";
+#endif
+}
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <algorithm>  // min
+#include <cerrno>
+#include <cstdlib>  // mkstemp
+#include <cstring>  // strerror
+#include <filesystem>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>  // swap
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace MappedFileDetail {
+
+[[noreturn]] inline void throwError(const std::string &what,
+                                    const std::filesystem::path &path) {
+    std::stringstream sstr;
+    sstr << "Error: " << what << " (" << path << "): " << strerror(errno);
+    throw std::runtime_error(sstr.str());
+}
+
+}  // namespace MappedFileDetail
+
+/**
+ * @brief   A file that is mapped into memory with `mmap`.
+ *
+ * The pages are only loaded when they are accessed, and the kernel can evict
+ * them again at any time, so a mapping of a file that is much larger than the
+ * available memory can be traversed with a bounded resident set. The
+ * `willNeed` and `dontNeed` hints make this explicit for access patterns that
+ * the kernel can't predict, e.g. a backward traversal.
+ */
+class MappedFile {
+  public:
+    enum Mode { ReadOnly, ReadWrite };
+
+    /// Map an existing file for reading.
+    explicit MappedFile(const std::filesystem::path &path)
+        : MappedFile{path, ReadOnly, 0} {}
+
+    /**
+     * @brief   Map a file. In ReadWrite mode, the file is created if needed,
+     *          and it is resized to the given size.
+     */
+    MappedFile(const std::filesystem::path &path, Mode mode, size_t size) {
+        int flags = mode == ReadOnly ? O_RDONLY : O_RDWR | O_CREAT;
+        int fd    = ::open(path.c_str(), flags, 0644);
+        if (fd < 0)
+            MappedFileDetail::throwError("unable to open file", path);
+        try {
+            map(fd, mode, size, path);
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+        ::close(fd);
+    }
+
+    /// Map an already opened file descriptor. The descriptor is not closed.
+    MappedFile(int fd, Mode mode, size_t size) { map(fd, mode, size, {}); }
+
+    ~MappedFile() {
+        if (bytes > 0)
+            munmap(address, bytes);
+    }
+    MappedFile(MappedFile &&other) noexcept
+        : address{other.address}, bytes{other.bytes} {
+        other.address = nullptr;
+        other.bytes   = 0;
+    }
+    MappedFile &operator=(MappedFile &&other) noexcept {
+        std::swap(address, other.address);
+        std::swap(bytes, other.bytes);
+        return *this;
+    }
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    void *data() { return address; }
+    const void *data() const { return address; }
+    size_t size() const { return bytes; }
+
+    /// Ask the kernel to start reading the given range in the background.
+    void willNeed(size_t offset, size_t length) const {
+        advise(offset, length, MADV_WILLNEED);
+    }
+    /// Tell the kernel that the given range won't be accessed again soon.
+    void dontNeed(size_t offset, size_t length) const {
+        advise(offset, length, MADV_DONTNEED);
+    }
+
+  private:
+    void map(int fd, Mode mode, size_t size,
+             const std::filesystem::path &path) {
+        if (mode == ReadWrite) {
+            if (ftruncate(fd, size) != 0)
+                MappedFileDetail::throwError("unable to resize file", path);
+        } else {
+            struct stat st;
+            if (fstat(fd, &st) != 0)
+                MappedFileDetail::throwError("unable to stat file", path);
+            size = st.st_size;
+        }
+        bytes = size;
+        if (bytes == 0)
+            return;
+        int prot = mode == ReadOnly ? PROT_READ : PROT_READ | PROT_WRITE;
+        address  = mmap(nullptr, bytes, prot, MAP_SHARED, fd, 0);
+        if (address == MAP_FAILED) {
+            address = nullptr;
+            bytes   = 0;
+            MappedFileDetail::throwError("unable to map file", path);
+        }
+    }
+
+    void advise(size_t offset, size_t length, int advice) const {
+        if (offset >= bytes)
+            return;
+        // madvise needs a page-aligned start address
+        const size_t page = sysconf(_SC_PAGESIZE);
+        size_t begin      = offset / page * page;
+        size_t end        = std::min(offset + length, bytes);
+        madvise(static_cast<char *>(address) + begin, end - begin, advice);
+    }
+
+    void *address = nullptr;
+    size_t bytes  = 0;
+};
+
+/**
+ * @brief   An append-only array of trivially copyable records, that is
+ *          spilled to an anonymous temporary file in blocks, and mapped back
+ *          into memory for reading.
+ *
+ * While writing, only the current block is kept in memory. After finish, the
+ * records can be read in any order, and forEachReverse visits them from back
+ * to front, prefetching the next block and releasing the visited blocks, so
+ * the resident memory stays bounded by a few blocks, regardless of the
+ * number of records.
+ */
+template <class T>
+class SpillBuffer {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Error: records are written to disk as raw bytes");
+
+  public:
+    /**
+     * @param   blockSize
+     *          The number of records per block.
+     * @param   directory
+     *          The directory of the temporary file. It is unlinked right
+     *          away, so it is removed even if the program crashes.
+     */
+    explicit SpillBuffer(size_t blockSize = 1 << 14,
+                         const std::filesystem::path &directory =
+                             std::filesystem::temp_directory_path())
+        : blockSize{blockSize} {
+        std::string name = (directory / "spill-XXXXXX").string();
+        fd               = mkstemp(name.data());
+        if (fd < 0)
+            MappedFileDetail::throwError("unable to create spill file",
+                                         directory);
+        ::unlink(name.c_str());
+        block.reserve(blockSize);
+    }
+    ~SpillBuffer() {
+        mapping.reset();
+        if (fd >= 0)
+            ::close(fd);
+    }
+    SpillBuffer(const SpillBuffer &) = delete;
+    SpillBuffer &operator=(const SpillBuffer &) = delete;
+
+    void push_back(const T &record) {
+        block.push_back(record);
+        if (block.size() == blockSize)
+            flush();
+    }
+
+    /// The number of records pushed so far.
+    size_t size() const { return count + block.size(); }
+
+    /// Write the last block, and map the file for reading.
+    void finish() {
+        flush();
+        block.clear();
+        block.shrink_to_fit();
+        mapping = std::make_unique<MappedFile>(fd, MappedFile::ReadOnly,
+                                               count * sizeof(T));
+    }
+
+    /// Access a record. Only valid after finish.
+    const T &operator[](size_t i) const {
+        return static_cast<const T *>(mapping->data())[i];
+    }
+
+    /// Visit all records, from the last one to the first one.
+    template <class F>
+    void forEachReverse(F &&f) const {
+        const size_t blockBytes = blockSize * sizeof(T);
+        for (size_t i = count; i-- > 0;) {
+            if ((i + 1) % blockSize == 0 || i + 1 == count) {
+                size_t b = i / blockSize;
+                if (b > 0)
+                    mapping->willNeed((b - 1) * blockBytes, blockBytes);
+                mapping->dontNeed((b + 1) * blockBytes, blockBytes);
+            }
+            f(i, (*this)[i]);
+        }
+    }
+
+  private:
+    void flush() {
+        const char *buf = reinterpret_cast<const char *>(block.data());
+        size_t len      = block.size() * sizeof(T);
+        while (len > 0) {
+            ssize_t written = ::write(fd, buf, len);
+            if (written < 0) {
+                if (errno == EINTR)
+                    continue;
+                MappedFileDetail::throwError("unable to write spill file",
+                                             "");
+            }
+            buf += written;
+            len -= written;
+        }
+        count += block.size();
+        block.clear();
+    }
+
+    const size_t blockSize;
+    int fd       = -1;
+    size_t count = 0;
+    std::vector<T> block;
+    std::unique_ptr<MappedFile> mapping;
+};
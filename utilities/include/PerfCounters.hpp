@@ -0,0 +1,137 @@
+#pragma once
+
+#include "CycleCounter.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstring>  // memset
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/// The events counted by PerfCounters between start and stop.
+struct PerfSample {
+    uint64_t cycles       = 0;
+    uint64_t instructions = 0;
+    uint64_t branchMisses = 0;
+    uint64_t cacheMisses  = 0;
+    /// False if the counters couldn't be read, in which case the events are
+    /// zero and the sample should be discarded.
+    bool valid = true;
+};
+
+/**
+ * @brief   Counts the cycles, instructions, branch misses and cache misses of
+ *          the calling thread in user space, with the hardware performance
+ *          counters of Linux (perf_event_open).
+ *
+ * The counters are opened as a single group, so they are scheduled on the
+ * PMU together, and they are read with a single system call in start and
+ * stop. The cost of reading them is included in every sample, but it's
+ * constant.
+ *
+ * If the counters can't be opened (other operating systems, virtual machines
+ * without a PMU, or `perf_event_paranoid` > 2), the cycles are measured with
+ * readCycleCounter instead, and the other events are zero.
+ */
+class PerfCounters {
+  public:
+    PerfCounters() { open(); }
+    ~PerfCounters() { close(); }
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    /// Check whether the hardware counters are used.
+    bool available() const { return fds[0] >= 0; }
+
+    /// The unit of PerfSample::cycles.
+    const char *unit() const {
+        return available() ? "cycles" : cycleCounterUnit();
+    }
+
+    void start() { begin = read(); }
+
+    /// Get the events since the last call of start. The sample is invalid if
+    /// the counters couldn't be read in start or stop.
+    PerfSample stop() {
+        PerfSample end = read();
+        if (!begin.valid || !end.valid)
+            return invalid();
+        return {end.cycles - begin.cycles,
+                end.instructions - begin.instructions,
+                end.branchMisses - begin.branchMisses,
+                end.cacheMisses - begin.cacheMisses};
+    }
+
+  private:
+    static constexpr size_t N = 4;
+
+    static PerfSample invalid() {
+        PerfSample sample = {};
+        sample.valid      = false;
+        return sample;
+    }
+
+#ifdef __linux__
+    void open() {
+        const std::array<uint64_t, N> events = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_BRANCH_MISSES,
+            PERF_COUNT_HW_CACHE_MISSES,
+        };
+        for (size_t i = 0; i < N; ++i) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size           = sizeof(attr);
+            attr.type           = PERF_TYPE_HARDWARE;
+            attr.config         = events[i];
+            attr.disabled       = i == 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv     = 1;
+            attr.read_format    = PERF_FORMAT_GROUP;
+            fds[i] = syscall(SYS_perf_event_open, &attr, 0, -1, fds[0], 0);
+            // Without the leader, there's no group
+            if (i == 0 && fds[0] < 0)
+                return;
+            if (fds[i] >= 0)
+                slot[i] = opened++;
+        }
+        ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    void close() {
+        for (int fd : fds)
+            if (fd >= 0)
+                ::close(fd);
+    }
+
+    PerfSample read() const {
+        if (!available())
+            return {readCycleCounter(), 0, 0, 0};
+        // Layout of a group read: the number of events, then their values in
+        // the order in which they were opened
+        uint64_t buffer[1 + N] = {};
+        if (::read(fds[0], buffer, sizeof(buffer)) <= 0)
+            return invalid();
+        auto value = [&](size_t i) {
+            return fds[i] >= 0 ? buffer[1 + slot[i]] : 0;
+        };
+        return {value(0), value(1), value(2), value(3)};
+    }
+#else
+    void open() {}
+    void close() {}
+    PerfSample read() const { return {readCycleCounter(), 0, 0, 0}; }
+#endif
+
+    std::array<int, N> fds     = {-1, -1, -1, -1};
+    std::array<size_t, N> slot = {};
+    size_t opened              = 0;
+    PerfSample begin           = {};
+};
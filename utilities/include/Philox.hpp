@@ -0,0 +1,221 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief   Counter-based random number generation using Philox4x32-10.
+ *
+ * Philox is a keyed bijection of a 128-bit counter (Salmon, Moraes, Dror and
+ * Shaw, "Parallel Random Numbers: As Easy as 1, 2, 3", SC'11). The output for
+ * a given (key, counter) pair does not depend on any previously generated
+ * numbers, so streams can be split across threads, or evaluated out of
+ * order, without changing the values that are produced.
+ *
+ * The block functions operate on structure-of-arrays lanes, with one simple
+ * loop per round, so the compiler can vectorize them.
+ */
+namespace Philox {
+
+using Counter = std::array<uint32_t, 4>;
+using Key     = std::array<uint32_t, 2>;
+
+constexpr uint32_t M0 = 0xD2511F53;
+constexpr uint32_t M1 = 0xCD9E8D57;
+constexpr uint32_t W0 = 0x9E3779B9;
+constexpr uint32_t W1 = 0xBB67AE85;
+
+constexpr size_t Rounds = 10;
+
+/** @brief   Split a 64-bit seed into a Philox key. */
+constexpr inline Key makeKey(uint64_t seed) {
+    return {uint32_t(seed), uint32_t(seed >> 32)};
+}
+
+/** @brief   Evaluate Philox4x32-10 for a single counter. */
+inline Counter philox4x32(Counter ctr, Key key) {
+    for (size_t r = 0; r < Rounds; ++r) {
+        uint64_t p0 = uint64_t(M0) * ctr[0];
+        uint64_t p1 = uint64_t(M1) * ctr[2];
+        ctr         = {
+            uint32_t(p1 >> 32) ^ ctr[1] ^ key[0],
+            uint32_t(p1),
+            uint32_t(p0 >> 32) ^ ctr[3] ^ key[1],
+            uint32_t(p0),
+        };
+        key[0] += W0;
+        key[1] += W1;
+    }
+    return ctr;
+}
+
+/**
+ * @brief   Evaluate Philox4x32-10 in place for `n` counters, stored as four
+ *          separate arrays of counter words.
+ *
+ * @param   n
+ *          The number of counters (lanes).
+ * @param   c0, c1, c2, c3
+ *          The counter words of each lane, overwritten by the random output.
+ * @param   key
+ *          The key shared by all lanes.
+ */
+inline void philox4x32(size_t n, uint32_t *c0, uint32_t *c1, uint32_t *c2,
+                       uint32_t *c3, Key key) {
+    for (size_t r = 0; r < Rounds; ++r) {
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t p0 = uint64_t(M0) * c0[i];
+            uint64_t p1 = uint64_t(M1) * c2[i];
+            uint32_t x0 = uint32_t(p1 >> 32) ^ c1[i] ^ key[0];
+            uint32_t x2 = uint32_t(p0 >> 32) ^ c3[i] ^ key[1];
+            c0[i]       = x0;
+            c1[i]       = uint32_t(p1);
+            c2[i]       = x2;
+            c3[i]       = uint32_t(p0);
+        }
+        key[0] += W0;
+        key[1] += W1;
+    }
+}
+
+/**
+ * @brief   Convert a 32-bit random integer to a uniform double in the open
+ *          interval (0, 1).
+ *
+ * The result is the midpoint of one of 2³² equal bins, so it's never 0 or 1,
+ * and its logarithm is always finite.
+ */
+constexpr inline double toUniformOpen(uint32_t x) {
+    return (double(x) + 0.5) * 0x1p-32;
+}
+
+/**
+ * @brief   Generate standard normal numbers using the Box–Muller transform
+ *          on the Philox stream (key, {i, c1, c2, c3}), for consecutive
+ *          counter values i = c0, c0 + 1, ..., c0 + ⌈n/4⌉ - 1.
+ *
+ * Each counter produces four 32-bit words, which are turned into two pairs of
+ * normal numbers. The i-th output only depends on the key, the fixed counter
+ * words and its own index, not on `n`, so any range of the stream can be
+ * generated independently.
+ *
+ * @param   key
+ *          The Philox key (e.g. derived from the seed).
+ * @param   c0
+ *          The first value of the counter word that is incremented.
+ * @param   c1, c2, c3
+ *          The remaining counter words, fixed for the entire stream.
+ * @param   out
+ *          Output array of at least `n` elements.
+ * @param   n
+ *          The number of normal numbers to generate.
+ */
+inline void generateStandardNormal(Key key, uint32_t c0, uint32_t c1,
+                                   uint32_t c2, uint32_t c3, double *out,
+                                   size_t n) {
+    constexpr size_t Lanes = 16;
+    constexpr double twopi = 6.283185307179586476925286766559;
+    uint32_t w0[Lanes], w1[Lanes], w2[Lanes], w3[Lanes];
+    double r[2 * Lanes], phi[2 * Lanes], z0[2 * Lanes], z1[2 * Lanes];
+    while (n > 0) {
+        size_t blocks = std::min((n + 3) / 4, Lanes);
+        for (size_t i = 0; i < blocks; ++i) {
+            w0[i] = c0 + uint32_t(i);
+            w1[i] = c1;
+            w2[i] = c2;
+            w3[i] = c3;
+        }
+        philox4x32(blocks, w0, w1, w2, w3, key);
+        for (size_t i = 0; i < blocks; ++i) {
+            r[2 * i + 0]   = -2 * std::log(toUniformOpen(w0[i]));
+            phi[2 * i + 0] = twopi * toUniformOpen(w1[i]);
+            r[2 * i + 1]   = -2 * std::log(toUniformOpen(w2[i]));
+            phi[2 * i + 1] = twopi * toUniformOpen(w3[i]);
+        }
+        for (size_t i = 0; i < 2 * blocks; ++i)
+            r[i] = std::sqrt(r[i]);
+        for (size_t i = 0; i < 2 * blocks; ++i) {
+            z0[i] = r[i] * std::cos(phi[i]);
+            z1[i] = r[i] * std::sin(phi[i]);
+        }
+        size_t count = std::min(n, 4 * blocks);
+        for (size_t j = 0; j < count; ++j)
+            out[j] = j % 2 == 0 ? z0[j / 2] : z1[j / 2];
+        out += count;
+        n -= count;
+        c0 += uint32_t(blocks);
+    }
+}
+
+/**
+ * @brief   A sequential stream of random numbers, with fixed key and counter
+ *          words c1, c2 and c3, e.g. (seed, generation, individual).
+ *
+ * The stream only depends on its key and counter words, not on any other
+ * streams, so giving every task its own stream makes parallel code
+ * reproducible for any number of threads, without sharing any state
+ * between the threads.
+ *
+ * Drawing only normal numbers gives the same sequence as
+ * generateStandardNormal with the same key and counter words, starting at
+ * c0 = 0.
+ */
+class Stream {
+  public:
+    using result_type = uint32_t;
+
+    Stream(Key key, uint32_t c1, uint32_t c2 = 0, uint32_t c3 = 0)
+        : key(key), ctr{0, c1, c2, c3} {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return 0xFFFFFFFF; }
+
+    /// Get the next 32-bit random word.
+    result_type operator()() {
+        if (used == block.size()) {
+            block = philox4x32(ctr, key);
+            ++ctr[0];
+            used = 0;
+        }
+        return block[used++];
+    }
+
+    /// Get a uniform double in the open interval (0, 1).
+    double uniform() { return toUniformOpen((*this)()); }
+
+    /**
+     * @brief   Get a uniform index in [0, n), for n ≤ 2³².
+     *
+     * Uses the high word of a 32×32-bit multiplication, which has a bias of
+     * at most n / 2³², negligible for the small n it's used for.
+     */
+    size_t index(size_t n) { return (uint64_t((*this)()) * n) >> 32; }
+
+    /// Get a standard normal number, using the Box–Muller transform.
+    double normal() {
+        constexpr double twopi = 6.283185307179586476925286766559;
+        if (hasSpare) {
+            hasSpare = false;
+            return spare;
+        }
+        double r   = -2 * std::log(uniform());
+        double phi = twopi * uniform();
+        r          = std::sqrt(r);
+        spare      = r * std::sin(phi);
+        hasSpare   = true;
+        return r * std::cos(phi);
+    }
+
+  private:
+    Key key;
+    Counter ctr;
+    Counter block;
+    size_t used   = 4;  // no words left in block
+    double spare  = 0;
+    bool hasSpare = false;
+};
+
+} // namespace Philox
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "Time.hpp"
+#include "TimeFunction.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+/**
+ * @brief   A time function that is tabulated on a uniform grid of sample
+ *          times @f$ t_k = t_{start} + k T_s @f$, @f$ k = 0 \dots N-1 @f$.
+ *
+ * The source function is evaluated using TimeFunctionT::evaluate, either for
+ * the entire grid at once, or lazily, one chunk of samples at a time. After
+ * that, every lookup is a constant-time read from a contiguous table.
+ *
+ * Between grid points, the value of the previous sample is returned
+ * (zero-order hold). Times before the first sample or after the last one
+ * return the first or last sample respectively.
+ */
+template <class T>
+class SampledTimeFunctionT : public TimeFunctionT<T> {
+  public:
+    /**
+     * @param   f
+     *          The function to sample. When chunkSize is nonzero, it has to
+     *          outlive this object.
+     * @param   t_start
+     *          The time of the first sample.
+     * @param   Ts
+     *          The sample time.
+     * @param   t_end
+     *          The time of the last sample.
+     * @param   chunkSize
+     *          The number of samples to evaluate at once. If zero, all samples
+     *          are evaluated in the constructor.
+     */
+    SampledTimeFunctionT(TimeFunctionT<T> &f, double t_start, double Ts,
+                         double t_end, size_t chunkSize = 0)
+        : f(&f), t_start(t_start), Ts(Ts),
+          N(numberOfSamplesInTimeRange(t_start, Ts, t_end)),
+          chunkSize(chunkSize == 0 ? N : chunkSize) {
+        assert(Ts > 0);
+        table.reserve(N);
+        if (chunkSize == 0)
+            evaluateUntil(N);
+    }
+
+    T operator()(double t) override { return (*this)[getIndex(t)]; }
+
+    void evaluate(const double *t, T *result, size_t n) override {
+        for (size_t i = 0; i < n; ++i)
+            result[i] = (*this)[getIndex(t[i])];
+    }
+
+    /// Get the k-th sample.
+    const T &operator[](size_t k) {
+        assert(k < N);
+        if (k >= table.size())
+            evaluateUntil(std::min(N, (k / chunkSize + 1) * chunkSize));
+        return table[k];
+    }
+
+    /// Get the index of the sample that holds at time t.
+    size_t getIndex(double t) const {
+        // Small tolerance, so t_start + k * Ts always maps to sample k
+        double k = std::floor((t - t_start) / Ts + 1e-9);
+        if (k <= 0)
+            return 0;
+        return std::min(size_t(k), N - 1);
+    }
+
+    double getSampleTime(size_t k) const { return t_start + Ts * k; }
+    size_t size() const { return N; }
+
+  private:
+    void evaluateUntil(size_t end) {
+        size_t begin = table.size();
+        std::vector<double> times(end - begin);
+        for (size_t k = begin; k < end; ++k)
+            times[k - begin] = getSampleTime(k);
+        table.resize(end);
+        f->evaluate(times.data(), table.data() + begin, end - begin);
+    }
+
+    TimeFunctionT<T> *f;
+    const double t_start;
+    const double Ts;
+    const size_t N;
+    const size_t chunkSize;
+    std::vector<T> table;
+};
@@ -1,11 +1,19 @@
 #pragma once
 
+#include <cstddef>
 #include <functional>
 
 template <class T>
 struct TimeFunctionT {
   public:
+    virtual ~TimeFunctionT() = default;
     virtual T operator()(double t) = 0;
+    /// Evaluate the function at the n given times. Implementations can
+    /// override this to evaluate many points at once.
+    virtual void evaluate(const double *t, T *result, size_t n) {
+        for (size_t i = 0; i < n; ++i)
+            result[i] = (*this)(t[i]);
+    }
 };
 
 template <class T>
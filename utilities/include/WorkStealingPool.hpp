@@ -0,0 +1,201 @@
+#pragma once
+
+#include <algorithm>  // max
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief   A pool of threads that runs parallel loops with dynamic load
+ *          balancing by work stealing.
+ *
+ * The iterations of a loop are split into one contiguous range per thread.
+ * Every thread takes the iterations of its own range from the front. When it
+ * runs out of work, it steals the upper half of the remaining range of
+ * another thread. Iterations that take very different amounts of time are
+ * therefore balanced over the threads, while neighboring iterations usually
+ * stay on the same thread.
+ *
+ * The calling thread participates in the loop, so a pool of size 1 has no
+ * worker threads and runs the loop sequentially, in order.
+ *
+ * Only one loop runs at a time: concurrent calls of parallelFor are
+ * serialized, and calling parallelFor from inside a loop body deadlocks.
+ * Nested parallelism should be flattened into a single index space instead,
+ * e.g. `i * M + j` for a loop over i and j.
+ */
+class WorkStealingPool {
+  public:
+    /// Create a pool with the given number of threads, including the calling
+    /// thread.
+    explicit WorkStealingPool(size_t threads = defaultThreads())
+        : ranges(std::max<size_t>(threads, 1)) {
+        for (size_t w = 1; w < ranges.size(); ++w)
+            workers.emplace_back([this, w] { workerLoop(w); });
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stop = true;
+        }
+        startCv.notify_all();
+        for (std::thread &t : workers)
+            t.join();
+    }
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    /// The number of threads, including the calling thread.
+    size_t size() const { return ranges.size(); }
+
+    static size_t defaultThreads() {
+        return std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    /**
+     * @brief   Call `f(i)` for all i in [0, n), and wait until all calls have
+     *          returned.
+     *
+     * @throws  The first exception thrown by `f`. The iterations that didn't
+     *          start yet are skipped.
+     */
+    template <class F>
+    void parallelFor(size_t n, F &&f) {
+        if (n == 0)
+            return;
+        std::lock_guard<std::mutex> serial(callMtx);
+        std::function<void(size_t)> body = std::ref(f);
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            // Workers that woke up too late for the previous loop must leave
+            // before the ranges are reused
+            doneCv.wait(lock, [this] { return active == 0; });
+            const size_t W = ranges.size();
+            for (size_t w = 0; w < W; ++w) {
+                std::lock_guard<std::mutex> rangeLock(ranges[w].mtx);
+                ranges[w].begin = n * w / W;
+                ranges[w].end   = n * (w + 1) / W;
+            }
+            job = &body;
+            remaining.store(n);
+            failed.store(false);
+            error = nullptr;
+            ++epoch;
+            ++active;
+        }
+        startCv.notify_all();
+        work(0, body);
+
+        std::unique_lock<std::mutex> lock(mtx);
+        --active;
+        doneCv.wait(lock,
+                    [this] { return remaining.load() == 0 && active == 0; });
+        job = nullptr;
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+  private:
+    /// The iterations [begin, end) that are still to be done by one thread.
+    struct alignas(64) Range {
+        std::mutex mtx;
+        size_t begin = 0;
+        size_t end   = 0;
+    };
+
+    void workerLoop(size_t w) {
+        size_t seen = 0;
+        while (true) {
+            std::function<void(size_t)> *body;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                startCv.wait(lock, [&] { return stop || epoch != seen; });
+                if (stop)
+                    return;
+                seen = epoch;
+                body = job;
+                ++active;
+            }
+            if (body)
+                work(w, *body);
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                --active;
+            }
+            doneCv.notify_all();
+        }
+    }
+
+    void work(size_t w, const std::function<void(size_t)> &body) {
+        size_t i;
+        while (takeOwn(w, i) || steal(w, i)) {
+            if (!failed.load(std::memory_order_relaxed)) {
+                try {
+                    body(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(mtx);
+                    if (!error)
+                        error = std::current_exception();
+                    failed.store(true);
+                }
+            }
+            if (remaining.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(mtx);
+                doneCv.notify_all();
+            }
+        }
+    }
+
+    bool takeOwn(size_t w, size_t &i) {
+        std::lock_guard<std::mutex> lock(ranges[w].mtx);
+        if (ranges[w].begin == ranges[w].end)
+            return false;
+        i = ranges[w].begin++;
+        return true;
+    }
+
+    bool steal(size_t w, size_t &i) {
+        const size_t W = ranges.size();
+        for (size_t k = 1; k < W; ++k) {
+            Range &victim = ranges[(w + k) % W];
+            size_t begin, end;
+            {
+                std::lock_guard<std::mutex> lock(victim.mtx);
+                if (victim.begin == victim.end)
+                    continue;
+                end          = victim.end;
+                begin        = victim.begin + (victim.end - victim.begin) / 2;
+                victim.end   = begin;
+            }
+            // Our own range is empty, so no other thread can take from it
+            std::lock_guard<std::mutex> lock(ranges[w].mtx);
+            ranges[w].begin = begin + 1;
+            ranges[w].end   = end;
+            i               = begin;
+            return true;
+        }
+        return false;
+    }
+
+    std::vector<Range> ranges;
+    std::vector<std::thread> workers;
+
+    std::mutex callMtx;
+    std::mutex mtx;
+    std::condition_variable startCv;
+    std::condition_variable doneCv;
+    std::function<void(size_t)> *job = nullptr;
+    size_t epoch                     = 0;
+    size_t active                    = 0;
+    bool stop                        = false;
+    std::atomic<size_t> remaining{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+};
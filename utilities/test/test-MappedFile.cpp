@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include <MappedFile.hpp>
+
+#include <vector>
+
+namespace fs = std::filesystem;
+
+TEST(MappedFile, readWrite) {
+    fs::path path = fs::temp_directory_path() / "test-MappedFile.bin";
+    {
+        MappedFile file = {path, MappedFile::ReadWrite, 100 * sizeof(int)};
+        ASSERT_EQ(file.size(), 100 * sizeof(int));
+        int *data = static_cast<int *>(file.data());
+        for (int i = 0; i < 100; ++i)
+            data[i] = i * i;
+    }
+    MappedFile file = MappedFile{path};
+    ASSERT_EQ(file.size(), 100 * sizeof(int));
+    const int *data = static_cast<const int *>(file.data());
+    for (int i = 0; i < 100; ++i)
+        EXPECT_EQ(data[i], i * i);
+    fs::remove(path);
+}
+
+TEST(MappedFile, missingFile) {
+    EXPECT_THROW(MappedFile{"/nonexistent/file"}, std::runtime_error);
+}
+
+struct Record {
+    size_t index;
+    double value;
+};
+
+/**
+ * The records are read back in the order they were written, for any number
+ * of records, including partial blocks.
+ */
+TEST(SpillBuffer, forEachReverse) {
+    for (size_t n : {0, 1, 63, 64, 65, 1000}) {
+        SpillBuffer<Record> buffer(64);
+        for (size_t i = 0; i < n; ++i)
+            buffer.push_back({i, 0.5 * i});
+        EXPECT_EQ(buffer.size(), n);
+        buffer.finish();
+
+        std::vector<size_t> visited;
+        buffer.forEachReverse([&](size_t i, const Record &record) {
+            EXPECT_EQ(record.index, i);
+            EXPECT_EQ(record.value, 0.5 * i);
+            visited.push_back(i);
+        });
+        ASSERT_EQ(visited.size(), n);
+        for (size_t i = 0; i < n; ++i)
+            EXPECT_EQ(visited[i], n - 1 - i);
+        if (n > 0) {
+            EXPECT_EQ(buffer[n / 2].index, n / 2);
+        }
+    }
+}
@@ -0,0 +1,28 @@
+#include <gtest/gtest.h>
+
+#include <PerfCounters.hpp>
+
+// The counters are monotonic, and a longer loop takes more cycles (and
+// retires more instructions, if the hardware counters are available).
+TEST(PerfCounters, monotonic) {
+    PerfCounters counters;
+    auto run = [&](size_t n) {
+        volatile double sum = 0;
+        counters.start();
+        for (size_t i = 0; i < n; ++i)
+            sum = sum + 1.0 / (i + 1);
+        return counters.stop();
+    };
+    run(1000);  // warm up
+    PerfSample shortRun = run(1000);
+    PerfSample longRun  = run(100000);
+    EXPECT_TRUE(shortRun.valid);
+    EXPECT_TRUE(longRun.valid);
+    EXPECT_GT(longRun.cycles, shortRun.cycles);
+    if (counters.available()) {
+        EXPECT_GT(longRun.instructions, 100000);
+        EXPECT_GT(longRun.instructions, shortRun.instructions);
+    } else {
+        EXPECT_EQ(longRun.instructions, 0);
+    }
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <Philox.hpp>
+#include <vector>
+
+using namespace Philox;
+
+// Known-answer tests from the Random123 distribution (kat_vectors).
+
+TEST(Philox, knownAnswerZero) {
+    Counter result   = philox4x32({0, 0, 0, 0}, {0, 0});
+    Counter expected = {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8};
+    ASSERT_EQ(result, expected);
+}
+
+TEST(Philox, knownAnswerOnes) {
+    Counter result   = philox4x32({0xffffffff, 0xffffffff, 0xffffffff,
+                                   0xffffffff},
+                                  {0xffffffff, 0xffffffff});
+    Counter expected = {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd};
+    ASSERT_EQ(result, expected);
+}
+
+TEST(Philox, knownAnswerPi) {
+    Counter result   = philox4x32({0x243f6a88, 0x85a308d3, 0x13198a2e,
+                                   0x03707344},
+                                  {0xa4093822, 0x299f31d0});
+    Counter expected = {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1};
+    ASSERT_EQ(result, expected);
+}
+
+TEST(Philox, lanesMatchScalar) {
+    constexpr size_t n = 37;
+    uint32_t c0[n], c1[n], c2[n], c3[n];
+    Key key = makeKey(0x0123456789abcdef);
+    for (size_t i = 0; i < n; ++i) {
+        c0[i] = i;
+        c1[i] = 3 * i;
+        c2[i] = 0xffffffff - i;
+        c3[i] = 7;
+    }
+    philox4x32(n, c0, c1, c2, c3, key);
+    for (uint32_t i = 0; i < n; ++i) {
+        Counter expected = philox4x32({i, 3 * i, 0xffffffff - i, 7}, key);
+        ASSERT_EQ(c0[i], expected[0]);
+        ASSERT_EQ(c1[i], expected[1]);
+        ASSERT_EQ(c2[i], expected[2]);
+        ASSERT_EQ(c3[i], expected[3]);
+    }
+}
+
+TEST(Philox, standardNormalIndependentOfLength) {
+    Key key = makeKey(42);
+    std::vector<double> all(1000);
+    generateStandardNormal(key, 0, 1, 2, 3, all.data(), all.size());
+    // Generating a sub-range of the stream gives the same numbers
+    std::vector<double> part(101);
+    generateStandardNormal(key, 40, 1, 2, 3, part.data(), part.size());
+    for (size_t i = 0; i < part.size(); ++i)
+        ASSERT_EQ(part[i], all[160 + i]);
+}
+
+TEST(Philox, standardNormalMoments) {
+    std::vector<double> x(1 << 16);
+    generateStandardNormal(makeKey(1), 0, 0, 0, 0, x.data(), x.size());
+    double mean = 0, meansq = 0;
+    for (double v : x) {
+        mean += v;
+        meansq += v * v;
+    }
+    mean /= x.size();
+    meansq /= x.size();
+    ASSERT_NEAR(mean, 0, 0.02);
+    ASSERT_NEAR(meansq - mean * mean, 1, 0.02);
+}
+
+TEST(Philox, streamMatchesBlocks) {
+    Key key       = makeKey(7);
+    Stream stream = {key, 1, 2, 3};
+    for (uint32_t i = 0; i < 5; ++i) {
+        Counter expected = philox4x32({i, 1, 2, 3}, key);
+        for (uint32_t word : expected)
+            ASSERT_EQ(stream(), word);
+    }
+}
+
+TEST(Philox, streamNormalMatchesGenerateStandardNormal) {
+    Key key = makeKey(42);
+    std::vector<double> expected(101);
+    generateStandardNormal(key, 0, 1, 2, 3, expected.data(), expected.size());
+    Stream stream = {key, 1, 2, 3};
+    for (double x : expected)
+        ASSERT_DOUBLE_EQ(stream.normal(), x);
+}
+
+TEST(Philox, streamsAreIndependent) {
+    Key key   = makeKey(42);
+    Stream a1 = {key, 5, 1}, a2 = {key, 5, 1}, b = {key, 5, 2};
+    // Drawing from another stream doesn't affect the numbers of a stream
+    for (size_t i = 0; i < 10; ++i)
+        b();
+    size_t equal = 0;
+    for (size_t i = 0; i < 100; ++i) {
+        uint32_t x = a1();
+        ASSERT_EQ(x, a2());
+        equal += x == b();
+    }
+    ASSERT_LT(equal, 2);
+}
+
+TEST(Philox, streamIndexInRange) {
+    Stream stream = {makeKey(3), 0};
+    std::vector<size_t> counts(7);
+    for (size_t i = 0; i < 7000; ++i) {
+        size_t idx = stream.index(counts.size());
+        ASSERT_LT(idx, counts.size());
+        ++counts[idx];
+    }
+    for (size_t c : counts)
+        ASSERT_NEAR(c, 1000, 150);
+}
+
+TEST(Philox, uniformIsOpenInterval) {
+    ASSERT_GT(toUniformOpen(0), 0);
+    ASSERT_LT(toUniformOpen(0xffffffff), 1);
+    ASSERT_DOUBLE_EQ(toUniformOpen(0x80000000), 0.5 + 0x1p-33);
+}
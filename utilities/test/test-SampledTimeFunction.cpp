@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+
+#include <SampledTimeFunction.hpp>
+
+struct CountingTimeFunction : TimeFunctionT<double> {
+    double operator()(double t) override { return 2 * t + 1; }
+    void evaluate(const double *t, double *result, size_t n) override {
+        ++calls;
+        TimeFunctionT<double>::evaluate(t, result, n);
+    }
+    size_t calls = 0;
+};
+
+TEST(SampledTimeFunction, samples) {
+    CountingTimeFunction f;
+    SampledTimeFunctionT<double> s = {f, 0.5, 0.1, 2.5};
+    ASSERT_EQ(s.size(), 21);
+    ASSERT_EQ(f.calls, 1);
+    for (size_t k = 0; k < s.size(); ++k) {
+        double t = 0.5 + 0.1 * k;
+        ASSERT_EQ(s(t), f(t));
+    }
+    ASSERT_EQ(f.calls, 1);
+}
+
+TEST(SampledTimeFunction, zeroOrderHold) {
+    CountingTimeFunction f;
+    SampledTimeFunctionT<double> s = {f, 0, 0.25, 1};
+    EXPECT_EQ(s(-1), f(0));
+    EXPECT_EQ(s(0.3), f(0.25));
+    EXPECT_EQ(s(0.4999), f(0.25));
+    EXPECT_EQ(s(0.5), f(0.5));
+    EXPECT_EQ(s(7), f(1));
+}
+
+TEST(SampledTimeFunction, chunks) {
+    CountingTimeFunction f;
+    SampledTimeFunctionT<double> s = {f, 0, 0.01, 1, 32};
+    ASSERT_EQ(f.calls, 0);
+    EXPECT_EQ(s(0), f(0));
+    EXPECT_EQ(f.calls, 1);
+    EXPECT_EQ(s(0.31), f(0.31));
+    EXPECT_EQ(f.calls, 1);
+    EXPECT_EQ(s(0.32), f(0.32));
+    EXPECT_EQ(f.calls, 2);
+    // Jumping ahead evaluates all chunks up to the requested sample
+    EXPECT_EQ(s(1), f(1));
+    EXPECT_EQ(f.calls, 3);
+    double t[]      = {0.5, 0.75, 0.25};
+    double result[] = {0, 0, 0};
+    s.evaluate(t, result, 3);
+    for (size_t i = 0; i < 3; ++i)
+        EXPECT_EQ(result[i], f(t[i]));
+    EXPECT_EQ(f.calls, 3);
+}
@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+
+#include <WorkStealingPool.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+TEST(WorkStealingPool, everyIterationOnce) {
+    WorkStealingPool pool{4};
+    ASSERT_EQ(pool.size(), 4);
+    for (size_t n : {1, 3, 4, 1000}) {
+        std::vector<std::atomic<int>> visits(n);
+        pool.parallelFor(n, [&](size_t i) { ++visits[i]; });
+        for (size_t i = 0; i < n; ++i)
+            ASSERT_EQ(visits[i], 1) << "n = " << n << ", i = " << i;
+    }
+}
+
+TEST(WorkStealingPool, sequentialInOrder) {
+    WorkStealingPool pool{1};
+    std::vector<size_t> order;
+    pool.parallelFor(10, [&](size_t i) { order.push_back(i); });
+    std::vector<size_t> expected = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    ASSERT_EQ(order, expected);
+}
+
+TEST(WorkStealingPool, unbalancedWork) {
+    // All the expensive iterations are in the range of the first thread, the
+    // other threads have to steal them
+    WorkStealingPool pool{4};
+    std::vector<std::thread::id> threads(64);
+    pool.parallelFor(threads.size(), [&](size_t i) {
+        if (i < 16)
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        threads[i] = std::this_thread::get_id();
+    });
+    size_t stolen = 0;
+    for (size_t i = 1; i < 16; ++i)
+        stolen += threads[i] != threads[0];
+    EXPECT_GT(stolen, 0);
+}
+
+TEST(WorkStealingPool, exception) {
+    WorkStealingPool pool{3};
+    EXPECT_THROW(pool.parallelFor(100,
+                                  [](size_t i) {
+                                      if (i == 42)
+                                          throw std::runtime_error("42");
+                                  }),
+                 std::runtime_error);
+    // The pool can still be used afterwards
+    std::atomic<size_t> sum{0};
+    pool.parallelFor(100, [&](size_t i) { sum += i; });
+    ASSERT_EQ(sum, 4950);
+}